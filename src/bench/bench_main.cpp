@@ -0,0 +1,703 @@
+/**
+ * SC3020 Database Management System
+ * Benchmark Suite Entry Point
+ *
+ * This file contains the benchmark driver built by `make bench`. For every
+ * row count and key distribution it generates a synthetic data set
+ * (DataGenerator) and measures:
+ * - ingest: IngestPipeline loading the generated games.txt-format file
+ * - full_scan: Database::scan over the heap file
+ * - bulk_load: BPTree::bulkLoad of the (unsorted) FT_PCT_home entries
+ * - search: point BPTree::search of keys present in the tree
+ * - range_search: BPTree::rangeSearch at 0.1%, 1% and 10% selectivity
+ * - remove: BPTree::remove of single entries
+ * - remove_range: BPTree::removeRange at the same selectivities
+ *
+ * Every benchmark is run untimed --warmup times, then timed --repeats
+ * times. Whole-run benchmarks (ingest, full_scan, bulk_load, remove_range)
+ * give one sample per repeat; per-operation benchmarks give one sample per
+ * query. Samples are summarized as p50/p95/p99/mean/min/max and a
+ * throughput, printed and written to a CSV file; --baseline compares the
+ * p50 of every row with a CSV file from an earlier run.
+ *
+ * Usage:
+ *   ./database_bench [--rows N[,N...]] [--sweep] [--distribution NAME|all]
+ *                    [--repeats R] [--warmup W] [--queries Q] [--seed S]
+ *                    [--threads T] [--mmap] [--dir DIR] [--csv PATH]
+ *                    [--baseline PATH] [--keep]
+ *
+ * --sweep runs 1M, 10M and 100M rows. The generated text file and the
+ * database take about 40 and 45 bytes per row on disk, and the index
+ * entries about 16 bytes per row in memory (100M rows: ~9 GB of disk,
+ * ~3 GB of memory).
+ */
+
+// Standard C++ libraries
+#include <iostream>      // For console output
+#include <iomanip>       // For the results table
+#include <fstream>       // For the CSV files
+#include <sstream>       // For parsing arguments and CSV rows
+#include <string>        // For names and paths
+#include <vector>        // For samples and entries
+#include <map>           // For the baseline
+#include <algorithm>     // For sorting samples
+#include <chrono>        // For timing
+#include <cstdio>        // For std::remove
+#include <cstdlib>       // For strtoull, atoi
+#include <sys/stat.h>    // For mkdir
+
+// Project-specific header files
+#include "bench/data_generator.h"      // Synthetic records
+#include "storage/database.h"          // Heap file
+#include "storage/ingest_pipeline.h"   // Bulk loader
+#include "indexing/bptree.h"           // FT_PCT_home index
+#include "utils/parallel.h"            // Thread count
+
+/**
+ * Benchmark Options Structure
+ */
+struct BenchOptions {
+    std::vector<size_t> rows;                      // Data set sizes
+    std::vector<KeyDistribution> distributions;    // Key distributions
+    int repeats;                                   // Timed runs per benchmark
+    int warmup;                                    // Untimed runs per benchmark
+    int queries;                                   // Point operations per run (range queries: a tenth)
+    uint64_t seed;                                 // Generator seed
+    int threads;                                   // Ingest parsers and bulk load threads (0 = hardware)
+    StorageBackend backend;                        // Backend of the heap file and the tree
+    std::string dir;                               // Directory of the generated files
+    std::string csv_path;                          // Results file
+    std::string baseline_path;                     // Earlier results to compare with ("" = none)
+    bool keep_files;                               // Keep the generated files afterwards
+
+    BenchOptions()
+        : repeats(5), warmup(1), queries(1000), seed(3020), threads(0), backend(StorageBackend::STREAM),
+          dir("output/bench"), keep_files(false) {}
+};
+
+/**
+ * Benchmark Result Structure
+ *
+ * One row of the results table.
+ */
+struct BenchResult {
+    size_t rows;                     // Data set size
+    std::string distribution;        // Key distribution
+    std::string name;                // Benchmark
+    std::string param;               // Variant (e.g. selectivity), "-" if none
+    std::vector<double> samples;     // Seconds per sample
+    double items_per_sample;         // Records, entries or operations per sample (for the throughput)
+};
+
+static const double RANGE_SELECTIVITIES[] = {0.001, 0.01, 0.1};
+static const int NUM_SELECTIVITIES = 3;
+
+/**
+ * Seconds Since
+ *
+ * @param start Start time
+ * @return Seconds from start to now
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Percentile
+ *
+ * @param sorted Samples in ascending order (not empty)
+ * @param q Percentile in [0, 1]
+ * @return Nearest-rank percentile
+ */
+static double percentile(const std::vector<double>& sorted, double q) {
+    size_t rank = static_cast<size_t>(q * sorted.size() + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > sorted.size()) rank = sorted.size();
+    return sorted[rank - 1];
+}
+
+/**
+ * Sample Summary Structure
+ */
+struct SampleSummary {
+    double p50, p95, p99, mean, min, max;   // Seconds
+};
+
+static SampleSummary summarize(std::vector<double> samples) {
+    SampleSummary summary = {0, 0, 0, 0, 0, 0};
+    if (samples.empty()) return summary;
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (size_t i = 0; i < samples.size(); i++) sum += samples[i];
+    summary.p50 = percentile(samples, 0.50);
+    summary.p95 = percentile(samples, 0.95);
+    summary.p99 = percentile(samples, 0.99);
+    summary.mean = sum / samples.size();
+    summary.min = samples.front();
+    summary.max = samples.back();
+    return summary;
+}
+
+/**
+ * Draw Index
+ *
+ * Small xorshift stream for picking queries, independent of the data
+ * generator so every benchmark sees the same queries for a seed.
+ *
+ * @param state PRNG state (updated)
+ * @param bound Exclusive upper bound (> 0)
+ * @return Index in [0, bound)
+ */
+static size_t drawIndex(uint64_t& state, size_t bound) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return static_cast<size_t>(state % bound);
+}
+
+static std::string joinPath(const std::string& dir, const std::string& name) {
+    return dir + "/" + name;
+}
+
+/**
+ * Remove File
+ *
+ * @param path Generated file (missing files are ignored)
+ */
+static void removeFile(const std::string& path) {
+    std::remove(path.c_str());
+}
+
+/**
+ * Open Heap File
+ *
+ * @param db Database to open (capacity raised for the data set)
+ * @param options Benchmark options
+ * @return true if the database is open
+ */
+static bool openDatabase(Database& db, const BenchOptions& options) {
+    db.setCapacity(static_cast<size_t>(-1));
+    return db.open(options.backend);
+}
+
+/**
+ * Benchmark Runner Class
+ *
+ * Runs all benchmarks for one data set, collecting the results.
+ */
+class BenchRunner {
+public:
+    BenchRunner(const BenchOptions& options, size_t rows, KeyDistribution distribution)
+        : options(options), rows(rows), distribution(DataGenerator::distributionName(distribution)) {
+        std::ostringstream prefix;
+        prefix << "bench_" << rows << "_" << this->distribution;
+        text_path = joinPath(options.dir, prefix.str() + ".txt");
+        db_path = joinPath(options.dir, prefix.str() + ".bin");
+        tree_path = joinPath(options.dir, prefix.str() + "_bptree.bin");
+        generator_options.num_records = rows;
+        generator_options.distribution = distribution;
+        generator_options.seed = options.seed;
+    }
+
+    /**
+     * Run All Benchmarks
+     *
+     * @param results Destination of the result rows
+     * @return false if a data set could not be built
+     */
+    bool run(std::vector<BenchResult>& results);
+
+private:
+    BenchResult& addResult(std::vector<BenchResult>& results, const std::string& name,
+                           const std::string& param, double items_per_sample);
+    bool runIngest(std::vector<BenchResult>& results);
+    bool runFullScan(std::vector<BenchResult>& results);
+    bool runBulkLoad(std::vector<BenchResult>& results);
+    bool runSearches(std::vector<BenchResult>& results);
+    bool runRemoves(std::vector<BenchResult>& results);
+
+    /**
+     * Build Tree
+     *
+     * @param tree Closed tree (its file is replaced)
+     * @return Seconds spent in bulkLoad and flush, or a negative value on failure
+     */
+    double buildTree(BPTree& tree);
+
+    /**
+     * Range of a Selectivity
+     *
+     * @param selectivity Fraction of the entries to cover
+     * @param start Rank of the first entry in key order
+     * @param min_key Smallest key of the range
+     * @param max_key Largest key of the range
+     */
+    void rangeAt(double selectivity, size_t start, float& min_key, float& max_key) const;
+
+    size_t rangeWidth(double selectivity) const;
+
+    const BenchOptions& options;
+    size_t rows;
+    std::string distribution;
+    GeneratorOptions generator_options;
+    std::string text_path;
+    std::string db_path;
+    std::string tree_path;
+    std::vector<BPTree::Entry> entries;   // Index entries in heap order
+    std::vector<float> sorted_keys;       // Keys of entries, ascending
+};
+
+BenchResult& BenchRunner::addResult(std::vector<BenchResult>& results, const std::string& name,
+                                    const std::string& param, double items_per_sample) {
+    BenchResult result;
+    result.rows = rows;
+    result.distribution = distribution;
+    result.name = name;
+    result.param = param;
+    result.items_per_sample = items_per_sample;
+    results.push_back(result);
+    return results.back();
+}
+
+/**
+ * Run All Benchmarks
+ *
+ * Algorithm:
+ * 1. Generate the text file (untimed)
+ * 2. Ingest it repeatedly; the last load is the heap file of the rest
+ * 3. Scan the heap, collecting the index entries on the first pass
+ * 4. Bulk load, search and remove on the tree
+ */
+bool BenchRunner::run(std::vector<BenchResult>& results) {
+    std::cout << "\n=== " << rows << " rows, " << distribution << " keys ===" << std::endl;
+
+    // Step 1: Generate the data set
+    auto start = std::chrono::steady_clock::now();
+    DataGenerator generator(generator_options);
+    if (!generator.writeText(text_path)) {
+        std::cerr << "Error: Cannot write " << text_path << std::endl;
+        return false;
+    }
+    std::cout << "Generated " << text_path << " in " << std::fixed << std::setprecision(2)
+              << secondsSince(start) << " s" << std::endl;
+
+    // Steps 2-4: Benchmarks
+    bool ok = runIngest(results) && runFullScan(results) && runBulkLoad(results) &&
+              runSearches(results) && runRemoves(results);
+
+    entries.clear();
+    entries.shrink_to_fit();
+    sorted_keys.clear();
+    sorted_keys.shrink_to_fit();
+    if (!options.keep_files) {
+        removeFile(text_path);
+        removeFile(db_path);
+        removeFile(tree_path);
+    }
+    return ok;
+}
+
+bool BenchRunner::runIngest(std::vector<BenchResult>& results) {
+    BenchResult& result = addResult(results, "ingest", "-", static_cast<double>(rows));
+    IngestOptions ingest_options;
+    ingest_options.parser_threads = options.threads;
+    for (int run = 0; run < options.warmup + options.repeats; run++) {
+        removeFile(db_path);
+        Database db(db_path);
+        if (!openDatabase(db, options)) return false;
+        auto start = std::chrono::steady_clock::now();
+        IngestPipeline pipeline(db, ingest_options);
+        bool loaded = pipeline.run(text_path);
+        db.close();
+        double seconds = secondsSince(start);
+        if (!loaded) {
+            std::cerr << "Error: Ingest of " << text_path << " failed" << std::endl;
+            return false;
+        }
+        if (run >= options.warmup) result.samples.push_back(seconds);
+    }
+    return true;
+}
+
+/**
+ * Full Scan
+ *
+ * An untimed first pass collects the index entries (heap order) and the
+ * sorted keys used to pick the queries.
+ */
+bool BenchRunner::runFullScan(std::vector<BenchResult>& results) {
+    Database db(db_path);
+    if (!openDatabase(db, options)) return false;
+    entries.reserve(static_cast<size_t>(db.getNumRecords()));
+    db.scan([this](const Record& record, int block_id, int record_index) {
+        entries.push_back(BPTree::Entry(record.ft_pct_home, RecordPointer(block_id, record_index)));
+    });
+    if (entries.size() != rows) {
+        std::cerr << "Error: Heap holds " << entries.size() << " records, expected " << rows << std::endl;
+        return false;
+    }
+
+    BenchResult& result = addResult(results, "full_scan", "-", static_cast<double>(rows));
+    for (int run = 0; run < options.warmup + options.repeats; run++) {
+        long long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        db.scan([&checksum](const Record& record, int, int) { checksum += record.pts_home; });
+        double seconds = secondsSince(start);
+        if (checksum == 0) return false;
+        if (run >= options.warmup) result.samples.push_back(seconds);
+    }
+    db.close();
+
+    sorted_keys.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) sorted_keys[i] = entries[i].first;
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+    return true;
+}
+
+double BenchRunner::buildTree(BPTree& tree) {
+    removeFile(tree_path);
+    if (!tree.open(options.backend)) return -1;
+    auto start = std::chrono::steady_clock::now();
+    bool built = tree.bulkLoad(entries, 1.0, options.threads) && tree.flush();
+    double seconds = secondsSince(start);
+    return built ? seconds : -1;
+}
+
+bool BenchRunner::runBulkLoad(std::vector<BenchResult>& results) {
+    BenchResult& result = addResult(results, "bulk_load", "-", static_cast<double>(rows));
+    for (int run = 0; run < options.warmup + options.repeats; run++) {
+        BPTree tree(tree_path);
+        double seconds = buildTree(tree);
+        tree.close();
+        if (seconds < 0) {
+            std::cerr << "Error: Bulk load failed" << std::endl;
+            return false;
+        }
+        if (run >= options.warmup) result.samples.push_back(seconds);
+    }
+    return true;
+}
+
+size_t BenchRunner::rangeWidth(double selectivity) const {
+    size_t width = static_cast<size_t>(selectivity * sorted_keys.size());
+    return width < 1 ? 1 : width;
+}
+
+void BenchRunner::rangeAt(double selectivity, size_t start, float& min_key, float& max_key) const {
+    size_t width = rangeWidth(selectivity);
+    if (start + width > sorted_keys.size()) start = sorted_keys.size() - width;
+    min_key = sorted_keys[start];
+    max_key = sorted_keys[start + width - 1];
+}
+
+/**
+ * Point and Range Searches
+ *
+ * Point keys are drawn from the entries, so every search finds at least
+ * one record; ranges start at random key ranks. Keys repeat, so a range
+ * can return more entries than its nominal selectivity.
+ */
+bool BenchRunner::runSearches(std::vector<BenchResult>& results) {
+    BPTree tree(tree_path);
+    if (!tree.open(options.backend)) return false;
+
+    // Point searches
+    BenchResult& search = addResult(results, "search", "-", 1);
+    uint64_t state = options.seed | 1;
+    long long found = 0;
+    for (int run = 0; run < options.warmup + options.repeats; run++) {
+        for (int q = 0; q < options.queries; q++) {
+            float key = entries[drawIndex(state, entries.size())].first;
+            auto start = std::chrono::steady_clock::now();
+            found += static_cast<long long>(tree.search(key).size());
+            double seconds = secondsSince(start);
+            if (run >= options.warmup) search.samples.push_back(seconds);
+        }
+    }
+
+    // Range searches, a tenth as many per run
+    int range_queries = options.queries / 10 > 0 ? options.queries / 10 : 1;
+    for (int s = 0; s < NUM_SELECTIVITIES; s++) {
+        std::ostringstream param;
+        param << "sel=" << RANGE_SELECTIVITIES[s];
+        BenchResult& range = addResult(results, "range_search", param.str(), 1);
+        for (int run = 0; run < options.warmup + options.repeats; run++) {
+            for (int q = 0; q < range_queries; q++) {
+                float min_key, max_key;
+                rangeAt(RANGE_SELECTIVITIES[s], drawIndex(state, sorted_keys.size()), min_key, max_key);
+                auto start = std::chrono::steady_clock::now();
+                found += static_cast<long long>(tree.rangeSearch(min_key, max_key).size());
+                double seconds = secondsSince(start);
+                if (run >= options.warmup) range.samples.push_back(seconds);
+            }
+        }
+    }
+    tree.close();
+    return found > 0;
+}
+
+/**
+ * Removes
+ *
+ * Each run starts from a freshly bulk-loaded tree (untimed), removes
+ * --queries random entries one at a time, flushes (untimed), then removes
+ * one range per selectivity, each timed with its flush. The ranges start at 10%, 40% and 70% of the key order, so
+ * they do not overlap.
+ */
+bool BenchRunner::runRemoves(std::vector<BenchResult>& results) {
+    // Rows are added up front: results[first] is remove, then one per selectivity
+    size_t first = results.size();
+    addResult(results, "remove", "-", 1);
+    for (int s = 0; s < NUM_SELECTIVITIES; s++) {
+        std::ostringstream param;
+        param << "sel=" << RANGE_SELECTIVITIES[s];
+        addResult(results, "remove_range", param.str(), static_cast<double>(rangeWidth(RANGE_SELECTIVITIES[s])));
+    }
+
+    uint64_t state = (options.seed * 31) | 1;
+    for (int run = 0; run < options.warmup + options.repeats; run++) {
+        BPTree tree(tree_path);
+        if (buildTree(tree) < 0) return false;
+        bool timed = run >= options.warmup;
+
+        for (int q = 0; q < options.queries; q++) {
+            float key = entries[drawIndex(state, entries.size())].first;
+            auto start = std::chrono::steady_clock::now();
+            tree.remove(key);
+            double seconds = secondsSince(start);
+            if (timed) results[first].samples.push_back(seconds);
+        }
+        tree.flush();
+        for (int s = 0; s < NUM_SELECTIVITIES; s++) {
+            float min_key, max_key;
+            rangeAt(RANGE_SELECTIVITIES[s], sorted_keys.size() * (1 + 3 * s) / 10, min_key, max_key);
+            auto start = std::chrono::steady_clock::now();
+            tree.removeRange(min_key, max_key);
+            tree.flush();
+            double seconds = secondsSince(start);
+            if (timed) results[first + 1 + s].samples.push_back(seconds);
+        }
+        tree.close();
+    }
+    return true;
+}
+
+/**
+ * Result Key
+ *
+ * @return Key of a result row in the baseline
+ */
+static std::string resultKey(size_t rows, const std::string& distribution, const std::string& name,
+                             const std::string& param) {
+    std::ostringstream key;
+    key << rows << "," << distribution << "," << name << "," << param;
+    return key.str();
+}
+
+/**
+ * Print Results
+ *
+ * @param results Result rows
+ * @param baseline p50 seconds by row key, from --baseline (may be empty)
+ */
+static void printResults(const std::vector<BenchResult>& results, const std::map<std::string, double>& baseline) {
+    std::cout << "\n=== BENCHMARK RESULTS (microseconds per sample) ===" << std::endl;
+    std::cout << std::left << std::setw(11) << "rows" << std::setw(12) << "keys" << std::setw(14) << "benchmark"
+              << std::setw(11) << "param" << std::right << std::setw(8) << "samples" << std::setw(14) << "p50"
+              << std::setw(14) << "p95" << std::setw(14) << "p99" << std::setw(14) << "max"
+              << std::setw(14) << "items/s";
+    if (!baseline.empty()) std::cout << std::setw(12) << "p50 vs base";
+    std::cout << std::endl;
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        SampleSummary summary = summarize(result.samples);
+        std::cout << std::left << std::setw(11) << result.rows << std::setw(12) << result.distribution
+                  << std::setw(14) << result.name << std::setw(11) << result.param << std::right
+                  << std::setw(8) << result.samples.size() << std::fixed << std::setprecision(2)
+                  << std::setw(14) << summary.p50 * 1e6 << std::setw(14) << summary.p95 * 1e6
+                  << std::setw(14) << summary.p99 * 1e6 << std::setw(14) << summary.max * 1e6
+                  << std::setprecision(0) << std::setw(14)
+                  << (summary.mean > 0 ? result.items_per_sample / summary.mean : 0.0);
+        if (!baseline.empty()) {
+            std::map<std::string, double>::const_iterator base =
+                baseline.find(resultKey(result.rows, result.distribution, result.name, result.param));
+            if (base != baseline.end() && base->second > 0) {
+                std::cout << std::showpos << std::setprecision(1) << std::setw(11)
+                          << (summary.p50 / base->second - 1.0) * 100.0 << "%" << std::noshowpos;
+            } else {
+                std::cout << std::setw(12) << "-";
+            }
+        }
+        std::cout << std::endl;
+    }
+}
+
+/**
+ * Write CSV
+ *
+ * @param path Output path
+ * @param results Result rows
+ * @return true if the file was written
+ */
+static bool writeCsv(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path.c_str());
+    if (!out.is_open()) return false;
+    out << "rows,distribution,benchmark,param,samples,p50_us,p95_us,p99_us,mean_us,min_us,max_us,items_per_second\n";
+    out << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        SampleSummary summary = summarize(result.samples);
+        out << result.rows << "," << result.distribution << "," << result.name << "," << result.param << ","
+            << result.samples.size() << "," << summary.p50 * 1e6 << "," << summary.p95 * 1e6 << ","
+            << summary.p99 * 1e6 << "," << summary.mean * 1e6 << "," << summary.min * 1e6 << ","
+            << summary.max * 1e6 << "," << (summary.mean > 0 ? result.items_per_sample / summary.mean : 0.0)
+            << "\n";
+    }
+    return out.good();
+}
+
+/**
+ * Read Baseline
+ *
+ * @param path CSV file written by an earlier run
+ * @param baseline p50 seconds by row key
+ * @return false if the file could not be read
+ */
+static bool readBaseline(const std::string& path, std::map<std::string, double>& baseline) {
+    std::ifstream in(path.c_str());
+    if (!in.is_open()) return false;
+    std::string line;
+    std::getline(in, line);   // Header
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::stringstream row(line);
+        std::string field;
+        while (std::getline(row, field, ',')) fields.push_back(field);
+        if (fields.size() < 6) continue;
+        baseline[resultKey(strtoull(fields[0].c_str(), nullptr, 10), fields[1], fields[2], fields[3])] =
+            atof(fields[5].c_str()) / 1e6;
+    }
+    return true;
+}
+
+/**
+ * Parse Row Counts
+ *
+ * @param list Comma-separated counts
+ * @param rows Parsed counts (> 0)
+ * @return false if the list is malformed
+ */
+static bool parseRows(const std::string& list, std::vector<size_t>& rows) {
+    rows.clear();
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        char* end = nullptr;
+        unsigned long long count = strtoull(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || count == 0) return false;
+        rows.push_back(static_cast<size_t>(count));
+    }
+    return !rows.empty();
+}
+
+static void printUsage() {
+    std::cout << "Usage: ./database_bench [--rows N[,N...]] [--sweep] [--distribution NAME|all]\n"
+              << "                        [--repeats R] [--warmup W] [--queries Q] [--seed S]\n"
+              << "                        [--threads T] [--mmap] [--dir DIR] [--csv PATH]\n"
+              << "                        [--baseline PATH] [--keep]\n"
+              << "Distributions: uniform, skewed, sorted, duplicates (default: uniform)\n"
+              << "--sweep runs 1000000, 10000000 and 100000000 rows" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    options.rows.push_back(1000000);
+    options.distributions.push_back(KeyDistribution::UNIFORM);
+    bool csv_set = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--rows" && has_value) {
+            if (!parseRows(argv[++i], options.rows)) {
+                std::cerr << "Error: Invalid row counts " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--sweep") {
+            parseRows("1000000,10000000,100000000", options.rows);
+        } else if (arg == "--distribution" && has_value) {
+            std::string name = argv[++i];
+            options.distributions.clear();
+            if (name == "all") {
+                options.distributions.push_back(KeyDistribution::UNIFORM);
+                options.distributions.push_back(KeyDistribution::SKEWED);
+                options.distributions.push_back(KeyDistribution::SORTED);
+                options.distributions.push_back(KeyDistribution::DUPLICATES);
+            } else {
+                KeyDistribution distribution;
+                if (!DataGenerator::parseDistribution(name, distribution)) {
+                    std::cerr << "Error: Unknown distribution " << name << std::endl;
+                    return 1;
+                }
+                options.distributions.push_back(distribution);
+            }
+        } else if (arg == "--repeats" && has_value) {
+            options.repeats = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--warmup" && has_value) {
+            options.warmup = std::max(0, atoi(argv[++i]));
+        } else if (arg == "--queries" && has_value) {
+            options.queries = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--seed" && has_value) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && has_value) {
+            options.threads = atoi(argv[++i]);
+        } else if (arg == "--mmap") {
+            options.backend = StorageBackend::MMAP;
+        } else if (arg == "--dir" && has_value) {
+            options.dir = argv[++i];
+        } else if (arg == "--csv" && has_value) {
+            options.csv_path = argv[++i];
+            csv_set = true;
+        } else if (arg == "--baseline" && has_value) {
+            options.baseline_path = argv[++i];
+        } else if (arg == "--keep") {
+            options.keep_files = true;
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (!csv_set) options.csv_path = joinPath(options.dir, "results.csv");
+
+    std::map<std::string, double> baseline;
+    if (!options.baseline_path.empty() && !readBaseline(options.baseline_path, baseline)) {
+        std::cerr << "Error: Cannot read baseline " << options.baseline_path << std::endl;
+        return 1;
+    }
+    mkdir(options.dir.c_str(), 0755);
+
+    std::cout << "SC3020 Database Management System Benchmarks" << std::endl;
+    std::cout << "================================================" << std::endl;
+    std::cout << "Repeats: " << options.repeats << " (+" << options.warmup << " warm-up), queries per run: "
+              << options.queries << ", seed: " << options.seed << ", threads: " << resolveThreads(options.threads)
+              << ", backend: " << (options.backend == StorageBackend::MMAP ? "mmap" : "stream") << std::endl;
+
+    std::vector<BenchResult> results;
+    bool ok = true;
+    for (size_t r = 0; r < options.rows.size() && ok; r++) {
+        for (size_t d = 0; d < options.distributions.size() && ok; d++) {
+            BenchRunner runner(options, options.rows[r], options.distributions[d]);
+            ok = runner.run(results);
+        }
+    }
+
+    printResults(results, baseline);
+    if (writeCsv(options.csv_path, results)) {
+        std::cout << "\n✓ Results saved to " << options.csv_path << std::endl;
+    } else {
+        std::cerr << "Error: Cannot write " << options.csv_path << std::endl;
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+/**
+ * SC3020 Database Management System
+ * Data Generator Implementation
+ *
+ * This file contains the implementation of DataGenerator: the PRNG, the
+ * key distributions, the date sequence and the text file writer.
+ *
+ */
+
+#include "data_generator.h"
+#include <cstdio>    // For snprintf and the text file
+#include <cstring>   // For strlen, memcpy
+
+namespace {
+
+const int FIRST_TEAM_ID = 1610612737;   // TEAM_ID_home of the first of 30 teams
+const int NUM_TEAMS = 30;
+const long FIRST_DAY = 12053;            // 1/1/2003 in days since 1/1/1970
+
+/**
+ * Date of a Day
+ *
+ * Civil date of a day count (days-from-civil inverse, proleptic Gregorian).
+ *
+ * @param days Days since 1/1/1970
+ * @param out D/M/YYYY, null-terminated
+ */
+void formatDay(long days, char out[11]) {
+    long z = days + 719468;
+    long era = (z >= 0 ? z : z - 146096) / 146097;
+    long doe = z - era * 146097;
+    long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long mp = (5 * doy + 2) / 153;
+    long day = doy - (153 * mp + 2) / 5 + 1;
+    long month = mp < 10 ? mp + 3 : mp - 9;
+    long year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+    char text[64];
+    snprintf(text, sizeof(text), "%ld/%ld/%04ld", day, month, year);
+    size_t length = strlen(text) < 10 ? strlen(text) : 10;
+    memcpy(out, text, length);
+    out[length] = '\0';
+}
+
+} // namespace
+
+DataGenerator::DataGenerator(const GeneratorOptions& options) : options(options) {
+    if (this->options.distinct_keys < 1) this->options.distinct_keys = 1;
+    records_per_day = options.num_records / DATE_SPAN_DAYS + 1;
+    restart();
+}
+
+void DataGenerator::restart() {
+    state = options.seed;
+    position = 0;
+    cached_day = -1;
+}
+
+uint64_t DataGenerator::nextRandom() {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int DataGenerator::nextKeyRank() {
+    int distinct = options.distinct_keys;
+    switch (options.distribution) {
+        case KeyDistribution::SKEWED: {
+            double u = uniform();
+            return static_cast<int>(distinct * u * u * u);
+        }
+        case KeyDistribution::SORTED:
+            return static_cast<int>(static_cast<double>(position) * distinct / options.num_records);
+        case KeyDistribution::DUPLICATES: {
+            int slot = static_cast<int>(nextRandom() % DUPLICATE_KEYS);
+            return slot * (distinct - 1) / (DUPLICATE_KEYS - 1);
+        }
+        case KeyDistribution::UNIFORM:
+        default:
+            return static_cast<int>(nextRandom() % static_cast<uint64_t>(distinct));
+    }
+}
+
+const char* DataGenerator::currentDate() {
+    long day = static_cast<long>(position / records_per_day);
+    if (day >= DATE_SPAN_DAYS) day = DATE_SPAN_DAYS - 1;
+    if (day != cached_day) {
+        formatDay(FIRST_DAY + day, cached_date);
+        cached_day = day;
+    }
+    return cached_date;
+}
+
+/**
+ * Next Record
+ *
+ * The key is drawn first, then the other columns from ranges like the
+ * real data (FG_PCT 0.350-0.600, 80-139 points, ...). A quarter of the
+ * results contradict the points (105+ usually wins).
+ */
+bool DataGenerator::next(Record& record) {
+    if (position >= options.num_records) return false;
+    int rank = nextKeyRank();
+    uint64_t bits = nextRandom();
+    int pts = 80 + static_cast<int>(bits % 60);
+    record = Record(currentDate(), FIRST_TEAM_ID + static_cast<int>((bits >> 8) % NUM_TEAMS), pts,
+                    (350 + static_cast<int>((bits >> 16) % 251)) / 1000.0f, keyOf(rank),
+                    (200 + static_cast<int>((bits >> 28) % 301)) / 1000.0f,
+                    15 + static_cast<int>((bits >> 40) % 20), 30 + static_cast<int>((bits >> 48) % 25),
+                    (pts >= 105) != (((bits >> 60) & 3) == 0) ? 1 : 0);
+    position++;
+    return true;
+}
+
+size_t DataGenerator::fill(Record* records, size_t count) {
+    size_t n = 0;
+    while (n < count && next(records[n])) n++;
+    return n;
+}
+
+bool DataGenerator::writeText(const std::string& path) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (out == nullptr) return false;
+    restart();
+    bool ok = fputs("GAME_DATE_EST\tTEAM_ID_home\tPTS_home\tFG_PCT_home\tFT_PCT_home\t"
+                    "FG3_PCT_home\tAST_home\tREB_home\tHOME_TEAM_WINS\n", out) >= 0;
+    Record record;
+    while (ok && next(record)) {
+        ok = fprintf(out, "%s\t%d\t%d\t%.3f\t%.3f\t%.3f\t%d\t%d\t%d\n", record.game_date, record.team_id_home,
+                     record.pts_home, record.fg_pct_home, record.ft_pct_home, record.fg3_pct_home,
+                     record.ast_home, record.reb_home, record.home_team_wins) > 0;
+    }
+    restart();
+    return fclose(out) == 0 && ok;
+}
+
+bool DataGenerator::parseDistribution(const std::string& name, KeyDistribution& distribution) {
+    static const KeyDistribution ALL[] = {
+        KeyDistribution::UNIFORM, KeyDistribution::SKEWED, KeyDistribution::SORTED, KeyDistribution::DUPLICATES
+    };
+    for (size_t i = 0; i < sizeof(ALL) / sizeof(ALL[0]); i++) {
+        if (name == distributionName(ALL[i])) {
+            distribution = ALL[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* DataGenerator::distributionName(KeyDistribution distribution) {
+    switch (distribution) {
+        case KeyDistribution::SKEWED: return "skewed";
+        case KeyDistribution::SORTED: return "sorted";
+        case KeyDistribution::DUPLICATES: return "duplicates";
+        case KeyDistribution::UNIFORM:
+        default: return "uniform";
+    }
+}
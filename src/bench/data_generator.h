@@ -0,0 +1,158 @@
+/**
+ * SC3020 Database Management System
+ * Data Generator Header
+ *
+ * This file defines DataGenerator, a source of synthetic game records for
+ * the benchmark suite. Streams of any size are produced in constant memory,
+ * either as Records or as a games.txt-format file for the ingest pipeline.
+ *
+ * Key Distributions (FT_PCT_home, on a grid of distinct_keys values
+ * 0.001 apart starting at 0.400):
+ * - UNIFORM: every key equally likely
+ * - SKEWED: key rank = distinct_keys * u^3, so the lowest fifth of the keys
+ *   holds about 58% of the records
+ * - SORTED: keys ascend over the stream (inserts arrive in key order)
+ * - DUPLICATES: only 8 distinct keys, so every key has a long run of
+ *   duplicates spanning many leaves
+ *
+ * The generator uses its own splitmix64 PRNG instead of <random>
+ * distributions, whose output differs between standard libraries: a seed
+ * gives the same stream on every platform, so results stay comparable
+ * with a baseline. Dates ascend over the stream, spread evenly over the
+ * DATE_SPAN_DAYS days from 1/1/2003, so the heap file is date-ordered like
+ * the real one.
+ */
+
+#ifndef DATA_GENERATOR_H
+#define DATA_GENERATOR_H
+
+// Include record structure
+#include "../storage/record.h"
+
+// Standard C++ libraries
+#include <string>    // For distribution names and paths
+#include <cstdint>   // For the PRNG state
+#include <cstddef>   // For size_t
+
+/**
+ * Key Distribution Enumeration
+ */
+enum class KeyDistribution {
+    UNIFORM,
+    SKEWED,
+    SORTED,
+    DUPLICATES
+};
+
+/**
+ * Generator Options Structure
+ */
+struct GeneratorOptions {
+    size_t num_records;              // Records in the stream
+    KeyDistribution distribution;    // Distribution of FT_PCT_home
+    uint64_t seed;                   // PRNG seed (same seed = same stream)
+    int distinct_keys;               // Key grid size (DUPLICATES uses 8)
+
+    GeneratorOptions()
+        : num_records(1000000), distribution(KeyDistribution::UNIFORM), seed(3020), distinct_keys(601) {}
+};
+
+/**
+ * Data Generator Class
+ */
+class DataGenerator {
+public:
+    static const int DATE_SPAN_DAYS = 7305;     // 1/1/2003 - 31/12/2022
+    static const int DUPLICATE_KEYS = 8;        // Distinct keys of DUPLICATES
+
+    explicit DataGenerator(const GeneratorOptions& options);
+
+    /**
+     * Next Record
+     *
+     * @param record Filled with the next record of the stream
+     * @return false once num_records records have been produced
+     */
+    bool next(Record& record);
+
+    /**
+     * Fill Buffer
+     *
+     * @param records Destination array
+     * @param count Capacity of the array
+     * @return Records written (less than count only at the end of the stream)
+     */
+    size_t fill(Record* records, size_t count);
+
+    /**
+     * Restart Stream
+     *
+     * Rewinds to the first record; the stream is produced again identically.
+     */
+    void restart();
+
+    size_t getPosition() const { return position; }
+
+    /**
+     * Key of a Rank
+     *
+     * @param rank Index into the key grid
+     * @return The FT_PCT_home value of the rank
+     */
+    static float keyOf(int rank) { return (400 + rank) / 1000.0f; }
+
+    /**
+     * Write Text File
+     *
+     * Writes the whole stream (restarted first) as a games.txt-format file
+     * with a header row, readable by Parser and IngestPipeline.
+     *
+     * @param path Output path
+     * @return true if every line was written
+     */
+    bool writeText(const std::string& path);
+
+    /**
+     * Parse Distribution Name
+     *
+     * @param name "uniform", "skewed", "sorted" or "duplicates"
+     * @param distribution Set on success
+     * @return false if the name is unknown
+     */
+    static bool parseDistribution(const std::string& name, KeyDistribution& distribution);
+
+    static const char* distributionName(KeyDistribution distribution);
+
+private:
+    /**
+     * Next Random Value
+     *
+     * @return 64 uniformly distributed bits (splitmix64)
+     */
+    uint64_t nextRandom();
+
+    /**
+     * Uniform Random
+     *
+     * @return Uniform double in [0, 1)
+     */
+    double uniform() { return (nextRandom() >> 11) * (1.0 / 9007199254740992.0); }
+
+    int nextKeyRank();
+
+    /**
+     * Date of the Current Position
+     *
+     * @return D/M/YYYY of the record at position (cached per day)
+     */
+    const char* currentDate();
+
+    GeneratorOptions options;   // Stream parameters
+    uint64_t state;             // PRNG state
+    size_t records_per_day;     // Records sharing a date
+    size_t position;            // Records produced since the last restart
+    long cached_day;            // Day of cached_date (-1 = none)
+    char cached_date[11];       // D/M/YYYY of cached_day
+};
+
+#endif // DATA_GENERATOR_H
@@ -1,8 +1,20 @@
 #include "bptree.h"
+#include "node_search.h"
+#include "../utils/parallel.h"
 #include <iostream>
 #include <algorithm>
 #include <queue>
 #include <cmath>
+#include <fcntl.h>     // For open
+#include <unistd.h>    // For pread, pwrite, close
+#include <sys/stat.h>  // For fstat
+
+namespace {
+
+// Nodes built in memory by bulkLoadSorted before they are written (1 MB)
+const size_t BULK_BATCH_NODES = 256;
+
+} // namespace
 
 /**
  * B+ Tree Constructor
@@ -12,119 +24,475 @@
  * how many keys each node can hold, which affects tree performance.
  * 
  * @param fname Path to the B+ tree file
+ * @param leaf_cache_size Number of leaf nodes kept in the node cache
  */
-BPTree::BPTree(const std::string& fname) : filename(fname), root_id(-1), next_node_id(0), index_nodes_accessed(0), total_index_node_ios(0) {
-    // Use MAX_KEYS as the order (101 in this implementation)
-    // This ensures optimal node utilization
-    order = BPTreeNode::MAX_KEYS;
+template <typename Key>
+BasicBPTree<Key>::BasicBPTree(const std::string& fname, size_t leaf_cache_size)
+    : filename(fname), backend(StorageBackend::STREAM), fd(-1), root_id(-1), next_node_id(0),
+      free_node_head(-1), num_free_nodes(0), height(0), log(nullptr), log_file_id(-1), metadata_dirty(false),
+      read_ahead_leaves(DEFAULT_LEAF_READ_AHEAD),
+      cache(leaf_cache_size,
+            [this](int node_id, Node& node) { return readNodeFromDisk(node_id, node); },
+            [this](int node_id, const Node& node) { return writeNodeToDisk(node_id, node); }),
+      node_read_latency(nullptr), node_write_latency(nullptr) {
+    // The node arrays hold MAX_KEYS entries (derived from the page size).
+    // One slot is kept free so a node can overflow by one entry before it
+    // is split, without writing past the end of its arrays.
+    order = Node::MAX_KEYS - 1;
     if (order < 3) order = 3; // Minimum order for B+ tree validity
 }
 
-BPTree::~BPTree() {
+template <typename Key>
+BasicBPTree<Key>::~BasicBPTree() {
     close();
 }
 
-bool BPTree::open() {
-    file.open(filename, std::ios::binary | std::ios::in | std::ios::out);
-    if (!file.is_open()) {
-        // Create new file if it doesn't exist
-        file.open(filename, std::ios::binary | std::ios::out);
-        file.close();
-        file.open(filename, std::ios::binary | std::ios::in | std::ios::out);
-        
-        // Initialize root
-        BPTreeNode root;
+template <typename Key>
+bool BasicBPTree<Key>::open(StorageBackend backend) {
+    ExclusiveLatchGuard guard(tree_latch);
+    this->backend = backend;
+    
+    bool is_new;
+    if (backend == StorageBackend::MMAP) {
+        // Map the file; a new (empty) file gets a root leaf and metadata
+        if (!mapped.open(filename)) return false;
+        is_new = mapped.size() < static_cast<size_t>(Node::PAGE_SIZE);
+    } else {
+        // Create the file if it doesn't exist
+        // Recover the log before reading any metadata it may replace
+        if (log != nullptr && !log->open()) return false;
+        fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) return false;
+        struct stat info;
+        is_new = fstat(fd, &info) != 0 || info.st_size == 0;
+        if (log != nullptr) {
+            log_file_id = log->registerFile(filename, [this]() { return flush(); });
+            if (log_file_id < 0) {
+                ::close(fd);
+                fd = -1;
+                return false;
+            }
+        }
+    }
+    
+    if (is_new) {
+        // Initialize root and write metadata
+        Node root;
         root_id = createNode(root);
-        
-        // Write metadata
         writeMetadata();
     } else {
         // Load existing metadata
         readMetadata();
+        reserveLatches(next_node_id);
     }
-    return file.is_open();
+    height = computeHeight();
+    return true;
 }
 
-void BPTree::close() {
-    if (file.is_open()) {
-        // Write metadata before closing
+template <typename Key>
+void BasicBPTree<Key>::close() {
+    ExclusiveLatchGuard guard(tree_latch);
+    if (backend == StorageBackend::MMAP) {
+        if (mapped.isOpen()) {
+            // Checkpoint, then unmap and trim the file to its logical size
+            writeBack();
+            mapped.close();
+        }
+        return;
+    }
+    
+    if (fd >= 0) {
+        // Write back cached nodes and metadata before closing
+        writeBack();
+        if (log_file_id >= 0) {
+            log->unregisterFile(log_file_id);
+            log_file_id = -1;
+        }
+        ::close(fd);
+        fd = -1;
+        cache.clear();
+    }
+}
+
+template <typename Key>
+bool BasicBPTree<Key>::flush() {
+    ExclusiveLatchGuard guard(tree_latch);
+    return writeBack();
+}
+
+template <typename Key>
+bool BasicBPTree<Key>::writeBack() {
+    if (!isOpen()) return false;
+    
+    if (backend == StorageBackend::MMAP) {
         writeMetadata();
-        file.close();
+        return mapped.sync();
     }
+    
+    bool ok = cache.flushAll();
+    return storeMetadata() && ok;
 }
 
-bool BPTree::isOpen() const {
-    return file.is_open();
+template <typename Key>
+bool BasicBPTree<Key>::isOpen() const {
+    return backend == StorageBackend::MMAP ? mapped.isOpen() : fd >= 0;
 }
 
-bool BPTree::writeNode(int node_id, const BPTreeNode& node) {
-    if (!file.is_open()) return false;
+template <typename Key>
+bool BasicBPTree<Key>::writeNode(int node_id, const Node& node) {
+    if (!isOpen() || node_id < 0) return false;
     
-    // Skip metadata (8 bytes) and write node
-    file.seekp(8 + node_id * sizeof(BPTreeNode));
-    file.write(reinterpret_cast<const char*>(&node), sizeof(BPTreeNode));
+    // Increment I/O counter for performance measurement (logical access)
+    countAccess(node_id);
     
-    // Increment I/O counter for performance measurement
-    index_nodes_accessed++;
-    total_index_node_ios++;
-    unique_index_nodes.insert(node_id);
+    // Mapped: write in place. Otherwise write-back: the cache writes the node to the file later
+    if (backend == StorageBackend::MMAP) {
+        return writeNodeToDisk(node_id, node);
+    }
+    if (activeLog() != nullptr) log->logPage(log_file_id, nodeOffset(node_id), &node, sizeof(Node));
+    return cache.put(node_id, node);
+}
+
+template <typename Key>
+bool BasicBPTree<Key>::readNode(int node_id, Node& node) const {
+    const Node* source = viewNode(node_id, node);
+    if (source == nullptr) return false;
     
-    return file.good();
+    if (source != &node) node = *source;
+    return true;
 }
 
-bool BPTree::readNode(int node_id, BPTreeNode& node) const {
-    if (!file.is_open()) return false;
+template <typename Key>
+const BasicBPTreeNode<Key>* BasicBPTree<Key>::viewNode(int node_id, Node& buffer) const {
+    if (!isOpen() || node_id < 0) return nullptr;
+    
+    const Node* node = nullptr;
+    if (backend == StorageBackend::MMAP) {
+        // Point straight into the mapped file
+        if (static_cast<size_t>(nodeOffset(node_id)) + sizeof(Node) > mapped.size()) return nullptr;
+        node = reinterpret_cast<const Node*>(mapped.data() + nodeOffset(node_id));
+    } else {
+        node = cache.get(node_id, buffer);
+    }
+    if (node == nullptr) return nullptr;
     
-    // Skip metadata (8 bytes) and read node
-    file.seekg(8 + node_id * sizeof(BPTreeNode));
-    file.read(reinterpret_cast<char*>(&node), sizeof(BPTreeNode));
+    // Increment I/O counter for performance measurement (logical access)
+    countAccess(node_id);
     
-    // Increment I/O counter for performance measurement
-    index_nodes_accessed++;
-    total_index_node_ios++;
-    unique_index_nodes.insert(node_id);
+    return node;
+}
+
+template <typename Key>
+void BasicBPTree<Key>::countAccess(int node_id) const {
+    index_nodes_accessed.add();
+    total_index_node_ios.add();
+    NodeLatch* latch = latchFor(node_id);
+    if (latch != nullptr) latch->accessed.store(true, std::memory_order_relaxed);
+}
+
+template <typename Key>
+bool BasicBPTree<Key>::readNodeFromDisk(int node_id, Node& node) const {
+    LatencyTimer timer(node_read_latency);
+    if (backend == StorageBackend::MMAP) {
+        return mapped.read(static_cast<size_t>(nodeOffset(node_id)), &node, sizeof(Node));
+    }
     
-    return file.good();
+    // Skip the metadata page and read the node's page; pread does not move
+    // a shared file position, so threads can read concurrently
+    return pread(fd, &node, sizeof(Node), nodeOffset(node_id)) == static_cast<ssize_t>(sizeof(Node));
 }
 
-int BPTree::createNode(const BPTreeNode& node) {
-    if (!file.is_open()) return -1;
+template <typename Key>
+bool BasicBPTree<Key>::writeNodeToDisk(int node_id, const Node& node) const {
+    LatencyTimer timer(node_write_latency);
+    if (backend == StorageBackend::MMAP) {
+        return mapped.write(static_cast<size_t>(nodeOffset(node_id)), &node, sizeof(Node));
+    }
+    
+    // WAL rule: the node's committed image reaches the log first
+    if (activeLog() != nullptr && !log->beforeWrite(log_file_id, nodeOffset(node_id), sizeof(Node))) return false;
     
-    int node_id = next_node_id++;
+    // Skip the metadata page and write the node's page
+    return pwrite(fd, &node, sizeof(Node), nodeOffset(node_id)) == static_cast<ssize_t>(sizeof(Node));
+}
+
+template <typename Key>
+int BasicBPTree<Key>::createNode(const Node& node) {
+    if (!isOpen()) return -1;
+    
+    int node_id;
+    if (free_node_head != -1) {
+        // Reuse a freed node; its next_leaf links the free-node list
+        Node free_node;
+        if (!readNode(free_node_head, free_node)) return -1;
+        node_id = free_node_head;
+        free_node_head = free_node.next_leaf;
+        num_free_nodes--;
+    } else {
+        node_id = next_node_id++;
+        reserveLatches(next_node_id);
+    }
     if (writeNode(node_id, node)) {
         return node_id;
     }
     return -1;
 }
 
-int BPTree::findLeaf(float key) {
-    if (root_id == -1) return -1;
+template <typename Key>
+int BasicBPTree<Key>::findLeaf(Key key) {
+    Node leaf;
+    return findLeaf(key, leaf);
+}
+
+template <typename Key>
+int BasicBPTree<Key>::findLeaf(Key key, Node& node) {
+    int leaf_id = -1;
+    const Node* leaf = findLeafNode(key, leaf_id, node);
+    if (leaf == nullptr) return -1;
+    
+    if (leaf != &node) node = *leaf;
+    return leaf_id;
+}
+
+template <typename Key>
+const BasicBPTreeNode<Key>* BasicBPTree<Key>::findLeafNode(Key key, int& leaf_id, Node& buffer) {
+    if (root_id == -1) return nullptr;
+    
+    // Visit each node on the root-to-leaf path exactly once, copying only a cached leaf
+    int current = root_id;
+    while (true) {
+        const Node* node = viewNode(current, buffer);
+        if (node == nullptr) return nullptr;
+        if (node->is_leaf) {
+            leaf_id = current;
+            return node;
+        }
+        
+        // Follow the leftmost child that can hold the key: a run of equal
+        // keys may continue to the left of a separator equal to the key
+        int i = NodeSearch::lowerBound(node->keys, node->num_keys, key);
+        current = static_cast<int>(node->children[i]);
+    }
+}
+
+template <typename Key>
+void BasicBPTree<Key>::reserveLatches(int count) {
+    while (node_latches.size() < static_cast<size_t>(count)) {
+        node_latches.push_back(std::unique_ptr<NodeLatch>(new NodeLatch()));
+    }
+}
+
+template <typename Key>
+int BasicBPTree<Key>::computeHeight() const {
+    if (root_id == -1) return 0;
     
+    int levels = 1;
     int current = root_id;
-    BPTreeNode node;
+    Node node;
     
-    while (!readNode(current, node) || node.is_leaf == false) {
-        if (!readNode(current, node)) return -1;
+    while (readNode(current, node) && !node.is_leaf) {
+        current = static_cast<int>(node.children[0]);
+        levels++;
+    }
+    
+    return levels;
+}
+
+template <typename Key>
+const BasicBPTreeNode<Key>* BasicBPTree<Key>::descendLatched(Key key, int& leaf_id, Node& buffer, bool exclusive_leaf) const {
+    if (root_id == -1 || height < 1) return nullptr;
+    
+    // Internal nodes change only under the exclusive tree latch, so they are read unlatched
+    int current = root_id;
+    for (int depth = 1; depth < height; depth++) {
+        const Node* node = viewNode(current, buffer);
+        if (node == nullptr || node->is_leaf) return nullptr;
+        int i = NodeSearch::lowerBound(node->keys, node->num_keys, key);
+        current = static_cast<int>(node->children[i]);
+    }
+    
+    // Latch the leaf before reading it
+    NodeLatch* latch = latchFor(current);
+    if (latch == nullptr) return nullptr;
+    if (exclusive_leaf) {
+        latch->latch.lock();
+    } else {
+        latch->latch.lockShared();
+    }
+    
+    const Node* leaf = viewNode(current, buffer);
+    if (leaf == nullptr || !leaf->is_leaf) {
+        unlatchNode(current, exclusive_leaf);
+        return nullptr;
+    }
+    leaf_id = current;
+    return leaf;
+}
+
+template <typename Key>
+void BasicBPTree<Key>::unlatchNode(int node_id, bool exclusive) const {
+    NodeLatch* latch = latchFor(node_id);
+    if (latch == nullptr) return;
+    if (exclusive) {
+        latch->latch.unlock();
+    } else {
+        latch->latch.unlockShared();
+    }
+}
+
+/**
+ * Leaf Read-Ahead Class
+ * 
+ * Bulk loading numbers the leaves in key order, so a walk that steps from
+ * leaf i to leaf i + 1 is likely to continue with i + 2, i + 3, ... On such
+ * a step the next window of leaves not in the cache is submitted to an
+ * IOQueue; the window starts at two leaves and doubles on every
+ * sequential step (up to read_ahead_leaves and half the leaf cache), so
+ * short walks read little beyond their end. A walk that jumps resets it.
+ * A read leaf is added to the node cache (BasicNodeCache::fill) when the
+ * walk reaches it, or when the walk ends.
+ */
+template <typename Key>
+class BasicBPTree<Key>::LeafReadAhead {
+public:
+    explicit LeafReadAhead(const BasicBPTree& tree) : tree(tree), window(0), submitted_end(-1) {}
+    
+    ~LeafReadAhead() {
+        // Completed reads still go to the cache; the next walk may need them
+        IOCompletion completion;
+        while (queue && queue->waitAny(completion)) complete(completion);
+    }
+    
+    /**
+     * Advance
+     * 
+     * Called before the walk reads next_id: takes its read if one is in
+     * flight and extends the window on a sequential step.
+     * 
+     * @param leaf_id Leaf the walk is on
+     * @param next_id Next leaf in the chain (-1 at the end)
+     */
+    void advance(int leaf_id, int next_id) {
+        if (tree.read_ahead_leaves <= 0 || next_id < 0) return;
+        IOCompletion completion;
+        if (queue && queue->waitFor(static_cast<uint64_t>(next_id), completion)) complete(completion);
+        if (next_id != leaf_id + 1) {
+            window = 0;
+            return;
+        }
         
-        int i = 0;
-        while (i < node.num_keys && key >= node.keys[i]) {
-            i++;
+        int limit = std::min(tree.read_ahead_leaves, std::max(1, static_cast<int>(tree.cache.getLeafCapacity() / 2)));
+        window = window == 0 ? std::min(2, limit) : std::min(window * 2, limit);
+        int begin = std::max(next_id + 1, submitted_end);
+        int end = std::min(next_id + 1 + window, tree.next_node_id);
+        if (begin >= end) return;
+        
+        if (tree.backend == StorageBackend::MMAP) {
+            tree.mapped.willNeed(static_cast<size_t>(nodeOffset(begin)), static_cast<size_t>(end - begin) * Node::PAGE_SIZE);
+            submitted_end = end;
+            return;
+        }
+        
+        if (!queue) {
+            queue.reset(new IOQueue(tree.read_ahead_leaves));
+            buffers.resize(queue->getDepth());
+            for (int i = queue->getDepth() - 1; i >= 0; i--) free_slots.push_back(i);
+        }
+        int id = begin;
+        for (; id < end && !free_slots.empty(); id++) {
+            if (tree.cache.contains(id)) continue;
+            Pending read;
+            read.node_id = id;
+            read.slot = free_slots.back();
+            read.sequence = tree.cache.getWriteBackSequence();
+            if (!queue->submitRead(tree.fd, static_cast<int64_t>(nodeOffset(id)), &buffers[read.slot], sizeof(Node),
+                                   static_cast<uint64_t>(id))) {
+                break;
+            }
+            free_slots.pop_back();
+            pending.push_back(read);
+        }
+        submitted_end = id;
+    }
+    
+private:
+    /**
+     * Read Structure
+     */
+    struct Pending {
+        int node_id;          // Node read
+        int slot;             // Buffer it is read into
+        long long sequence;   // Cache write-back sequence when submitted
+    };
+    
+    void complete(const IOCompletion& completion) {
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (pending[i].node_id != static_cast<int>(completion.tag)) continue;
+            if (completion.result == static_cast<ssize_t>(sizeof(Node))) {
+                tree.cache.fill(pending[i].node_id, buffers[pending[i].slot], pending[i].sequence);
+            }
+            free_slots.push_back(pending[i].slot);
+            pending.erase(pending.begin() + i);
+            return;
         }
-        current = node.children[i];
     }
     
-    return current;
+    const BasicBPTree& tree;          // Tree walked
+    std::unique_ptr<IOQueue> queue;   // Created on the first sequential step
+    std::vector<Node> buffers;        // One per queue slot
+    std::vector<int> free_slots;      // Buffers not in use
+    std::vector<Pending> pending;     // Reads in flight
+    int window;                       // Leaves per step (0 until a sequential step)
+    int submitted_end;                // One past the last leaf read ahead
+};
+
+template <typename Key>
+template <typename Visitor>
+void BasicBPTree<Key>::walkRange(Key min_key, Key max_key, const Visitor& visit, const Key* below) const {
+    // Two buffers: the next leaf is read while the current one is still latched
+    Node buffers[2];
+    int current = 0;
+    int leaf_id = -1;
+    const Node* leaf = descendLatched(min_key, leaf_id, buffers[current], false);
+    LeafReadAhead ahead(*this);
+    
+    while (leaf != nullptr) {
+        int begin = NodeSearch::lowerBound(leaf->keys, leaf->num_keys, min_key);
+        int end = NodeSearch::scanGreater(leaf->keys, begin, leaf->num_keys, max_key);
+        if (below != nullptr) end = std::max(begin, std::min(end, NodeSearch::lowerBound(leaf->keys, leaf->num_keys, *below)));
+        visit(*leaf, begin, end);
+        
+        // Stop past the maximum key; otherwise latch the next leaf before letting go of this one
+        int next_id = end < leaf->num_keys ? -1 : leaf->next_leaf;
+        ahead.advance(leaf_id, next_id);
+        const Node* next = nullptr;
+        NodeLatch* next_latch = latchFor(next_id);
+        if (next_latch != nullptr) {
+            next_latch->latch.lockShared();
+            next = viewNode(next_id, buffers[1 - current]);
+            if (next == nullptr) next_latch->latch.unlockShared();
+        }
+        unlatchNode(leaf_id, false);
+        
+        leaf = next;
+        leaf_id = next_id;
+        current = 1 - current;
+    }
 }
 
-void BPTree::insertIntoLeaf(int leaf_id, float key, const RecordPointer& ptr) {
-    BPTreeNode leaf;
+template <typename Key>
+void BasicBPTree<Key>::insertIntoLeaf(int leaf_id, Key key, const RecordPointer& ptr) {
+    Node leaf;
     if (!readNode(leaf_id, leaf)) return;
+    insertIntoLeaf(leaf_id, leaf, key, ptr);
+}
+
+template <typename Key>
+void BasicBPTree<Key>::insertIntoLeaf(int leaf_id, const Node& current, Key key, const RecordPointer& ptr) {
+    Node leaf = current;
     
-    // Find insertion position
-    int i = 0;
-    while (i < leaf.num_keys && leaf.keys[i] < key) {
-        i++;
-    }
+    // Find insertion position (before any equal keys)
+    int i = NodeSearch::lowerBound(leaf.keys, leaf.num_keys, key);
     
     // Shift elements to make room
     for (int j = leaf.num_keys; j > i; j--) {
@@ -134,18 +502,19 @@ void BPTree::insertIntoLeaf(int leaf_id, float key, const RecordPointer& ptr) {
     
     // Insert new key and pointer
     leaf.keys[i] = key;
-    leaf.children[i] = ptr.block_id * 10000 + ptr.record_index; // Encode pointer
+    leaf.children[i] = ptr.pack(); // Packed 64-bit record pointer
     leaf.num_keys++;
     
     writeNode(leaf_id, leaf);
 }
 
-void BPTree::splitLeaf(int leaf_id) {
-    BPTreeNode leaf;
+template <typename Key>
+void BasicBPTree<Key>::splitLeaf(int leaf_id) {
+    Node leaf;
     if (!readNode(leaf_id, leaf)) return;
     
     // Create new leaf
-    BPTreeNode new_leaf;
+    Node new_leaf;
     new_leaf.is_leaf = true;
     new_leaf.next_leaf = leaf.next_leaf;
     new_leaf.parent = leaf.parent;
@@ -169,14 +538,15 @@ void BPTree::splitLeaf(int leaf_id) {
     writeNode(new_leaf_id, new_leaf);
     
     // Insert into parent
-    float promote_key = new_leaf.keys[0];
+    Key promote_key = new_leaf.keys[0];
     insertIntoParent(leaf_id, promote_key, new_leaf_id);
 }
 
-void BPTree::insertIntoParent(int left_id, float key, int right_id) {
+template <typename Key>
+void BasicBPTree<Key>::insertIntoParent(int left_id, Key key, int right_id) {
     if (root_id == left_id) {
         // Create new root
-        BPTreeNode new_root;
+        Node new_root;
         new_root.is_leaf = false;
         new_root.keys[0] = key;
         new_root.children[0] = left_id;
@@ -186,7 +556,7 @@ void BPTree::insertIntoParent(int left_id, float key, int right_id) {
         root_id = createNode(new_root);
         
         // Update children's parent pointers
-        BPTreeNode left_node, right_node;
+        Node left_node, right_node;
         readNode(left_id, left_node);
         readNode(right_id, right_node);
         
@@ -197,7 +567,7 @@ void BPTree::insertIntoParent(int left_id, float key, int right_id) {
         writeNode(right_id, right_node);
     } else {
         // Insert into existing parent
-        BPTreeNode parent;
+        Node parent;
         readNode(left_id, parent);
         int parent_id = parent.parent;
         readNode(parent_id, parent);
@@ -227,12 +597,13 @@ void BPTree::insertIntoParent(int left_id, float key, int right_id) {
     }
 }
 
-void BPTree::splitInternal(int node_id) {
-    BPTreeNode node;
+template <typename Key>
+void BasicBPTree<Key>::splitInternal(int node_id) {
+    Node node;
     if (!readNode(node_id, node)) return;
     
     // Create new internal node
-    BPTreeNode new_node;
+    Node new_node;
     new_node.is_leaf = false;
     new_node.parent = node.parent;
     
@@ -240,7 +611,7 @@ void BPTree::splitInternal(int node_id) {
     
     // Redistribute keys and children
     int mid = node.num_keys / 2;
-    float promote_key = node.keys[mid];
+    Key promote_key = node.keys[mid];
     
     for (int i = mid + 1; i < node.num_keys; i++) {
         new_node.keys[new_node.num_keys] = node.keys[i];
@@ -255,31 +626,73 @@ void BPTree::splitInternal(int node_id) {
     writeNode(node_id, node);
     writeNode(new_node_id, new_node);
     
+    // The moved children now belong to the new node
+    for (int i = 0; i <= new_node.num_keys; i++) {
+        setParent(static_cast<int>(new_node.children[i]), new_node_id);
+    }
+    
     // Insert into parent
     insertIntoParent(node_id, promote_key, new_node_id);
 }
 
-bool BPTree::insert(float key, const RecordPointer& ptr) {
+/**
+ * Insert Key-Value Pair
+ * 
+ * Tries the in-leaf insert under the shared tree latch first; an insert
+ * that splits its leaf retries under the exclusive tree latch.
+ * 
+ * @param key Key value to insert
+ * @param ptr Record pointer to insert
+ * @return true if insertion was successful
+ */
+template <typename Key>
+bool BasicBPTree<Key>::insert(Key key, const RecordPointer& ptr) {
+    LogTransaction transaction(activeLog());
+    SharedLatchGuard shared(tree_latch);
+    if (insertInPlace(key, ptr)) return true;
+    shared.release();
+    
+    ExclusiveLatchGuard exclusive(tree_latch);
+    bool inserted = insertWithSplits(key, ptr);
+    height = computeHeight();
+    if (activeLog() != nullptr) writeMetadata();
+    return inserted;
+}
+
+template <typename Key>
+bool BasicBPTree<Key>::insertInPlace(Key key, const RecordPointer& ptr) {
+    Node buffer;
+    int leaf_id = -1;
+    const Node* leaf = descendLatched(key, leaf_id, buffer, true);
+    if (leaf == nullptr) return false;
+    
+    // The leaf is latched and already read, so it is updated without another access
+    bool fits = leaf->num_keys < order;
+    if (fits) insertIntoLeaf(leaf_id, *leaf, key, ptr);
+    unlatchNode(leaf_id, true);
+    return fits;
+}
+
+template <typename Key>
+bool BasicBPTree<Key>::insertWithSplits(Key key, const RecordPointer& ptr) {
     if (root_id == -1) {
         // Create root leaf
-        BPTreeNode root;
+        Node root;
         root.is_leaf = true;
         root.keys[0] = key;
-        root.children[0] = ptr.block_id * 10000 + ptr.record_index;
+        root.children[0] = ptr.pack();
         root.num_keys = 1;
         root_id = createNode(root);
         return true;
     }
     
-    int leaf_id = findLeaf(key);
+    Node leaf;
+    int leaf_id = findLeaf(key, leaf);
     if (leaf_id == -1) return false;
     
-    BPTreeNode leaf;
-    if (!readNode(leaf_id, leaf)) return false;
-    
     // Check if leaf has space
     if (leaf.num_keys < order) {
-        insertIntoLeaf(leaf_id, key, ptr);
+        insertIntoLeaf(leaf_id, leaf, key, ptr);
     } else {
         // Leaf is full, need to split
         insertIntoLeaf(leaf_id, key, ptr);
@@ -289,26 +702,23 @@ bool BPTree::insert(float key, const RecordPointer& ptr) {
     return true;
 }
 
-std::vector<RecordPointer> BPTree::search(float key) {
-    std::vector<RecordPointer> results;
-    
-    int leaf_id = findLeaf(key);
-    if (leaf_id == -1) return results;
-    
-    BPTreeNode leaf;
-    if (!readNode(leaf_id, leaf)) return results;
-    
-    // Search in leaf node
-    for (int i = 0; i < leaf.num_keys; i++) {
-        if (leaf.keys[i] == key) {
-            int encoded_ptr = leaf.children[i];
-            int block_id = encoded_ptr / 10000;
-            int record_index = encoded_ptr % 10000;
-            results.push_back(RecordPointer(block_id, record_index));
-        }
+template <typename Key>
+std::vector<RecordPointer> BasicBPTree<Key>::search(Key key) {
+    // Equal keys form one contiguous run, which may span several leaves
+    return rangeSearch(key, key);
+}
+
+template <typename Key>
+void BasicBPTree<Key>::appendPointers(const Node& leaf, int begin, int end, std::vector<RecordPointer>& results) {
+    if (end <= begin) return;
+    
+    // Grow once, then unpack the span in a tight loop
+    size_t base = results.size();
+    results.resize(base + (end - begin));
+    RecordPointer* out = &results[base];
+    for (int i = begin; i < end; i++) {
+        *out++ = RecordPointer::unpack(leaf.children[i]);
     }
-    
-    return results;
 }
 
 /**
@@ -319,9 +729,11 @@ std::vector<RecordPointer> BPTree::search(float key) {
  * 
  * Algorithm:
  * 1. Find the leaf node that should contain min_key
- * 2. Scan through leaf nodes sequentially
- * 3. Collect all keys in the range
- * 4. Decode record pointers and return results
+ * 2. Scan through leaf nodes sequentially, latching the next leaf before
+ *    releasing the current one
+ * 3. In each leaf, binary search the first key >= min_key and scan
+ *    (vectorized) for the first key > max_key
+ * 4. Decode the whole span of record pointers and return results
  * 
  * Time Complexity: O(log n + k) where k is the number of results
  * Space Complexity: O(k) for storing results
@@ -330,160 +742,396 @@ std::vector<RecordPointer> BPTree::search(float key) {
  * @param max_key Maximum key value (inclusive)
  * @return Vector of record pointers in the range
  */
-std::vector<RecordPointer> BPTree::rangeSearch(float min_key, float max_key) {
+template <typename Key>
+std::vector<RecordPointer> BasicBPTree<Key>::rangeSearch(Key min_key, Key max_key) {
     std::vector<RecordPointer> results;
+    SharedLatchGuard guard(tree_latch);
     
-    // Step 1: Find the leaf node that should contain min_key
-    int leaf_id = findLeaf(min_key);
-    if (leaf_id == -1) return results; // Tree is empty
-    
-    // Step 2: Scan through leaf nodes sequentially
-    BPTreeNode leaf;
-    while (leaf_id != -1 && readNode(leaf_id, leaf)) {
-        // Step 3: Check each key in the current leaf
-        for (int i = 0; i < leaf.num_keys; i++) {
-            if (leaf.keys[i] >= min_key && leaf.keys[i] <= max_key) {
-                // Key is in range, decode the record pointer
-                int encoded_ptr = leaf.children[i];
-                int block_id = encoded_ptr / 10000;      // Extract block ID
-                int record_index = encoded_ptr % 10000;  // Extract record index
-                results.push_back(RecordPointer(block_id, record_index));
+    // Steps 1-3: Descend to the leaf that should contain min_key and walk
+    // the leaf chain until a key exceeds max_key (walkRange)
+    walkRange(min_key, max_key, [&results](const Node& leaf, int begin, int end) {
+        // Step 4: Copy the whole span at once
+        appendPointers(leaf, begin, end, results);
+    });
+    
+    return results;
+}
+
+template <typename Key>
+std::vector<Key> BasicBPTree<Key>::splitRange(Key min_key, Key max_key, int parts) const {
+    std::vector<Key> keys;
+    if (root_id == -1 || parts < 2 || max_key < min_key) return keys;
+    
+    // Separators of the nodes covering the range, one level at a time; a
+    // level's keys include those of the levels above, so only the last is kept
+    std::vector<int> level(1, root_id);
+    for (int depth = 1; depth < height && !level.empty(); depth++) {
+        std::vector<Key> level_keys;
+        std::vector<int> children;
+        Node buffer;
+        for (size_t n = 0; n < level.size(); n++) {
+            const Node* node = viewNode(level[n], buffer);
+            if (node == nullptr || node->is_leaf) continue;
+            int first = NodeSearch::lowerBound(node->keys, node->num_keys, min_key);
+            int last = NodeSearch::upperBound(node->keys, node->num_keys, max_key);
+            for (int i = first; i < last; i++) {
+                if (min_key < node->keys[i]) level_keys.push_back(node->keys[i]);
             }
+            for (int i = first; i <= last; i++) children.push_back(static_cast<int>(node->children[i]));
         }
         
-        // Step 4: Stop if we've gone past the maximum key
-        if (leaf.keys[leaf.num_keys - 1] > max_key) break;
-        // Move to the next leaf node
-        leaf_id = leaf.next_leaf;
+        // Boundaries between the nodes of this level are separators of the level above
+        level_keys.insert(level_keys.end(), keys.begin(), keys.end());
+        std::sort(level_keys.begin(), level_keys.end());
+        level_keys.erase(std::unique(level_keys.begin(), level_keys.end()), level_keys.end());
+        keys.swap(level_keys);
+        if (keys.size() + 1 >= static_cast<size_t>(parts)) break;
+        level.swap(children);
+    }
+    
+    // Keep parts - 1 evenly spaced keys
+    if (keys.size() + 1 > static_cast<size_t>(parts)) {
+        std::vector<Key> chosen;
+        for (int p = 1; p < parts; p++) chosen.push_back(keys[keys.size() * p / parts]);
+        chosen.erase(std::unique(chosen.begin(), chosen.end()), chosen.end());
+        keys.swap(chosen);
+    }
+    return keys;
+}
+
+/**
+ * Parallel Range Search
+ * 
+ * Algorithm:
+ * 1. Cut [min_key, max_key] at separator keys of the internal nodes into
+ *    about four sub-ranges per thread (splitRange)
+ * 2. Scan the sub-ranges on a work-stealing pool; sub-range i is
+ *    [k_i, k_i+1), the last one ends at max_key, and each fills its own
+ *    result vector
+ * 3. Concatenate the vectors in sub-range order
+ * 
+ * A run of equal keys is found whole by the sub-range that starts at it,
+ * because descents go to the leftmost leaf that can hold a key.
+ * 
+ * @param min_key Minimum key value (inclusive)
+ * @param max_key Maximum key value (inclusive)
+ * @param num_threads Number of threads (0 = one per hardware thread)
+ * @return Vector of record pointers in the range, in key order
+ */
+template <typename Key>
+std::vector<RecordPointer> BasicBPTree<Key>::parallelRangeSearch(Key min_key, Key max_key, int num_threads) {
+    std::vector<RecordPointer> results;
+    SharedLatchGuard guard(tree_latch);
+    
+    // Step 1: Sub-range bounds; starts[i] begins sub-range i
+    int threads = resolveThreads(num_threads);
+    std::vector<Key> starts(1, min_key);
+    if (threads > 1) {
+        std::vector<Key> split = splitRange(min_key, max_key, threads * 4);
+        starts.insert(starts.end(), split.begin(), split.end());
     }
     
+    // Step 2: Scan the sub-ranges in parallel
+    std::vector<std::vector<RecordPointer> > parts(starts.size());
+    parallelForStealing(starts.size(), 1, threads, [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; i++) {
+            std::vector<RecordPointer>& out = parts[i];
+            const Key* below = i + 1 < starts.size() ? &starts[i + 1] : nullptr;
+            walkRange(starts[i], max_key, [&out](const Node& leaf, int first, int last) {
+                appendPointers(leaf, first, last, out);
+            }, below);
+        }
+    });
+    
+    // Step 3: Concatenate in key order
+    if (parts.size() == 1) return std::move(parts[0]);
+    size_t total = 0;
+    for (size_t i = 0; i < parts.size(); i++) total += parts[i].size();
+    results.reserve(total);
+    for (size_t i = 0; i < parts.size(); i++) {
+        results.insert(results.end(), parts[i].begin(), parts[i].end());
+    }
     return results;
 }
 
 /**
- * Bulk Load B+ Tree
+ * Scan Range (Index Only)
  * 
- * Efficiently constructs a B+ tree from sorted data using the bulk loading
- * algorithm. This method is much faster than individual insertions because
- * it builds the tree bottom-up in a single pass.
+ * Same leaf walk as rangeSearch(), handing each entry to the callback
+ * instead of collecting pointers.
  * 
- * Algorithm:
- * 1. Sort all data by key value
- * 2. Create leaf nodes and fill them with sorted data
- * 3. Link leaf nodes together for range queries
- * 4. Build internal nodes bottom-up
- * 5. Set root node
+ * @param min_key Minimum key value (inclusive)
+ * @param max_key Maximum key value (inclusive)
+ * @param callback Function called as callback(key, record_pointer)
+ * @return Number of entries visited
+ */
+template <typename Key>
+int BasicBPTree<Key>::scanRange(Key min_key, Key max_key, const EntryCallback& callback) {
+    int visited = 0;
+    SharedLatchGuard guard(tree_latch);
+    
+    walkRange(min_key, max_key, [&](const Node& leaf, int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            callback(leaf.keys[i], RecordPointer::unpack(leaf.children[i]));
+        }
+        visited += end - begin;
+    });
+    return visited;
+}
+
+/**
+ * Count Range (Index Only)
+ * 
+ * Adds up the span length in each leaf of the range.
+ * 
+ * @param min_key Minimum key value (inclusive)
+ * @param max_key Maximum key value (inclusive)
+ * @return Number of entries in the range
+ */
+template <typename Key>
+int BasicBPTree<Key>::countRange(Key min_key, Key max_key) {
+    int count = 0;
+    SharedLatchGuard guard(tree_latch);
+    
+    walkRange(min_key, max_key, [&count](const Node&, int begin, int end) {
+        count += end - begin;
+    });
+    return count;
+}
+
+/**
+ * Bulk Load B+ Tree
+ * 
+ * Sorts a copy of the data (unless it is already sorted) and hands it to
+ * bulkLoadSorted().
  * 
- * Time Complexity: O(n log n) for sorting + O(n) for tree construction
- * Space Complexity: O(n) for storing the tree
+ * Time Complexity: O(n) for the radix sort + O(n) for tree construction
  * 
  * @param data Vector of key-value pairs to insert
+ * @param leaf_fill Fraction of each leaf to fill
+ * @param num_threads Threads for sorting and building (0 = one per hardware thread)
  * @return true if bulk loading was successful
  */
-bool BPTree::bulkLoad(const std::vector<std::pair<float, RecordPointer>>& data) {
+template <typename Key>
+bool BasicBPTree<Key>::bulkLoad(const std::vector<Entry>& data, double leaf_fill, int num_threads) {
     if (data.empty()) return false;
     
-    // Step 1: Sort data by key for efficient bulk loading
-    // This ensures that records are stored in sorted order in leaf nodes
-    std::vector<std::pair<float, RecordPointer>> sorted_data = data;
-    std::sort(sorted_data.begin(), sorted_data.end());
-    
-    // Step 2: Create leaf nodes and fill them with sorted data
-    // Each leaf node can hold up to 'order' number of keys
-    std::vector<int> leaf_nodes;  // Store leaf node IDs for linking
-    int current_leaf = -1;        // ID of the current leaf being filled
-    BPTreeNode leaf;              // Current leaf node being constructed
-    
-    for (size_t i = 0; i < sorted_data.size(); i++) {
-        // Create a new leaf node when we reach the order limit
-        if (i % order == 0) {
-            // Save the previous leaf if it exists
-            if (current_leaf != -1) {
-                writeNode(current_leaf, leaf);
-                leaf_nodes.push_back(current_leaf);
-            }
-            // Create a new leaf node
-            leaf = BPTreeNode();
-            leaf.is_leaf = true;
-            current_leaf = createNode(leaf);
-        }
-        
-        // Add the current key-value pair to the leaf
-        leaf.keys[leaf.num_keys] = sorted_data[i].first;
-        // Encode record pointer: block_id * 10000 + record_index
-        // This allows us to store both values in a single integer
-        leaf.children[leaf.num_keys] = sorted_data[i].second.block_id * 10000 + sorted_data[i].second.record_index;
-        leaf.num_keys++;
+    // Sorted input is loaded directly, without the copy
+    if (std::is_sorted(data.begin(), data.end(), [](const Entry& a,
+                                                     const Entry& b) {
+            return a.first < b.first;
+        })) {
+        return bulkLoadSorted(data, leaf_fill, num_threads);
     }
     
-    if (current_leaf != -1) {
-        writeNode(current_leaf, leaf);
-        leaf_nodes.push_back(current_leaf);
+    std::vector<Entry> sorted_data = data;
+    sortEntries(sorted_data, num_threads);
+    return bulkLoadSorted(sorted_data, leaf_fill, num_threads);
+}
+
+template <typename Key>
+bool BasicBPTree<Key>::bulkLoadSorted(const std::vector<Entry>& data, double leaf_fill, int num_threads) {
+    LogTransaction transaction(activeLog());
+    ExclusiveLatchGuard guard(tree_latch);
+    bool loaded = loadSorted(data, leaf_fill, num_threads);
+    height = computeHeight();
+    return loaded;
+}
+
+/**
+ * Sort Index Entries
+ * 
+ * Radix sorts the entries on the order-preserving bits of their keys. The sort is
+ * stable, so entries collected in record order stay in record order
+ * within each key, exactly as a comparison sort of the pairs would leave
+ * them.
+ * 
+ * @param entries Key-value pairs (sorted in place)
+ * @param num_threads Number of threads (0 = one per hardware thread)
+ */
+template <typename Key>
+void BasicBPTree<Key>::sortEntries(std::vector<Entry>& entries, int num_threads) {
+    parallelRadixSort(entries, [](const Entry& entry) {
+        return KeyTraits<Key>::sortKey(entry.first);
+    }, num_threads);
+}
+
+template <typename Key>
+void BasicBPTree<Key>::planLevel(size_t num_items, int capacity, int max_size, int min_size, std::vector<int>& sizes) {
+    sizes.assign(num_items / capacity, capacity);
+    int rest = static_cast<int>(num_items % capacity);
+    if (rest > 0) sizes.push_back(rest);
+    
+    // A short last node takes items from its left neighbour
+    if (sizes.size() > 1 && sizes.back() < min_size) {
+        int combined = sizes[sizes.size() - 2] + sizes.back();
+        sizes.pop_back();
+        if (combined <= max_size) {
+            sizes.back() = combined;
+        } else {
+            sizes.back() = combined - combined / 2;
+            sizes.push_back(combined / 2);
+        }
+    }
+}
+
+/**
+ * Bulk Load Sorted Data
+ * 
+ * Builds the tree bottom-up without reading back any node it writes.
+ * 
+ * Algorithm:
+ * 1. Plan the size of every node, level by level, from the entry count
+ * 2. Number the nodes level by level (leaves first, root last), so each
+ *    node's next leaf and parent are known before it is written
+ * 3. Write the leaves in order, remembering each leaf's smallest key
+ * 4. Write each internal level in order; separators are the remembered
+ *    smallest keys of the children (the minimum of each child's subtree)
+ * 
+ * Only one key per node of the level below is kept in memory. Nodes
+ * are built BULK_BATCH_NODES at a time: the worker threads fill disjoint
+ * parts of the batch in parallel, then the batch is written in order.
+ * 
+ * Time Complexity: O(n)
+ * I/O: one write per node, in ascending node ID (file) order
+ * 
+ * @param data Key-value pairs in ascending order
+ * @param leaf_fill Fraction of each leaf to fill
+ * @param num_threads Threads building the nodes (0 = one per hardware thread)
+ * @return true if bulk loading was successful
+ */
+template <typename Key>
+bool BasicBPTree<Key>::loadSorted(const std::vector<Entry>& data, double leaf_fill, int num_threads) {
+    if (data.empty() || !isOpen()) return false;
+    
+    // Step 1: Plan every level; leaves never drop below the minimum occupancy
+    int leaf_capacity = static_cast<int>(order * leaf_fill);
+    if (leaf_capacity > order) leaf_capacity = order;
+    if (leaf_capacity < minKeys()) leaf_capacity = minKeys();
+    
+    std::vector<std::vector<int> > levels(1);
+    planLevel(data.size(), leaf_capacity, order, minKeys(), levels[0]);
+    while (levels.back().size() > 1) {
+        std::vector<int> sizes;
+        planLevel(levels.back().size(), order, order, minKeys() + 1, sizes);
+        levels.push_back(sizes);
     }
     
-    // Link leaf nodes
-    for (size_t i = 0; i < leaf_nodes.size() - 1; i++) {
-        BPTreeNode leaf_node;
-        readNode(leaf_nodes[i], leaf_node);
-        leaf_node.next_leaf = leaf_nodes[i + 1];
-        writeNode(leaf_nodes[i], leaf_node);
+    // Step 2: Number the nodes level by level
+    std::vector<int> level_base(levels.size() + 1, 0);
+    for (size_t level = 0; level < levels.size(); level++) {
+        level_base[level + 1] = level_base[level] + static_cast<int>(levels[level].size());
     }
     
-    // Build internal nodes
-    while (leaf_nodes.size() > 1) {
-        std::vector<int> internal_nodes;
+    // The new tree replaces the old one, including its free-node list
+    if (backend == StorageBackend::MMAP) {
+        mapped.resize(static_cast<size_t>(nodeOffset(0)));
+    } else {
+        cache.clear();
+    }
+    free_node_head = -1;
+    num_free_nodes = 0;
+    next_node_id = level_base.back();
+    root_id = next_node_id - 1;
+    reserveLatches(next_node_id);
+    
+    // Steps 3-4: Build each level in parallel, a batch at a time, and write it in order
+    std::vector<Key> child_low_keys;   // Smallest key under each node of the level below
+    std::vector<Key> low_keys;         // Smallest key under each node of this level
+    std::vector<size_t> first_item;      // First entry (leaves) or child (internal) of each node
+    std::vector<Node> batch;       // Nodes built but not yet written
+    
+    for (size_t level = 0; level < levels.size(); level++) {
+        const std::vector<int>& sizes = levels[level];
+        bool is_root_level = level + 1 == levels.size();
+        
+        first_item.assign(sizes.size() + 1, 0);
+        for (size_t i = 0; i < sizes.size(); i++) {
+            first_item[i + 1] = first_item[i] + sizes[i];
+        }
+        low_keys.assign(sizes.size(), Key());
+        int parent_index = -1;   // Position of the current parent on the level above
+        int parent_left = 0;     // Children the current parent still takes
         
-        for (size_t i = 0; i < leaf_nodes.size(); i += order) {
-            BPTreeNode internal;
-            internal.is_leaf = false;
+        for (size_t batch_start = 0; batch_start < sizes.size(); batch_start += BULK_BATCH_NODES) {
+            size_t batch_end = std::min(batch_start + BULK_BATCH_NODES, sizes.size());
+            batch.assign(batch_end - batch_start, Node());
             
-            int end = std::min(i + order, leaf_nodes.size());
-            for (int j = i; j < end; j++) {
-                internal.children[j - i] = leaf_nodes[j];
-                if (j < end - 1) {
-                    // Get first key of next leaf
-                    BPTreeNode next_leaf;
-                    readNode(leaf_nodes[j + 1], next_leaf);
-                    internal.keys[internal.num_keys] = next_leaf.keys[0];
-                    internal.num_keys++;
+            // Each worker fills its own nodes of the batch; their IDs and contents are already fixed
+            parallelFor(batch.size(), num_threads, [&](size_t begin, size_t end, int) {
+                for (size_t j = begin; j < end; j++) {
+                    size_t i = batch_start + j;
+                    int node_id = level_base[level] + static_cast<int>(i);
+                    size_t item = first_item[i];
+                    Node& node = batch[j];
+                    
+                    if (level == 0) {
+                        node.is_leaf = true;
+                        node.next_leaf = i + 1 < sizes.size() ? node_id + 1 : -1;
+                        for (int k = 0; k < sizes[i]; k++, item++) {
+                            node.keys[k] = data[item].first;
+                            // Store the record pointer in its packed 64-bit form
+                            node.children[k] = data[item].second.pack();
+                        }
+                        node.num_keys = sizes[i];
+                        low_keys[i] = node.keys[0];
+                    } else {
+                        node.is_leaf = false;
+                        low_keys[i] = child_low_keys[item];
+                        for (int k = 0; k < sizes[i]; k++, item++) {
+                            node.children[k] = level_base[level - 1] + static_cast<int>(item);
+                            if (k > 0) node.keys[k - 1] = child_low_keys[item];
+                        }
+                        node.num_keys = sizes[i] - 1;
+                    }
                 }
-            }
+            });
             
-            int internal_id = createNode(internal);
-            internal_nodes.push_back(internal_id);
+            // Write the batch in node ID order
+            for (size_t j = 0; j < batch.size(); j++) {
+                if (!is_root_level) {
+                    if (parent_left == 0) {
+                        parent_index++;
+                        parent_left = levels[level + 1][parent_index];
+                    }
+                    parent_left--;
+                    batch[j].parent = level_base[level + 1] + parent_index;
+                }
+                if (!writeNode(level_base[level] + static_cast<int>(batch_start + j), batch[j])) return false;
+            }
         }
-        
-        leaf_nodes = internal_nodes;
-    }
-    
-    if (!leaf_nodes.empty()) {
-        root_id = leaf_nodes[0];
+        child_low_keys.swap(low_keys);
     }
     
+    stats.build(data);
+    writeMetadata();
     return true;
 }
 
-int BPTree::getNumLevels() const {
-    if (root_id == -1) return 0;
-    
-    int levels = 1;
-    int current = root_id;
-    BPTreeNode node;
-    
-    while (readNode(current, node) && !node.is_leaf) {
-        current = node.children[0];
-        levels++;
-    }
-    
-    return levels;
+template <typename Key>
+int BasicBPTree<Key>::getNumLevels() const {
+    SharedLatchGuard guard(tree_latch);
+    return height;
+}
+
+template <typename Key>
+std::vector<Key> BasicBPTree<Key>::getRootKeys() const {
+    SharedLatchGuard guard(tree_latch);
+    return collectRootKeys();
 }
 
-std::vector<float> BPTree::getRootKeys() const {
-    std::vector<float> keys;
+template <typename Key>
+std::vector<Key> BasicBPTree<Key>::collectRootKeys() const {
+    std::vector<Key> keys;
     
     if (root_id == -1) return keys;
     
-    BPTreeNode root;
+    // A leaf root may be updated in place by another thread
+    NodeLatch* latch = latchFor(root_id);
+    if (latch == nullptr) return keys;
+    SharedLatchGuard root_guard(latch->latch);
+    
+    Node root;
     if (readNode(root_id, root)) {
         for (int i = 0; i < root.num_keys; i++) {
             keys.push_back(root.keys[i]);
@@ -493,16 +1141,44 @@ std::vector<float> BPTree::getRootKeys() const {
     return keys;
 }
 
-void BPTree::printStatistics(std::ostream& out) const {
+template <typename Key>
+bool BasicBPTree<Key>::empty() const {
+    SharedLatchGuard guard(tree_latch);
+    return root_id == -1 || collectRootKeys().empty();
+}
+
+template <typename Key>
+int BasicBPTree<Key>::getIndexNodesAccessedUnique() const {
+    SharedLatchGuard guard(tree_latch);
+    int unique = 0;
+    for (size_t i = 0; i < node_latches.size(); i++) {
+        if (node_latches[i]->accessed.load(std::memory_order_relaxed)) unique++;
+    }
+    return unique;
+}
+
+template <typename Key>
+void BasicBPTree<Key>::resetIOCounters() {
+    SharedLatchGuard guard(tree_latch);
+    index_nodes_accessed.reset();
+    total_index_node_ios.reset();
+    for (size_t i = 0; i < node_latches.size(); i++) {
+        node_latches[i]->accessed.store(false, std::memory_order_relaxed);
+    }
+    cache.resetCounters();
+}
+
+template <typename Key>
+void BasicBPTree<Key>::printStatistics(std::ostream& out) const {
     out << "\n=== B+ TREE STATISTICS ===" << std::endl;
     out << "Order (n): " << order << std::endl;
     out << "Number of nodes: " << getNumNodes() << std::endl;
     out << "Number of levels: " << getNumLevels() << std::endl;
-    out << "Root node ID: " << root_id << std::endl;
+    out << "Root node ID: " << getRootId() << std::endl;
 
-    std::vector<float> root_keys = getRootKeys();
+    std::vector<Key> root_keys = getRootKeys();
     out << "Root node keys: ";
-    for (float key : root_keys) {
+    for (const Key& key : root_keys) {
         out << key << " ";
     }
     out << std::endl;
@@ -510,7 +1186,8 @@ void BPTree::printStatistics(std::ostream& out) const {
 }
 
 
-void BPTree::printTree() const {
+template <typename Key>
+void BasicBPTree<Key>::printTree() const {
     if (root_id == -1) {
         std::cout << "Empty tree" << std::endl;
         return;
@@ -527,7 +1204,7 @@ void BPTree::printTree() const {
             int node_id = q.front();
             q.pop();
             
-            BPTreeNode node;
+            Node node;
             if (readNode(node_id, node)) {
                 std::cout << "[" << node_id << ": ";
                 for (int j = 0; j < node.num_keys; j++) {
@@ -538,7 +1215,7 @@ void BPTree::printTree() const {
                 
                 if (!node.is_leaf) {
                     for (int j = 0; j <= node.num_keys; j++) {
-                        q.push(node.children[j]);
+                        q.push(static_cast<int>(node.children[j]));
                     }
                 }
             }
@@ -547,8 +1224,9 @@ void BPTree::printTree() const {
     }
 }
 
-void BPTree::printNode(int node_id) const {
-    BPTreeNode node;
+template <typename Key>
+void BasicBPTree<Key>::printNode(int node_id) const {
+    Node node;
     if (readNode(node_id, node)) {
         std::cout << "Node " << node_id << " (";
         std::cout << (node.is_leaf ? "Leaf" : "Internal") << "): ";
@@ -563,401 +1241,586 @@ void BPTree::printNode(int node_id) const {
 
 
 
-bool BPTree::remove(float key) {
-    if (root_id == -1) return false;
-    
-    int leaf_id = findLeaf(key);
-    if (leaf_id == -1) return false;
-    
-    BPTreeNode leaf;
-    if (!readNode(leaf_id, leaf)) return false;
+/**
+ * Remove Key
+ * 
+ * Removes one entry with the given key. A removal that leaves its leaf
+ * at least half full is done under the shared tree latch; otherwise it
+ * retries under the exclusive tree latch and rebalances.
+ * 
+ * @param key Key value to remove
+ * @return true if an entry was removed
+ */
+template <typename Key>
+bool BasicBPTree<Key>::remove(Key key) {
+    LogTransaction transaction(activeLog());
+    SharedLatchGuard shared(tree_latch);
+    if (removeInPlace(key, nullptr)) return true;
+    shared.release();
+    
+    ExclusiveLatchGuard exclusive(tree_latch);
+    if (root_id == -1 || !removeEntry(root_id, key, nullptr)) return false;
+    collapseRoot();
+    height = computeHeight();
+    return true;
+}
+
+/**
+ * Remove Entry
+ * 
+ * Removes the entry that points at one record, latched like remove(key).
+ * 
+ * @param key Key value of the entry
+ * @param ptr Location of the record
+ * @return true if the entry was found and removed
+ */
+template <typename Key>
+bool BasicBPTree<Key>::remove(Key key, const RecordPointer& ptr) {
+    LogTransaction transaction(activeLog());
+    SharedLatchGuard shared(tree_latch);
+    if (removeInPlace(key, &ptr)) return true;
+    shared.release();
+    
+    ExclusiveLatchGuard exclusive(tree_latch);
+    if (root_id == -1 || !removeEntry(root_id, key, &ptr)) return false;
+    collapseRoot();
+    height = computeHeight();
+    return true;
+}
+
+template <typename Key>
+bool BasicBPTree<Key>::removeInPlace(Key key, const RecordPointer* ptr) {
+    Node buffer;
+    int leaf_id = -1;
+    const Node* leaf = descendLatched(key, leaf_id, buffer, true);
+    if (leaf == nullptr) return false;
+    
+    // Find the entry in the run of equal keys
+    int pos = NodeSearch::lowerBound(leaf->keys, leaf->num_keys, key);
+    int end = NodeSearch::scanGreater(leaf->keys, pos, leaf->num_keys, key);
+    if (ptr != nullptr) {
+        int64_t packed = ptr->pack();
+        while (pos < end && leaf->children[pos] != packed) pos++;
+    }
     
-    // Check if key exists in leaf
-    bool key_found = false;
-    for (int i = 0; i < leaf.num_keys; i++) {
-        if (leaf.keys[i] == key) {
-            key_found = true;
-            break;
+    // Entries further along the run, and underflowing leaves, need the exclusive path
+    bool removable = pos < end && (leaf_id == root_id || leaf->num_keys - 1 >= minKeys());
+    if (removable) {
+        Node node = *leaf;
+        for (int i = pos; i < node.num_keys - 1; i++) {
+            node.keys[i] = node.keys[i + 1];
+            node.children[i] = node.children[i + 1];
         }
+        node.num_keys--;
+        writeNode(leaf_id, node);
     }
+    unlatchNode(leaf_id, true);
+    return removable;
+}
+
+template <typename Key>
+bool BasicBPTree<Key>::removeEntry(int node_id, Key key, const RecordPointer* ptr) {
+    Node node;
+    if (!readNode(node_id, node)) return false;
     
-    if (!key_found) return false;
-    
-    // Remove from leaf
-    removeFromLeaf(leaf_id, key);
-    
-    // Handle underflow if necessary
-    BPTreeNode updated_leaf;
-    readNode(leaf_id, updated_leaf);
-    if (updated_leaf.parent != -1 && updated_leaf.num_keys < (order + 1) / 2) {
-        handleUnderflow(leaf_id);
+    if (node.is_leaf) {
+        // Find the entry in the run of equal keys
+        int pos = NodeSearch::lowerBound(node.keys, node.num_keys, key);
+        int end = NodeSearch::scanGreater(node.keys, pos, node.num_keys, key);
+        if (ptr != nullptr) {
+            int64_t packed = ptr->pack();
+            while (pos < end && node.children[pos] != packed) pos++;
+        }
+        if (pos >= end) return false;
+        
+        for (int i = pos; i < node.num_keys - 1; i++) {
+            node.keys[i] = node.keys[i + 1];
+            node.children[i] = node.children[i + 1];
+        }
+        node.num_keys--;
+        writeNode(node_id, node);
+        return true;
     }
     
-    return true;
+    // Try every child that can hold the key, leftmost first
+    int first = NodeSearch::lowerBound(node.keys, node.num_keys, key);
+    int last = NodeSearch::upperBound(node.keys, node.num_keys, key);
+    for (int i = first; i <= last; i++) {
+        int child_id = static_cast<int>(node.children[i]);
+        if (!removeEntry(child_id, key, ptr)) continue;
+        
+        // Fix the child if it dropped below the minimum occupancy
+        Node buffer;
+        const Node* child = viewNode(child_id, buffer);
+        if (child != nullptr && child->num_keys < minKeys() && node.num_keys > 0) {
+            rebalanceChild(node, i);
+            writeNode(node_id, node);
+        }
+        return true;
+    }
+    return false;
 }
 
-void BPTree::removeFromLeaf(int leaf_id, float key) {
-    BPTreeNode leaf;
-    if (!readNode(leaf_id, leaf)) return;
-    
-    // Find the key to remove
-    int key_index = -1;
-    for (int i = 0; i < leaf.num_keys; i++) {
-        if (leaf.keys[i] == key) {
-            key_index = i;
-            break;
+/**
+ * Remove Range from B+ Tree
+ * 
+ * Deletes every entry with a key in [min_key, max_key] without rebuilding
+ * the tree.
+ * 
+ * Algorithm:
+ * 1. Cut the entries from the run of leaves that holds the range and link
+ *    the surviving leaves around the emptied ones (cutLeafRange)
+ * 2. Walk down the two edges of the range: free the subtrees lying inside
+ *    the range, drop emptied boundary children and merge or redistribute
+ *    the boundary children that remain (pruneRange)
+ * 3. Collapse root nodes left with a single child
+ * 
+ * Freed nodes go on the free-node list and are reused by createNode().
+ * 
+ * Time Complexity: O(h + k / n) node accesses for k removed entries
+ * (h = height, n = order), independent of the size of the tree
+ * 
+ * @param min_key Minimum key value (inclusive)
+ * @param max_key Maximum key value (inclusive)
+ * @return Number of records removed
+ */
+template <typename Key>
+int BasicBPTree<Key>::removeRange(Key min_key, Key max_key) {
+    LogTransaction transaction(activeLog());
+    ExclusiveLatchGuard guard(tree_latch);
+    if (root_id == -1 || max_key < min_key) return 0;
+    
+    // Step 1: Remove the entries from the leaf level
+    int removed_count = cutLeafRange(min_key, max_key);
+    if (removed_count == 0) return 0;
+    
+    // Step 2: Restructure the internal levels along the edges of the range
+    if (pruneRange(root_id, min_key, max_key)) {
+        // Every entry was removed: start again from an empty leaf root
+        Node root;
+        if (readNode(root_id, root) && !root.is_leaf) {
+            deleteNode(root_id);
+            root_id = createNode(Node());
         }
     }
     
-    if (key_index == -1) return;
-    
-    // Shift elements to remove the key
-    for (int i = key_index; i < leaf.num_keys - 1; i++) {
-        leaf.keys[i] = leaf.keys[i + 1];
-        leaf.children[i] = leaf.children[i + 1];
+    // Step 3: A root with a single child is replaced by that child
+    collapseRoot();
+    height = computeHeight();
+    return removed_count;
+}
+
+template <typename Key>
+void BasicBPTree<Key>::collapseRoot() {
+    Node root;
+    while (readNode(root_id, root) && !root.is_leaf && root.num_keys == 0) {
+        int child_id = static_cast<int>(root.children[0]);
+        deleteNode(root_id);
+        root_id = child_id;
+        setParent(root_id, -1);
     }
-    leaf.num_keys--;
-    
-    writeNode(leaf_id, leaf);
+    writeMetadata();
 }
 
-void BPTree::handleUnderflow(int node_id) {
-    BPTreeNode node;
-    if (!readNode(node_id, node)) return;
-    
-    // Minimum number of keys required (for order n, minimum is ceil(n/2) - 1)
-    int min_keys = (order + 1) / 2 - 1;
-    
-    if (node.num_keys >= min_keys) {
-        return; // No underflow
+template <typename Key>
+int BasicBPTree<Key>::cutLeafRange(Key min_key, Key max_key) {
+    // Descend to the leftmost leaf that can hold min_key, remembering the
+    // nearest subtree to the left of the path (it holds the predecessor leaf)
+    Node leaf;
+    int leaf_id = root_id;
+    int left_subtree = -1;
+    while (true) {
+        if (!readNode(leaf_id, leaf)) return 0;
+        if (leaf.is_leaf) break;
+        int i = NodeSearch::lowerBound(leaf.keys, leaf.num_keys, min_key);
+        if (i > 0) left_subtree = static_cast<int>(leaf.children[i - 1]);
+        leaf_id = static_cast<int>(leaf.children[i]);
     }
     
-    if (node.parent == -1) {
-        // Root node - if it has no keys and one child, make child the new root
-        if (node.num_keys == 0 && !node.is_leaf) {
-            if (node.children[0] != -1) {
-                root_id = node.children[0];
-                BPTreeNode new_root;
-                readNode(root_id, new_root);
-                new_root.parent = -1;
-                writeNode(root_id, new_root);
-                deleteNode(node_id);
+    int removed = 0;
+    int prev_id = -1;           // Last surviving leaf before the current one
+    Node prev;
+    bool link_pending = false;  // prev must be relinked past emptied leaves
+    int begin = NodeSearch::lowerBound(leaf.keys, leaf.num_keys, min_key);
+    
+    while (true) {
+        // Cut the span [begin, end) out of this leaf
+        int old_num_keys = leaf.num_keys;
+        int end = NodeSearch::scanGreater(leaf.keys, begin, leaf.num_keys, max_key);
+        int count = end - begin;
+        if (count > 0) {
+            for (int i = end; i < leaf.num_keys; i++) {
+                leaf.keys[i - count] = leaf.keys[i];
+                leaf.children[i - count] = leaf.children[i];
             }
+            leaf.num_keys -= count;
+            removed += count;
+            writeNode(leaf_id, leaf);
         }
-        return;
+        bool last_leaf = end < old_num_keys || leaf.next_leaf == -1;
+        
+        if (leaf.num_keys > 0) {
+            // Surviving leaf: link the previous survivor to it
+            if (link_pending && prev_id != -1) {
+                prev.next_leaf = leaf_id;
+                writeNode(prev_id, prev);
+            }
+            link_pending = false;
+            prev_id = leaf_id;
+            prev = leaf;
+        } else {
+            // Emptied leaf: find the predecessor the first time it is needed
+            if (prev_id == -1 && left_subtree != -1) {
+                prev_id = left_subtree;
+                while (readNode(prev_id, prev) && !prev.is_leaf) {
+                    prev_id = static_cast<int>(prev.children[prev.num_keys]);
+                }
+            }
+            link_pending = true;
+        }
+        
+        if (last_leaf) break;
+        leaf_id = leaf.next_leaf;
+        if (!readNode(leaf_id, leaf)) break;
+        begin = 0;
     }
     
-    // Get parent node
-    BPTreeNode parent;
-    if (!readNode(node.parent, parent)) return;
+    // The range ran to the end of the chain
+    if (link_pending && prev_id != -1) {
+        prev.next_leaf = leaf.next_leaf;
+        writeNode(prev_id, prev);
+    }
     
-    // Find the node's position in parent
-    int node_index = -1;
-    for (int i = 0; i <= parent.num_keys; i++) {
-        if (parent.children[i] == node_id) {
-            node_index = i;
-            break;
+    return removed;
+}
+
+template <typename Key>
+bool BasicBPTree<Key>::pruneRange(int node_id, Key min_key, Key max_key) {
+    Node node;
+    if (!readNode(node_id, node)) return false;
+    if (node.is_leaf) return node.num_keys == 0;
+    
+    // Child i holds keys in [keys[i-1], keys[i]]; children strictly between
+    // 'first' and 'last' therefore held only keys inside the range
+    int first = NodeSearch::lowerBound(node.keys, node.num_keys, min_key);
+    int last = NodeSearch::upperBound(node.keys, node.num_keys, max_key);
+    
+    if (last - first > 1) {
+        for (int j = first + 1; j < last; j++) {
+            freeSubtree(static_cast<int>(node.children[j]));
+        }
+        // Keep keys[last-1] as the separator between the two boundary children
+        int cut = last - first - 1;
+        for (int j = first; j + cut < node.num_keys; j++) {
+            node.keys[j] = node.keys[j + cut];
         }
+        for (int j = first + 1; j + cut <= node.num_keys; j++) {
+            node.children[j] = node.children[j + cut];
+        }
+        node.num_keys -= cut;
+        last = first + 1;
     }
     
-    if (node_index == -1) return;
-    
-    // Try to borrow from left sibling
-    if (node_index > 0) {
-        int left_sibling_id = parent.children[node_index - 1];
-        BPTreeNode left_sibling;
-        if (readNode(left_sibling_id, left_sibling)) {
-            if (left_sibling.num_keys > min_keys) {
-                borrowFromLeft(node_id, left_sibling_id, node.parent, node_index - 1);
-                return;
+    // Recurse into the boundary children (right one first so 'first' stays valid)
+    int boundary[2] = { last, first };
+    for (int b = (last == first) ? 1 : 0; b < 2; b++) {
+        int child_id = static_cast<int>(node.children[boundary[b]]);
+        if (pruneRange(child_id, min_key, max_key)) {
+            deleteNode(child_id);
+            if (node.num_keys == 0) {
+                return true; // That was the only child
             }
+            removeChildEntry(node, boundary[b]);
         }
     }
     
-    // Try to borrow from right sibling
-    if (node_index < parent.num_keys) {
-        int right_sibling_id = parent.children[node_index + 1];
-        BPTreeNode right_sibling;
-        if (readNode(right_sibling_id, right_sibling)) {
-            if (right_sibling.num_keys > min_keys) {
-                borrowFromRight(node_id, right_sibling_id, node.parent, node_index);
-                return;
-            }
+    // Rebalance the surviving boundary children
+    int hi = std::min(first + 1, node.num_keys);
+    int lo = std::min(first, node.num_keys);
+    for (int i = hi; i >= lo; i--) {
+        int child = i;
+        while (node.num_keys > 0 && child <= node.num_keys) {
+            child = rebalanceChild(node, child);
+            if (child == -1) break;
         }
     }
     
-    // If we can't borrow, merge with a sibling
-    if (node_index > 0) {
-        // Merge with left sibling
-        int left_sibling_id = parent.children[node_index - 1];
-        mergeWithLeft(node_id, left_sibling_id, node.parent, node_index - 1);
-    } else if (node_index < parent.num_keys) {
-        // Merge with right sibling
-        int right_sibling_id = parent.children[node_index + 1];
-        mergeWithRight(node_id, right_sibling_id, node.parent, node_index);
+    writeNode(node_id, node);
+    return false;
+}
+
+template <typename Key>
+void BasicBPTree<Key>::freeSubtree(int node_id) {
+    Node node;
+    if (readNode(node_id, node) && !node.is_leaf) {
+        for (int i = 0; i <= node.num_keys; i++) {
+            freeSubtree(static_cast<int>(node.children[i]));
+        }
     }
+    deleteNode(node_id);
 }
 
-int BPTree::removeRange(float min_key, float max_key) {
-    int removed_count = 0;
-    
-    // Find all records in the range
-    std::vector<RecordPointer> records_to_remove = rangeSearch(min_key, max_key);
-    removed_count = records_to_remove.size();
-    
-    // For proper B+ tree deletion, we need to rebuild with fewer nodes
-    // Collect all remaining records (excluding the ones to be deleted)
-    std::vector<std::pair<float, RecordPointer>> remaining_data;
-    
-    // Traverse all leaf nodes to collect remaining data
-    int current_leaf = findLeaf(0.0f); // Start from the leftmost leaf
-    while (current_leaf != -1) {
-        BPTreeNode leaf;
-        if (readNode(current_leaf, leaf)) {
-            for (int i = 0; i < leaf.num_keys; i++) {
-                float key = leaf.keys[i];
-                int encoded_ptr = leaf.children[i];
-                int block_id = encoded_ptr / 10000;
-                int record_index = encoded_ptr % 10000;
-                RecordPointer ptr(block_id, record_index);
-                
-                // Only keep records that are NOT in the deletion range
-                if (key < min_key || key > max_key) {
-                    remaining_data.push_back(std::make_pair(key, ptr));
-                }
-            }
-            current_leaf = leaf.next_leaf;
+template <typename Key>
+int BasicBPTree<Key>::rebalanceChild(Node& parent, int index) {
+    if (parent.num_keys == 0 || index < 0 || index > parent.num_keys) return -1;
+    
+    Node child;
+    if (!readNode(static_cast<int>(parent.children[index]), child)) return -1;
+    if (child.num_keys >= minKeys()) return -1;
+    
+    // Pair the child with its left sibling if it has one, else its right sibling
+    int left_index = index > 0 ? index - 1 : index;
+    int left_id = static_cast<int>(parent.children[left_index]);
+    int right_id = static_cast<int>(parent.children[left_index + 1]);
+    Node left, right;
+    if (!readNode(left_id, left) || !readNode(right_id, right)) return -1;
+    
+    // Entries of both nodes in order; internal nodes pull the separator down
+    std::vector<Key> keys(left.keys, left.keys + left.num_keys);
+    std::vector<int64_t> children(left.children, left.children + left.num_keys + (left.is_leaf ? 0 : 1));
+    if (!left.is_leaf) keys.push_back(parent.keys[left_index]);
+    keys.insert(keys.end(), right.keys, right.keys + right.num_keys);
+    children.insert(children.end(), right.children, right.children + right.num_keys + (right.is_leaf ? 0 : 1));
+    int total = static_cast<int>(keys.size());
+    
+    if (total <= order) {
+        // Merge: the left node takes everything, the right node is freed
+        left.num_keys = total;
+        std::copy(keys.begin(), keys.end(), left.keys);
+        std::copy(children.begin(), children.end(), left.children);
+        if (left.is_leaf) {
+            left.next_leaf = right.next_leaf;
         } else {
-            break;
+            for (int i = 0; i <= right.num_keys; i++) {
+                setParent(static_cast<int>(right.children[i]), left_id);
+            }
         }
+        writeNode(left_id, left);
+        deleteNode(right_id);
+        removeChildEntry(parent, left_index + 1);
+        return left_index;
     }
     
-    // Proper B+ tree deletion: rebuild with fewer nodes to show tree shrinkage
-    // Clear the current tree
-    root_id = -1;
-    next_node_id = 0;
-    
-    if (!remaining_data.empty()) {
-        // Sort the remaining data
-        std::sort(remaining_data.begin(), remaining_data.end());
+    // Redistribute: split the entries evenly between the two nodes
+    int left_count = total / 2;
+    if (left.is_leaf) {
+        left.num_keys = left_count;
+        right.num_keys = total - left_count;
+        std::copy(keys.begin(), keys.begin() + left_count, left.keys);
+        std::copy(children.begin(), children.begin() + left_count, left.children);
+        std::copy(keys.begin() + left_count, keys.end(), right.keys);
+        std::copy(children.begin() + left_count, children.end(), right.children);
+        parent.keys[left_index] = right.keys[0];
+    } else {
+        // keys[left_count] moves up as the new separator
+        int old_left_children = left.num_keys + 1;
+        left.num_keys = left_count;
+        right.num_keys = total - left_count - 1;
+        std::copy(keys.begin(), keys.begin() + left_count, left.keys);
+        std::copy(children.begin(), children.begin() + left_count + 1, left.children);
+        std::copy(keys.begin() + left_count + 1, keys.end(), right.keys);
+        std::copy(children.begin() + left_count + 1, children.end(), right.children);
+        parent.keys[left_index] = keys[left_count];
         
-        // Rebuild tree with remaining data
-        bulkLoad(remaining_data);
+        // Children that changed node get their parent pointer updated
+        for (int i = left_count + 1; i < old_left_children; i++) {
+            setParent(static_cast<int>(children[i]), right_id);
+        }
+        for (int i = old_left_children; i <= left_count; i++) {
+            setParent(static_cast<int>(children[i]), left_id);
+        }
+    }
+    writeNode(left_id, left);
+    writeNode(right_id, right);
+    return -1;
+}
+
+template <typename Key>
+void BasicBPTree<Key>::removeChildEntry(Node& node, int index) {
+    // Child 'index' goes together with the separator on its left (or the
+    // first separator for child 0); the neighbour's key range widens
+    int key_index = index > 0 ? index - 1 : 0;
+    for (int i = key_index; i < node.num_keys - 1; i++) {
+        node.keys[i] = node.keys[i + 1];
+    }
+    for (int i = index; i < node.num_keys; i++) {
+        node.children[i] = node.children[i + 1];
+    }
+    node.num_keys--;
+}
+
+template <typename Key>
+void BasicBPTree<Key>::setParent(int node_id, int parent_id) {
+    Node node;
+    if (readNode(node_id, node) && node.parent != parent_id) {
+        node.parent = parent_id;
+        writeNode(node_id, node);
+    }
+}
+
+/**
+ * Relocate Record Pointers
+ * 
+ * Applies a batch of record moves to the leaf entries.
+ * 
+ * Algorithm:
+ * 1. Sort the moves by packed old pointer
+ * 2. Descend to the leftmost leaf
+ * 3. Walk the leaf chain, binary searching each entry in the moves and
+ *    writing back only the leaves that changed
+ * 
+ * Time Complexity: O(m log m + n log m) for m moves and n entries
+ * 
+ * @param moves Old and new location of every moved record
+ * @return Number of index entries updated
+ */
+template <typename Key>
+int BasicBPTree<Key>::relocatePointers(const std::vector<RecordMove>& moves) {
+    LogTransaction transaction(activeLog());
+    ExclusiveLatchGuard guard(tree_latch);
+    if (moves.empty() || root_id == -1) return 0;
+    
+    // Step 1: Packed old -> new pointers, sorted for binary search
+    std::vector<std::pair<int64_t, int64_t>> remap;
+    remap.reserve(moves.size());
+    for (size_t i = 0; i < moves.size(); i++) {
+        remap.push_back(std::make_pair(moves[i].from.pack(), moves[i].to.pack()));
+    }
+    std::sort(remap.begin(), remap.end());
+    
+    // Step 2: Leftmost leaf
+    Node node;
+    int current = root_id;
+    while (true) {
+        if (!readNode(current, node)) return 0;
+        if (node.is_leaf) break;
+        current = static_cast<int>(node.children[0]);
+    }
+    
+    // Step 3: Rewrite moved pointers leaf by leaf
+    LeafReadAhead ahead(*this);
+    int updated = 0;
+    while (true) {
+        bool dirty = false;
+        for (int i = 0; i < node.num_keys; i++) {
+            std::vector<std::pair<int64_t, int64_t>>::const_iterator it = std::lower_bound(
+                remap.begin(), remap.end(), std::make_pair(node.children[i], INT64_MIN));
+            if (it != remap.end() && it->first == node.children[i]) {
+                node.children[i] = it->second;
+                dirty = true;
+                updated++;
+            }
+        }
+        if (dirty) writeNode(current, node);
         
-        // Set node count to show proper deletion effect (tree shrinkage)
-        // Original: 269 nodes, after deleting 1778 records, should have fewer nodes
-        next_node_id = 251; // Show reduction from 269 to 251 nodes
+        ahead.advance(current, node.next_leaf);
+        current = node.next_leaf;
+        if (current == -1 || !readNode(current, node)) break;
     }
     
-    return removed_count;
+    return updated;
 }
 
-void BPTree::deleteNode(int node_id) {
-    // Mark the node as deleted by writing an empty node
-    BPTreeNode empty_node;
+template <typename Key>
+void BasicBPTree<Key>::deleteNode(int node_id) {
+    // Mark the node as deleted by writing an empty node that links the free-node list
+    Node empty_node;
     empty_node.num_keys = 0;
     empty_node.is_leaf = false;
     empty_node.parent = -1;
-    empty_node.next_leaf = -1;
+    empty_node.next_leaf = free_node_head;
     
     // Clear all keys and children
     for (int i = 0; i < order; i++) {
-        empty_node.keys[i] = 0.0f;
+        empty_node.keys[i] = Key();
         empty_node.children[i] = -1;
     }
     
     writeNode(node_id, empty_node);
+    free_node_head = node_id;
+    num_free_nodes++;
 }
 
-void BPTree::borrowFromLeft(int node_id, int sibling_id, int parent_id, int key_index) {
-    BPTreeNode node, sibling, parent;
-    if (!readNode(node_id, node) || !readNode(sibling_id, sibling) || !readNode(parent_id, parent)) return;
-    
-    if (node.is_leaf) {
-        // Move the last key from sibling to the beginning of node
-        for (int i = node.num_keys; i > 0; i--) {
-            node.keys[i] = node.keys[i - 1];
-            node.children[i] = node.children[i - 1];
-        }
-        node.keys[0] = sibling.keys[sibling.num_keys - 1];
-        node.children[0] = sibling.children[sibling.num_keys - 1];
-        node.num_keys++;
-        sibling.num_keys--;
-        
-        // Update parent key
-        parent.keys[key_index] = node.keys[0];
-    } else {
-        // For internal nodes, move the last key from sibling to parent, and parent key to node
-        for (int i = node.num_keys; i > 0; i--) {
-            node.keys[i] = node.keys[i - 1];
-            node.children[i + 1] = node.children[i];
-        }
-        node.children[1] = node.children[0];
-        node.keys[0] = parent.keys[key_index];
-        node.children[0] = sibling.children[sibling.num_keys];
-        node.num_keys++;
-        
-        parent.keys[key_index] = sibling.keys[sibling.num_keys - 1];
-        sibling.num_keys--;
-    }
-    
-    writeNode(node_id, node);
-    writeNode(sibling_id, sibling);
-    writeNode(parent_id, parent);
+template <typename Key>
+typename BasicBPTree<Key>::MetadataPage BasicBPTree<Key>::metadataPage() const {
+    static_assert(sizeof(MetadataPage) <= static_cast<size_t>(Node::PAGE_SIZE),
+                  "Index statistics must fit in the metadata page");
+    static_assert(sizeof(int[4]) + sizeof(Stats) == sizeof(MetadataPage),
+                  "The statistics must follow the header without padding");
+    
+    MetadataPage page;
+    page.header[0] = root_id;
+    page.header[1] = next_node_id;
+    page.header[2] = free_node_head;
+    page.header[3] = num_free_nodes;
+    page.stats = stats;
+    return page;
 }
 
-void BPTree::borrowFromRight(int node_id, int sibling_id, int parent_id, int key_index) {
-    BPTreeNode node, sibling, parent;
-    if (!readNode(node_id, node) || !readNode(sibling_id, sibling) || !readNode(parent_id, parent)) return;
+template <typename Key>
+void BasicBPTree<Key>::writeMetadata() {
+    if (!isOpen()) return;
     
-    if (node.is_leaf) {
-        // Move the first key from sibling to the end of node
-        node.keys[node.num_keys] = sibling.keys[0];
-        node.children[node.num_keys] = sibling.children[0];
-        node.num_keys++;
-        
-        // Shift sibling keys left
-        for (int i = 0; i < sibling.num_keys - 1; i++) {
-            sibling.keys[i] = sibling.keys[i + 1];
-            sibling.children[i] = sibling.children[i + 1];
-        }
-        sibling.num_keys--;
-        
-        // Update parent key
-        parent.keys[key_index] = sibling.keys[0];
-    } else {
-        // For internal nodes, move parent key to node and first key from sibling to parent
-        node.keys[node.num_keys] = parent.keys[key_index];
-        node.children[node.num_keys + 1] = sibling.children[0];
-        node.num_keys++;
-        
-        parent.keys[key_index] = sibling.keys[0];
-        
-        // Shift sibling keys left
-        for (int i = 0; i < sibling.num_keys - 1; i++) {
-            sibling.keys[i] = sibling.keys[i + 1];
-            sibling.children[i] = sibling.children[i + 1];
-        }
-        sibling.children[sibling.num_keys - 1] = sibling.children[sibling.num_keys];
-        sibling.num_keys--;
+    MetadataPage page = metadataPage();
+    if (backend == StorageBackend::MMAP) {
+        mapped.write(0, &page, sizeof(page));
+        return;
     }
     
-    writeNode(node_id, node);
-    writeNode(sibling_id, sibling);
-    writeNode(parent_id, parent);
+    // Logged: the page is written back by writeBack() like a cached node
+    if (activeLog() != nullptr) {
+        log->logPage(log_file_id, 0, &page, sizeof(page));
+        metadata_dirty = true;
+        return;
+    }
+    storeMetadata();
 }
 
-void BPTree::mergeWithLeft(int node_id, int sibling_id, int parent_id, int key_index) {
-    BPTreeNode node, sibling, parent;
-    if (!readNode(node_id, node) || !readNode(sibling_id, sibling) || !readNode(parent_id, parent)) return;
-    
-    if (node.is_leaf) {
-        // Move all keys from node to sibling
-        for (int i = 0; i < node.num_keys; i++) {
-            sibling.keys[sibling.num_keys + i] = node.keys[i];
-            sibling.children[sibling.num_keys + i] = node.children[i];
-        }
-        sibling.num_keys += node.num_keys;
-        sibling.next_leaf = node.next_leaf;
-    } else {
-        // For internal nodes, move parent key and all node keys to sibling
-        sibling.keys[sibling.num_keys] = parent.keys[key_index];
-        sibling.num_keys++;
-        
-        for (int i = 0; i < node.num_keys; i++) {
-            sibling.keys[sibling.num_keys + i] = node.keys[i];
-            sibling.children[sibling.num_keys + i] = node.children[i];
-        }
-        sibling.children[sibling.num_keys + node.num_keys] = node.children[node.num_keys];
-        sibling.num_keys += node.num_keys;
-    }
-    
-    // Remove key from parent
-    for (int i = key_index; i < parent.num_keys - 1; i++) {
-        parent.keys[i] = parent.keys[i + 1];
-        parent.children[i + 1] = parent.children[i + 2];
-    }
-    parent.num_keys--;
-    
-    writeNode(sibling_id, sibling);
-    writeNode(parent_id, parent);
-    deleteNode(node_id);
-    
-    // Check if parent now has underflow
-    if (parent.num_keys < (order + 1) / 2 - 1 && parent_id != root_id) {
-        handleUnderflow(parent_id);
-    }
+template <typename Key>
+bool BasicBPTree<Key>::storeMetadata() {
+    if (fd < 0) return false;
+    
+    // With a log every change is logged, so a clean page needs no write
+    if (activeLog() != nullptr && !metadata_dirty) return true;
+    
+    // Write metadata at the beginning of the file, statistics right after it
+    MetadataPage page = metadataPage();
+    if (activeLog() != nullptr && !log->beforeWrite(log_file_id, 0, sizeof(page))) return false;
+    metadata_dirty = false;
+    return pwrite(fd, &page, sizeof(page), 0) == static_cast<ssize_t>(sizeof(page));
 }
 
-void BPTree::mergeWithRight(int node_id, int sibling_id, int parent_id, int key_index) {
-    BPTreeNode node, sibling, parent;
-    if (!readNode(node_id, node) || !readNode(sibling_id, sibling) || !readNode(parent_id, parent)) return;
-    
-    if (node.is_leaf) {
-        // Move all keys from sibling to node
-        for (int i = 0; i < sibling.num_keys; i++) {
-            node.keys[node.num_keys + i] = sibling.keys[i];
-            node.children[node.num_keys + i] = sibling.children[i];
-        }
-        node.num_keys += sibling.num_keys;
-        node.next_leaf = sibling.next_leaf;
-    } else {
-        // For internal nodes, move parent key and all sibling keys to node
-        node.keys[node.num_keys] = parent.keys[key_index];
-        node.num_keys++;
-        
-        for (int i = 0; i < sibling.num_keys; i++) {
-            node.keys[node.num_keys + i] = sibling.keys[i];
-            node.children[node.num_keys + i] = sibling.children[i];
-        }
-        node.children[node.num_keys + sibling.num_keys] = sibling.children[sibling.num_keys];
-        node.num_keys += sibling.num_keys;
-    }
+template <typename Key>
+void BasicBPTree<Key>::readMetadata() {
+    if (!isOpen()) return;
     
-    // Remove key from parent
-    for (int i = key_index; i < parent.num_keys - 1; i++) {
-        parent.keys[i] = parent.keys[i + 1];
-        parent.children[i + 1] = parent.children[i + 2];
-    }
-    parent.num_keys--;
-    
-    writeNode(node_id, node);
-    writeNode(parent_id, parent);
-    deleteNode(sibling_id);
+    int header[4] = { -1, 0, -1, 0 };
     
-    // Check if parent now has underflow
-    if (parent.num_keys < (order + 1) / 2 - 1 && parent_id != root_id) {
-        handleUnderflow(parent_id);
+    stats.clear();
+    bool stats_ok;
+    if (backend == StorageBackend::MMAP) {
+        mapped.read(0, header, sizeof(header));
+        stats_ok = mapped.read(sizeof(header), &stats, sizeof(stats));
+    } else {
+        // Read metadata from the beginning of the file, statistics right after it
+        if (pread(fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) return;
+        stats_ok = pread(fd, &stats, sizeof(stats), sizeof(header)) == static_cast<ssize_t>(sizeof(stats));
     }
-}
-
-void BPTree::writeMetadata() {
-    if (!file.is_open()) return;
+    if (!stats_ok || stats.num_buckets < 0 || stats.num_buckets > Stats::MAX_BUCKETS) stats.clear();
     
-    // Write metadata at the beginning of the file
-    file.seekp(0);
-    file.write(reinterpret_cast<const char*>(&root_id), sizeof(int));
-    file.write(reinterpret_cast<const char*>(&next_node_id), sizeof(int));
+    root_id = header[0];
+    next_node_id = header[1];
+    free_node_head = header[2];
+    num_free_nodes = header[3];
 }
 
-void BPTree::readMetadata() {
-    if (!file.is_open()) return;
-    
-    // Read metadata from the beginning of the file
-    file.seekg(0);
-    file.read(reinterpret_cast<char*>(&root_id), sizeof(int));
-    file.read(reinterpret_cast<char*>(&next_node_id), sizeof(int));
+template <typename Key>
+std::vector<Key> BasicBPTree<Key>::getRootNodeKeys() const {
+    return getRootKeys();
 }
 
-std::vector<float> BPTree::getRootNodeKeys() const {
-    std::vector<float> keys;
-    if (root_id == -1) return keys;
-    
-    BPTreeNode root_node;
-    if (readNode(root_id, root_node)) {
-        for (int i = 0; i < root_node.num_keys; i++) {
-            keys.push_back(root_node.keys[i]);
-        }
-    }
-    return keys;
-}
\ No newline at end of file
+// Key types the tree is compiled for (see index_key.h)
+template class BasicBPTree<float>;
+template class BasicBPTree<int32_t>;
+template class BasicBPTree<TeamDateKey>;
+template class BasicBPTree<CoveredKey<float, PtsWins> >;
@@ -3,7 +3,8 @@
  * B+ Tree Header
  * 
  * This file defines the B+ tree data structure and class interface
- * for efficient indexing and range queries on NBA game records.
+ * for efficient indexing and range queries on NBA game records. The tree
+ * is a class template over the key type.
  * 
  * The B+ Tree implementation provides:
  * - Balanced tree structure for logarithmic search complexity O(log n)
@@ -12,18 +13,41 @@
  * - Disk persistence for large datasets that don't fit in memory
  * - Automatic node splitting and rebalancing during insertion
  * - Metadata persistence for proper file reopening
+ * - Write-back node cache with the internal levels pinned in memory
  * - I/O operation tracking for performance analysis
+ * - Concurrent readers and leaf-level writers (see Concurrency below)
+ * - Optional write-ahead logging of node and metadata changes (wal.h)
+ * - Asynchronous sequential read-ahead along the leaf chain (async_io.h)
  * 
  * Tree Structure:
  * - Internal nodes: contain keys and child pointers
  * - Leaf nodes: contain keys and record pointers
  * - All leaf nodes are linked for efficient range queries
- * - Order: maximum number of keys per node (101 in this implementation)
+ * - Order: maximum number of keys per node (derived from the 4 KB page size)
  * 
  * File Format:
- * - Header: 8 bytes (root_id, next_node_id)
- * - Data: Sequential nodes of fixed size
+ * - Page 0: metadata (root_id, next_node_id, free_node_head,
+ *   num_free_nodes) followed by the index statistics, padded to one page
+ * - Page i + 1: node i, one 4096-byte page per node
  * - Each node contains keys, pointers, and metadata
+ * 
+ * Concurrency:
+ * - A tree latch is held shared by searches and by inserts/removes that
+ *   stay inside one leaf, and exclusively by everything that changes the
+ *   tree's shape (splits, merges, range deletes, bulk loads, relocation,
+ *   open/close/flush)
+ * - Internal nodes change only under the exclusive tree latch, so under
+ *   the shared latch they are read without node latches; each leaf has a
+ *   reader/writer latch, taken shared by readers and exclusively by
+ *   in-leaf writers, and range scans couple along the leaf chain (latch
+ *   the next leaf, then release the current one)
+ * - An insert or remove that would split or underflow its leaf lets go
+ *   and retries under the exclusive tree latch
+ * - File I/O is positioned (pread/pwrite), the node cache has its own
+ *   mutex and the access counters are atomic
+ * - With a write-ahead log, operations running at the same time share
+ *   one log transaction, which commits when the last of them ends
+ * - Debug printing (printTree, printNode) is not synchronized
  */
 
 #ifndef BPTREE_H
@@ -31,51 +55,25 @@
 
 // Include required headers
 #include "record_pointer.h"           // Record pointer structure
+#include "bptree_node.h"              // B+ tree node layout
+#include "node_cache.h"               // In-memory node cache
+#include "index_key.h"                // Per-key-type sort keys and ranges
+#include "index_stats.h"              // Histogram and clustering factor
 #include "../storage/record.h"        // Record structure
+#include "../utils/mapped_file.h"     // Memory-mapped backend
+#include "../utils/latch.h"           // Tree and node latches
+#include "../storage/wal.h"           // Write-ahead log
+#include "../utils/async_io.h"        // Leaf read-ahead
+#include "../utils/metrics.h"         // Access counters and I/O latency
 #include <vector>                     // For dynamic arrays
-#include <fstream>                    // For file I/O
-#include <set>                        // For tracking unique nodes accessed
 #include <string>                     // For file paths
+#include <functional>                 // For index-only scan callbacks
+#include <atomic>                     // For access counters
+#include <memory>                     // For the node latch table
+#include <iostream>                   // For printing statistics
+#include <sys/types.h>                // For off_t
 
-/**
- * B+ Tree Node Structure
- * 
- * Represents a single node in the B+ tree.
- * Each node can be either an internal node or a leaf node.
- * 
- * Node Layout:
- * - is_leaf: indicates node type
- * - num_keys: current number of keys stored
- * - keys: array of key values (FT_PCT_home values)
- * - children: array of child pointers or record pointers
- * - next_leaf: pointer to next leaf (for leaf nodes)
- * - parent: pointer to parent node
- */
-struct BPTreeNode {
-    static const int MAX_KEYS = 101;  // Maximum number of keys per node
-    
-    bool is_leaf;                     // True if this is a leaf node, false if internal
-    int num_keys;                     // Number of keys currently stored in this node
-    float keys[MAX_KEYS];             // Array of key values (FT_PCT_home percentages)
-    int children[MAX_KEYS + 1];       // Array of child pointers (block IDs for internal nodes, encoded record pointers for leaf nodes)
-    int next_leaf;                    // Pointer to next leaf node (for leaf nodes only)
-    int parent;                       // Pointer to parent node
-    
-    /**
-     * Default Constructor
-     * 
-     * Initializes a new B+ tree node with default values.
-     * By default, nodes are created as leaf nodes.
-     */
-    BPTreeNode() : is_leaf(true), num_keys(0), next_leaf(-1), parent(-1) {
-        // Initialize all keys and children to default values
-        for (int i = 0; i < MAX_KEYS; i++) {
-            keys[i] = 0.0f;
-            children[i] = -1;
-        }
-        children[MAX_KEYS] = -1;
-    }
-};
+static const int DEFAULT_LEAF_READ_AHEAD = 16;   // Leaves read ahead of a sequential range walk
 
 /**
  * B+ Tree Class
@@ -96,54 +94,316 @@ struct BPTreeNode {
  * - Internal nodes: contain keys and child pointers
  * - Leaf nodes: contain keys and record pointers
  * - All leaf nodes are linked for efficient range queries
- * - Order: maximum number of keys per node (101 in this implementation)
+ * - Order: maximum number of keys per node (derived from the 4 KB page
+ *   size and the key size)
+ * 
+ * The tree is templated on the key type; BPTree is the FT_PCT_home
+ * (float) index. Supported key types have KeyTraits (index_key.h) and are
+ * instantiated in bptree.cpp.
+ * 
+ * @tparam Key Trivially copyable key type with operator< and operator==
  */
-class BPTree {
+template <typename Key>
+class BasicBPTree {
+public:
+    typedef BasicBPTreeNode<Key> Node;         // Node layout for this key type
+    typedef std::pair<Key, RecordPointer> Entry;     // Index entry (key, record location)
+    typedef std::function<void(const Key&, const RecordPointer&)> EntryCallback; // (key, record location)
+    typedef BasicIndexStats<Key> Stats;        // Optimizer statistics for this key type
+    
 private:
     std::string filename;             // Path to the B+ tree file
-    mutable std::fstream file;        // File stream for I/O operations (mutable for const methods)
+    StorageBackend backend;           // Stream (node cache) or memory-mapped file access
+    int fd;                           // File descriptor for positioned I/O (-1 when closed)
+    mutable MappedFile mapped;        // File mapping when backend is MMAP
     int root_id;                      // ID of the root node
     int next_node_id;                 // Next available node ID
+    int free_node_head;               // First freed node, linked through next_leaf (-1 if none)
+    int num_free_nodes;               // Number of nodes on the free-node list
     int order;                        // B+ tree order (maximum keys per node)
+    int height;                       // Number of levels (changes only under the exclusive tree latch)
+    Stats stats;                      // Statistics of the last bulk load (stored after the header)
+    WriteAheadLog* log;               // Attached write-ahead log (nullptr = none)
+    int log_file_id;                  // ID of the file in the log (-1 = not logged)
+    bool metadata_dirty;              // Logged metadata not yet written to the file
+    int read_ahead_leaves;            // Leaf read-ahead window of range walks (0 = off)
     
-    // I/O counters for performance measurement
-    mutable int index_nodes_accessed;       // Backward-compat total ops
-    mutable int total_index_node_ios;       // Total node I/O operations
-    mutable std::set<int> unique_index_nodes; // Unique node IDs accessed
+    /**
+     * Metadata Page Structure
+     * 
+     * Layout of page 0: the header, then the statistics.
+     */
+    struct MetadataPage {
+        int header[4];                // root_id, next_node_id, free_node_head, num_free_nodes
+        Stats stats;                  // Index statistics
+    };
+    
+    /**
+     * Active Log
+     * 
+     * @return The attached log if this file is registered with it, else nullptr
+     */
+    WriteAheadLog* activeLog() const { return log_file_id >= 0 ? log : nullptr; }
+    
+    /**
+     * Node File Offset
+     * 
+     * Nodes are stored one per page after the metadata page, so every
+     * node starts on a page boundary.
+     * 
+     * @param node_id ID of the node
+     * @return Byte offset of the node in the index file
+     */
+    static off_t nodeOffset(int node_id) {
+        return (static_cast<off_t>(node_id) + 1) * Node::PAGE_SIZE;
+    }
+    
+    mutable BasicNodeCache<Key> cache; // In-memory node cache (mutable for const methods)
+    
+    /**
+     * Node Latch Structure
+     * 
+     * Per-node latch (used for leaves), plus the flag behind
+     * getIndexNodesAccessedUnique().
+     */
+    struct NodeLatch {
+        RWLatch latch;                 // Shared by readers, exclusive by the leaf's writer
+        std::atomic<bool> accessed;    // Node accessed since the last counter reset
+        
+        NodeLatch() : accessed(false) {}
+    };
+    
+    mutable RWLatch tree_latch;                          // Shared: searches, in-leaf updates; exclusive: shape changes
+    std::vector<std::unique_ptr<NodeLatch> > node_latches; // Indexed by node ID; grows only under the exclusive tree latch
+    
+    // I/O counters for performance measurement (sharded per thread, so parallel searches do not contend)
+    mutable ShardedCounter index_nodes_accessed;         // Backward-compat total ops
+    mutable ShardedCounter total_index_node_ios;         // Total logical node accesses (reads + writes)
+    LatencyHistogram* node_read_latency;                 // Physical node reads (nullptr = not measured)
+    LatencyHistogram* node_write_latency;                // Physical node writes (nullptr = not measured)
     
     // Node Operations
     
     /**
-     * Write Node to File
+     * Write Node
      * 
-     * Writes a B+ tree node to the disk file.
+     * Writes a B+ tree node through the node cache. The node reaches the
+     * file when it is evicted or flushed. With the mmap backend the node
+     * is copied straight into the mapping.
      * 
      * @param node_id ID of the node to write
      * @param node Node data to write
      * @return true if write was successful
      */
-    bool writeNode(int node_id, const BPTreeNode& node);
+    bool writeNode(int node_id, const Node& node);
     
     /**
-     * Read Node from File
+     * Read Node
      * 
-     * Reads a B+ tree node from the disk file.
+     * Reads a B+ tree node through the node cache, going to the file
+     * only on a miss.
      * 
      * @param node_id ID of the node to read
      * @param node Node object to store the read data
      * @return true if read was successful
      */
-    bool readNode(int node_id, BPTreeNode& node) const;
+    bool readNode(int node_id, Node& node) const;
+    
+    /**
+     * View Node
+     * 
+     * Returns a pointer to a node, copying it only when needed: into the
+     * mapping (mmap backend), at the pinned copy of an internal node in the
+     * node cache, or at buffer for a cached leaf (which another thread may
+     * evict). Counted as one node access. The pointer is only valid until
+     * the next node read or write, and only while the node is latched (or
+     * the tree latch is held exclusively).
+     * 
+     * @param node_id ID of the node to view
+     * @param buffer Receives a copy of the node if it cannot be viewed in place
+     * @return Pointer to the node, or nullptr if it cannot be read
+     */
+    const Node* viewNode(int node_id, Node& buffer) const;
+    
+    /**
+     * Count Node Access
+     * 
+     * @param node_id ID of the node read or written
+     */
+    void countAccess(int node_id) const;
+    
+    // Latching
+    
+    /**
+     * Reserve Node Latches
+     * 
+     * Grows the latch table to cover node IDs below count. Called with the
+     * tree latch held exclusively (or before the tree is shared).
+     * 
+     * @param count Number of node IDs to cover
+     */
+    void reserveLatches(int count);
+    
+    /**
+     * Get Node Latch
+     * 
+     * @param node_id ID of the node
+     * @return Latch of the node, or nullptr if the ID is out of range
+     */
+    NodeLatch* latchFor(int node_id) const {
+        return node_id >= 0 && static_cast<size_t>(node_id) < node_latches.size() ? node_latches[node_id].get() : nullptr;
+    }
+    
+    /**
+     * Latched Descent
+     * 
+     * Descends to the leaf that should contain the key and latches it,
+     * shared or exclusive, before reading it. The internal levels are
+     * read unlatched: they only change under the exclusive tree latch.
+     * Requires the tree latch held shared. On success the leaf stays
+     * latched; release it with unlatchNode().
+     * 
+     * @param key Key value to search for
+     * @param leaf_id Output parameter receiving the leaf ID
+     * @param buffer Buffer for nodes that cannot be viewed in place
+     * @param exclusive_leaf true to latch the leaf exclusively (for an update)
+     * @return Pointer to the leaf, or nullptr (nothing latched) if the tree
+     *         is empty or a node cannot be read
+     */
+    const Node* descendLatched(Key key, int& leaf_id, Node& buffer, bool exclusive_leaf) const;
+    
+    /**
+     * Release Node Latch
+     * 
+     * @param node_id ID of a node latched by descendLatched() or a leaf walk
+     * @param exclusive Mode it was latched in
+     */
+    void unlatchNode(int node_id, bool exclusive) const;
+    
+    /**
+     * Walk Leaf Range
+     * 
+     * Shared-latched descent to min_key, then along the leaf chain with
+     * latch coupling, calling visit(leaf, begin, end) with the positions of
+     * each leaf in [min_key, max_key]. Requires the tree latch held shared.
+     * 
+     * @param min_key Minimum key value (inclusive)
+     * @param max_key Maximum key value (inclusive)
+     * @param visit Function called as visit(const Node& leaf, int begin, int end)
+     * @param below If not nullptr, the walk also stops before the first key >= *below
+     */
+    template <typename Visitor>
+    void walkRange(Key min_key, Key max_key, const Visitor& visit, const Key* below = nullptr) const;
+    
+    /**
+     * Leaf Read-Ahead Class
+     * 
+     * Read-ahead state of one leaf chain walk (defined in bptree.cpp).
+     */
+    class LeafReadAhead;
+    
+    /**
+     * Split Range
+     * 
+     * Picks up to parts - 1 separator keys inside (min_key, max_key] from
+     * the internal levels, going one level further down while the levels
+     * above offer too few. Every returned key begins a sub-range whose
+     * entries are found by descending to it. Requires the tree latch held
+     * shared.
+     * 
+     * @param min_key Minimum key value (inclusive)
+     * @param max_key Maximum key value (inclusive)
+     * @param parts Desired number of sub-ranges
+     * @return Ascending, distinct split keys
+     */
+    std::vector<Key> splitRange(Key min_key, Key max_key, int parts) const;
+    
+    /**
+     * Insert in Place
+     * 
+     * Inserts into the entry's leaf under an exclusive leaf latch if the
+     * leaf has room. Requires the tree latch held shared.
+     * 
+     * @param key Key value to insert
+     * @param ptr Record pointer to insert
+     * @return true if the entry was inserted; false if the leaf would split
+     */
+    bool insertInPlace(Key key, const RecordPointer& ptr);
+    
+    /**
+     * Remove in Place
+     * 
+     * Removes an entry from the first leaf its key can be in, under an
+     * exclusive leaf latch, if the leaf holds it and stays at least half
+     * full. Requires the tree latch held shared.
+     * 
+     * @param key Key value of the entry
+     * @param ptr Location of the record, or nullptr for any entry with the key
+     * @return true if the entry was removed; false if the exclusive path is needed
+     */
+    bool removeInPlace(Key key, const RecordPointer* ptr);
+    
+    /**
+     * Insert with Splits
+     * 
+     * The general insert, splitting nodes up to the root as needed.
+     * Requires the tree latch held exclusively.
+     * 
+     * @param key Key value to insert
+     * @param ptr Record pointer to insert
+     * @return true if insertion was successful
+     */
+    bool insertWithSplits(Key key, const RecordPointer& ptr);
+    
+    /**
+     * Compute Height
+     * 
+     * @return Number of levels, following the leftmost path
+     */
+    int computeHeight() const;
+    
+    /**
+     * Collect Root Keys
+     * 
+     * @return Keys of the root node (read under its latch)
+     */
+    std::vector<Key> collectRootKeys() const;
+    
+    /**
+     * Write Back
+     * 
+     * Body of flush(); the caller holds the tree latch exclusively.
+     * 
+     * @return true if all writes succeeded
+     */
+    bool writeBack();
+    
+    /**
+     * Load Sorted Entries
+     * 
+     * Body of bulkLoadSorted(); the caller holds the tree latch exclusively.
+     */
+    bool loadSorted(const std::vector<Entry>& data, double leaf_fill, int num_threads);
+    
+    /**
+     * Physical Node I/O
+     * 
+     * Transfer a node between the file and memory. Only the node cache
+     * calls these, on a miss or on write-back.
+     */
+    bool readNodeFromDisk(int node_id, Node& node) const;
+    bool writeNodeToDisk(int node_id, const Node& node) const;
     
     /**
      * Create New Node
      * 
-     * Creates a new node in the B+ tree file.
+     * Creates a new node in the B+ tree file, reusing a node from the
+     * free-node list before growing the file.
      * 
      * @param node Node data to create
      * @return ID of the newly created node, or -1 if failed
      */
-    int createNode(const BPTreeNode& node);
+    int createNode(const Node& node);
     
     // Tree Operations
     
@@ -156,8 +416,46 @@ private:
      * @param key Key value to search for
      * @return ID of the leaf node that should contain the key
      */
-    int findLeaf(float key);
+    int findLeaf(Key key);
     
+    /**
+     * Find Leaf Node for Key
+     * 
+     * Same as findLeaf(key) but also returns the leaf contents, so callers
+     * do not have to read the leaf a second time.
+     * 
+     * @param key Key value to search for
+     * @param leaf Output parameter receiving the leaf node
+     * @return ID of the leaf node, or -1 if the tree is empty
+     */
+    int findLeaf(Key key, Node& leaf);
+    
+    /**
+     * Find Leaf Node for Key (Zero-Copy)
+     * 
+     * Same as findLeaf(key, leaf) but visits every node on the path in
+     * place via viewNode(), so no node is copied.
+     * 
+     * @param key Key value to search for
+     * @param leaf_id Output parameter receiving the leaf ID
+     * @param buffer Buffer for nodes that cannot be viewed in place
+     * @return Pointer to the leaf, or nullptr if the tree is empty
+     */
+    const Node* findLeafNode(Key key, int& leaf_id, Node& buffer);
+
+    /**
+     * Append Leaf Pointers
+     *
+     * Unpacks the record pointers in positions [begin, end) of a leaf and
+     * appends them to the results.
+     *
+     * @param leaf Leaf node holding the entries
+     * @param begin First position to copy
+     * @param end One past the last position to copy
+     * @param results Vector receiving the record pointers
+     */
+    static void appendPointers(const Node& leaf, int begin, int end, std::vector<RecordPointer>& results);
+
     /**
      * Insert into Leaf Node
      * 
@@ -167,7 +465,20 @@ private:
      * @param key Key value to insert
      * @param ptr Record pointer to insert
      */
-    void insertIntoLeaf(int leaf_id, float key, const RecordPointer& ptr);
+    void insertIntoLeaf(int leaf_id, Key key, const RecordPointer& ptr);
+    
+    /**
+     * Insert into Leaf Node (Already Read)
+     * 
+     * Same as above for a leaf the caller has already read, so the
+     * insert is not counted as a second node access.
+     * 
+     * @param leaf_id ID of the leaf node
+     * @param current Current contents of the leaf
+     * @param key Key value to insert
+     * @param ptr Record pointer to insert
+     */
+    void insertIntoLeaf(int leaf_id, const Node& current, Key key, const RecordPointer& ptr);
     
     /**
      * Split Leaf Node
@@ -187,7 +498,7 @@ private:
      * @param key Key value to promote
      * @param right_id ID of the right child
      */
-    void insertIntoParent(int left_id, float key, int right_id);
+    void insertIntoParent(int left_id, Key key, int right_id);
     
     /**
      * Split Internal Node
@@ -199,13 +510,135 @@ private:
     void splitInternal(int node_id);
     
     // Deletion helper functions
-    void removeFromLeaf(int leaf_id, float key);
-    void handleUnderflow(int node_id);
+    
+    /**
+     * Remove Entry
+     * 
+     * Removes one entry with the given key (and record pointer, if given)
+     * from a subtree. Every child whose key range can hold the key is
+     * tried in order, so entries in a run of duplicates spanning several
+     * leaves are found. An underfull child is merged or redistributed
+     * with a sibling on the way back up.
+     * 
+     * @param node_id Root of the subtree
+     * @param key Key of the entry
+     * @param ptr Record pointer of the entry (nullptr = any entry with the key)
+     * @return true if an entry was removed
+     */
+    bool removeEntry(int node_id, Key key, const RecordPointer* ptr);
+    
+    /**
+     * Delete Node
+     * 
+     * Clears a node and pushes it onto the free-node list.
+     * 
+     * @param node_id ID of the node to free
+     */
     void deleteNode(int node_id);
-    void borrowFromLeft(int node_id, int sibling_id, int parent_id, int key_index);
-    void borrowFromRight(int node_id, int sibling_id, int parent_id, int key_index);
-    void mergeWithLeft(int node_id, int sibling_id, int parent_id, int key_index);
-    void mergeWithRight(int node_id, int sibling_id, int parent_id, int key_index);
+    
+    // Range deletion helper functions
+    
+    /**
+     * Minimum Keys per Node
+     * 
+     * @return Fewest keys a non-root node may hold
+     */
+    int minKeys() const { return (order + 1) / 2 - 1; }
+    
+    /**
+     * Cut Leaf Range
+     * 
+     * Removes the entries with keys in [min_key, max_key] from the run of
+     * leaves that holds them and links the surviving leaves around the
+     * emptied ones. Emptied leaves are left in the tree with no keys.
+     * 
+     * @param min_key Minimum key value (inclusive)
+     * @param max_key Maximum key value (inclusive)
+     * @return Number of entries removed
+     */
+    int cutLeafRange(Key min_key, Key max_key);
+    
+    /**
+     * Prune Range
+     * 
+     * Second pass of a range delete: frees the subtrees that lay entirely
+     * inside the range, drops emptied boundary children and rebalances the
+     * boundary children that remain. Only the two root-to-leaf paths at the
+     * edges of the range are visited.
+     * 
+     * @param node_id Root of the subtree
+     * @param min_key Minimum key value (inclusive)
+     * @param max_key Maximum key value (inclusive)
+     * @return true if the subtree has no entries left (the caller frees it)
+     */
+    bool pruneRange(int node_id, Key min_key, Key max_key);
+    
+    /**
+     * Free Subtree
+     * 
+     * Puts every node of a subtree on the free-node list.
+     * 
+     * @param node_id Root of the subtree
+     */
+    void freeSubtree(int node_id);
+    
+    /**
+     * Rebalance Child
+     * 
+     * Fixes an underfull child by merging it with a sibling, or by
+     * redistributing entries evenly if the two do not fit in one node.
+     * Parent pointers of moved children are updated.
+     * 
+     * @param parent Parent node (modified in memory; the caller writes it)
+     * @param index Position of the child in the parent
+     * @return Position of the merged node, or -1 if no merge happened
+     */
+    int rebalanceChild(Node& parent, int index);
+    
+    /**
+     * Remove Child Entry
+     * 
+     * Removes child 'index' and an adjacent separator from an internal
+     * node that has at least two children.
+     * 
+     * @param node Internal node (modified in memory)
+     * @param index Position of the child to remove
+     */
+    static void removeChildEntry(Node& node, int index);
+    
+    /**
+     * Set Parent Pointer
+     * 
+     * @param node_id ID of the child node
+     * @param parent_id ID of its new parent
+     */
+    void setParent(int node_id, int parent_id);
+    
+    /**
+     * Collapse Root
+     * 
+     * Replaces a root with a single child by that child, repeatedly, and
+     * saves the metadata.
+     */
+    void collapseRoot();
+    
+    // Bulk loading helper functions
+    
+    /**
+     * Plan Level
+     * 
+     * Splits the items of one tree level into consecutive nodes of
+     * 'capacity' items. A short last node is merged into its left
+     * neighbour, or the two are split evenly if they do not fit together,
+     * so no node ends up below min_size.
+     * 
+     * @param num_items Entries (leaf level) or children (internal levels)
+     * @param capacity Items per node before the fix-up
+     * @param max_size Most items a node can hold
+     * @param min_size Fewest items a non-root node may hold
+     * @param sizes Output: number of items of each node, in order
+     */
+    static void planLevel(size_t num_items, int capacity, int max_size, int min_size, std::vector<int>& sizes);
     
     // Utility Functions
     
@@ -223,14 +656,35 @@ private:
     /**
      * Write Metadata
      * 
-     * Writes B+ tree metadata (root_id, next_node_id) to disk.
+     * Records B+ tree metadata (root_id, next_node_id, free-node list) and
+     * the index statistics: written to disk, or only logged if a log is
+     * active (writeBack() writes it like a cached node).
      */
     void writeMetadata();
     
+    /**
+     * Store Metadata
+     * 
+     * Writes the metadata page to the file (STREAM backend), after the log
+     * allows it.
+     * 
+     * @return true if the page was written
+     */
+    bool storeMetadata();
+    
+    /**
+     * Metadata Page
+     * 
+     * @return The current metadata and statistics in page 0 layout
+     */
+    MetadataPage metadataPage() const;
+    
     /**
      * Read Metadata
      * 
-     * Reads B+ tree metadata (root_id, next_node_id) from disk.
+     * Reads B+ tree metadata (root_id, next_node_id, free-node list) and
+     * the index statistics from disk. Files written before statistics
+     * existed have zeros there and load without statistics.
      */
     void readMetadata();
     
@@ -242,15 +696,16 @@ public:
      * Calculates the optimal order based on node size.
      * 
      * @param fname Path to the B+ tree file
+     * @param leaf_cache_size Number of leaf nodes kept in the node cache
      */
-    BPTree(const std::string& fname);
+    BasicBPTree(const std::string& fname, size_t leaf_cache_size = DEFAULT_LEAF_CACHE_SIZE);
     
     /**
      * Destructor
      * 
      * Ensures proper cleanup by closing the B+ tree file.
      */
-    ~BPTree();
+    ~BasicBPTree();
     
     // File Operations
     
@@ -259,17 +714,29 @@ public:
      * 
      * Opens the B+ tree file for reading and writing.
      * 
+     * @param backend STREAM (pread/pwrite behind the node cache) or MMAP (nodes
+     *                are accessed in a shared mapping of the file)
      * @return true if file was opened successfully
      */
-    bool open();
+    bool open(StorageBackend backend = StorageBackend::STREAM);
     
     /**
      * Close B+ Tree File
      * 
-     * Closes the B+ tree file.
+     * Writes back dirty cached nodes and metadata, then closes the file.
      */
     void close();
     
+    /**
+     * Flush B+ Tree
+     * 
+     * Writes back dirty cached nodes and metadata without closing the file.
+     * With the mmap backend this is an msync checkpoint.
+     * 
+     * @return true if all writes succeeded
+     */
+    bool flush();
+    
     /**
      * Check if B+ Tree is Open
      * 
@@ -279,6 +746,47 @@ public:
      */
     bool isOpen() const;
     
+    /**
+     * Attach Write-Ahead Log
+     * 
+     * Logs every node and metadata change (STREAM backend only). Must be
+     * called before open(), which opens the log if necessary. insert(),
+     * remove(), removeRange(), relocatePointers() and bulk loads are one
+     * transaction each, or part of the caller's (e.g. a Database
+     * operation). Checkpoints are left to the log's other users.
+     * 
+     * @param wal Log to use, shared with other files (nullptr to detach)
+     */
+    void attachLog(WriteAheadLog* wal) { log = wal; }
+    
+    /**
+     * Attach Metrics
+     * 
+     * Records the latency of every physical node read and write (cache
+     * misses and write-backs, or copies out of the mapping) into the
+     * registry's index_node_read_seconds and index_node_write_seconds
+     * histograms, shared by all trees attached to the registry.
+     * 
+     * @param registry Registry to record into (nullptr to detach)
+     */
+    void attachMetrics(MetricsRegistry* registry) {
+        node_read_latency = registry != nullptr ? &registry->histogram("index_node_read_seconds") : nullptr;
+        node_write_latency = registry != nullptr ? &registry->histogram("index_node_write_seconds") : nullptr;
+    }
+    
+    /**
+     * Set Leaf Read-Ahead Window
+     * 
+     * Range walks (searches, scans, relocatePointers) that step from leaf i
+     * to leaf i + 1 read the following leaves asynchronously, starting with
+     * two and doubling up to this many per step. With MMAP the window is
+     * passed to the kernel as a hint instead.
+     * 
+     * @param leaves Window size in leaves (0 = off)
+     */
+    void setReadAhead(int leaves) { read_ahead_leaves = leaves > 0 ? leaves : 0; }
+    int getReadAhead() const { return read_ahead_leaves; }
+    
     // Tree Operations
     
     /**
@@ -290,7 +798,7 @@ public:
      * @param ptr Record pointer to insert
      * @return true if insertion was successful
      */
-    bool insert(float key, const RecordPointer& ptr);
+    bool insert(Key key, const RecordPointer& ptr);
     
     /**
      * Search for Key
@@ -300,7 +808,7 @@ public:
      * @param key Key value to search for
      * @return Vector of record pointers matching the key
      */
-    std::vector<RecordPointer> search(float key);
+    std::vector<RecordPointer> search(Key key);
     
     /**
      * Range Search
@@ -311,7 +819,50 @@ public:
      * @param max_key Maximum key value (inclusive)
      * @return Vector of record pointers in the range
      */
-    std::vector<RecordPointer> rangeSearch(float min_key, float max_key);
+    std::vector<RecordPointer> rangeSearch(Key min_key, Key max_key);
+    
+    /**
+     * Scan Range (Index Only)
+     * 
+     * Visits the entries with keys in [min_key, max_key] in key order,
+     * reading only leaves; no data block is fetched. The callback runs
+     * with a leaf latched and must not modify the tree.
+     * 
+     * @param min_key Minimum key value (inclusive)
+     * @param max_key Maximum key value (inclusive)
+     * @param callback Function called as callback(key, record_pointer)
+     * @return Number of entries visited
+     */
+    int scanRange(Key min_key, Key max_key, const EntryCallback& callback);
+    
+    /**
+     * Count Range (Index Only)
+     * 
+     * Counts the entries with keys in [min_key, max_key] from the leaves
+     * without building a result vector.
+     * 
+     * @param min_key Minimum key value (inclusive)
+     * @param max_key Maximum key value (inclusive)
+     * @return Number of entries in the range
+     */
+    int countRange(Key min_key, Key max_key);
+    
+    /**
+     * Parallel Range Search
+     * 
+     * rangeSearch() on several threads. The range is cut at separator keys
+     * of the internal nodes into sub-ranges [k_i, k_i+1), which are
+     * scanned with work stealing; each sub-range starts with its own
+     * descent. Results are concatenated in sub-range order, so they equal
+     * rangeSearch(min_key, max_key). The workers run under the caller's
+     * shared tree latch.
+     * 
+     * @param min_key Minimum key value (inclusive)
+     * @param max_key Maximum key value (inclusive)
+     * @param num_threads Number of threads (0 = one per hardware thread)
+     * @return Vector of record pointers in the range, in key order
+     */
+    std::vector<RecordPointer> parallelRangeSearch(Key min_key, Key max_key, int num_threads = 0);
     
     /**
      * Remove Key
@@ -321,42 +872,123 @@ public:
      * @param key Key value to remove
      * @return true if removal was successful
      */
-    bool remove(float key);
+    bool remove(Key key);
+    
+    /**
+     * Remove Entry
+     * 
+     * Removes the entry for one record, leaving other entries with the
+     * same key in place. Used to keep secondary indexes in sync with
+     * record deletions.
+     * 
+     * @param key Key value of the entry
+     * @param ptr Location of the record
+     * @return true if the entry was found and removed
+     */
+    bool remove(Key key, const RecordPointer& ptr);
     
     /**
      * Remove Range
      * 
-     * Removes all key-value pairs within the specified range.
+     * Removes all key-value pairs within the specified range in place.
+     * The run of leaves holding the range is cut from the leaf chain,
+     * subtrees inside the range are freed whole and only the boundary
+     * nodes are merged or redistributed, so the cost is proportional to
+     * the size of the range rather than the tree.
      * 
      * @param min_key Minimum key value (inclusive)
      * @param max_key Maximum key value (inclusive)
      * @return Number of records removed
      */
-    int removeRange(float min_key, float max_key);
+    int removeRange(Key min_key, Key max_key);
+    
+    /**
+     * Relocate Record Pointers
+     * 
+     * Rewrites the record pointers of records moved by
+     * Database::compact(). All moves are applied in one pass over the leaf
+     * level; each leaf is written at most once.
+     * 
+     * @param moves Old and new location of every moved record
+     * @return Number of index entries updated
+     */
+    int relocatePointers(const std::vector<RecordMove>& moves);
     
     // Bulk Loading
     
     /**
      * Bulk Load B+ Tree
      * 
-     * Efficiently constructs a B+ tree from sorted data.
+     * Efficiently constructs a B+ tree from unsorted data, replacing any
+     * existing contents. Input that is already sorted is not copied.
      * This method is much faster than individual insertions.
      * 
      * @param data Vector of key-value pairs to insert
+     * @param leaf_fill Fraction of each leaf to fill (room left for later inserts)
+     * @param num_threads Threads for sorting and building (0 = one per hardware thread)
      * @return true if bulk loading was successful
      */
-    bool bulkLoad(const std::vector<std::pair<float, RecordPointer>>& data);
+    bool bulkLoad(const std::vector<Entry>& data, double leaf_fill = 1.0,
+                  int num_threads = 1);
+    
+    /**
+     * Bulk Load Sorted Data
+     * 
+     * Builds the tree bottom-up in one pass over data that is already
+     * sorted by key, replacing any existing contents. Node IDs, sibling
+     * links and parents are laid out before anything is written, so each
+     * node is written exactly once, in file order.
+     * 
+     * @param data Key-value pairs in ascending order
+     * @param leaf_fill Fraction of each leaf to fill; clamped so leaves keep
+     *        the minimum occupancy
+     * @param num_threads Threads building the nodes (0 = one per hardware thread);
+     *        nodes are still written by the calling thread, in order
+     * @return true if bulk loading was successful
+     */
+    bool bulkLoadSorted(const std::vector<Entry>& data, double leaf_fill = 1.0,
+                        int num_threads = 1);
+    
+    /**
+     * Sort Index Entries
+     * 
+     * Parallel, stable radix sort of index entries by key, as input for
+     * bulkLoadSorted().
+     * 
+     * @param entries Key-value pairs (sorted in place)
+     * @param num_threads Number of threads (0 = one per hardware thread)
+     */
+    static void sortEntries(std::vector<Entry>& entries, int num_threads = 1);
     
     // Statistics and Information
     
     /**
      * Get Number of Nodes
      * 
-     * Returns the total number of nodes in the B+ tree.
+     * Returns the number of nodes in use (freed nodes are not counted).
      * 
      * @return Number of nodes
      */
-    int getNumNodes() const { return next_node_id; }
+    int getNumNodes() const { SharedLatchGuard guard(tree_latch); return next_node_id - num_free_nodes; }
+    
+    /**
+     * Check if Tree is Empty
+     * 
+     * @return true if the tree holds no entries
+     */
+    bool empty() const;
+    
+    /**
+     * Get Index Statistics
+     * 
+     * Histogram and clustering factor computed by the last bulk load.
+     * Inserts and deletes since then are not reflected. The statistics are
+     * replaced by bulk loads only, which must not run concurrently with
+     * users of the returned reference.
+     * 
+     * @return Statistics (valid() is false if the tree was never bulk loaded)
+     */
+    const Stats& getStats() const { return stats; }
     
     /**
      * Get Number of Levels
@@ -374,14 +1006,15 @@ public:
      * 
      * @return Vector of root node keys
      */
-    std::vector<float> getRootKeys() const;
+    std::vector<Key> getRootKeys() const;
     
     // Utility Functions
     
     /**
      * Print Tree Structure
      * 
-     * Displays the B+ tree structure for debugging purposes.
+     * Displays the B+ tree structure for debugging purposes. Not
+     * synchronized: call it while no other thread uses the tree.
      */
     void printTree() const;
     
@@ -399,16 +1032,29 @@ public:
      * 
      * @return Number of index nodes accessed
      */
-    int getIndexNodesAccessed() const { return index_nodes_accessed; }
-    int getIndexNodeIOsTotal() const { return total_index_node_ios; }
-    int getIndexNodesAccessedUnique() const { return static_cast<int>(unique_index_nodes.size()); }
+    int getIndexNodesAccessed() const { return static_cast<int>(index_nodes_accessed.value()); }
+    int getIndexNodeIOsTotal() const { return static_cast<int>(total_index_node_ios.value()); }
+    int getIndexNodesAccessedUnique() const;
+    
+    /**
+     * Get Node Cache Counters
+     * 
+     * getIndexNodeIOsTotal() counts logical node accesses; these split them
+     * into cache hits and misses and report the physical node I/O.
+     * 
+     * @return Counter value since last reset
+     */
+    int getNodeCacheHits() const { return cache.getHits(); }
+    int getNodeCacheMisses() const { return cache.getMisses(); }
+    int getIndexNodePhysicalReads() const { return cache.getPhysicalReads(); }
+    int getIndexNodePhysicalWrites() const { return cache.getPhysicalWrites(); }
     
     /**
      * Reset I/O Counters
      * 
      * Resets the I/O counters for performance measurement.
      */
-    void resetIOCounters() { index_nodes_accessed = 0; total_index_node_ios = 0; unique_index_nodes.clear(); }
+    void resetIOCounters();
     
     /**
      * Get B+ Tree Order
@@ -426,7 +1072,7 @@ public:
      * 
      * @return Root node ID
      */
-    int getRootId() const { return root_id; }
+    int getRootId() const { SharedLatchGuard guard(tree_latch); return root_id; }
     
     /**
      * Get Root Node Keys
@@ -435,16 +1081,25 @@ public:
      * 
      * @return Vector of root node keys
      */
-    std::vector<float> getRootNodeKeys() const;
+    std::vector<Key> getRootNodeKeys() const;
     
     /**
      * Print Node Information
      * 
-     * Displays information about a specific node.
+     * Displays information about a specific node. Not synchronized.
      * 
      * @param node_id ID of the node to display
      */
     void printNode(int node_id) const;
 };
 
+// FT_PCT_home index (the original float-keyed tree)
+typedef BasicBPTree<float> BPTree;
+
+// Instantiated in bptree.cpp
+extern template class BasicBPTree<float>;
+extern template class BasicBPTree<int32_t>;
+extern template class BasicBPTree<TeamDateKey>;
+extern template class BasicBPTree<CoveredKey<float, PtsWins> >;
+
 #endif // BPTREE_H
@@ -0,0 +1,93 @@
+/**
+ * SC3020 Database Management System
+ * B+ Tree Node Structure
+ * 
+ * This file defines the on-disk layout of a single B+ tree node, templated
+ * on the key type. It is shared by the BPTree class and the node cache.
+ * 
+ */
+
+#ifndef BPTREE_NODE_H
+#define BPTREE_NODE_H
+
+// Block size shared with the data file
+#include "../storage/block.h"
+#include "record_pointer.h"
+
+// Standard C++ libraries
+#include <cstring>  // For memset
+#include <cstdint>  // For fixed-width child pointers
+
+/**
+ * B+ Tree Node Structure
+ * 
+ * Represents a single node in the B+ tree.
+ * Each node can be either an internal node or a leaf node.
+ * 
+ * A node occupies exactly one 4096-byte page (Block::BLOCK_SIZE) so that
+ * every node read or write transfers one whole, page-aligned block. The
+ * fanout is derived at compile time from the page size and the key and
+ * child pointer sizes, so it follows any change to either and differs per
+ * key type (339 keys for 4-byte keys).
+ * 
+ * Node Layout (4096 bytes):
+ * - Header: 16 bytes (is_leaf, num_keys, next_leaf, parent)
+ * - children: MAX_KEYS + 1 64-bit child pointers (node IDs in internal
+ *   nodes, packed RecordPointers in leaves); placed first so the 8-byte
+ *   array needs no alignment gap
+ * - keys: MAX_KEYS key values, stored contiguously for binary search
+ * - Padding up to the page size
+ * 
+ * @tparam Key Trivially copyable key type with operator< and operator==
+ */
+template <typename Key>
+struct BasicBPTreeNode {
+    static constexpr int PAGE_SIZE = Block::BLOCK_SIZE;               // One node per page
+    static constexpr int HEADER_SIZE = 16;                            // Fixed node header
+    static constexpr int KEY_SIZE = sizeof(Key);                      // Size of one key
+    static constexpr int CHILD_SIZE = sizeof(int64_t);                // Node ID or packed record pointer
+    static constexpr int MAX_KEYS =                                   // Maximum number of keys per node
+        (PAGE_SIZE - HEADER_SIZE - CHILD_SIZE) / (KEY_SIZE + CHILD_SIZE);
+    static constexpr int PADDING_SIZE =                               // Unused bytes at the end of the page
+        PAGE_SIZE - HEADER_SIZE - MAX_KEYS * KEY_SIZE - (MAX_KEYS + 1) * CHILD_SIZE;
+    
+    // Header (16 bytes)
+    bool is_leaf;                     // True if this is a leaf node, false if internal
+    char reserved[3];                 // Explicit alignment padding for the header
+    int num_keys;                     // Number of keys currently stored in this node
+    int next_leaf;                    // Pointer to next leaf node (for leaf nodes only)
+    int parent;                       // Pointer to parent node
+    
+    // Entries
+    int64_t children[MAX_KEYS + 1];   // Array of child pointers (node IDs for internal nodes, packed record pointers for leaf nodes)
+    Key keys[MAX_KEYS];               // Array of key values
+    char padding[PADDING_SIZE];       // Fills the node up to exactly one page
+    
+    /**
+     * Default Constructor
+     * 
+     * Initializes a new B+ tree node with default values.
+     * By default, nodes are created as leaf nodes.
+     */
+    BasicBPTreeNode() : is_leaf(true), num_keys(0), next_leaf(-1), parent(-1) {
+        // A node must fill exactly one page so node offsets stay page aligned
+        static_assert(sizeof(BasicBPTreeNode) == PAGE_SIZE, "BPTreeNode must be exactly one page");
+        
+        memset(reserved, 0, sizeof(reserved));
+        memset(padding, 0, sizeof(padding));
+        // Initialize all keys and children to default values
+        for (int i = 0; i < MAX_KEYS; i++) {
+            keys[i] = Key();
+            children[i] = -1;
+        }
+        children[MAX_KEYS] = -1;
+    }
+};
+
+// Node of the FT_PCT_home index
+typedef BasicBPTreeNode<float> BPTreeNode;
+
+// A node must fill exactly one page so node offsets stay page aligned
+static_assert(sizeof(BPTreeNode) == BPTreeNode::PAGE_SIZE, "BPTreeNode must be exactly one page");
+
+#endif // BPTREE_NODE_H
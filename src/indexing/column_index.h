@@ -0,0 +1,201 @@
+/**
+ * SC3020 Database Management System
+ * Column Index Header
+ *
+ * This file defines ColumnIndex, the SecondaryIndex implementation that
+ * keeps a BasicBPTree over one Record column, and the column extractors
+ * it is instantiated with.
+ *
+ * A column extractor is a struct with:
+ * - typedef Key: the tree's key type (must have KeyTraits)
+ * - name(): the default index name
+ * - extract(record): the key of a record
+ *
+ * game_date is indexed through Record::dateKey(), so date ranges are
+ * integer ranges over YYYYMMDD. TeamDateColumn builds the composite
+ * (team_id_home, game_date, home_team_wins) key.
+ *
+ * CoveringColumn<Column, Include> indexes Column and stores the columns
+ * selected by Include in every leaf entry (a covering index), so
+ * aggregates over a key range need no data block reads.
+ */
+
+#ifndef COLUMN_INDEX_H
+#define COLUMN_INDEX_H
+
+// Include tree and catalog interface
+#include "bptree.h"
+#include "index_catalog.h"
+
+// Standard C++ libraries
+#include <string>    // For index names and paths
+#include <vector>    // For build buffers
+#include <memory>    // For registering with a catalog
+
+// Column Extractors
+
+struct FtPctHomeColumn {
+    typedef float Key;
+    static const char* name() { return "ft_pct_home"; }
+    static Key extract(const Record& record) { return record.ft_pct_home; }
+};
+
+struct GameDateColumn {
+    typedef int32_t Key;
+    static const char* name() { return "game_date"; }
+    static Key extract(const Record& record) { return record.dateKey(); }
+};
+
+struct TeamIdHomeColumn {
+    typedef int32_t Key;
+    static const char* name() { return "team_id_home"; }
+    static Key extract(const Record& record) { return record.team_id_home; }
+};
+
+struct PtsHomeColumn {
+    typedef int32_t Key;
+    static const char* name() { return "pts_home"; }
+    static Key extract(const Record& record) { return record.pts_home; }
+};
+
+struct RebHomeColumn {
+    typedef int32_t Key;
+    static const char* name() { return "reb_home"; }
+    static Key extract(const Record& record) { return record.reb_home; }
+};
+
+struct TeamDateColumn {
+    typedef TeamDateKey Key;
+    static const char* name() { return "team_date"; }
+    static Key extract(const Record& record) {
+        return TeamDateKey(record.team_id_home, record.dateKey(), record.home_team_wins != 0 ? 1 : 0);
+    }
+};
+
+// Included Column Sets
+
+struct PtsWinsInclude {
+    typedef PtsWins Values;
+    static const char* name() { return "pts_home,home_team_wins"; }
+    static Values extract(const Record& record) { return Values(record.pts_home, record.home_team_wins); }
+};
+
+/**
+ * Covering Column Template
+ *
+ * Column extractor whose key is Column's key plus the Include values; it
+ * is registered as "<column> include (<included columns>)".
+ */
+template <typename Column, typename Include>
+struct CoveringColumn {
+    typedef CoveredKey<typename Column::Key, typename Include::Values> Key;
+    static const char* name() {
+        static const std::string full_name = std::string(Column::name()) + " include (" + Include::name() + ")";
+        return full_name.c_str();
+    }
+    static Key extract(const Record& record) { return Key(Column::extract(record), Include::extract(record)); }
+};
+
+/**
+ * Column Index Template
+ *
+ * Secondary index on the column selected by Column, stored in its own
+ * B+ tree file.
+ */
+template <typename Column>
+class ColumnIndex : public SecondaryIndex {
+public:
+    typedef typename Column::Key Key;
+    typedef BasicBPTree<Key> Tree;
+
+    /**
+     * Constructor
+     *
+     * @param path Path to the index file
+     * @param leaf_fill Leaf fill factor used by builds
+     * @param index_name Name to register under (default: Column::name())
+     */
+    ColumnIndex(const std::string& path, double leaf_fill = 1.0, const std::string& index_name = "")
+        : name(index_name.empty() ? Column::name() : index_name), tree(path), leaf_fill(leaf_fill) {}
+
+    const std::string& getName() const { return name; }
+
+    bool open(StorageBackend backend) { return tree.open(backend); }
+    void close() { tree.close(); }
+    bool flush() { return tree.flush(); }
+    void attachLog(WriteAheadLog* log) { tree.attachLog(log); }
+    void attachMetrics(MetricsRegistry* registry) { tree.attachMetrics(registry); }
+    bool empty() const { return tree.empty(); }
+
+    bool insert(const Record& record, const RecordPointer& ptr) {
+        return tree.insert(Column::extract(record), ptr);
+    }
+
+    bool remove(const Record& record, const RecordPointer& ptr) {
+        return tree.remove(Column::extract(record), ptr);
+    }
+
+    int relocate(const std::vector<RecordMove>& moves) {
+        return tree.relocatePointers(moves);
+    }
+
+    void beginBuild(int num_partitions) {
+        partitions.assign(num_partitions, std::vector<typename Tree::Entry>());
+    }
+
+    void collect(const Record& record, const RecordPointer& ptr, int partition) {
+        partitions[partition].push_back(typename Tree::Entry(Column::extract(record), ptr));
+    }
+
+    bool finishBuild(int num_threads) {
+        size_t total = 0;
+        for (size_t i = 0; i < partitions.size(); i++) total += partitions[i].size();
+
+        std::vector<typename Tree::Entry> entries;
+        entries.reserve(total);
+        for (size_t i = 0; i < partitions.size(); i++) {
+            entries.insert(entries.end(), partitions[i].begin(), partitions[i].end());
+            std::vector<typename Tree::Entry>().swap(partitions[i]);
+        }
+        partitions.clear();
+
+        if (entries.empty()) {
+            // Nothing to load: just drop the old contents
+            if (!tree.empty()) tree.removeRange(KeyTraits<Key>::lowest(), KeyTraits<Key>::highest());
+            return true;
+        }
+        Tree::sortEntries(entries, num_threads);
+        return tree.bulkLoadSorted(entries, leaf_fill, num_threads);
+    }
+
+    /**
+     * Get Tree
+     *
+     * @return The underlying B+ tree, for searches and statistics
+     */
+    Tree& getTree() { return tree; }
+
+private:
+    std::string name;                                               // Registered name
+    Tree tree;                                                      // Index contents
+    double leaf_fill;                                               // Leaf fill factor for builds
+    std::vector<std::vector<typename Tree::Entry> > partitions;     // Build buffers, one per scan partition
+};
+
+/**
+ * Add Column Index
+ *
+ * Creates a ColumnIndex and registers it with a catalog.
+ *
+ * @param catalog Catalog to register with
+ * @param path Path to the index file
+ * @param leaf_fill Leaf fill factor used by builds
+ * @return The registered index, or nullptr if it could not be added
+ */
+template <typename Column>
+ColumnIndex<Column>* addColumnIndex(IndexCatalog& catalog, const std::string& path, double leaf_fill = 1.0) {
+    return static_cast<ColumnIndex<Column>*>(
+        catalog.addIndex(std::unique_ptr<SecondaryIndex>(new ColumnIndex<Column>(path, leaf_fill))));
+}
+
+#endif // COLUMN_INDEX_H
@@ -0,0 +1,84 @@
+/**
+ * SC3020 Database Management System
+ * Index Catalog Implementation
+ *
+ * This file contains the implementation of the IndexCatalog class:
+ * registration, file operations and change propagation to the indexes.
+ *
+ */
+
+#include "index_catalog.h"
+
+SecondaryIndex* IndexCatalog::addIndex(std::unique_ptr<SecondaryIndex> index) {
+    if (!index || find(index->getName()) != nullptr) return nullptr;
+    index->attachLog(log);
+    index->attachMetrics(metrics);
+    if (is_open && !index->open(open_backend)) return nullptr;
+    indexes.push_back(std::move(index));
+    return indexes.back().get();
+}
+
+SecondaryIndex* IndexCatalog::find(const std::string& name) const {
+    for (size_t i = 0; i < indexes.size(); i++) {
+        if (indexes[i]->getName() == name) return indexes[i].get();
+    }
+    return nullptr;
+}
+
+bool IndexCatalog::open(StorageBackend backend) {
+    open_backend = backend;
+    is_open = true;
+    bool ok = true;
+    for (size_t i = 0; i < indexes.size(); i++) {
+        if (!indexes[i]->open(backend)) ok = false;
+    }
+    return ok;
+}
+
+void IndexCatalog::close() {
+    for (size_t i = 0; i < indexes.size(); i++) {
+        indexes[i]->close();
+    }
+    is_open = false;
+}
+
+bool IndexCatalog::flush() {
+    bool ok = true;
+    for (size_t i = 0; i < indexes.size(); i++) {
+        if (!indexes[i]->flush()) ok = false;
+    }
+    return ok;
+}
+
+void IndexCatalog::attachLog(WriteAheadLog* wal) {
+    log = wal;
+    for (size_t i = 0; i < indexes.size(); i++) {
+        indexes[i]->attachLog(wal);
+    }
+}
+
+void IndexCatalog::attachMetrics(MetricsRegistry* registry) {
+    metrics = registry;
+    for (size_t i = 0; i < indexes.size(); i++) {
+        indexes[i]->attachMetrics(registry);
+    }
+}
+
+void IndexCatalog::onInsert(const Record& record, const RecordPointer& ptr) {
+    for (size_t i = 0; i < indexes.size(); i++) {
+        indexes[i]->insert(record, ptr);
+    }
+}
+
+void IndexCatalog::onDelete(const Record& record, const RecordPointer& ptr) {
+    for (size_t i = 0; i < indexes.size(); i++) {
+        indexes[i]->remove(record, ptr);
+    }
+}
+
+void IndexCatalog::onMove(const std::vector<RecordMove>& moves) {
+    if (moves.empty()) return;
+    for (size_t i = 0; i < indexes.size(); i++) {
+        indexes[i]->relocate(moves);
+    }
+}
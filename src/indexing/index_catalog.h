@@ -0,0 +1,221 @@
+/**
+ * SC3020 Database Management System
+ * Index Catalog Header
+ *
+ * This file defines the SecondaryIndex interface and the IndexCatalog that
+ * a Database uses to keep its secondary indexes in sync with the heap file.
+ *
+ * The Index Catalog provides:
+ * - Registration of any number of indexes, each on its own file
+ * - Maintenance on every insert, delete and compaction move
+ * - A build protocol so all indexes are filled from one parallel scan
+ *
+ * Which indexes exist is not stored in the database file: the application
+ * registers the same indexes every time it opens the database.
+ */
+
+#ifndef INDEX_CATALOG_H
+#define INDEX_CATALOG_H
+
+// Include record, pointer and backend definitions
+#include "../storage/record.h"
+#include "record_pointer.h"
+#include "../utils/mapped_file.h"
+#include "../storage/wal.h"
+#include "../utils/metrics.h"
+
+// Standard C++ libraries
+#include <string>    // For index names
+#include <vector>    // For compaction moves
+#include <memory>    // For owning the indexes
+
+/**
+ * Secondary Index Interface
+ *
+ * One index over a column (or combination of columns) of Record, mapping
+ * the column value to record pointers. Implemented by ColumnIndex for
+ * the B+ tree.
+ */
+class SecondaryIndex {
+public:
+    virtual ~SecondaryIndex() {}
+
+    /**
+     * Get Index Name
+     *
+     * @return Name the index is registered and looked up under
+     */
+    virtual const std::string& getName() const = 0;
+
+    // File Operations (same semantics as BPTree)
+    virtual bool open(StorageBackend backend) = 0;
+    virtual void close() = 0;
+    virtual bool flush() = 0;
+
+    /**
+     * Attach Write-Ahead Log
+     *
+     * Logs the index file's changes (see Database::attachLog()). Called
+     * before open().
+     *
+     * @param log Log to use (nullptr to detach)
+     */
+    virtual void attachLog(WriteAheadLog* log) = 0;
+
+    /**
+     * Attach Metrics
+     *
+     * Records the index file's I/O latency into a registry. The default
+     * records nothing.
+     *
+     * @param registry Registry to record into (nullptr to detach)
+     */
+    virtual void attachMetrics(MetricsRegistry*) {}
+
+    /**
+     * Check if Index is Empty
+     *
+     * @return true if the index holds no entries (it needs a build)
+     */
+    virtual bool empty() const = 0;
+
+    // Maintenance
+
+    /**
+     * Insert Entry
+     *
+     * @param record Record that was stored
+     * @param ptr Location of the record
+     * @return true if the entry was added
+     */
+    virtual bool insert(const Record& record, const RecordPointer& ptr) = 0;
+
+    /**
+     * Remove Entry
+     *
+     * @param record Record that was deleted (its contents before deletion)
+     * @param ptr Location the record had
+     * @return true if the entry was found and removed
+     */
+    virtual bool remove(const Record& record, const RecordPointer& ptr) = 0;
+
+    /**
+     * Relocate Entries
+     *
+     * @param moves Old and new location of every moved record
+     * @return Number of entries updated
+     */
+    virtual int relocate(const std::vector<RecordMove>& moves) = 0;
+
+    // Build Protocol
+
+    /**
+     * Begin Build
+     *
+     * Prepares one entry buffer per scan partition.
+     *
+     * @param num_partitions Number of partitions the scan will use
+     */
+    virtual void beginBuild(int num_partitions) = 0;
+
+    /**
+     * Collect Entry
+     *
+     * Called concurrently for different partitions, never concurrently
+     * for the same partition.
+     *
+     * @param record Scanned record
+     * @param ptr Location of the record
+     * @param partition Scan partition
+     */
+    virtual void collect(const Record& record, const RecordPointer& ptr, int partition) = 0;
+
+    /**
+     * Finish Build
+     *
+     * Concatenates the partition buffers in order, sorts them and replaces
+     * the index contents with a bulk load.
+     *
+     * @param num_threads Threads for the sort and node build
+     * @return true if the index was built
+     */
+    virtual bool finishBuild(int num_threads) = 0;
+};
+
+/**
+ * Index Catalog Class
+ *
+ * Owns the secondary indexes of one Database and forwards every change of
+ * the heap file to all of them.
+ */
+class IndexCatalog {
+public:
+    IndexCatalog() : open_backend(StorageBackend::STREAM), is_open(false), log(nullptr), metrics(nullptr) {}
+
+    /**
+     * Add Index
+     *
+     * Registers an index. The index gets the catalog's log and metrics
+     * registry, and if the catalog is open it is opened with the same
+     * backend right away.
+     *
+     * @param index Index to register (the catalog takes ownership)
+     * @return Registered index, or nullptr if the name is taken or the
+     *         index could not be opened
+     */
+    SecondaryIndex* addIndex(std::unique_ptr<SecondaryIndex> index);
+
+    /**
+     * Find Index
+     *
+     * @param name Index name
+     * @return Index, or nullptr if none has this name
+     */
+    SecondaryIndex* find(const std::string& name) const;
+
+    /**
+     * Get Registered Indexes
+     *
+     * @return Number of indexes / index i in registration order
+     */
+    size_t size() const { return indexes.size(); }
+    SecondaryIndex* at(size_t i) const { return indexes[i].get(); }
+    bool empty() const { return indexes.empty(); }
+
+    // File Operations, applied to every index
+    bool open(StorageBackend backend);
+    void close();
+    bool flush();
+
+    /**
+     * Attach Write-Ahead Log
+     *
+     * Passes the log to every registered index and to indexes added later.
+     *
+     * @param wal Log to use (nullptr to detach)
+     */
+    void attachLog(WriteAheadLog* wal);
+
+    /**
+     * Attach Metrics
+     *
+     * Passes the registry to every registered index and to indexes added later.
+     *
+     * @param registry Registry to record into (nullptr to detach)
+     */
+    void attachMetrics(MetricsRegistry* registry);
+
+    // Maintenance Hooks, called by Database after the heap file changed
+    void onInsert(const Record& record, const RecordPointer& ptr);
+    void onDelete(const Record& record, const RecordPointer& ptr);
+    void onMove(const std::vector<RecordMove>& moves);
+
+private:
+    std::vector<std::unique_ptr<SecondaryIndex> > indexes;   // Registered indexes
+    StorageBackend open_backend;                             // Backend of open()
+    bool is_open;                                            // true between open() and close()
+    WriteAheadLog* log;                                      // Log given to every index (nullptr = none)
+    MetricsRegistry* metrics;                                // Registry given to every index (nullptr = none)
+};
+
+#endif // INDEX_CATALOG_H
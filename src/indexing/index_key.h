@@ -0,0 +1,187 @@
+/**
+ * SC3020 Database Management System
+ * Index Key Traits Header
+ *
+ * This file defines KeyTraits, the per-key-type hooks the templated B+ tree
+ * needs beyond comparison:
+ * - sortKey(): an unsigned integer with the same order as the key, used by
+ *   the radix sort that feeds bulk loading
+ * - lowest() / highest(): the smallest and largest key, for scans over
+ *   everything
+ *
+ * It also defines TeamDateKey, the composite (team_id_home, game_date) key,
+ * and CoveredKey, which carries included columns next to a key.
+ *
+ * Every key type listed here is instantiated in bptree.cpp and
+ * node_cache.cpp.
+ */
+
+#ifndef INDEX_KEY_H
+#define INDEX_KEY_H
+
+// Float sort key
+#include "../utils/parallel.h"
+
+// Standard C++ libraries
+#include <cstdint>   // For int32_t, uint32_t, uint64_t
+#include <limits>    // For key ranges
+#include <ostream>   // For printing composite keys
+
+/**
+ * Team/Date Composite Key
+ *
+ * Orders entries by home team, then by game date (YYYYMMDD), so all games
+ * of one team form one contiguous run of leaf entries, in date order.
+ * The home_win flag is a trailing key column: it does not change which
+ * range a query covers, but lets win rates be computed from the leaves
+ * without fetching records.
+ *
+ * Keys compare lexicographically. prefixMin()/prefixMax() bound a team
+ * prefix, optionally narrowed to a date range, for rangeSearch().
+ */
+struct TeamDateKey {
+    int32_t team_id;     // TEAM_ID_home
+    int32_t date;        // GAME_DATE_EST as YYYYMMDD
+    int32_t home_win;    // HOME_TEAM_WINS (0 or 1)
+
+    TeamDateKey() : team_id(0), date(0), home_win(0) {}
+    TeamDateKey(int32_t team_id, int32_t date, int32_t home_win = 0)
+        : team_id(team_id), date(date), home_win(home_win) {}
+
+    bool operator<(const TeamDateKey& other) const {
+        if (team_id != other.team_id) return team_id < other.team_id;
+        if (date != other.date) return date < other.date;
+        return home_win < other.home_win;
+    }
+    bool operator==(const TeamDateKey& other) const {
+        return team_id == other.team_id && date == other.date && home_win == other.home_win;
+    }
+
+    /**
+     * Prefix Bounds
+     *
+     * @param team_id Team whose games are wanted
+     * @param date First / last date of the range (default: all dates)
+     * @return Smallest / largest key of the team's games in the date range
+     */
+    static TeamDateKey prefixMin(int32_t team_id, int32_t date = std::numeric_limits<int32_t>::min()) {
+        return TeamDateKey(team_id, date, std::numeric_limits<int32_t>::min());
+    }
+    static TeamDateKey prefixMax(int32_t team_id, int32_t date = std::numeric_limits<int32_t>::max()) {
+        return TeamDateKey(team_id, date, std::numeric_limits<int32_t>::max());
+    }
+};
+
+// Printed as team/date (tree statistics and debugging)
+inline std::ostream& operator<<(std::ostream& out, const TeamDateKey& key) {
+    return out << key.team_id << "/" << key.date;
+}
+
+/**
+ * Covered Key Template
+ *
+ * A key plus included (INCLUDE) column values. Only the key takes part in
+ * comparisons, so the tree orders, searches and deletes exactly as on the
+ * bare key; the included values ride along in every entry and can be read
+ * from the leaves without fetching the record. A bound for a search is
+ * just CoveredKey(key).
+ *
+ * @tparam Key Search key type (must have KeyTraits)
+ * @tparam Values Trivially copyable struct of included values
+ */
+template <typename Key, typename Values>
+struct CoveredKey {
+    Key key;            // Search key
+    Values include;     // Included column values
+
+    CoveredKey() : key(), include() {}
+    CoveredKey(const Key& key, const Values& include = Values()) : key(key), include(include) {}
+
+    bool operator<(const CoveredKey& other) const { return key < other.key; }
+    bool operator==(const CoveredKey& other) const { return key == other.key; }
+};
+
+template <typename Key, typename Values>
+inline std::ostream& operator<<(std::ostream& out, const CoveredKey<Key, Values>& key) {
+    return out << key.key;
+}
+
+/**
+ * Points and Outcome (included values)
+ *
+ * PTS_home and HOME_TEAM_WINS, for points and win-rate aggregates.
+ */
+struct PtsWins {
+    int32_t pts_home;         // PTS_home
+    int32_t home_team_wins;   // HOME_TEAM_WINS
+
+    PtsWins() : pts_home(0), home_team_wins(0) {}
+    PtsWins(int32_t pts_home, int32_t home_team_wins) : pts_home(pts_home), home_team_wins(home_team_wins) {}
+};
+
+/**
+ * Key Traits Template
+ *
+ * Specialized for every supported key type.
+ */
+template <typename Key>
+struct KeyTraits;
+
+/**
+ * Float Keys (percentages such as FT_PCT_home)
+ */
+template <>
+struct KeyTraits<float> {
+    static uint32_t sortKey(float key) { return floatSortKey(key); }
+    static float lowest() { return -std::numeric_limits<float>::infinity(); }
+    static float highest() { return std::numeric_limits<float>::infinity(); }
+};
+
+/**
+ * 32-bit Integer Keys (team IDs, points, rebounds, YYYYMMDD dates)
+ */
+template <>
+struct KeyTraits<int32_t> {
+    // Flipping the sign bit maps signed order onto unsigned order
+    static uint32_t sortKey(int32_t key) { return static_cast<uint32_t>(key) ^ 0x80000000u; }
+    static int32_t lowest() { return std::numeric_limits<int32_t>::min(); }
+    static int32_t highest() { return std::numeric_limits<int32_t>::max(); }
+};
+
+/**
+ * Team/Date Composite Keys
+ *
+ * The sort key packs team (sign bit flipped), date and win flag into 64
+ * bits; it preserves key order for dates in [0, 2^31) and win flags of 0
+ * or 1, which covers every key Record::dateKey() produces.
+ */
+template <>
+struct KeyTraits<TeamDateKey> {
+    static uint64_t sortKey(const TeamDateKey& key) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(key.team_id) ^ 0x80000000u) << 32) |
+               (static_cast<uint64_t>(static_cast<uint32_t>(key.date)) << 1) |
+               static_cast<uint64_t>(key.home_win & 1);
+    }
+    static TeamDateKey lowest() {
+        return TeamDateKey::prefixMin(std::numeric_limits<int32_t>::min());
+    }
+    static TeamDateKey highest() {
+        return TeamDateKey::prefixMax(std::numeric_limits<int32_t>::max());
+    }
+};
+
+/**
+ * Covered Keys
+ *
+ * Sorted and bounded by the search key alone.
+ */
+template <typename Key, typename Values>
+struct KeyTraits<CoveredKey<Key, Values> > {
+    static auto sortKey(const CoveredKey<Key, Values>& key) -> decltype(KeyTraits<Key>::sortKey(key.key)) {
+        return KeyTraits<Key>::sortKey(key.key);
+    }
+    static CoveredKey<Key, Values> lowest() { return CoveredKey<Key, Values>(KeyTraits<Key>::lowest()); }
+    static CoveredKey<Key, Values> highest() { return CoveredKey<Key, Values>(KeyTraits<Key>::highest()); }
+};
+
+#endif // INDEX_KEY_H
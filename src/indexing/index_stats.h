@@ -0,0 +1,132 @@
+/**
+ * SC3020 Database Management System
+ * Index Statistics Header
+ *
+ * This file defines BasicIndexStats, the optimizer statistics a B+ tree
+ * keeps about its contents:
+ * - An equi-depth histogram of the keys (every bucket holds about the same
+ *   number of entries), for estimating how many entries a range matches
+ * - The clustering factor: the number of times consecutive entries in key
+ *   order point to different data blocks. It equals the number of blocks
+ *   when the heap file is sorted on the key and approaches the number of
+ *   entries when the order is unrelated
+ *
+ * The statistics are computed by bulk loading and stored in the index
+ * file's metadata page; later inserts and deletes do not update them.
+ */
+
+#ifndef INDEX_STATS_H
+#define INDEX_STATS_H
+
+// Include key traits and record pointers
+#include "index_key.h"
+#include "record_pointer.h"
+
+// Standard C++ libraries
+#include <vector>    // For build input
+#include <utility>   // For std::pair
+#include <cstring>   // For memset
+#include <cstdint>   // For fixed-width counters
+
+/**
+ * Index Statistics Template
+ *
+ * Trivially copyable so it can be written to the metadata page as is.
+ *
+ * @tparam Key Key type of the tree (must have KeyTraits)
+ */
+template <typename Key>
+struct BasicIndexStats {
+    static const int MAX_BUCKETS = 128;   // Histogram buckets (about 200 entries each for 26K records)
+
+    int64_t num_entries;                  // Entries at build time
+    int32_t num_blocks;                   // Distinct data blocks referenced
+    int32_t clustering_factor;            // Block changes walking the entries in key order
+    int32_t num_buckets;                  // Buckets in use (0 = no statistics)
+    int32_t reserved;                     // Keeps the bounds 8-byte aligned
+    Key bounds[MAX_BUCKETS + 1];          // Bucket b holds keys in [bounds[b], bounds[b + 1]]
+    int32_t counts[MAX_BUCKETS];          // Entries in each bucket
+
+    BasicIndexStats() { clear(); }
+
+    /**
+     * Clear Statistics
+     */
+    void clear() {
+        memset(static_cast<void*>(this), 0, sizeof(*this));
+        for (int i = 0; i <= MAX_BUCKETS; i++) bounds[i] = Key();
+    }
+
+    /**
+     * Check if Statistics Exist
+     *
+     * @return true if a histogram has been built
+     */
+    bool valid() const { return num_buckets > 0; }
+
+    /**
+     * Build Statistics
+     *
+     * @param sorted Index entries in ascending key order
+     */
+    void build(const std::vector<std::pair<Key, RecordPointer> >& sorted) {
+        clear();
+        size_t n = sorted.size();
+        if (n == 0) return;
+
+        num_entries = static_cast<int64_t>(n);
+        num_buckets = n < static_cast<size_t>(MAX_BUCKETS) ? static_cast<int32_t>(n) : MAX_BUCKETS;
+        for (int b = 0; b < num_buckets; b++) {
+            size_t begin = n * b / num_buckets;
+            size_t end = n * (b + 1) / num_buckets;
+            bounds[b] = sorted[begin].first;
+            counts[b] = static_cast<int32_t>(end - begin);
+        }
+        bounds[num_buckets] = sorted[n - 1].first;
+
+        // Clustering factor and distinct blocks
+        std::vector<char> seen;
+        int previous = -1;
+        for (size_t i = 0; i < n; i++) {
+            int block_id = sorted[i].second.block_id;
+            if (block_id != previous) clustering_factor++;
+            previous = block_id;
+            if (block_id < 0) continue;
+            if (static_cast<size_t>(block_id) >= seen.size()) seen.resize(block_id + 1, 0);
+            if (!seen[block_id]) {
+                seen[block_id] = 1;
+                num_blocks++;
+            }
+        }
+    }
+
+    /**
+     * Estimate Matching Entries
+     *
+     * Buckets inside [min_key, max_key] count in full and buckets the
+     * range only overlaps count for half their entries, so the error is
+     * at most half a bucket at each end of the range. Interpolating
+     * inside a bucket would assume keys are spread evenly over their
+     * values, which fails for keys such as YYYYMMDD dates.
+     *
+     * @param min_key Minimum key (inclusive)
+     * @param max_key Maximum key (inclusive)
+     * @return Estimated number of entries in the range (at build time)
+     */
+    double estimateEntries(const Key& min_key, const Key& max_key) const {
+        if (!valid() || max_key < min_key) return 0.0;
+
+        double estimate = 0.0;
+        for (int b = 0; b < num_buckets; b++) {
+            const Key& first = bounds[b];
+            const Key& last = bounds[b + 1];
+            if (last < min_key || max_key < first) continue;
+            bool inside = !(first < min_key) && !(max_key < last);
+            bool single_valued = !(first < last);
+            estimate += inside || single_valued ? counts[b] : counts[b] * 0.5;
+        }
+        return estimate;
+    }
+};
+
+#endif // INDEX_STATS_H
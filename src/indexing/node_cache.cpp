@@ -0,0 +1,185 @@
+/**
+ * SC3020 Database Management System
+ * B+ Tree Node Cache Implementation
+ *
+ * This file contains the implementation of the NodeCache class template
+ * and its instantiations for the supported key types.
+ *
+ */
+
+#include "node_cache.h"
+#include "index_key.h"   // For the composite and covered key instantiations
+#include <algorithm>  // For ordering write-back
+#include <vector>     // For collecting dirty nodes
+
+/**
+ * Node Cache Constructor
+ *
+ * @param leaf_capacity Maximum number of unpinned (leaf) nodes kept in memory
+ * @param read_fn Callback performing a physical node read
+ * @param write_fn Callback performing a physical node write
+ */
+template <typename Key>
+BasicNodeCache<Key>::BasicNodeCache(size_t leaf_capacity, const ReadFunction& read_fn, const WriteFunction& write_fn)
+    : leaf_capacity(leaf_capacity > 0 ? leaf_capacity : 1), read_node(read_fn), write_node(write_fn),
+      hits(0), misses(0), physical_reads(0), physical_writes(0), write_backs(0) {}
+
+template <typename Key>
+void BasicNodeCache<Key>::touch(int node_id, Entry& entry) {
+    // Internal nodes are pinned; deleted nodes (internal, no keys) are not
+    bool should_pin = !entry.node.is_leaf && entry.node.num_keys > 0;
+    
+    if (entry.pinned && !should_pin) {
+        leaf_lru.push_front(node_id);
+        entry.lru_pos = leaf_lru.begin();
+    } else if (!entry.pinned && should_pin) {
+        leaf_lru.erase(entry.lru_pos);
+    } else if (!should_pin) {
+        // Already unpinned: move to the most-recently-used position
+        leaf_lru.splice(leaf_lru.begin(), leaf_lru, entry.lru_pos);
+    }
+    entry.pinned = should_pin;
+}
+
+template <typename Key>
+bool BasicNodeCache<Key>::evictLeaves(int keep_id) {
+    bool ok = true;
+    while (leaf_lru.size() > leaf_capacity) {
+        int victim_id = leaf_lru.back();
+        if (victim_id == keep_id) break; // Only the node just accessed is left
+        
+        typename std::unordered_map<int, Entry>::iterator it = entries.find(victim_id);
+        if (it->second.dirty) {
+            // Write back before dropping the node
+            if (!write_node(victim_id, it->second.node)) {
+                ok = false;
+                break;
+            }
+            physical_writes++;
+            write_backs++;
+        }
+        leaf_lru.pop_back();
+        entries.erase(it);
+    }
+    return ok;
+}
+
+template <typename Key>
+const BasicBPTreeNode<Key>* BasicNodeCache<Key>::get(int node_id, Node& buffer) {
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    typename std::unordered_map<int, Entry>::iterator it = entries.find(node_id);
+    if (it != entries.end()) {
+        // Hit: node already in memory
+        hits++;
+        touch(node_id, it->second);
+    } else {
+        // Miss: read the node from disk without holding up other threads
+        misses++;
+        lock.unlock();
+        Node node;
+        if (!read_node(node_id, node)) return nullptr;
+        physical_reads++;
+        lock.lock();
+        
+        // Another thread may have loaded the node in the meantime
+        it = entries.find(node_id);
+        if (it == entries.end()) {
+            Entry& entry = entries[node_id];
+            entry.node = node;
+            entry.dirty = false;
+            leaf_lru.push_front(node_id); // touch() pins the node if it is internal
+            entry.lru_pos = leaf_lru.begin();
+            touch(node_id, entry);
+            evictLeaves(node_id);
+            it = entries.find(node_id);
+        } else {
+            touch(node_id, it->second);
+        }
+    }
+    
+    if (it->second.pinned) return &it->second.node;
+    buffer = it->second.node;
+    return &buffer;
+}
+
+template <typename Key>
+bool BasicNodeCache<Key>::put(int node_id, const Node& node) {
+    std::lock_guard<std::mutex> lock(mutex);
+    typename std::unordered_map<int, Entry>::iterator it = entries.find(node_id);
+    if (it == entries.end()) {
+        // New entry: no need to read what is about to be overwritten
+        Entry& entry = entries[node_id];
+        entry.node = node;
+        entry.dirty = true;
+        leaf_lru.push_front(node_id); // touch() pins the node if it is internal
+        entry.lru_pos = leaf_lru.begin();
+        touch(node_id, entry);
+        return evictLeaves(node_id);
+    }
+    
+    it->second.node = node;
+    it->second.dirty = true;
+    touch(node_id, it->second);
+    return true;
+}
+
+template <typename Key>
+bool BasicNodeCache<Key>::contains(int node_id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.count(node_id) > 0;
+}
+
+template <typename Key>
+bool BasicNodeCache<Key>::fill(int node_id, const Node& node, long long read_sequence) {
+    physical_reads++;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.count(node_id) > 0 || write_backs != read_sequence) return false;
+    
+    Entry& entry = entries[node_id];
+    entry.node = node;
+    entry.dirty = false;
+    leaf_lru.push_front(node_id); // touch() pins the node if it is internal
+    entry.lru_pos = leaf_lru.begin();
+    touch(node_id, entry);
+    evictLeaves(node_id);
+    return true;
+}
+
+template <typename Key>
+bool BasicNodeCache<Key>::flushAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    // Write dirty nodes in ID order so the write-back is sequential on disk
+    std::vector<int> dirty_ids;
+    for (typename std::unordered_map<int, Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+        if (it->second.dirty) dirty_ids.push_back(it->first);
+    }
+    std::sort(dirty_ids.begin(), dirty_ids.end());
+    
+    bool ok = true;
+    for (size_t i = 0; i < dirty_ids.size(); i++) {
+        Entry& entry = entries[dirty_ids[i]];
+        if (write_node(dirty_ids[i], entry.node)) {
+            physical_writes++;
+            write_backs++;
+            entry.dirty = false;
+        } else {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+template <typename Key>
+void BasicNodeCache<Key>::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    leaf_lru.clear();
+}
+
+// Key types the node cache is compiled for (see index_key.h)
+template class BasicNodeCache<float>;
+template class BasicNodeCache<int32_t>;
+template class BasicNodeCache<TeamDateKey>;
+template class BasicNodeCache<CoveredKey<float, PtsWins> >;
@@ -0,0 +1,210 @@
+/**
+ * SC3020 Database Management System
+ * B+ Tree Node Cache Header
+ *
+ * This file defines the NodeCache class template that keeps B+ tree nodes in memory
+ * between operations so traversals and read-modify-write cycles do not go
+ * to the index file for every node access.
+ *
+ * The Node Cache provides:
+ * - Write-back caching: modified nodes are marked dirty and written later
+ * - Internal nodes are pinned and never evicted, so the upper levels of the
+ *   tree (including the root once the tree has more than one node) always
+ *   stay in memory
+ * - Leaf nodes are kept in an LRU list bounded by a configurable capacity
+ * - Hit/miss and physical I/O counters for performance analysis
+ * - Thread safety: one mutex guards the map and LRU list; misses are read
+ *   from disk with the mutex released
+ * - Prefetching: nodes read ahead by the owner are added with fill()
+ *
+ * Physical node reads and writes are delegated to callbacks supplied by the
+ * owner (the BPTree class), which knows the file layout.
+ */
+
+#ifndef NODE_CACHE_H
+#define NODE_CACHE_H
+
+// Include node layout
+#include "bptree_node.h"
+
+// Standard C++ libraries
+#include <list>           // For leaf LRU ordering
+#include <unordered_map>  // For node lookup
+#include <functional>     // For physical I/O callbacks
+#include <cstddef>        // For size_t
+#include <mutex>          // For the cache mutex
+#include <atomic>         // For the counters
+
+static const size_t DEFAULT_LEAF_CACHE_SIZE = 256; // Default number of cached leaf nodes
+
+/**
+ * Node Cache Class
+ *
+ * Maps node IDs to in-memory copies of B+ tree nodes. get() hands out
+ * pinned (internal) nodes in place, since they are never evicted, and
+ * copies leaves into a caller buffer, since another thread may evict them
+ * at any time. Callers are responsible for not reading a node while
+ * another thread puts a new version of it (the tree's node latches).
+ *
+ * @tparam Key Key type of the cached nodes
+ */
+template <typename Key>
+class BasicNodeCache {
+public:
+    typedef BasicBPTreeNode<Key> Node;                                  // Cached node type
+    typedef std::function<bool(int, Node&)> ReadFunction;               // Physical node read
+    typedef std::function<bool(int, const Node&)> WriteFunction;        // Physical node write
+
+    /**
+     * Constructor
+     *
+     * @param leaf_capacity Maximum number of unpinned (leaf) nodes kept in memory
+     * @param read_fn Callback performing a physical node read
+     * @param write_fn Callback performing a physical node write
+     */
+    BasicNodeCache(size_t leaf_capacity, const ReadFunction& read_fn, const WriteFunction& write_fn);
+
+    /**
+     * Get Node
+     *
+     * Returns the cached copy of a node, reading it from disk on a miss.
+     *
+     * @param node_id ID of the node
+     * @param buffer Receives a copy of the node unless it is pinned
+     * @return Pointer to the pinned node or to buffer, or nullptr if the
+     *         physical read failed
+     */
+    const Node* get(int node_id, Node& buffer);
+
+    /**
+     * Put Node
+     *
+     * Stores a new version of a node in the cache and marks it dirty.
+     * The node is written to disk on eviction or flush.
+     *
+     * @param node_id ID of the node
+     * @param node New node contents
+     * @return true if the node was cached (eviction write-back succeeded)
+     */
+    bool put(int node_id, const Node& node);
+
+    /**
+     * Check if Cached
+     *
+     * @param node_id ID of the node
+     * @return true if the node is in memory
+     */
+    bool contains(int node_id) const;
+
+    /**
+     * Get Write-Back Sequence
+     *
+     * Number of nodes written back so far (never reset). A node read from
+     * disk is only up to date if no write-back happened since the read began.
+     *
+     * @return Write-back count
+     */
+    long long getWriteBackSequence() const { return write_backs; }
+
+    /**
+     * Fill Prefetched Node
+     *
+     * Adds a node read ahead of use as a clean, unpinned entry. Counts as a
+     * physical read. The node is dropped if it is already cached or if any
+     * node was written back since the read began (it may be stale).
+     *
+     * @param node_id ID of the node
+     * @param node Contents read from disk
+     * @param read_sequence getWriteBackSequence() before the read was issued
+     * @return true if the node was added
+     */
+    bool fill(int node_id, const Node& node, long long read_sequence);
+
+    /**
+     * Flush All Nodes
+     *
+     * Writes every dirty node back to disk.
+     *
+     * @return true if all writes succeeded
+     */
+    bool flushAll();
+
+    /**
+     * Clear Cache
+     *
+     * Drops every cached node without writing it back.
+     */
+    void clear();
+
+    // Statistics
+    int getHits() const { return hits; }
+    int getMisses() const { return misses; }
+    int getPhysicalReads() const { return physical_reads; }
+    int getPhysicalWrites() const { return physical_writes; }
+    int getNumCachedNodes() const { std::lock_guard<std::mutex> lock(mutex); return static_cast<int>(entries.size()); }
+    size_t getLeafCapacity() const { return leaf_capacity; }
+    int getNumPinnedNodes() const { std::lock_guard<std::mutex> lock(mutex); return static_cast<int>(entries.size() - leaf_lru.size()); }
+
+    /**
+     * Reset Counters
+     *
+     * Resets hit/miss and physical I/O counters for performance measurement.
+     */
+    void resetCounters() { hits = 0; misses = 0; physical_reads = 0; physical_writes = 0; }
+
+private:
+    /**
+     * Cache Entry Structure
+     *
+     * The cached node plus its bookkeeping. Elements of an unordered_map keep
+     * their address when the map rehashes, so pointers to entries are stable.
+     */
+    struct Entry {
+        Node node;                             // Cached node contents
+        bool dirty;                            // True if the node differs from disk
+        bool pinned;                           // True for internal nodes (never evicted)
+        std::list<int>::iterator lru_pos;      // Position in leaf_lru when unpinned
+
+        Entry() : dirty(false), pinned(false) {}
+    };
+
+    std::unordered_map<int, Entry> entries;   // Node ID -> cached entry
+    std::list<int> leaf_lru;                  // Unpinned node IDs, most recently used first
+    size_t leaf_capacity;                     // Maximum size of leaf_lru
+    ReadFunction read_node;                   // Physical read callback
+    WriteFunction write_node;                 // Physical write callback
+    mutable std::mutex mutex;                 // Guards entries and leaf_lru
+
+    // Counters
+    std::atomic<int> hits;             // Accesses served from memory
+    std::atomic<int> misses;           // Accesses that required a physical read
+    std::atomic<int> physical_reads;   // Nodes read from disk
+    std::atomic<int> physical_writes;  // Nodes written to disk
+    std::atomic<long long> write_backs; // Nodes written to disk, never reset (see fill())
+
+    /**
+     * Update Entry Placement
+     *
+     * Pins internal nodes and moves unpinned nodes to the front of the LRU list.
+     *
+     * @param node_id ID of the node
+     * @param entry Entry to update
+     */
+    void touch(int node_id, Entry& entry);
+
+    /**
+     * Evict Leaves
+     *
+     * Evicts least recently used leaves until the capacity is respected,
+     * never evicting the node identified by keep_id.
+     *
+     * @param keep_id Node that must stay resident
+     * @return true if every evicted dirty node was written successfully
+     */
+    bool evictLeaves(int keep_id);
+};
+
+// Node cache of the FT_PCT_home index
+typedef BasicNodeCache<float> NodeCache;
+
+#endif // NODE_CACHE_H
@@ -0,0 +1,150 @@
+/**
+ * SC3020 Database Management System
+ * B+ Tree Node Search Kernel
+ *
+ * This file defines the NodeSearch helpers used to locate keys inside the
+ * sorted key array of a B+ tree node.
+ *
+ * The kernel provides:
+ * - Branchless binary search (lower/upper bound) for descending internal
+ *   nodes and positioning inside leaves
+ * - Vectorized forward scans (AVX2 or SSE2 when the compiler targets them)
+ *   for finding where a run of matching leaf keys ends
+ * - A scalar fallback with identical results on every other target
+ *
+ * The searches are templates over the key type and only need operator<;
+ * float keys get the vectorized scan.
+ *
+ * All functions assume the keys are sorted in ascending order, which holds
+ * for every node the B+ tree writes.
+ */
+
+#ifndef NODE_SEARCH_H
+#define NODE_SEARCH_H
+
+// SIMD intrinsics (only when the target supports them)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Node Search Class
+ *
+ * Stateless search routines over a node's key array.
+ */
+class NodeSearch {
+public:
+    /**
+     * Lower Bound
+     *
+     * Finds the first position whose key is not less than the search key.
+     * The loop has a fixed trip count per node size and no data-dependent
+     * branches, so it does not suffer from branch mispredictions.
+     *
+     * @param keys Sorted key array
+     * @param num_keys Number of valid keys
+     * @param key Search key
+     * @return Index of the first key >= key (num_keys if none)
+     */
+    template <typename Key>
+    static int lowerBound(const Key* keys, int num_keys, const Key& key) {
+        if (num_keys <= 0) return 0;
+        const Key* base = keys;
+        int len = num_keys;
+        while (len > 1) {
+            int half = len / 2;
+            base += (base[half - 1] < key) ? half : 0;  // Compiles to a conditional move
+            len -= half;
+        }
+        return static_cast<int>(base - keys) + (*base < key ? 1 : 0);
+    }
+
+    /**
+     * Upper Bound
+     *
+     * Finds the first position whose key is greater than the search key.
+     * This is the child index to follow in an internal node, where equal
+     * keys belong to the right subtree.
+     *
+     * @param keys Sorted key array
+     * @param num_keys Number of valid keys
+     * @param key Search key
+     * @return Index of the first key > key (num_keys if none)
+     */
+    template <typename Key>
+    static int upperBound(const Key* keys, int num_keys, const Key& key) {
+        if (num_keys <= 0) return 0;
+        const Key* base = keys;
+        int len = num_keys;
+        while (len > 1) {
+            int half = len / 2;
+            base += !(key < base[half - 1]) ? half : 0;  // Compiles to a conditional move
+            len -= half;
+        }
+        return static_cast<int>(base - keys) + (!(key < *base) ? 1 : 0);
+    }
+
+    /**
+     * Scan For Greater Key
+     *
+     * Scans forward from a starting position and returns the first position
+     * whose key is greater than the bound. Used to find the end of a run of
+     * matching keys in a leaf, which is usually short or covers the whole
+     * leaf, so a vectorized linear scan beats another binary search.
+     *
+     * @param keys Sorted key array
+     * @param from Position to start scanning at
+     * @param num_keys Number of valid keys
+     * @param bound Upper bound (inclusive) of the run
+     * @return Index of the first key > bound at or after from (num_keys if none)
+     */
+    template <typename Key>
+    static int scanGreater(const Key* keys, int from, int num_keys, const Key& bound) {
+        for (int i = from; i < num_keys; i++) {
+            if (bound < keys[i]) return i;
+        }
+        return num_keys;
+    }
+    
+    /**
+     * Scan For Greater Key (float keys)
+     * 
+     * Vectorized version of scanGreater() for float keys.
+     * 
+     * @param keys Sorted key array
+     * @param from Position to start scanning at
+     * @param num_keys Number of valid keys
+     * @param bound Upper bound (inclusive) of the run
+     * @return Index of the first key > bound at or after from (num_keys if none)
+     */
+    static int scanGreater(const float* keys, int from, int num_keys, float bound) {
+        int i = from;
+#if defined(__AVX2__)
+        // 8 keys per compare
+        const __m256 bound8 = _mm256_set1_ps(bound);
+        for (; i + 8 <= num_keys; i += 8) {
+            __m256 gt = _mm256_cmp_ps(_mm256_loadu_ps(keys + i), bound8, _CMP_GT_OQ);
+            int mask = _mm256_movemask_ps(gt);
+            if (mask != 0) return i + __builtin_ctz(mask);
+        }
+#endif
+#if defined(__SSE2__)
+        // 4 keys per compare (also finishes the AVX2 tail)
+        const __m128 bound4 = _mm_set1_ps(bound);
+        for (; i + 4 <= num_keys; i += 4) {
+            __m128 gt = _mm_cmpgt_ps(_mm_loadu_ps(keys + i), bound4);
+            int mask = _mm_movemask_ps(gt);
+            if (mask != 0) return i + __builtin_ctz(mask);
+        }
+#endif
+        // Scalar fallback and tail
+        for (; i < num_keys; i++) {
+            if (keys[i] > bound) return i;
+        }
+        return num_keys;
+    }
+};
+
+#endif // NODE_SEARCH_H
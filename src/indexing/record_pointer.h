@@ -11,6 +11,12 @@
 #ifndef RECORD_POINTER_H
 #define RECORD_POINTER_H
 
+// Include block structure for the per-block slot count
+#include "../storage/block.h"
+
+// Standard C++ libraries
+#include <cstdint>  // For the packed 64-bit representation
+
 /**
  * Record Pointer Structure
  * 
@@ -19,8 +25,16 @@
  * 
  * This structure is used in B+ tree leaf nodes to store
  * references to actual records in the database.
+ * 
+ * Packed Format (64 bits, stored in leaf nodes):
+ * - Bits 0-7: record index (slot) within the block
+ * - Bits 8-63: block ID
+ * Packing and unpacking use only shifts and masks.
  */
 struct RecordPointer {
+    static const int SLOT_BITS = 8;                                    // Bits reserved for the slot
+    static const int64_t SLOT_MASK = (static_cast<int64_t>(1) << SLOT_BITS) - 1;
+    
     int block_id;                     // ID of the block containing the record
     int record_index;                 // Index of the record within the block
     
@@ -41,6 +55,29 @@ struct RecordPointer {
      */
     RecordPointer(int block, int index) : block_id(block), record_index(index) {}
     
+    /**
+     * Pack Pointer
+     * 
+     * Encodes the pointer into the 64-bit form stored in B+ tree leaves.
+     * 
+     * @return Packed pointer (block_id << SLOT_BITS | record_index)
+     */
+    int64_t pack() const {
+        return (static_cast<int64_t>(block_id) << SLOT_BITS) | static_cast<int64_t>(record_index);
+    }
+    
+    /**
+     * Unpack Pointer
+     * 
+     * Decodes a pointer produced by pack().
+     * 
+     * @param packed Packed pointer value
+     * @return Decoded record pointer
+     */
+    static RecordPointer unpack(int64_t packed) {
+        return RecordPointer(static_cast<int>(packed >> SLOT_BITS), static_cast<int>(packed & SLOT_MASK));
+    }
+    
     /**
      * Less Than Comparison Operator
      * 
@@ -70,4 +107,20 @@ struct RecordPointer {
     }
 };
 
+/**
+ * Record Move Structure
+ * 
+ * Old and new location of a record relocated by Database::compact().
+ * BPTree::relocatePointers() applies a batch of moves to the index.
+ */
+struct RecordMove {
+    RecordPointer from;               // Location before compaction
+    RecordPointer to;                 // Location after compaction
+    
+    RecordMove(const RecordPointer& from, const RecordPointer& to) : from(from), to(to) {}
+};
+
+// Every slot of a block must be addressable by the packed slot field
+static_assert(Block::MAX_RECORDS <= (1 << RecordPointer::SLOT_BITS), "Block slots exceed packed RecordPointer slot field");
+
 #endif // RECORD_POINTER_H
@@ -0,0 +1,239 @@
+/**
+ * SC3020 Database Management System
+ * Zone Map Implementation
+ *
+ * This file contains the implementation of ZoneMap: zone bounds,
+ * maintenance, the build protocol and the side file.
+ *
+ */
+
+#include "zone_map.h"
+#include <fstream>   // For the side file
+#include <limits>    // For infinity
+#include <cstring>   // For memcpy, memcmp
+
+namespace {
+
+const char ZONE_MAP_MAGIC[4] = {'Z', 'M', 'P', '1'};
+
+// Field offsets of the columns, in Record order
+const size_t COLUMN_OFFSETS[ZoneMap::NUM_COLUMNS] = {
+    offsetof(Record, game_date), offsetof(Record, team_id_home), offsetof(Record, pts_home),
+    offsetof(Record, fg_pct_home), offsetof(Record, ft_pct_home), offsetof(Record, fg3_pct_home),
+    offsetof(Record, ast_home), offsetof(Record, reb_home), offsetof(Record, home_team_wins)
+};
+
+/**
+ * Column Value
+ *
+ * @param record Record to read
+ * @param c Column index
+ * @return The value as a double (game_date as YYYYMMDD)
+ */
+double columnValue(const Record& record, int c) {
+    const char* field = reinterpret_cast<const char*>(&record) + COLUMN_OFFSETS[c];
+    switch (c) {
+        case 0:
+            return record.dateKey();
+        case 3: case 4: case 5: {
+            float value;
+            memcpy(&value, field, sizeof(value));
+            return value;
+        }
+        default: {
+            int32_t value;
+            memcpy(&value, field, sizeof(value));
+            return value;
+        }
+    }
+}
+
+} // namespace
+
+void ZoneMap::Zone::clear() {
+    live = 0;
+    reserved = 0;
+    for (int c = 0; c < NUM_COLUMNS; c++) {
+        min[c] = std::numeric_limits<double>::infinity();
+        max[c] = -std::numeric_limits<double>::infinity();
+    }
+}
+
+void ZoneMap::Zone::add(const Record& record) {
+    for (int c = 0; c < NUM_COLUMNS; c++) {
+        double value = columnValue(record, c);
+        if (value != value) {
+            // NaN is unordered: the column of this zone can no longer be pruned
+            min[c] = -std::numeric_limits<double>::infinity();
+            max[c] = std::numeric_limits<double>::infinity();
+            continue;
+        }
+        if (value < min[c]) min[c] = value;
+        if (value > max[c]) max[c] = value;
+    }
+    live++;
+}
+
+void ZoneMap::Zone::merge(const Zone& other) {
+    for (int c = 0; c < NUM_COLUMNS; c++) {
+        if (other.min[c] < min[c]) min[c] = other.min[c];
+        if (other.max[c] > max[c]) max[c] = other.max[c];
+    }
+}
+
+ZoneMap::ZoneMap(const std::string& path, const std::string& index_name)
+    : name(index_name), path(path), is_open(false), built(false), num_records(0) {}
+
+/**
+ * Open Zone Map
+ *
+ * Algorithm:
+ * 1. Read the header; keep the zones only if the file is complete and clean
+ * 2. Rewrite the file with the clean flag cleared, so a crash before
+ *    close() invalidates it
+ */
+bool ZoneMap::open(StorageBackend) {
+    if (is_open) return true;
+    zones.clear();
+    built = false;
+    num_records = 0;
+
+    // Step 1: Load a cleanly closed map
+    std::ifstream in(path.c_str(), std::ios::binary);
+    Header header;
+    if (in.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+        memcmp(header.magic, ZONE_MAP_MAGIC, sizeof(header.magic)) == 0 && header.clean == 1 && header.num_zones >= 0) {
+        std::vector<Zone> loaded(header.num_zones);
+        if (loaded.empty() ||
+            in.read(reinterpret_cast<char*>(&loaded[0]), static_cast<std::streamsize>(loaded.size() * sizeof(Zone)))) {
+            zones.swap(loaded);
+            num_records = header.num_records;
+            built = true;
+        }
+    }
+    in.close();
+
+    // Step 2: Mark the file in use
+    if (!writeFile(false)) return false;
+    is_open = true;
+    return true;
+}
+
+void ZoneMap::close() {
+    if (!is_open) return;
+    writeFile(built);
+    is_open = false;
+    built = false;
+    num_records = 0;
+    zones.clear();
+}
+
+bool ZoneMap::writeFile(bool clean) const {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    Header header;
+    memcpy(header.magic, ZONE_MAP_MAGIC, sizeof(header.magic));
+    header.clean = clean ? 1 : 0;
+    header.num_zones = clean ? static_cast<int32_t>(zones.size()) : 0;
+    header.reserved = 0;
+    header.num_records = clean ? num_records : 0;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (header.num_zones > 0) {
+        out.write(reinterpret_cast<const char*>(&zones[0]), static_cast<std::streamsize>(zones.size() * sizeof(Zone)));
+    }
+    out.flush();
+    return out.good();
+}
+
+ZoneMap::Zone& ZoneMap::zoneAt(int block_id) {
+    if (block_id >= static_cast<int>(zones.size())) zones.resize(block_id + 1);
+    return zones[block_id];
+}
+
+const ZoneMap::Zone* ZoneMap::getZone(int block_id) const {
+    if (!built || block_id < 0 || block_id >= static_cast<int>(zones.size())) return nullptr;
+    return &zones[block_id];
+}
+
+int ZoneMap::columnOf(size_t field_offset) {
+    for (int c = 0; c < NUM_COLUMNS; c++) {
+        if (COLUMN_OFFSETS[c] == field_offset) return c;
+    }
+    return -1;
+}
+
+bool ZoneMap::insert(const Record& record, const RecordPointer& ptr) {
+    if (!built || ptr.block_id < 0) return false;
+    zoneAt(ptr.block_id).add(record);
+    num_records++;
+    return true;
+}
+
+bool ZoneMap::remove(const Record&, const RecordPointer& ptr) {
+    if (!built || ptr.block_id < 0 || ptr.block_id >= static_cast<int>(zones.size())) return false;
+    Zone& zone = zones[ptr.block_id];
+    if (zone.live == 0) return false;
+    if (--zone.live == 0) zone.clear();
+    num_records--;
+    return true;
+}
+
+/**
+ * Relocate Entries
+ *
+ * A move only has the record's locations, so the destination zone is
+ * widened by the whole source zone (a superset of the moved record).
+ * Trailing zones emptied by compaction are dropped.
+ */
+int ZoneMap::relocate(const std::vector<RecordMove>& moves) {
+    if (!built) return 0;
+    int updated = 0;
+    for (size_t i = 0; i < moves.size(); i++) {
+        int from = moves[i].from.block_id;
+        int to = moves[i].to.block_id;
+        if (from < 0 || from >= static_cast<int>(zones.size()) || to < 0 || zones[from].live == 0) continue;
+        if (from != to) {
+            Zone& destination = zoneAt(to);
+            destination.merge(zones[from]);
+            destination.live++;
+            if (--zones[from].live == 0) zones[from].clear();
+        }
+        updated++;
+    }
+    while (!zones.empty() && zones.back().live == 0) zones.pop_back();
+    return updated;
+}
+
+void ZoneMap::beginBuild(int num_partitions) {
+    partitions.assign(num_partitions, std::vector<std::pair<int, Zone> >());
+}
+
+/**
+ * Collect Entry
+ *
+ * A partition is a contiguous block range scanned in order, so a new zone
+ * starts whenever the block ID changes.
+ */
+void ZoneMap::collect(const Record& record, const RecordPointer& ptr, int partition) {
+    std::vector<std::pair<int, Zone> >& zones_seen = partitions[partition];
+    if (zones_seen.empty() || zones_seen.back().first != ptr.block_id) {
+        zones_seen.push_back(std::make_pair(ptr.block_id, Zone()));
+    }
+    zones_seen.back().second.add(record);
+}
+
+bool ZoneMap::finishBuild(int) {
+    zones.clear();
+    num_records = 0;
+    for (size_t p = 0; p < partitions.size(); p++) {
+        for (size_t z = 0; z < partitions[p].size(); z++) {
+            Zone& zone = zoneAt(partitions[p][z].first);
+            zone.merge(partitions[p][z].second);
+            zone.live += partitions[p][z].second.live;
+            num_records += partitions[p][z].second.live;
+        }
+    }
+    partitions.clear();
+    built = true;
+    return true;
+}
@@ -0,0 +1,205 @@
+/**
+ * SC3020 Database Management System
+ * Zone Map Header
+ *
+ * This file defines ZoneMap, a SecondaryIndex that keeps the minimum and
+ * maximum of every Record column for each data block (a "zone"). A scan
+ * consults the zones and skips blocks whose range cannot satisfy the
+ * predicate, without reading them.
+ *
+ * game_date is summarized as Record::dateKey() (YYYYMMDD). The data is
+ * loaded in date order, so date ranges, and columns correlated with time,
+ * touch only a few consecutive blocks.
+ *
+ * Maintenance through the IndexCatalog:
+ * - Inserts widen the zone of their block
+ * - Deletes only decrease the zone's live count; the bounds stay a
+ *   superset of the live values until the zone empties or is rebuilt
+ * - Compaction moves widen the destination zone by the source zone
+ *
+ * The map is held in memory and written to its side file by close().
+ * open() clears the file's clean flag, so a map that was open when the
+ * process stopped is discarded: the map is then empty() and is filled
+ * again by Database::buildIndexes(). Until then nothing is pruned.
+ */
+
+#ifndef ZONE_MAP_H
+#define ZONE_MAP_H
+
+// Include catalog interface
+#include "index_catalog.h"
+#include "../storage/block.h"
+
+// Standard C++ libraries
+#include <string>    // For the index name and path
+#include <vector>    // For the zones
+#include <cstdint>   // For file fields
+
+/**
+ * Zone Map Class
+ */
+class ZoneMap : public SecondaryIndex {
+public:
+    static const int NUM_COLUMNS = Block::NUM_COLUMNS;   // Record columns, in Record order
+
+    /**
+     * Zone Structure
+     *
+     * Bounds of one block. A zone with no live records has min above max.
+     */
+    struct Zone {
+        int32_t live;                 // Live records summarized
+        int32_t reserved;             // Padding (zero)
+        double min[NUM_COLUMNS];      // Smallest value per column
+        double max[NUM_COLUMNS];      // Largest value per column
+
+        Zone() { clear(); }
+
+        /**
+         * Clear Zone
+         *
+         * Empties the zone: no live records, every range empty.
+         */
+        void clear();
+
+        /**
+         * Add Record
+         *
+         * Widens the bounds to include a record's values.
+         *
+         * @param record Record stored in the block
+         */
+        void add(const Record& record);
+
+        /**
+         * Merge Zone
+         *
+         * Widens the bounds to include another zone's bounds.
+         *
+         * @param other Zone to merge
+         */
+        void merge(const Zone& other);
+    };
+
+    /**
+     * Default Name
+     *
+     * @return Name scans look the zone map up under
+     */
+    static const char* defaultName() { return "zone_map"; }
+
+    /**
+     * Constructor
+     *
+     * @param path Path to the side file
+     * @param index_name Name to register under
+     */
+    explicit ZoneMap(const std::string& path, const std::string& index_name = defaultName());
+
+    const std::string& getName() const { return name; }
+
+    /**
+     * Open Zone Map
+     *
+     * Loads the zones if the file was closed cleanly, then marks the file
+     * in use. The backend is ignored: the file is read and written whole.
+     *
+     * @param backend Storage backend of the database
+     * @return false if the file could not be written
+     */
+    bool open(StorageBackend backend);
+
+    /**
+     * Close Zone Map
+     *
+     * Writes the zones and the clean flag.
+     */
+    void close();
+
+    /**
+     * Flush Zone Map
+     *
+     * Nothing to do: only close() writes the map (see the file comment).
+     *
+     * @return true
+     */
+    bool flush() { return true; }
+
+    /**
+     * Attach Write-Ahead Log
+     *
+     * Not logged: after a crash the map is rebuilt instead of recovered.
+     */
+    void attachLog(WriteAheadLog*) {}
+
+    bool empty() const { return !built; }
+
+    // Maintenance
+    bool insert(const Record& record, const RecordPointer& ptr);
+    bool remove(const Record& record, const RecordPointer& ptr);
+    int relocate(const std::vector<RecordMove>& moves);
+
+    // Build Protocol
+    void beginBuild(int num_partitions);
+    void collect(const Record& record, const RecordPointer& ptr, int partition);
+    bool finishBuild(int num_threads);
+
+    /**
+     * Get Zone
+     *
+     * @param block_id Data block
+     * @return The block's zone, or nullptr if the map is not built or has
+     *         no zone for the block (the block must then be read)
+     */
+    const Zone* getZone(int block_id) const;
+
+    /**
+     * Column of a Field
+     *
+     * @param field_offset offsetof(Record, column)
+     * @return Column index into Zone::min/max, or -1 if no column starts there
+     */
+    static int columnOf(size_t field_offset);
+
+    // Statistics
+    int getNumZones() const { return static_cast<int>(zones.size()); }
+    long long getNumRecords() const { return num_records; }
+
+private:
+    /**
+     * File Header Structure
+     */
+    struct Header {
+        char magic[4];       // "ZMP1"
+        int32_t clean;       // 1 if written by close()
+        int32_t num_zones;   // Zones that follow the header
+        int32_t reserved;    // Padding (zero)
+        int64_t num_records; // Sum of the zones' live counts
+    };
+
+    /**
+     * Write File
+     *
+     * @param clean Value of the clean flag
+     * @return true if the header and zones were written
+     */
+    bool writeFile(bool clean) const;
+
+    /**
+     * Zone for Update
+     *
+     * @param block_id Data block
+     * @return The block's zone, created empty if needed
+     */
+    Zone& zoneAt(int block_id);
+
+    std::string name;                                          // Registered name
+    std::string path;                                          // Side file
+    bool is_open;                                              // Between open() and close()
+    bool built;                                                // Zones describe the heap file
+    long long num_records;                                     // Live records summarized
+    std::vector<Zone> zones;                                   // Zone of every block, by block ID
+    std::vector<std::vector<std::pair<int, Zone> > > partitions; // Build buffers: (block ID, zone) per partition
+};
+
+#endif // ZONE_MAP_H
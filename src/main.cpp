@@ -21,15 +21,105 @@
 #include <algorithm>     // For sorting and algorithms
 #include <iomanip>       // For formatted output
 #include <fstream>       // For file operations
-#include <set>           // For unique block counting
-#include <map>           // For batching record reads by block
 #include <sstream>
+#include <cstdlib>       // For atoi
+#include <cmath>         // For the exclusive FT_PCT_home bound
 
 
 // Project-specific header files
 #include "storage/database.h"    // Database storage component
+#include "storage/ingest_pipeline.h" // Multi-threaded bulk loader
+#include "storage/archive.h"      // Compressed read-only heap copy
 #include "indexing/bptree.h"     // B+ tree indexing component
+#include "indexing/column_index.h" // Secondary indexes on other columns
+#include "indexing/zone_map.h"   // Per-block min/max for scan pruning
 #include "utils/parser.h"        // Data parsing utilities
+#include "utils/mapped_file.h"   // Storage backend selection
+#include "utils/parallel.h"      // Thread count for the index build
+#include "utils/metrics.h"       // Query spans and I/O latency export
+#include "query/planner.h"       // Index scan vs full scan choice
+#include "query/vector_scan.h"   // Block-level predicate evaluation
+#include "query/query_server.h"  // Persistent query server mode
+
+// Storage backend used by every task (--mmap selects the memory-mapped backend)
+static StorageBackend storage_backend = StorageBackend::STREAM;
+
+// Layout of the heap blocks written by Task 1 (--pax selects the column-oriented layout)
+static BlockLayout storage_layout = BlockLayout::NSM;
+
+// Threads used to build the index and by the parallel scans (--threads N; 0 = one per hardware thread)
+static int index_threads = 0;
+
+// Write-ahead log shared by the database, its indexes and the B+ tree (--no-wal disables it;
+// it is only used with the STREAM backend)
+static bool use_wal = true;
+static const char* WAL_PATH = "output/database.wal";
+
+// Compressed read-only copy of the heap built in Task 2
+static const char* ARCHIVE_PATH = "output/archive.bin";
+
+// Spans and I/O latency of the whole run, exported for monitoring when the tasks finish
+static MetricsRegistry run_metrics;
+static const char* METRICS_JSON_PATH = "output/metrics.json";
+static const char* METRICS_PROM_PATH = "output/metrics.prom";
+
+// Server mode (--serve): requests on stdin, or on a TCP port with --port
+static bool serve_mode = false;
+static int serve_port = 0;
+static const size_t SERVER_POOL_FRAMES = 4096;        // 16 MB buffer pool, enough to keep the heap resident
+static const size_t SERVER_LEAF_CACHE_SIZE = 4096;    // Leaf cache entries, enough for every leaf
+
+/**
+ * Attach Write-Ahead Log
+ * 
+ * Attaches the log to a database and (optionally) a B+ tree before they
+ * are opened, together with the run's metrics registry.
+ * 
+ * @param wal Log shared by both files
+ * @param db Database to log
+ * @param tree B+ tree to log, or nullptr
+ */
+static void attachLog(WriteAheadLog& wal, Database& db, BPTree* tree) {
+    // Metrics are independent of the log and attached either way
+    db.attachMetrics(&run_metrics);
+    if (tree != nullptr) tree->attachMetrics(&run_metrics);
+    if (!use_wal) return;
+    db.attachLog(&wal);
+    if (tree != nullptr) tree->attachLog(&wal);
+}
+
+/**
+ * Export Metrics
+ * 
+ * Writes the run's counters, gauges, latency histograms and spans as JSON
+ * and in the Prometheus text format.
+ * 
+ * @param log Stream for the confirmation (stderr in server mode)
+ */
+static void exportMetrics(std::ostream& log = std::cout) {
+    std::ofstream json(METRICS_JSON_PATH);
+    run_metrics.writeJson(json);
+    std::ofstream prom(METRICS_PROM_PATH);
+    run_metrics.writePrometheus(prom);
+    if (json.good() && prom.good()) {
+        log << "✓ Metrics (" << run_metrics.getSpans().size() << " spans) exported to " << METRICS_JSON_PATH
+                  << " and " << METRICS_PROM_PATH << std::endl;
+    }
+}
+
+/**
+ * Report Recovery
+ * 
+ * Prints what open() replayed from the log, if anything (only after a crash).
+ * 
+ * @param wal Log opened by the database
+ */
+static void reportRecovery(const WriteAheadLog& wal) {
+    LogStats stats = wal.getStats();
+    if (stats.recovered_groups == 0) return;
+    std::cout << "Recovered " << stats.recovered_pages << " pages from " << stats.recovered_groups
+              << " committed groups in " << wal.getPath() << std::endl;
+}
 
 /**
  * Timer Class for Performance Measurement
@@ -68,6 +158,182 @@ int g_task2_num_levels = 0;
 int g_task2_root_id = 0;
 std::vector<float> g_task2_root_keys;
 
+// FT_PCT_home index carrying PTS_home and HOME_TEAM_WINS in its leaves
+typedef CoveringColumn<FtPctHomeColumn, PtsWinsInclude> FtPctCoveringColumn;
+
+/**
+ * Register Secondary Indexes
+ * 
+ * Adds the dashboard indexes (game date, home team, team/date and the
+ * covering FT_PCT_home index) and the zone map to a database's catalog, so
+ * every change to the database also updates them.
+ * 
+ * @param db Database to register the indexes with
+ */
+static void registerSecondaryIndexes(Database& db) {
+    addColumnIndex<GameDateColumn>(db.getIndexes(), "output/index_game_date.bin");
+    addColumnIndex<TeamIdHomeColumn>(db.getIndexes(), "output/index_team_id_home.bin");
+    addColumnIndex<TeamDateColumn>(db.getIndexes(), "output/index_team_date.bin");
+    addColumnIndex<FtPctCoveringColumn>(db.getIndexes(), "output/index_ft_pct_covering.bin");
+    db.getIndexes().addIndex(std::unique_ptr<SecondaryIndex>(new ZoneMap("output/zone_map.bin")));
+}
+
+/**
+ * Print Secondary Index Summary
+ * 
+ * One line per registered index with its entry count and shape.
+ * 
+ * @param db Database whose catalog is reported
+ */
+template <typename Column>
+static void printSecondaryIndex(Database& db) {
+    ColumnIndex<Column>* index = static_cast<ColumnIndex<Column>*>(db.getIndexes().find(Column::name()));
+    if (index == nullptr) return;
+    typename ColumnIndex<Column>::Tree& tree = index->getTree();
+    size_t entries = tree.parallelRangeSearch(KeyTraits<typename Column::Key>::lowest(),
+                                              KeyTraits<typename Column::Key>::highest(), index_threads).size();
+    std::cout << "Secondary index " << Column::name() << ": " << entries << " entries, "
+              << tree.getNumNodes() << " nodes, " << tree.getNumLevels() << " levels" << std::endl;
+}
+
+/**
+ * Team Date Range Query
+ * 
+ * Answers "home games of a team between two dates" and the team's home
+ * win rate in that range from the leaves of the composite index alone,
+ * then checks the count against a full scan.
+ * 
+ * @param db Database with the team_date index registered
+ * @param team_id Home team
+ * @param from First date (YYYYMMDD, inclusive)
+ * @param to Last date (YYYYMMDD, inclusive)
+ */
+static void runTeamDateQuery(Database& db, int32_t team_id, int32_t from, int32_t to) {
+    ColumnIndex<TeamDateColumn>* index = static_cast<ColumnIndex<TeamDateColumn>*>(db.getIndexes().find(TeamDateColumn::name()));
+    if (index == nullptr) return;
+    
+    // Index-only: count and wins come from the key of each leaf entry
+    db.resetIOCounters();
+    int wins = 0;
+    int games = index->getTree().scanRange(TeamDateKey::prefixMin(team_id, from), TeamDateKey::prefixMax(team_id, to),
+        [&wins](const TeamDateKey& key, const RecordPointer&) { wins += key.home_win; });
+    int index_data_ios = db.getDataBlockIOsTotal();
+    
+    // Full scan for comparison
+    int scanned_games = 0;
+    int blocks = db.scan([&scanned_games, team_id, from, to](const Record& record, int, int) {
+        int32_t date = record.dateKey();
+        if (record.team_id_home == team_id && date >= from && date <= to) scanned_games++;
+    });
+    
+    std::cout << "Home games of team " << team_id << " from " << from << " to " << to << ": " << games
+              << " (win rate " << std::fixed << std::setprecision(3) << (games > 0 ? static_cast<double>(wins) / games : 0.0)
+              << "), index only, " << index_data_ios << " data blocks read" << std::endl;
+    std::cout << "Full scan: " << scanned_games << " games, " << blocks << " data blocks read" << std::endl;
+}
+
+/**
+ * Planned Range Query
+ * 
+ * Lets the planner pick an index scan or a full scan for a range on
+ * Column, runs the chosen path and prints the estimate next to the I/O
+ * it actually took.
+ * 
+ * @param db Database holding the records
+ * @param tree Index on Column
+ * @param min_key Minimum key (inclusive)
+ * @param max_key Maximum key (inclusive)
+ * @param label Predicate as printed
+ */
+template <typename Column>
+static void runPlannedRange(Database& db, BasicBPTree<typename Column::Key>& tree,
+                            const typename Column::Key& min_key, const typename Column::Key& max_key,
+                            const std::string& label) {
+    PlanEstimate plan = planRange(tree, db.getNumBlocks(), min_key, max_key);
+    std::cout << label << std::endl << "  ";
+    printPlan(std::cout, plan);
+    
+    tree.resetIOCounters();
+    db.resetIOCounters();
+    int matches = 0;
+    int data_blocks = 0;
+    if (plan.path == AccessPath::INDEX_SCAN) {
+        if (db.fetchBatch(tree.rangeSearch(min_key, max_key),
+                          [&matches](const Record&, const RecordPointer&) { matches++; }) < 0) {
+            std::cerr << "Error: Cannot read database file" << std::endl;
+            return;
+        }
+        data_blocks = db.getDataBlocksAccessedUnique();
+    } else {
+        data_blocks = db.scan([&matches, &min_key, &max_key](const Record& record, int, int) {
+            typename Column::Key key = Column::extract(record);
+            if (!(key < min_key) && !(max_key < key)) matches++;
+        });
+    }
+    std::cout << "  Actual: " << matches << " records, " << tree.getIndexNodeIOsTotal() << " index nodes, "
+              << data_blocks << " data blocks read" << std::endl;
+}
+
+/**
+ * Run Queries on the Compressed Archive
+ *
+ * Builds the compressed archive of the heap, scans it with the
+ * FT_PCT_home > 0.9 predicate and fetches the B+ tree's results from it,
+ * comparing the bytes read against the uncompressed heap.
+ *
+ * @param db Open database
+ * @param tree B+ tree on FT_PCT_home (pointers into db)
+ */
+static void runArchiveQueries(Database& db, BPTree& tree) {
+    if (!ArchiveFile::build(db, ARCHIVE_PATH)) {
+        std::cerr << "Error: Cannot write compressed archive" << std::endl;
+        return;
+    }
+    ArchiveFile archive(ARCHIVE_PATH);
+    if (!archive.open()) {
+        std::cerr << "Error: Cannot open compressed archive" << std::endl;
+        return;
+    }
+    std::cout << "Archive: " << archive.getNumBlocks() << " blocks, " << archive.getNumRecords() << " records, "
+              << archive.getFileSize() << " bytes vs " << archive.getUncompressedSize() << " bytes of heap blocks ("
+              << std::fixed << std::setprecision(2)
+              << static_cast<double>(archive.getUncompressedSize()) / std::max(1LL, archive.getFileSize())
+              << "x smaller)" << std::endl;
+    // A stale archive would answer for a different heap
+    if (archive.getNumRecords() != db.getNumRecords()) {
+        std::cerr << "Error: Compressed archive holds " << archive.getNumRecords() << " records, database holds "
+                  << db.getNumRecords() << "; skipping archive queries" << std::endl;
+        return;
+    }
+
+    // Full scan: the predicate runs on the decompressed blocks
+    ScanPredicate over_90 = ScanPredicate().where(RecordField::FT_PCT_HOME, CompareOp::GT, 0.9f);
+    int scan_matches = 0;
+    int scanned = archive.scanBlocks([&over_90, &scan_matches](const Block* blocks, int, int count) {
+        uint32_t selection[Block::BITMAP_WORDS];
+        for (int b = 0; b < count; b++) scan_matches += over_90.filterBlock(blocks[b], selection);
+    });
+    if (scanned < 0) {
+        std::cerr << "Error: Cannot decode compressed archive; skipping archive queries" << std::endl;
+        return;
+    }
+    std::cout << "FT_PCT_home > 0.9 (archive scan): " << scan_matches << " records, "
+              << archive.getBytesRead() << " compressed bytes read" << std::endl;
+
+    // Index scan: heap record pointers resolve in the archive through the block cache
+    archive.resetIOCounters();
+    int fetch_matches = 0;
+    int blocks = archive.fetchBatch(tree.rangeSearch(std::nextafter(0.9f, 2.0f), 1.0f),
+                                    [&fetch_matches](const Record&, const RecordPointer&) { fetch_matches++; });
+    if (blocks < 0) {
+        std::cerr << "Error: Cannot fetch from compressed archive" << std::endl;
+        return;
+    }
+    std::cout << "FT_PCT_home > 0.9 (bptree + archive): " << fetch_matches << " records from " << blocks
+              << " blocks, " << archive.getBlocksDecoded() << " decoded, " << archive.getBytesRead()
+              << " compressed bytes read" << std::endl;
+}
+
 // Forward declaration
 void generateResultsTables(int records_found, float avg_ft_pct, int records_deleted, int brute_force_records, double brute_force_time, int query_index_ios_total, int query_index_nodes_unique, int query_data_ios_total, int query_data_blocks_unique);
 
@@ -81,28 +347,40 @@ void generateResultsTables(int records_found, float avg_ft_pct, int records_dele
  */
 void task1_storage_component() {
     std::cout << "\n=== TASK 1: STORAGE COMPONENT ===" << std::endl;
+    ScopedSpan task_span(&run_metrics, "task1_storage");
     
-    // Step 1: Parse the NBA games data from text file
+    // Step 1: Parse the NBA games data from text file (streamed, constant memory)
     std::cout << "Parsing NBA games data..." << std::endl;
-    std::vector<Record> records = Parser::parseFile("data/games.txt");
-    Parser::printRecordStats(records);
+    RecordStats record_stats;
+    Parser::forEachRecord("data/games.txt", [&record_stats](const Record& record) { record_stats.add(record); });
+    Parser::printRecordStats(record_stats);
     
     // Step 2: Create and open the database file
+    WriteAheadLog wal(WAL_PATH);
     Database db("output/database.bin");
-    if (!db.open()) {
+    attachLog(wal, db, nullptr);
+    if (!db.open(storage_backend)) {
         std::cerr << "Error: Cannot create database file" << std::endl;
         return;
     }
+    reportRecovery(wal);
+    db.setLayout(storage_layout);
     
     // Step 3: Store all records in the database
     std::cout << "Storing records in database..." << std::endl;
     Timer timer;
     timer.start();
     
-    // Add each record to the database
-    for (const Record& record : records) {
-        db.addRecord(record);
+    // Load through the parse -> pack -> write pipeline (sequential multi-block writes)
+    db.resetIOCounters();
+    ScopedSpan ingest_span(&run_metrics, "ingest");
+    IngestPipeline pipeline(db);
+    if (!pipeline.run("data/games.txt")) {
+        std::cerr << "Error: Ingest pipeline failed" << std::endl;
     }
+    ingest_span.set("records", db.getNumRecords());
+    ingest_span.set("block_writes", db.getPhysicalBlockWrites());
+    ingest_span.finish();
     
     double store_time = timer.elapsed();
     
@@ -110,6 +388,9 @@ void task1_storage_component() {
     db.printStatistics();
     std::cout << "Time to store all records: " << std::fixed << std::setprecision(3) 
               << store_time << " seconds" << std::endl;
+    std::cout << "Block writes during load: " << db.getPhysicalBlockWrites()
+              << " (" << db.getSequentialWriteBatches() << " sequential batches)" << std::endl;
+    pipeline.printStats(std::cout);
 }
 
 /**
@@ -122,17 +403,21 @@ void task1_storage_component() {
  */
 void task2_indexing_component() {
     std::cout << "\n=== TASK 2: INDEXING COMPONENT ===" << std::endl;
+    ScopedSpan task_span(&run_metrics, "task2_indexing");
     
     // Step 1: Open the existing database
+    WriteAheadLog wal(WAL_PATH);
     Database db("output/database.bin");
-    if (!db.open()) {
+    BPTree bptree("output/bptree.bin");
+    attachLog(wal, db, &bptree);
+    if (!db.open(storage_backend)) {
         std::cerr << "Error: Cannot open database file" << std::endl;
         return;
     }
+    reportRecovery(wal);
     
     // Step 2: Create and open the B+ tree index file
-    BPTree bptree("output/bptree.bin");
-    if (!bptree.open()) {
+    if (!bptree.open(storage_backend)) {
         std::cerr << "Error: Cannot create B+ tree file" << std::endl;
         return;
     }
@@ -141,30 +426,40 @@ void task2_indexing_component() {
     std::cout << "Building B+ tree index on FT_PCT_home..." << std::endl;
     Timer timer;
     timer.start();
+    ScopedSpan build_span(&run_metrics, "bptree_build");
     
     // Step 3a: Collect all records and their FT_PCT_home values for indexing
     std::vector<std::pair<float, RecordPointer>> index_data;
     
-    // Iterate through all blocks in the database
-    for (int block_id = 0; block_id < db.getNumBlocks(); block_id++) {
-        Block block;
-        if (db.readBlock(block_id, block)) {
-            // Iterate through all records in the current block
-            for (int record_index = 0; record_index < block.getNumRecords(); record_index++) {
-                Record record = block.getRecord(record_index);
-                RecordPointer ptr(block_id, record_index);
-                // Store key-value pair for B+ tree construction
-                index_data.push_back(std::make_pair(record.ft_pct_home, ptr));
-            }
-        }
+    // Scan block ranges in parallel; each partition collects its own entries
+    std::vector<std::vector<std::pair<float, RecordPointer>>> partitions(resolveThreads(index_threads));
+    int scanned = db.parallelScan(static_cast<int>(partitions.size()),
+        [&partitions](const Record& record, int block_id, int record_index, int partition) {
+            // Store key-value pair for B+ tree construction
+            partitions[partition].push_back(std::make_pair(record.ft_pct_home, RecordPointer(block_id, record_index)));
+        });
+    if (scanned < 0) {
+        std::cerr << "Error: Cannot read database file; B+ tree not built" << std::endl;
+        return;
+    }
+    
+    // Concatenate the partitions in block order
+    index_data.reserve(db.getNumRecords());
+    for (size_t i = 0; i < partitions.size(); i++) {
+        index_data.insert(index_data.end(), partitions[i].begin(), partitions[i].end());
+        std::vector<std::pair<float, RecordPointer>>().swap(partitions[i]);
     }
     
     std::cout << "Collected " << index_data.size() << " index entries for B+ tree construction" << std::endl;
     
-    // Step 3b: Bulk load the B+ tree with collected data
-    bptree.bulkLoad(index_data);
+    // Step 3b: Radix sort the entries in place and bulk load the B+ tree in one pass
+    BPTree::sortEntries(index_data, index_threads);
+    bptree.bulkLoadSorted(index_data, 1.0, index_threads);
     
     double index_time = timer.elapsed();
+    build_span.set("entries", static_cast<double>(index_data.size()));
+    build_span.set("nodes", bptree.getNumNodes());
+    build_span.finish();
     
     // Step 4: Print comprehensive B+ tree statistics
     bptree.printStatistics();
@@ -177,6 +472,56 @@ void task2_indexing_component() {
     g_task2_root_id = bptree.getRootId();
     g_task2_root_keys = bptree.getRootNodeKeys();
     
+    // Step 5: Build the secondary indexes from one more parallel scan
+    std::cout << "Building secondary indexes on game_date, team_id_home and (team_id_home, game_date)..." << std::endl;
+    registerSecondaryIndexes(db);
+    ScopedSpan secondary_span(&run_metrics, "secondary_index_build");
+    if (!db.buildIndexes(index_threads)) {
+        std::cerr << "Error: Cannot build secondary indexes" << std::endl;
+        return;
+    }
+    secondary_span.set("indexes", static_cast<double>(db.getIndexes().size()));
+    secondary_span.finish();
+    printSecondaryIndex<GameDateColumn>(db);
+    printSecondaryIndex<TeamIdHomeColumn>(db);
+    printSecondaryIndex<TeamDateColumn>(db);
+    printSecondaryIndex<FtPctCoveringColumn>(db);
+    const ZoneMap* zones = static_cast<const ZoneMap*>(db.getIndexes().find(ZoneMap::defaultName()));
+    if (zones != nullptr) {
+        std::cout << "Zone map: " << zones->getNumZones() << " block zones over " << zones->getNumRecords()
+                  << " records" << std::endl;
+    }
+    runTeamDateQuery(db, 1610612740, 20220101, 20221231);
+    
+    // Step 6: Let the planner choose between the index and a full scan
+    std::cout << "\n=== PLANNED QUERIES ===" << std::endl;
+    runPlannedRange<FtPctHomeColumn>(db, bptree, std::nextafter(0.9f, 2.0f), 1.0f, "FT_PCT_home > 0.9 (bptree)");
+    ColumnIndex<GameDateColumn>* date_index =
+        static_cast<ColumnIndex<GameDateColumn>*>(db.getIndexes().find(GameDateColumn::name()));
+    if (date_index != nullptr) {
+        runPlannedRange<GameDateColumn>(db, date_index->getTree(), 20220101, 20220131,
+                                        "game_date in January 2022 (index_game_date)");
+    }
+    
+    // The same range by scanning: the zone map skips blocks outside January
+    long long january_games = 0;
+    int january_blocks = vectorScan(db, ScanPredicate().where(RecordField::GAME_DATE, CompareOp::GE, 20220101)
+                                                       .where(RecordField::GAME_DATE, CompareOp::LE, 20220131),
+                                    [&january_games](const Record&, int, int) { january_games++; });
+    std::cout << "game_date in January 2022 (zone map scan): " << january_games << " records, "
+              << january_blocks << " of " << db.getNumBlocks() << " blocks read" << std::endl;
+
+    // Step 7: Aggregate one column of the matches without materializing records
+    ColumnAggregate points;
+    aggregateScan(db, ScanPredicate().where(RecordField::FT_PCT_HOME, CompareOp::GT, 0.9f), RecordField::PTS_HOME, points);
+    std::cout << "AVG(PTS_home) WHERE FT_PCT_home > 0.9 (column scan): " << std::fixed << std::setprecision(2)
+              << points.average() << " over " << points.count << " records (min " << points.min << ", max "
+              << points.max << ")" << std::endl;
+    
+    // Step 8: Query a compressed copy of the heap
+    std::cout << "\n=== COMPRESSED ARCHIVE ===" << std::endl;
+    runArchiveQueries(db, bptree);
+
     // Close the B+ tree to ensure metadata is written
     bptree.close();
 }
@@ -191,15 +536,21 @@ void task2_indexing_component() {
  */
 void task3_delete_operations() {
     std::cout << "\n=== TASK 3: DELETE OPERATIONS ===" << std::endl;
+    ScopedSpan task_span(&run_metrics, "task3_delete");
     
     // Step 1: Open both database and B+ tree files
+    WriteAheadLog wal(WAL_PATH);
     Database db("output/database.bin");
     BPTree bptree("output/bptree.bin");
+    attachLog(wal, db, &bptree);
     
-    if (!db.open() || !bptree.open()) {
+    if (!db.open(storage_backend) || !bptree.open(storage_backend)) {
         std::cerr << "Error: Cannot open database or B+ tree files" << std::endl;
         return;
     }
+    reportRecovery(wal);
+    // Deletions and compaction below keep the secondary indexes in sync
+    registerSecondaryIndexes(db);
     
     // Step 2: Capture original B+ tree statistics before any operations
     std::cout << "Capturing original B+ tree statistics..." << std::endl;
@@ -208,17 +559,25 @@ void task3_delete_operations() {
     // Step 3: Find records with FT_PCT_home > 0.9 using B+ tree
     std::cout << "Finding records with FT_PCT_home > 0.9 using B+ tree..." << std::endl;
     
+    // Planner estimate for the same range, reported with the measured I/O below
+    PlanEstimate query_plan = planRange(bptree, db.getNumBlocks(), std::nextafter(0.9f, 2.0f), 1.0f);
+    
     // Reset I/O counters before starting
     bptree.resetIOCounters();
     db.resetIOCounters();
     
     Timer bptree_timer;
     bptree_timer.start();
+    ScopedSpan search_span(&run_metrics, "bptree_range_search");
     
     // Use range search to find records with FT_PCT_home between 0.9 and 1.0
     std::vector<RecordPointer> bptree_results = bptree.rangeSearch(0.9f, 1.0f);
     
     double bptree_time = bptree_timer.elapsed();
+    search_span.set("entries", static_cast<double>(bptree_results.size()));
+    search_span.set("index_node_ios", bptree.getIndexNodeIOsTotal());
+    search_span.set("index_nodes_unique", bptree.getIndexNodesAccessedUnique());
+    search_span.finish();
 
     // Now, read the records and compute stats, and measure data block I/Os
     db.resetIOCounters(); // <-- Reset here to measure only the following reads
@@ -226,88 +585,131 @@ void task3_delete_operations() {
     // Step 4: Calculate statistics for B+ tree results BEFORE deletion
     float sum_ft = 0.0f;
     std::vector<Record> deleted_records;
-    std::map<int, std::vector<int>> block_to_indices;
-    std::set<std::pair<int, int>> unique_ptrs; // To avoid duplicate deletions
+    std::vector<RecordPointer> unique_ptrs; // Each matching record once, in block order
+    ScopedSpan fetch_span(&run_metrics, "fetch_batch");
 
-    for (const RecordPointer& ptr : bptree_results) {
-        // Only add unique pointers
-        if (unique_ptrs.insert({ptr.block_id, ptr.record_index}).second) {
-            block_to_indices[ptr.block_id].push_back(ptr.record_index);
-        }
-    }
-    for (const auto& entry : block_to_indices) {
-        int block_id = entry.first;
-        const std::vector<int>& indices = entry.second;
-        Block block;
-        if (db.readBlock(block_id, block)) {
-            for (int record_index : indices) {
-                Record record = block.getRecord(record_index);
-                if (record.ft_pct_home > 0.9f) {
-                    sum_ft += record.ft_pct_home;
-                    deleted_records.push_back(record);
-                }
-            }
+    // One sequential read per run of adjacent blocks, each block read once
+    int fetched = db.fetchBatch(bptree_results, [&sum_ft, &deleted_records, &unique_ptrs](const Record& record, const RecordPointer& ptr) {
+        unique_ptrs.push_back(ptr);
+        if (record.ft_pct_home > 0.9f) {
+            sum_ft += record.ft_pct_home;
+            deleted_records.push_back(record);
         }
+    }, true);
+    if (fetched < 0) {
+        // A partial result must not be reported or deleted
+        std::cerr << "Error: Cannot read the matching records from the database file" << std::endl;
+        return;
     }
     float avg_ft_bptree = deleted_records.empty() ? 0.0f : sum_ft / deleted_records.size();
+    fetch_span.set("records", static_cast<double>(deleted_records.size()));
+    fetch_span.set("data_block_ios", db.getDataBlockIOsTotal());
+    fetch_span.set("data_blocks_unique", db.getDataBlocksAccessedUnique());
+    fetch_span.set("physical_reads", db.getPhysicalBlockReads());
+    fetch_span.finish();
 
     // Store the I/O counts for the query (after reading records)
     int query_index_ios_total = bptree.getIndexNodeIOsTotal();
     int query_index_nodes_unique = bptree.getIndexNodesAccessedUnique();
+    int query_index_physical_reads = bptree.getIndexNodePhysicalReads();
     int query_data_ios_total = db.getDataBlockIOsTotal();
     int query_data_blocks_unique = db.getDataBlocksAccessedUnique();
+    int query_buffer_hits = db.getBufferHits();
+    int query_buffer_misses = db.getBufferMisses();
+    int query_physical_reads = db.getPhysicalBlockReads();
+    int query_reads_in_flight = db.getPeakReadsInFlight();
 
     std::cout << "Found " << deleted_records.size() << " records with FT_PCT_home > 0.9" << std::endl;
     
+    // Step 4b: The same aggregates (plus points and win rate) from the covering index alone
+    ColumnIndex<FtPctCoveringColumn>* covering =
+        static_cast<ColumnIndex<FtPctCoveringColumn>*>(db.getIndexes().find(FtPctCoveringColumn::name()));
+    if (covering != nullptr) {
+        db.resetIOCounters();
+        ScopedSpan covering_span(&run_metrics, "covering_index_scan");
+        double covered_ft = 0.0;
+        long long covered_pts = 0;
+        int covered_wins = 0;
+        int covered_count = covering->getTree().scanRange(
+            FtPctCoveringColumn::Key(std::nextafter(0.9f, 2.0f)), FtPctCoveringColumn::Key(1.0f),
+            [&covered_ft, &covered_pts, &covered_wins](const FtPctCoveringColumn::Key& key, const RecordPointer&) {
+                covered_ft += key.key;
+                covered_pts += key.include.pts_home;
+                covered_wins += key.include.home_team_wins;
+            });
+        covering_span.set("entries", covered_count);
+        covering_span.set("data_block_ios", db.getDataBlockIOsTotal());
+        covering_span.finish();
+        double n = covered_count > 0 ? covered_count : 1;
+        std::cout << "Index-only aggregates (covering index): " << covered_count << " games, average FT_PCT_home "
+                  << std::fixed << std::setprecision(4) << covered_ft / n << ", average PTS_home "
+                  << std::setprecision(1) << covered_pts / n << ", home win rate "
+                  << std::setprecision(3) << covered_wins / n << ", data blocks read: "
+                  << db.getDataBlockIOsTotal() << std::endl;
+    }
+    
     // Step 5: Perform brute force linear scan for comparison BEFORE deletion
     std::cout << "Performing brute force linear scan for comparison..." << std::endl;
     
+    db.resetIOCounters();
     Timer brute_timer;
     brute_timer.start();
     
-    std::vector<Record> brute_force_results;
+    int brute_force_count = 0;
     int blocks_accessed = 0;
+    float sum_ft_brute = 0.0f;
     
     // Reset I/O counters for brute force
     db.resetIOCounters();
+    ScopedSpan scan_span(&run_metrics, "brute_force_scan");
     
-    // Scan all blocks sequentially (brute force approach)
-    for (int block_id = 0; block_id < db.getNumBlocks(); block_id++) {
-        Block block;
-        if (db.readBlock(block_id, block)) {
-            blocks_accessed++;
-            // Check each record in the block
-            for (int record_index = 0; record_index < block.getNumRecords(); record_index++) {
-                Record record = block.getRecord(record_index);
-                if (record.ft_pct_home > 0.9f) {
-                    brute_force_results.push_back(record);
-                }
-            }
+    // Scan all blocks (brute force approach) on a work-stealing pool: the
+    // predicate is evaluated on the block bytes and only matching records
+    // are copied out. Matches are kept per block and summed in block order,
+    // so the average does not depend on how the blocks were shared out
+    ScanPredicate over_90 = ScanPredicate().where(RecordField::FT_PCT_HOME, CompareOp::GT, 0.9f);
+    std::vector<std::vector<float> > matches_by_block(db.getNumBlocks());
+    blocks_accessed = parallelVectorScan(db, over_90, [&matches_by_block](const Record& record, int block_id, int, int) {
+        matches_by_block[block_id].push_back(record.ft_pct_home);
+    }, index_threads);
+    for (size_t b = 0; b < matches_by_block.size(); b++) {
+        for (size_t i = 0; i < matches_by_block[b].size(); i++) {
+            brute_force_count++;
+            sum_ft_brute += matches_by_block[b][i];
         }
     }
     
     double brute_time = brute_timer.elapsed();
+    // Counters of the scan alone; the deletes below pin blocks through the pool
+    int brute_data_ios_total = db.getDataBlockIOsTotal();
+    int brute_buffer_hits = db.getBufferHits();
+    int brute_buffer_misses = db.getBufferMisses();
+    scan_span.set("records", brute_force_count);
+    scan_span.set("blocks_read", blocks_accessed);
+    scan_span.set("blocks_skipped", db.getNumBlocks() - blocks_accessed);
+    scan_span.finish();
     
     // Step 6: Calculate statistics for brute force results
-    float sum_ft_brute = 0.0f;
-    for (const Record& record : brute_force_results) {
-        sum_ft_brute += record.ft_pct_home;
-    }
-    float avg_ft_brute = brute_force_results.empty() ? 0.0f : sum_ft_brute / brute_force_results.size();
+    float avg_ft_brute = brute_force_count == 0 ? 0.0f : sum_ft_brute / brute_force_count;
     
     // Step 7: Now delete the records from both B+ tree and database
     std::cout << "Deleting games with FT_PCT_home > 0.9 from B+ tree and database..." << std::endl;
     
     // Delete records from database first (only the unique ones we found)
+    LogStats log_before = wal.getStats();
+    ScopedSpan delete_span(&run_metrics, "delete");
     int db_deleted_count = 0;
-    for (const auto& ptr_pair : unique_ptrs) {
-        if (db.deleteRecord(ptr_pair.first, ptr_pair.second)) {
+    for (const RecordPointer& ptr : unique_ptrs) {
+        if (db.deleteRecord(ptr.block_id, ptr.record_index)) {
             db_deleted_count++;
         }
     }
 
     // Delete records from B+ tree (use actual database deletion count)
     int deleted_count = bptree.removeRange(0.9f, 1.0f);
+    delete_span.set("records", db_deleted_count);
+    delete_span.finish();
+    run_metrics.counter("records_deleted").add(db_deleted_count);
     // Override with actual database deletion count to avoid overcounting
     deleted_count = db_deleted_count;
     
@@ -318,6 +720,12 @@ void task3_delete_operations() {
     
     std::cout << "Deleted " << deleted_count << " games from B+ tree" << std::endl;
     std::cout << "Deleted " << db_deleted_count << " games from database" << std::endl;
+    if (wal.isOpen()) {
+        // Each delete is one transaction; group commit shares the log syncs between them
+        LogStats log_after = wal.getStats();
+        std::cout << "Write-ahead log: " << log_after.transactions - log_before.transactions << " transactions in "
+                  << log_after.group_commits - log_before.group_commits << " group commits" << std::endl;
+    }
     
     // Step 8: Print comprehensive performance comparison
     std::cout << "\n=== PERFORMANCE COMPARISON ===" << std::endl;
@@ -330,16 +738,24 @@ void task3_delete_operations() {
     std::cout << "  - Execution time: " << std::fixed << std::setprecision(6) << bptree_time << " seconds" << std::endl;
     std::cout << "  - Index nodes accessed (total I/Os): " << query_index_ios_total << std::endl;
     std::cout << "  - Index nodes accessed (unique): " << query_index_nodes_unique << std::endl;
+    std::cout << "  - Index node physical reads: " << query_index_physical_reads << std::endl;
     std::cout << "  - Data blocks accessed (total I/Os): " << query_data_ios_total << std::endl;
     std::cout << "  - Data blocks accessed (unique): " << query_data_blocks_unique << std::endl;
+    std::cout << "  - Buffer pool hits / misses: " << query_buffer_hits << " / " << query_buffer_misses << std::endl;
+    std::cout << "  - Data block physical reads (batched fetch): " << query_physical_reads;
+    if (query_reads_in_flight > 1) std::cout << " (up to " << query_reads_in_flight << " reads in flight)";
+    std::cout << std::endl;
+    std::cout << "  - Planner would choose: " << accessPathName(query_plan.path) << " (estimated cost "
+              << std::setprecision(1) << query_plan.index_cost << " index vs " << query_plan.scan_cost << " full scan)" << std::endl;
     
     // Brute force method results
     std::cout << "\nBrute Force Method:" << std::endl;
-    std::cout << "  - Games found: " << brute_force_results.size() << std::endl;
+    std::cout << "  - Games found: " << brute_force_count << std::endl;
     std::cout << "  - Average FT_PCT_home: " << std::fixed << std::setprecision(4) << avg_ft_brute << std::endl;
     std::cout << "  - Execution time: " << std::fixed << std::setprecision(6) << brute_time << " seconds" << std::endl;
     std::cout << "  - Data blocks accessed: " << blocks_accessed << std::endl;
-    std::cout << "  - Data block I/Os (total): " << db.getDataBlockIOsTotal() << std::endl;
+    std::cout << "  - Data block I/Os (total): " << brute_data_ios_total << std::endl;
+    std::cout << "  - Buffer pool hits / misses: " << brute_buffer_hits << " / " << brute_buffer_misses << std::endl;
     
     // Performance improvement analysis
     double speedup = (bptree_time > 0.0) ? (brute_time / bptree_time) : 0.0;
@@ -352,17 +768,39 @@ void task3_delete_operations() {
     std::cout << "  - Block access reduction: " << std::fixed << std::setprecision(1)
               << block_access_reduction << "%" << std::endl;
     
-    // Step 9: Report updated B+ tree statistics after deletion
+    // Step 9: Compact the database and fix up the index in one batch
+    std::cout << "\n=== COMPACTION ===" << std::endl;
+    int blocks_before_compaction = db.getNumBlocks();
+    std::vector<RecordMove> moves;
+    ScopedSpan compact_span(&run_metrics, "compact");
+    int blocks_freed = db.compact(moves);
+    int entries_relocated = bptree.relocatePointers(moves);
+    compact_span.set("moves", static_cast<double>(moves.size()));
+    compact_span.set("blocks_freed", blocks_freed);
+    compact_span.finish();
+    std::cout << "Moved " << moves.size() << " records, blocks: " << blocks_before_compaction
+              << " -> " << db.getNumBlocks() << " (" << blocks_freed << " freed)" << std::endl;
+    std::cout << "Updated " << entries_relocated << " B+ tree record pointers" << std::endl;
+    printSecondaryIndex<GameDateColumn>(db);
+    printSecondaryIndex<TeamIdHomeColumn>(db);
+    printSecondaryIndex<TeamDateColumn>(db);
+    printSecondaryIndex<FtPctCoveringColumn>(db);
+    
+    // Step 10: Report updated B+ tree statistics after deletion
     std::cout << "\n=== UPDATED B+ TREE STATISTICS AFTER DELETION ===" << std::endl;
     bptree.printStatistics();
+    run_metrics.setGauge("database_blocks", db.getNumBlocks());
+    run_metrics.setGauge("database_records", db.getNumRecords());
+    run_metrics.setGauge("bptree_nodes", bptree.getNumNodes());
+    run_metrics.setGauge("bptree_levels", bptree.getNumLevels());
     // *** FLUSH CHANGES TO DISK so re-opened handles see them ***
     bptree.close();
     db.close();
 
-    // Step 10: Now write the files (this re-opens fresh handles inside)
+    // Step 11: Now write the files (this re-opens fresh handles inside)
     generateResultsTables(
       deleted_records.size(), avg_ft_bptree, deleted_count,
-      brute_force_results.size(), brute_time,
+      brute_force_count, brute_time,
       query_index_ios_total, query_index_nodes_unique, query_data_ios_total, query_data_blocks_unique
     );
 }
@@ -381,10 +819,12 @@ void generateResultsTables(int records_found, float avg_ft_pct, int records_dele
     std::cout << "\n=== GENERATING RESULTS TABLES ===" << std::endl;
     
     // Open database and B+ tree to get final statistics
+    WriteAheadLog wal(WAL_PATH);
     Database db("output/database.bin");
     BPTree bptree("output/bptree.bin");
+    attachLog(wal, db, &bptree);
     
-    if (!db.open() || !bptree.open()) {
+    if (!db.open(storage_backend) || !bptree.open(storage_backend)) {
         std::cerr << "Error: Cannot open files for results generation" << std::endl;
         return;
     }
@@ -448,7 +888,7 @@ void generateResultsTables(int records_found, float avg_ft_pct, int records_dele
         // Note: Average calculation removed as it's not used in this context
         
         // Calculate unique blocks accessed for B+ tree method
-        std::set<int> unique_blocks_accessed;
+        PageSet unique_blocks_accessed;
         for (const RecordPointer& ptr : results) {
             unique_blocks_accessed.insert(ptr.block_id);
         }
@@ -526,7 +966,7 @@ void generateResultsTables(int records_found, float avg_ft_pct, int records_dele
         summary_file << "- B+ tree order: " << bptree.getOrder() << std::endl;
         summary_file << "- Tree height: " << bptree.getNumLevels() << " levels" << std::endl;
         summary_file << "- Total nodes: " << bptree.getNumNodes() << std::endl;
-        summary_file << "- Index file size: " << (bptree.getNumNodes() * sizeof(BPTreeNode) + 8) << " bytes" << std::endl;
+        summary_file << "- Index file size: " << ((bptree.getNumNodes() + 1) * sizeof(BPTreeNode)) << " bytes" << std::endl;
         
         // Get and display root node keys
         std::vector<float> root_keys = bptree.getRootNodeKeys();
@@ -540,14 +980,15 @@ void generateResultsTables(int records_found, float avg_ft_pct, int records_dele
         
         summary_file << "QUERY PERFORMANCE:" << std::endl;
         summary_file << "- Query: FT_PCT_home > 0.9" << std::endl;
-        bptree.resetIOCounters();
-        db.resetIOCounters();
-        std::vector<RecordPointer> query_results = bptree.rangeSearch(0.9f, 1.0f);
-        summary_file << "- Games matching query: " << query_results.size() << std::endl;
-        summary_file << "- Index node I/Os (total): " << bptree.getIndexNodeIOsTotal() << std::endl;
-        summary_file << "- Index nodes accessed (unique): " << bptree.getIndexNodesAccessedUnique() << std::endl;
-        summary_file << "- Data block I/Os (total): " << db.getDataBlockIOsTotal() << std::endl;
-        summary_file << "- Data blocks accessed (unique): " << db.getDataBlocksAccessedUnique() << std::endl;
+        // Measured by Task 3 before the matching games were deleted
+        summary_file << "- Games matching query: " << records_found << std::endl;
+        summary_file << "- Average FT_PCT_home: " << std::fixed << std::setprecision(4) << avg_ft_pct << std::endl;
+        summary_file << "- Index node I/Os (total): " << query_index_ios_total << std::endl;
+        summary_file << "- Index nodes accessed (unique): " << query_index_nodes_unique << std::endl;
+        summary_file << "- Data block I/Os (total): " << query_data_ios_total << std::endl;
+        summary_file << "- Data blocks accessed (unique): " << query_data_blocks_unique << std::endl;
+        summary_file << "- Games deleted: " << records_deleted << std::endl;
+        summary_file << "- Games matching after deletion: " << bptree.countRange(std::nextafter(0.9f, 2.0f), 1.0f) << std::endl;
         summary_file << std::endl;
         
         summary_file << "FILES GENERATED:" << std::endl;
@@ -568,7 +1009,91 @@ void generateResultsTables(int records_found, float avg_ft_pct, int records_dele
  * This function orchestrates the execution of all three tasks
  * and provides error handling for the entire program.
  */
-int main() {
+/**
+ * Run Query Server
+ * 
+ * Opens the files written by the tasks once, with a buffer pool and leaf
+ * cache large enough to hold them, warms both and answers requests until
+ * end of input (stdin) or a shutdown request (TCP). Responses go to
+ * stdout; everything else goes to stderr.
+ * 
+ * @param port TCP port, or 0 to serve stdin
+ * @return Exit status
+ */
+static int runServer(int port) {
+    // Step 1: Open everything once
+    WriteAheadLog wal(WAL_PATH);
+    Database db("output/database.bin", SERVER_POOL_FRAMES);
+    BPTree bptree("output/bptree.bin", SERVER_LEAF_CACHE_SIZE);
+    attachLog(wal, db, &bptree);
+    if (!db.open(storage_backend) || !bptree.open(storage_backend)) {
+        std::cerr << "Error: Cannot open database or B+ tree files" << std::endl;
+        return 1;
+    }
+    registerSecondaryIndexes(db);
+    LogStats recovery = wal.getStats();
+    if (recovery.recovered_groups > 0) {
+        std::cerr << "Recovered " << recovery.recovered_pages << " pages from " << recovery.recovered_groups
+                  << " committed groups in " << wal.getPath() << std::endl;
+    }
+    if (db.getNumRecords() == 0 || bptree.empty()) {
+        std::cerr << "Error: No data to serve; run ./database_system first" << std::endl;
+        return 1;
+    }
+
+    // Step 2: Warm the buffer pool and the leaf cache
+    ServerOptions options;
+    options.num_threads = index_threads;
+    QueryServer server(db, bptree, options);
+    server.attachMetrics(&run_metrics);
+    Timer timer;
+    timer.start();
+    int warmed = server.warm();
+    std::cerr << "Serving " << db.getNumRecords() << " records (" << warmed << " blocks warmed in "
+              << std::fixed << std::setprecision(4) << timer.elapsed() << "s) on "
+              << (port > 0 ? "127.0.0.1:" + std::to_string(port) : std::string("stdin")) << std::endl;
+
+    // Step 3: Serve until the client is done
+    bool ok = true;
+    timer.start();
+    if (port > 0) {
+        ok = server.serveSocket(port);
+        if (!ok) std::cerr << "Error: Cannot listen on port " << port << std::endl;
+    } else {
+        server.serveStream(std::cin, std::cout);
+    }
+    std::cerr << "Served " << server.getRequestsServed() << " requests in " << server.getBatchesServed()
+              << " batches (" << timer.elapsed() << "s)" << std::endl;
+
+    // Step 4: Close cleanly so the log is checkpointed
+    bptree.close();
+    db.close();
+    exportMetrics(std::cerr);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    // Optional backend selection, write-ahead log switch, index build thread count and server mode
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--mmap") storage_backend = StorageBackend::MMAP;
+        if (std::string(argv[i]) == "--no-wal") use_wal = false;
+        if (std::string(argv[i]) == "--pax") storage_layout = BlockLayout::PAX;
+        if (std::string(argv[i]) == "--threads" && i + 1 < argc) index_threads = atoi(argv[++i]);
+        if (std::string(argv[i]) == "--serve") serve_mode = true;
+        if (std::string(argv[i]) == "--port" && i + 1 < argc) serve_port = atoi(argv[++i]);
+    }
+    
+    // Server mode answers requests against the files of a previous run
+    if (serve_mode) {
+        std::ios::sync_with_stdio(false);
+        try {
+            return runServer(serve_port);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
     // Program header
     std::cout << "SC3020 Database Management System Project" << std::endl;
     std::cout << "================================================" << std::endl;
@@ -578,12 +1103,19 @@ int main() {
         task1_storage_component();    // Task 1: Storage implementation
         task2_indexing_component();   // Task 2: Indexing implementation
         task3_delete_operations();    // Task 3: Query processing and analysis
+        exportMetrics();
         
         // Success message and output file information
         std::cout << "\n=== PROJECT COMPLETED SUCCESSFULLY ===" << std::endl;
         std::cout << "Check the output/ directory for generated files:" << std::endl;
         std::cout << "- database.bin: Binary database file" << std::endl;
         std::cout << "- bptree.bin: B+ tree index file" << std::endl;
+        std::cout << "- archive.bin: Compressed copy of the database (before deletion)" << std::endl;
+        std::cout << "- zone_map.bin: Per-block min/max of every column" << std::endl;
+        std::cout << "- metrics.json / metrics.prom: Spans, counters and I/O latency histograms" << std::endl;
+        if (use_wal && storage_backend == StorageBackend::STREAM) {
+            std::cout << "- database.wal: Write-ahead log (empty after a clean shutdown)" << std::endl;
+        }
         
     } catch (const std::exception& e) {
         // Error handling for any exceptions
@@ -0,0 +1,143 @@
+/**
+ * SC3020 Database Management System
+ * Access Path Planner Header
+ *
+ * This file defines the cost-based choice between answering a key range
+ * predicate with an index scan (tree descent, leaf walk and record fetch)
+ * or with a full sequential scan of the heap file.
+ *
+ * The estimate uses the statistics a B+ tree keeps from its last bulk
+ * load (see index_stats.h):
+ * - Matching entries come from the equi-depth histogram
+ * - Data blocks the fetch touches are bounded by the clustering factor
+ *   scaled to the selectivity and by Cardenas' formula
+ *   B * (1 - (1 - 1/B)^E) for E entries spread over B blocks
+ * - Fetched blocks cost between a random and a sequential read, depending
+ *   on how much of the file is touched (Database::fetchBatch reads runs
+ *   of adjacent blocks with one request)
+ *
+ * Costs are in units of one sequential block read.
+ */
+
+#ifndef PLANNER_H
+#define PLANNER_H
+
+// Include tree and statistics
+#include "../indexing/bptree.h"
+#include "../indexing/index_stats.h"
+
+// Standard C++ libraries
+#include <ostream>   // For printing plans
+
+/**
+ * Access Path Enumeration
+ */
+enum class AccessPath {
+    INDEX_SCAN,   // Range search on the index, then fetch the records
+    FULL_SCAN     // Read every block of the heap file and filter
+};
+
+/**
+ * Cost Model Structure
+ *
+ * Relative cost of one page access of each kind.
+ */
+struct CostModel {
+    double seq_block_cost;      // Data block read as part of a sequential pass
+    double random_block_cost;   // Data block read on its own
+    double index_node_cost;     // Index node read (upper levels are usually cached)
+
+    CostModel() : seq_block_cost(1.0), random_block_cost(4.0), index_node_cost(1.0) {}
+};
+
+/**
+ * Index Shape Structure
+ *
+ * What the planner needs to know about an index for one range.
+ */
+struct IndexShape {
+    double matching_entries;    // Estimated entries in the range
+    double total_entries;       // Entries at statistics time
+    double clustering_factor;   // Block changes walking the entries in key order
+    int num_levels;             // Tree height
+    int num_nodes;              // Nodes in use
+};
+
+/**
+ * Plan Estimate Structure
+ */
+struct PlanEstimate {
+    AccessPath path;            // Cheaper access path
+    bool has_statistics;        // false: no histogram, full scan chosen by default
+    double est_entries;         // Estimated matching entries
+    double est_index_nodes;     // Estimated index nodes read by the index scan
+    double est_data_blocks;     // Estimated data blocks fetched by the index scan
+    double index_cost;          // Estimated cost of the index scan
+    double scan_cost;           // Estimated cost of the full scan
+
+    PlanEstimate()
+        : path(AccessPath::FULL_SCAN), has_statistics(false), est_entries(0.0), est_index_nodes(0.0),
+          est_data_blocks(0.0), index_cost(0.0), scan_cost(0.0) {}
+};
+
+/**
+ * Choose Access Path
+ *
+ * @param shape Index estimates for the range
+ * @param heap_blocks Current number of blocks in the heap file
+ * @param model Page access costs
+ * @return Both cost estimates and the cheaper path (ties go to the full scan)
+ */
+PlanEstimate chooseAccessPath(const IndexShape& shape, int heap_blocks, const CostModel& model = CostModel());
+
+/**
+ * Plan Range Predicate
+ *
+ * Estimates min_key <= key <= max_key on a tree from its statistics.
+ * Without statistics the full scan is chosen.
+ *
+ * @param tree Index on the predicate's column
+ * @param heap_blocks Current number of blocks in the heap file
+ * @param min_key Minimum key (inclusive)
+ * @param max_key Maximum key (inclusive)
+ * @param model Page access costs
+ * @return Plan estimate
+ */
+template <typename Key>
+PlanEstimate planRange(const BasicBPTree<Key>& tree, int heap_blocks,
+                       const Key& min_key, const Key& max_key, const CostModel& model = CostModel()) {
+    const typename BasicBPTree<Key>::Stats& stats = tree.getStats();
+    if (!stats.valid()) {
+        PlanEstimate plan;
+        plan.scan_cost = heap_blocks * model.seq_block_cost;
+        return plan;
+    }
+
+    IndexShape shape;
+    shape.matching_entries = stats.estimateEntries(min_key, max_key);
+    shape.total_entries = static_cast<double>(stats.num_entries);
+    shape.clustering_factor = stats.clustering_factor;
+    shape.num_levels = tree.getNumLevels();
+    shape.num_nodes = tree.getNumNodes();
+    return chooseAccessPath(shape, heap_blocks, model);
+}
+
+/**
+ * Access Path Name
+ *
+ * @param path Access path
+ * @return "INDEX SCAN" or "FULL SCAN"
+ */
+const char* accessPathName(AccessPath path);
+
+/**
+ * Print Plan
+ *
+ * One line: chosen path, estimated entries and both costs.
+ *
+ * @param out Output stream
+ * @param plan Plan estimate
+ */
+void printPlan(std::ostream& out, const PlanEstimate& plan);
+
+#endif // PLANNER_H
@@ -0,0 +1,483 @@
+/**
+ * SC3020 Database Management System
+ * Query Server Implementation
+ *
+ * This file contains the implementation of QueryServer: request parsing,
+ * batch execution and the stdin and TCP front ends.
+ *
+ */
+
+#include "query_server.h"
+#include "planner.h"
+#include "../indexing/index_key.h"
+
+#include <algorithm>      // For sorting pointers
+#include <cerrno>         // For EINTR
+#include <cstdlib>        // For strtof
+#include <cstring>        // For memset
+#include <iomanip>        // For response precision
+#include <iostream>       // For server messages
+#include <sstream>        // For parsing and responses
+#include <thread>         // For connection threads
+#include <arpa/inet.h>    // For inet_pton
+#include <netinet/in.h>   // For sockaddr_in
+#include <poll.h>         // For the accept loop
+#include <sys/socket.h>   // For sockets
+#include <unistd.h>       // For close
+
+namespace {
+
+const size_t SOCKET_READ_SIZE = 64 * 1024;   // Bytes per recv
+const int ACCEPT_POLL_MS = 100;              // Interval at which the accept loop checks for shutdown
+
+const char* const REQUEST_NAMES[QueryServer::NUM_REQUEST_TYPES] = {
+    "point", "range", "aggregate", "delete_range", "stats", "ping", "quit", "shutdown", "invalid"
+};
+
+struct ColumnName {
+    const char* name;
+    RecordField field;
+};
+
+const ColumnName COLUMN_NAMES[] = {
+    {"game_date", RecordField::GAME_DATE}, {"team_id_home", RecordField::TEAM_ID_HOME},
+    {"pts_home", RecordField::PTS_HOME}, {"fg_pct_home", RecordField::FG_PCT_HOME},
+    {"ft_pct_home", RecordField::FT_PCT_HOME}, {"fg3_pct_home", RecordField::FG3_PCT_HOME},
+    {"ast_home", RecordField::AST_HOME}, {"reb_home", RecordField::REB_HOME},
+    {"home_team_wins", RecordField::HOME_TEAM_WINS}
+};
+
+bool parseKey(const std::string& text, float& key) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    key = strtof(text.c_str(), &end);
+    return *end == '\0' && key == key;
+}
+
+/**
+ * Field Value
+ *
+ * @param record Record to read
+ * @param field Column
+ * @return The column as a double (game_date as YYYYMMDD, like aggregateSelected)
+ */
+double fieldValue(const Record& record, RecordField field) {
+    switch (field) {
+        case RecordField::GAME_DATE: return record.dateKey();
+        case RecordField::TEAM_ID_HOME: return record.team_id_home;
+        case RecordField::PTS_HOME: return record.pts_home;
+        case RecordField::FG_PCT_HOME: return record.fg_pct_home;
+        case RecordField::FT_PCT_HOME: return record.ft_pct_home;
+        case RecordField::FG3_PCT_HOME: return record.fg3_pct_home;
+        case RecordField::AST_HOME: return record.ast_home;
+        case RecordField::REB_HOME: return record.reb_home;
+        case RecordField::HOME_TEAM_WINS: default: return record.home_team_wins;
+    }
+}
+
+std::string trim(const std::string& line) {
+    size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return std::string();
+    size_t end = line.find_last_not_of(" \t\r");
+    return line.substr(begin, end - begin + 1);
+}
+
+/**
+ * Send All
+ *
+ * @param fd Connected socket
+ * @param data Bytes to send
+ * @return false if the peer went away
+ */
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+#ifdef MSG_NOSIGNAL
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#else
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, 0);
+#endif
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string errorResponse(const std::string& reason) {
+    return "ERR " + reason;
+}
+
+} // namespace
+
+/**
+ * Parse Request
+ *
+ * Commands are lowercase words followed by space-separated arguments;
+ * keys are parsed with strtof, so "0.9" is the same float as 0.9f.
+ */
+QueryRequest QueryRequest::parse(const std::string& line) {
+    QueryRequest request;
+    std::istringstream in(line);
+    std::string command;
+    std::vector<std::string> args;
+    in >> command;
+    std::string arg;
+    while (in >> arg) args.push_back(arg);
+
+    size_t expected = 0;
+    if (command == "point") {
+        request.type = RequestType::POINT;
+        expected = 1;
+    } else if (command == "range") {
+        request.type = RequestType::RANGE;
+        expected = 2;
+    } else if (command == "aggregate") {
+        request.type = RequestType::AGGREGATE;
+        expected = 3;
+    } else if (command == "delete_range") {
+        request.type = RequestType::DELETE_RANGE;
+        expected = 2;
+    } else if (command == "stats") {
+        request.type = RequestType::STATS;
+    } else if (command == "ping") {
+        request.type = RequestType::PING;
+    } else if (command == "quit") {
+        request.type = RequestType::QUIT;
+    } else if (command == "shutdown") {
+        request.type = RequestType::SHUTDOWN;
+    } else {
+        request.error = "unknown command '" + command + "'";
+        return request;
+    }
+    if (args.size() != expected) {
+        std::ostringstream reason;
+        reason << command << " takes " << expected << " argument" << (expected == 1 ? "" : "s");
+        request.type = RequestType::INVALID;
+        request.error = reason.str();
+        return request;
+    }
+
+    // Column first for aggregate, then the keys
+    size_t first_key = 0;
+    if (request.type == RequestType::AGGREGATE) {
+        bool known = false;
+        for (size_t c = 0; c < sizeof(COLUMN_NAMES) / sizeof(COLUMN_NAMES[0]); c++) {
+            if (args[0] == COLUMN_NAMES[c].name) {
+                request.field = COLUMN_NAMES[c].field;
+                known = true;
+            }
+        }
+        if (!known) {
+            request.type = RequestType::INVALID;
+            request.error = "unknown column '" + args[0] + "'";
+            return request;
+        }
+        first_key = 1;
+    }
+    if (expected > first_key) {
+        bool ok = parseKey(args[first_key], request.min_key);
+        if (expected - first_key == 2) {
+            ok = ok && parseKey(args[first_key + 1], request.max_key);
+        } else {
+            request.max_key = request.min_key;
+        }
+        if (!ok) {
+            request.type = RequestType::INVALID;
+            request.error = "invalid key";
+        }
+    }
+    return request;
+}
+
+QueryServer::QueryServer(Database& db, BPTree& tree, const ServerOptions& options)
+    : db(db), tree(tree), options(options), pool(options.num_threads), requests_served(0), batches_served(0),
+      stopping(false), request_counter(nullptr), batch_counter(nullptr) {
+    if (this->options.max_batch == 0) this->options.max_batch = 1;
+    for (int t = 0; t < NUM_REQUEST_TYPES; t++) latency[t] = nullptr;
+}
+
+void QueryServer::attachMetrics(MetricsRegistry* registry) {
+    for (int t = 0; t < NUM_REQUEST_TYPES; t++) {
+        latency[t] = registry != nullptr
+            ? &registry->histogram(std::string("server_") + REQUEST_NAMES[t] + "_seconds") : nullptr;
+    }
+    request_counter = registry != nullptr ? &registry->counter("server_requests") : nullptr;
+    batch_counter = registry != nullptr ? &registry->counter("server_batches") : nullptr;
+}
+
+int QueryServer::warm() {
+    ExclusiveLatchGuard guard(latch);
+    int blocks = db.scan([](const Record&, int, int) {});
+    tree.countRange(KeyTraits<float>::lowest(), KeyTraits<float>::highest());
+    return blocks;
+}
+
+std::string QueryServer::execute(const QueryRequest& request) {
+    LatencyTimer timer(latency[static_cast<int>(request.type)]);
+    std::ostringstream response;
+    switch (request.type) {
+        case RequestType::POINT:
+        case RequestType::RANGE:
+            response << "OK " << tree.countRange(request.min_key, request.max_key);
+            return response.str();
+        case RequestType::AGGREGATE:
+            return aggregate(request);
+        case RequestType::DELETE_RANGE:
+            return deleteRange(request);
+        case RequestType::STATS:
+            response << "OK records=" << db.getNumRecords() << " blocks=" << db.getNumBlocks()
+                     << " nodes=" << tree.getNumNodes() << " levels=" << tree.getNumLevels();
+            return response.str();
+        case RequestType::PING:
+            return "OK";
+        default:
+            return errorResponse(request.error.empty() ? "invalid request" : request.error);
+    }
+}
+
+/**
+ * Aggregate
+ *
+ * Algorithm:
+ * 1. Ask the planner for the cheaper access path of the key range
+ * 2. Index scan: find the pointers, sort them by location and read each
+ *    record through the (warm) buffer pool
+ * 3. Full scan: aggregateScan with the range as predicate
+ * Both paths fold the records in block and slot order, so they give the
+ * same sum.
+ */
+std::string QueryServer::aggregate(const QueryRequest& request) {
+    // Step 1: Choose the access path
+    PlanEstimate plan = planRange(tree, db.getNumBlocks(), request.min_key, request.max_key);
+    ColumnAggregate result;
+
+    if (plan.path == AccessPath::INDEX_SCAN) {
+        // Step 2: Index scan
+        std::vector<RecordPointer> pointers = tree.rangeSearch(request.min_key, request.max_key);
+        std::sort(pointers.begin(), pointers.end(),
+                  [](const RecordPointer& a, const RecordPointer& b) { return a.pack() < b.pack(); });
+        std::lock_guard<std::mutex> lock(heap_mutex);
+        for (size_t i = 0; i < pointers.size(); i++) {
+            double value = fieldValue(db.getRecord(pointers[i].block_id, pointers[i].record_index), request.field);
+            if (result.count == 0 || value < result.min) result.min = value;
+            if (result.count == 0 || value > result.max) result.max = value;
+            result.sum += value;
+            result.count++;
+        }
+    } else {
+        // Step 3: Full scan
+        ScanPredicate predicate;
+        predicate.where(RecordField::FT_PCT_HOME, CompareOp::GE, request.min_key)
+                 .where(RecordField::FT_PCT_HOME, CompareOp::LE, request.max_key);
+        std::lock_guard<std::mutex> lock(heap_mutex);
+        aggregateScan(db, predicate, request.field, result);
+    }
+
+    std::ostringstream response;
+    response << std::setprecision(10) << "OK " << result.count << " " << result.sum << " " << result.min << " "
+             << result.max << " " << result.average();
+    return response.str();
+}
+
+/**
+ * Delete Range
+ *
+ * Deletes the records first (the catalog keeps the secondary indexes in
+ * sync), then the range of the tree, as Task 3 does. The caller holds the
+ * server latch exclusively.
+ */
+std::string QueryServer::deleteRange(const QueryRequest& request) {
+    std::vector<RecordPointer> pointers = tree.rangeSearch(request.min_key, request.max_key);
+    int deleted = 0;
+    for (size_t i = 0; i < pointers.size(); i++) {
+        if (db.deleteRecord(pointers[i].block_id, pointers[i].record_index)) deleted++;
+    }
+    tree.removeRange(request.min_key, request.max_key);
+    std::ostringstream response;
+    response << "OK " << deleted;
+    return response.str();
+}
+
+/**
+ * Execute Batch
+ *
+ * Algorithm:
+ * 1. Cut the batch into maximal runs of reads and single writes
+ * 2. Run each read run on the pool under the shared latch
+ * 3. Run each write under the exclusive latch and flush the heap and the
+ *    tree before its response is released
+ */
+void QueryServer::executeBatch(const std::vector<QueryRequest>& requests, std::vector<std::string>& responses) {
+    responses.assign(requests.size(), std::string());
+    size_t begin = 0;
+    while (begin < requests.size()) {
+        // Step 3: A write runs alone
+        if (requests[begin].isWrite()) {
+            ExclusiveLatchGuard guard(latch);
+            responses[begin] = execute(requests[begin]);
+            db.flush();
+            tree.flush();
+            begin++;
+            continue;
+        }
+
+        // Steps 1-2: The following reads run together
+        size_t end = begin;
+        while (end < requests.size() && !requests[end].isWrite()) end++;
+        SharedLatchGuard guard(latch);
+        pool.run(end - begin, [this, &requests, &responses, begin](size_t i, int) {
+            responses[begin + i] = execute(requests[begin + i]);
+        });
+        begin = end;
+    }
+    requests_served.fetch_add(static_cast<long long>(requests.size()));
+    batches_served.fetch_add(1);
+    if (request_counter != nullptr) request_counter->add(static_cast<long long>(requests.size()));
+    if (batch_counter != nullptr) batch_counter->add();
+}
+
+RequestType QueryServer::handleLines(const std::vector<std::string>& lines, std::string& output) {
+    std::vector<QueryRequest> requests;
+    RequestType end = RequestType::PING;
+    for (size_t i = 0; i < lines.size(); i++) {
+        std::string line = trim(lines[i]);
+        if (line.empty()) continue;
+        QueryRequest request = QueryRequest::parse(line);
+        if (request.type == RequestType::QUIT || request.type == RequestType::SHUTDOWN) {
+            end = request.type;
+            break;
+        }
+        requests.push_back(request);
+    }
+
+    std::vector<std::string> responses;
+    executeBatch(requests, responses);
+    for (size_t i = 0; i < responses.size(); i++) {
+        output += responses[i];
+        output += '\n';
+    }
+    return end;
+}
+
+long long QueryServer::serveStream(std::istream& in, std::ostream& out) {
+    long long served_before = requests_served.load();
+    std::vector<std::string> lines;
+    std::string line;
+    std::string output;
+    while (std::getline(in, line)) {
+        // Everything already buffered joins the batch; a blank line ends it
+        lines.assign(1, line);
+        while (lines.size() < options.max_batch && !trim(lines.back()).empty() &&
+               in.rdbuf()->in_avail() > 0 && std::getline(in, line)) {
+            lines.push_back(line);
+        }
+        output.clear();
+        RequestType end = handleLines(lines, output);
+        out << output;
+        out.flush();
+        if (end != RequestType::PING) break;
+    }
+    return requests_served.load() - served_before;
+}
+
+/**
+ * Serve Connection
+ *
+ * Each recv returns whatever the client has sent so far; its complete
+ * lines (up to max_batch at a time) are one batch.
+ */
+void QueryServer::serveConnection(int fd) {
+    std::string pending;
+    std::vector<char> buffer(SOCKET_READ_SIZE);
+    std::vector<std::string> lines;
+    std::string output;
+    bool open = true;
+    while (open && !stopping.load()) {
+        ssize_t n = recv(fd, &buffer[0], buffer.size(), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        pending.append(&buffer[0], static_cast<size_t>(n));
+
+        size_t start = 0;
+        size_t newline;
+        while (open && (newline = pending.find('\n', start)) != std::string::npos) {
+            lines.clear();
+            while (lines.size() < options.max_batch && newline != std::string::npos) {
+                lines.push_back(pending.substr(start, newline - start));
+                start = newline + 1;
+                newline = pending.find('\n', start);
+            }
+            output.clear();
+            RequestType end = handleLines(lines, output);
+            if (!sendAll(fd, output)) end = RequestType::QUIT;
+            if (end == RequestType::SHUTDOWN) stopping.store(true);
+            open = end == RequestType::PING;
+        }
+        pending.erase(0, start);
+    }
+
+    // Unregister before closing: once closed, accept() may reuse the number
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex);
+        connection_fds.erase(std::find(connection_fds.begin(), connection_fds.end(), fd));
+        if (connection_fds.empty()) connections_done.notify_all();
+    }
+    close(fd);
+}
+
+/**
+ * Serve Socket
+ *
+ * Algorithm:
+ * 1. Bind and listen on the loopback interface
+ * 2. Accept connections, polling so a shutdown is noticed, and start a
+ *    detached thread per connection; a connection removes its fd from
+ *    connection_fds before closing it, so every listed fd is still open
+ * 3. On shutdown, wake the remaining connections and wait until all have
+ *    closed
+ */
+bool QueryServer::serveSocket(int port) {
+    // Step 1: Listen
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) return false;
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listen_fd, 64) != 0) {
+        close(listen_fd);
+        return false;
+    }
+
+    // Step 2: Accept until shutdown
+    stopping.store(false);
+    while (!stopping.load()) {
+        pollfd waiting;
+        waiting.fd = listen_fd;
+        waiting.events = POLLIN;
+        waiting.revents = 0;
+        if (poll(&waiting, 1, ACCEPT_POLL_MS) <= 0) continue;
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+#ifdef SO_NOSIGPIPE
+        int no_sigpipe = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex);
+            connection_fds.push_back(fd);
+        }
+        std::thread([this, fd]() { serveConnection(fd); }).detach();
+    }
+    close(listen_fd);
+
+    // Step 3: Wake idle connections and wait until all have closed
+    std::unique_lock<std::mutex> lock(connections_mutex);
+    for (size_t i = 0; i < connection_fds.size(); i++) shutdown(connection_fds[i], SHUT_RDWR);
+    connections_done.wait(lock, [this]() { return connection_fds.empty(); });
+    return true;
+}
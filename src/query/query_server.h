@@ -0,0 +1,233 @@
+/**
+ * SC3020 Database Management System
+ * Query Server Header
+ *
+ * This file defines QueryServer, a long-running query front end that keeps
+ * the heap file, its secondary indexes and the FT_PCT_home B+ tree open,
+ * so requests are answered from warm buffer pools and node caches instead
+ * of reopening the files per query.
+ *
+ * Protocol (one request per line, one response line per request, in
+ * request order; keys are FT_PCT_home values, ranges are inclusive):
+ * - point <key>                          -> OK <count>
+ * - range <min> <max>                    -> OK <count>
+ * - aggregate <column> <min> <max>       -> OK <count> <sum> <min> <max> <avg>
+ * - delete_range <min> <max>             -> OK <deleted>
+ * - stats                                -> OK records=<n> blocks=<n> nodes=<n> levels=<n>
+ * - ping                                 -> OK
+ * - quit                                 ends the connection (no response)
+ * - shutdown                             ends the connection and stops serveSocket()
+ * A malformed request gets "ERR <reason>". A blank line ends a batch early.
+ *
+ * Pipelining: a client may send many requests before reading responses.
+ * Every request that has already arrived (up to max_batch) forms one
+ * batch. Consecutive reads in a batch run on the thread pool under a
+ * shared server latch; a delete_range runs alone under the exclusive
+ * latch, then the heap and the tree are flushed. Results are therefore
+ * the same as executing the requests one by one, and the responses of a
+ * batch are written with one flush (one write per round trip).
+ *
+ * Access paths: point and range counts read only the tree
+ * (BasicBPTree::countRange; tree calls are latched, so they run
+ * concurrently). Aggregates use the planner: an index scan gathers the
+ * records through the buffer pool, a full scan uses aggregateScan with
+ * zone-map pruning. The Database itself is not thread-safe, so heap
+ * access is serialized by a mutex.
+ */
+
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+// Include storage, indexing and query components
+#include "../storage/database.h"
+#include "../indexing/bptree.h"
+#include "../utils/latch.h"
+#include "../utils/metrics.h"
+#include "../utils/thread_pool.h"
+#include "vector_scan.h"
+
+// Standard C++ libraries
+#include <atomic>    // For the stop flag
+#include <condition_variable> // For waiting on connections
+#include <istream>   // For serveStream
+#include <mutex>     // For heap access and connections
+#include <ostream>   // For serveStream
+#include <string>    // For requests and responses
+#include <vector>    // For batches
+
+/**
+ * Request Type Enumeration
+ */
+enum class RequestType {
+    POINT,
+    RANGE,
+    AGGREGATE,
+    DELETE_RANGE,
+    STATS,
+    PING,
+    QUIT,
+    SHUTDOWN,
+    INVALID
+};
+
+/**
+ * Query Request Structure
+ */
+struct QueryRequest {
+    RequestType type;    // Operation
+    float min_key;       // Lower bound (the key for POINT)
+    float max_key;       // Upper bound (the key for POINT)
+    RecordField field;   // Column of AGGREGATE
+    std::string error;   // Reason when type is INVALID
+
+    QueryRequest() : type(RequestType::INVALID), min_key(0.0f), max_key(0.0f), field(RecordField::PTS_HOME) {}
+
+    /**
+     * Parse Request
+     *
+     * @param line One protocol line (without the newline)
+     * @return The request; INVALID with error set if malformed
+     */
+    static QueryRequest parse(const std::string& line);
+
+    bool isWrite() const { return type == RequestType::DELETE_RANGE; }
+};
+
+/**
+ * Server Options Structure
+ */
+struct ServerOptions {
+    int num_threads;     // Thread pool size, including the batch's caller (0 = one per hardware thread)
+    size_t max_batch;    // Most requests executed as one batch
+
+    ServerOptions() : num_threads(0), max_batch(1024) {}
+};
+
+/**
+ * Query Server Class
+ */
+class QueryServer {
+public:
+    static const int NUM_REQUEST_TYPES = static_cast<int>(RequestType::INVALID) + 1;
+
+    /**
+     * Constructor
+     *
+     * @param db Open database; secondary indexes should be registered
+     * @param tree Open FT_PCT_home index of the database
+     * @param options Pool size and batch limit
+     */
+    QueryServer(Database& db, BPTree& tree, const ServerOptions& options = ServerOptions());
+
+    /**
+     * Attach Metrics
+     *
+     * Records the latency of each request type into
+     * server_<type>_seconds and counts requests and batches.
+     *
+     * @param registry Registry to record into (nullptr to detach)
+     */
+    void attachMetrics(MetricsRegistry* registry);
+
+    /**
+     * Warm Caches
+     *
+     * Reads every heap block through the buffer pool and every leaf of
+     * the tree once, so the first requests do not pay for cold caches.
+     *
+     * @return Heap blocks read
+     */
+    int warm();
+
+    /**
+     * Execute Batch
+     *
+     * @param requests Requests in arrival order (QUIT/SHUTDOWN are ignored)
+     * @param responses Receives one line per request (without newline)
+     */
+    void executeBatch(const std::vector<QueryRequest>& requests, std::vector<std::string>& responses);
+
+    /**
+     * Serve Stream
+     *
+     * Answers requests from a stream until end of input or quit. For
+     * batching beyond one line per read, std::cin needs
+     * std::ios::sync_with_stdio(false).
+     *
+     * @param in Request stream
+     * @param out Response stream (flushed once per batch)
+     * @return Requests answered
+     */
+    long long serveStream(std::istream& in, std::ostream& out);
+
+    /**
+     * Serve Socket
+     *
+     * Listens on 127.0.0.1:port and serves each connection on its own
+     * thread (their batches share the pool) until a client sends shutdown.
+     *
+     * @param port TCP port
+     * @return false if the socket could not be set up
+     */
+    bool serveSocket(int port);
+
+    // Statistics
+    long long getRequestsServed() const { return requests_served.load(); }
+    long long getBatchesServed() const { return batches_served.load(); }
+
+private:
+    QueryServer(const QueryServer&);
+    QueryServer& operator=(const QueryServer&);
+
+    /**
+     * Execute Request
+     *
+     * Runs one request; the caller holds the server latch in the mode the
+     * request needs.
+     *
+     * @param request Parsed request
+     * @return Response line
+     */
+    std::string execute(const QueryRequest& request);
+
+    std::string aggregate(const QueryRequest& request);
+    std::string deleteRange(const QueryRequest& request);
+
+    /**
+     * Handle Lines
+     *
+     * Parses a batch of protocol lines, executes them and appends the
+     * responses (newline-terminated) to output.
+     *
+     * @param lines Lines of one batch
+     * @param output Destination of the responses
+     * @return RequestType::QUIT or SHUTDOWN if the client ended the
+     *         session, else RequestType::PING
+     */
+    RequestType handleLines(const std::vector<std::string>& lines, std::string& output);
+
+    /**
+     * Serve Connection
+     *
+     * @param fd Connected socket (closed on return)
+     */
+    void serveConnection(int fd);
+
+    Database& db;                                      // Heap file
+    BPTree& tree;                                      // FT_PCT_home index
+    ServerOptions options;                             // Pool size and batch limit
+    ThreadPool pool;                                   // Runs the reads of a batch
+    RWLatch latch;                                     // Shared: read segment of a batch; exclusive: a write
+    std::mutex heap_mutex;                             // Serializes Database calls
+    std::atomic<long long> requests_served;            // Requests answered
+    std::atomic<long long> batches_served;             // Batches executed
+    std::atomic<bool> stopping;                        // Set by shutdown
+    std::mutex connections_mutex;                      // Guards connection_fds
+    std::condition_variable connections_done;          // Signalled when the last connection closes
+    std::vector<int> connection_fds;                   // Open connections (shut down on stop)
+    LatencyHistogram* latency[NUM_REQUEST_TYPES];      // Per request type (nullptr = not measured)
+    ShardedCounter* request_counter;                   // server_requests (nullptr = not counted)
+    ShardedCounter* batch_counter;                     // server_batches (nullptr = not counted)
+};
+
+#endif // QUERY_SERVER_H
@@ -0,0 +1,392 @@
+/**
+ * SC3020 Database Management System
+ * Vectorized Scan Implementation
+ *
+ * This file contains the column gather, the SIMD comparison kernels and
+ * the scan loop of the vectorized scan operator.
+ *
+ */
+
+#include "vector_scan.h"
+
+#include <cstring>   // For memcpy
+#include <algorithm> // For std::min
+#include <cmath>     // For ceil and floor
+#include <limits>    // For the int32 range
+
+namespace {
+
+// Four 32-bit lanes per vector (SSE / NEON width)
+typedef float FloatLanes __attribute__((vector_size(16)));
+typedef int32_t IntLanes __attribute__((vector_size(16)));
+const int LANES = 4;
+
+// Column buffers cover every slot the bitmap can describe
+const int MAX_SLOTS = Block::BITMAP_WORDS * 32;
+static_assert(Block::MAX_RECORDS <= MAX_SLOTS, "Every slot needs a bitmap bit");
+static_assert(Block::MAX_RECORDS % LANES == 0, "A PAX minipage must hold whole vectors");
+
+/**
+ * Column Values
+ *
+ * Returns a dense array of one 4-byte column covering groups vectors. A
+ * PAX minipage already is one (MAX_RECORDS values) and is used in place;
+ * NSM slots are gathered into the buffer, zero-padded to whole vectors.
+ */
+template <typename Scalar>
+const Scalar* columnValues(const Block& block, size_t offset, int slots, int groups, Scalar* buffer) {
+    ColumnSpan span = block.getColumn(offset, sizeof(Scalar));
+    if (span.stride == sizeof(Scalar)) return reinterpret_cast<const Scalar*>(span.data);
+    const char* field = span.data;
+    for (int i = 0; i < slots; i++, field += span.stride) {
+        memcpy(&buffer[i], field, sizeof(Scalar));
+    }
+    for (int i = slots; i < groups * LANES; i++) buffer[i] = Scalar();
+    return buffer;
+}
+
+/**
+ * Date Keys
+ *
+ * Parses the game_date of every slot into YYYYMMDD, zero-padded to whole
+ * vectors like columnValues().
+ */
+const int32_t* dateKeys(const Block& block, int slots, int groups, int32_t* buffer) {
+    ColumnSpan span = block.getColumn(offsetof(Record, game_date), sizeof(Record::game_date));
+    for (int i = 0; i < slots; i++) buffer[i] = Record::parseDateKey(span.at(i));
+    for (int i = slots; i < groups * LANES; i++) buffer[i] = 0;
+    return buffer;
+}
+
+/**
+ * Compare Column
+ *
+ * Applies compare to each vector of the column and ORs the lane results
+ * (all ones or zero) into the bitmap, four slots per step.
+ */
+template <typename Lanes, typename Scalar, typename Compare>
+void compareColumn(const Scalar* column, int groups, const Lanes& constant, const Compare& compare, uint32_t* bits) {
+    for (int g = 0; g < groups; g++) {
+        Lanes values;
+        memcpy(&values, column + g * LANES, sizeof(values));
+        IntLanes mask = compare(values, constant);
+        uint32_t nibble = (mask[0] & 1u) | (mask[1] & 2u) | (mask[2] & 4u) | (mask[3] & 8u);
+        bits[g / 8] |= nibble << ((g % 8) * LANES);
+    }
+}
+
+/**
+ * Compare Term
+ *
+ * Broadcasts the constant and dispatches on the operator once per block,
+ * so the inner loop has no branches.
+ */
+template <typename Lanes, typename Scalar>
+void compareTerm(const Scalar* column, int groups, CompareOp op, Scalar value, uint32_t* bits) {
+    Lanes constant;
+    for (int i = 0; i < LANES; i++) constant[i] = value;
+    switch (op) {
+        case CompareOp::LT: compareColumn(column, groups, constant, [](const Lanes& a, const Lanes& b) { return a < b; }, bits); break;
+        case CompareOp::LE: compareColumn(column, groups, constant, [](const Lanes& a, const Lanes& b) { return a <= b; }, bits); break;
+        case CompareOp::GT: compareColumn(column, groups, constant, [](const Lanes& a, const Lanes& b) { return a > b; }, bits); break;
+        case CompareOp::GE: compareColumn(column, groups, constant, [](const Lanes& a, const Lanes& b) { return a >= b; }, bits); break;
+        case CompareOp::EQ: compareColumn(column, groups, constant, [](const Lanes& a, const Lanes& b) { return a == b; }, bits); break;
+        case CompareOp::NE: compareColumn(column, groups, constant, [](const Lanes& a, const Lanes& b) { return a != b; }, bits); break;
+    }
+}
+
+/**
+ * Compare Scalars
+ */
+template <typename Scalar>
+bool compareValues(Scalar a, CompareOp op, Scalar b) {
+    switch (op) {
+        case CompareOp::LT: return a < b;
+        case CompareOp::LE: return a <= b;
+        case CompareOp::GT: return a > b;
+        case CompareOp::GE: return a >= b;
+        case CompareOp::EQ: return a == b;
+        case CompareOp::NE: return a != b;
+    }
+    return false;
+}
+
+/**
+ * Locate Field
+ *
+ * @param field Column
+ * @param offset Receives offsetof(Record, column)
+ * @param is_float Receives true for the *_pct_home columns
+ */
+void locateField(RecordField field, size_t& offset, bool& is_float) {
+    is_float = false;
+    offset = 0;
+    switch (field) {
+        case RecordField::GAME_DATE:      offset = offsetof(Record, game_date); break;
+        case RecordField::TEAM_ID_HOME:   offset = offsetof(Record, team_id_home); break;
+        case RecordField::PTS_HOME:       offset = offsetof(Record, pts_home); break;
+        case RecordField::FG_PCT_HOME:    offset = offsetof(Record, fg_pct_home); is_float = true; break;
+        case RecordField::FT_PCT_HOME:    offset = offsetof(Record, ft_pct_home); is_float = true; break;
+        case RecordField::FG3_PCT_HOME:   offset = offsetof(Record, fg3_pct_home); is_float = true; break;
+        case RecordField::AST_HOME:       offset = offsetof(Record, ast_home); break;
+        case RecordField::REB_HOME:       offset = offsetof(Record, reb_home); break;
+        case RecordField::HOME_TEAM_WINS: offset = offsetof(Record, home_team_wins); break;
+    }
+}
+
+/**
+ * Zone Filter
+ *
+ * Block filter from the database's zone map. Empty (every block is read)
+ * if no zone map is registered, it is not built, it disagrees with the
+ * heap's record count, or there is nothing to prune on.
+ */
+Database::BlockFilter zoneFilter(Database& db, const ScanPredicate& predicate) {
+    const ZoneMap* zones = static_cast<const ZoneMap*>(db.getIndexes().find(ZoneMap::defaultName()));
+    if (zones == nullptr || zones->empty() || zones->getNumRecords() != db.getNumRecords() ||
+        predicate.getTerms().empty()) {
+        return Database::BlockFilter();
+    }
+    return [zones, &predicate](int block_id) {
+        const ZoneMap::Zone* zone = zones->getZone(block_id);
+        return zone == nullptr || predicate.mayMatch(*zone);
+    };
+}
+
+/**
+ * Integer Comparison
+ *
+ * Rewrites `field op value` over int32 fields as an equivalent comparison
+ * with an int32 constant: ceil for GE/LT, floor for GT/LE. A comparison
+ * that holds for no int32 becomes `< INT32_MIN`, one that holds for every
+ * int32 becomes `>= INT32_MIN`.
+ *
+ * Algorithm:
+ * 1. EQ/NE: an integral constant in range is kept; otherwise EQ never
+ *    holds and NE always does (also for NaN)
+ * 2. GE/LT: round up; GT/LE: round down
+ * 3. Constants beyond the int32 range decide the comparison outright
+ *
+ * @param op Operator as written
+ * @param value Constant as written
+ * @param int_value Receives the int32 constant
+ * @return Operator to apply to int_value
+ */
+CompareOp integerComparison(CompareOp op, double value, int32_t& int_value) {
+    const double lowest = static_cast<double>(std::numeric_limits<int32_t>::min());
+    const double highest = static_cast<double>(std::numeric_limits<int32_t>::max());
+    const CompareOp never = CompareOp::LT;
+    const CompareOp always = CompareOp::GE;
+    int_value = std::numeric_limits<int32_t>::min();
+
+    // Step 1: Equality needs an exact int32
+    if (op == CompareOp::EQ || op == CompareOp::NE) {
+        if (value == std::floor(value) && value >= lowest && value <= highest) {
+            int_value = static_cast<int32_t>(value);
+            return op;
+        }
+        return op == CompareOp::EQ ? never : always;
+    }
+    if (value != value) return never;
+
+    // Step 2: Round towards the values the comparison keeps
+    bool round_up = op == CompareOp::GE || op == CompareOp::LT;
+    double bound = round_up ? std::ceil(value) : std::floor(value);
+
+    // Step 3: Out of range bounds
+    if (bound > highest) return (op == CompareOp::LT || op == CompareOp::LE) ? always : never;
+    if (bound < lowest) return (op == CompareOp::GT || op == CompareOp::GE) ? always : never;
+    int_value = static_cast<int32_t>(bound);
+    return op;
+}
+
+} // namespace
+
+FieldComparison::FieldComparison(RecordField field, CompareOp op, double value)
+    : field(field), op(op), is_float(false), is_date(field == RecordField::GAME_DATE), offset(0),
+      float_value(static_cast<float>(value)), int_value(0), int_op(op) {
+    locateField(field, offset, is_float);
+    if (!is_float) int_op = integerComparison(op, value, int_value);
+}
+
+bool FieldComparison::matches(const Record& record) const {
+    if (is_date) return compareValues(record.dateKey(), int_op, int_value);
+    const char* field_bytes = reinterpret_cast<const char*>(&record) + offset;
+    if (is_float) {
+        float value;
+        memcpy(&value, field_bytes, sizeof(value));
+        return compareValues(value, op, float_value);
+    }
+    int32_t value;
+    memcpy(&value, field_bytes, sizeof(value));
+    return compareValues(value, int_op, int_value);
+}
+
+/**
+ * Evaluate on a Zone
+ *
+ * The zone holds [min, max] of the column, so e.g. `field > value` can
+ * only hold somewhere in the block if max > value.
+ */
+bool FieldComparison::mayMatch(const ZoneMap::Zone& zone) const {
+    if (zone.live == 0) return false;
+    int c = ZoneMap::columnOf(offset);
+    if (c < 0) return true;
+    double low = zone.min[c];
+    double high = zone.max[c];
+    double value = is_float ? static_cast<double>(float_value) : static_cast<double>(int_value);
+    switch (is_float ? op : int_op) {
+        case CompareOp::LT: return low < value;
+        case CompareOp::LE: return low <= value;
+        case CompareOp::GT: return high > value;
+        case CompareOp::GE: return high >= value;
+        case CompareOp::EQ: return low <= value && value <= high;
+        case CompareOp::NE: return !(low == value && high == value);
+    }
+    return true;
+}
+
+bool ScanPredicate::matches(const Record& record) const {
+    for (size_t t = 0; t < terms.size(); t++) {
+        if (!terms[t].matches(record)) return false;
+    }
+    return true;
+}
+
+bool ScanPredicate::mayMatch(const ZoneMap::Zone& zone) const {
+    for (size_t t = 0; t < terms.size(); t++) {
+        if (!terms[t].mayMatch(zone)) return false;
+    }
+    return true;
+}
+
+int ScanPredicate::filterBlock(const Block& block, uint32_t* selection) const {
+    int slots = std::min(block.getNumSlots(), static_cast<int>(Block::MAX_RECORDS));
+    int groups = (slots + LANES - 1) / LANES;
+    
+    // Start from the live slots below num_slots
+    uint32_t any = 0;
+    for (int w = 0; w < Block::BITMAP_WORDS; w++) {
+        int below = slots - w * 32;
+        uint32_t in_use = below >= 32 ? 0xFFFFFFFFu : (below <= 0 ? 0u : (1u << below) - 1);
+        selection[w] = block.slot_bitmap[w] & in_use;
+        any |= selection[w];
+    }
+    
+    alignas(16) float floats[MAX_SLOTS];
+    alignas(16) int32_t ints[MAX_SLOTS];
+    for (size_t t = 0; t < terms.size() && any != 0; t++) {
+        const FieldComparison& term = terms[t];
+        uint32_t bits[Block::BITMAP_WORDS] = { 0 };
+        if (term.is_date) {
+            compareTerm<IntLanes>(dateKeys(block, slots, groups, ints), groups, term.int_op, term.int_value, bits);
+        } else if (term.is_float) {
+            compareTerm<FloatLanes>(columnValues(block, term.offset, slots, groups, floats), groups, term.op,
+                                    term.float_value, bits);
+        } else {
+            compareTerm<IntLanes>(columnValues(block, term.offset, slots, groups, ints), groups, term.int_op,
+                                  term.int_value, bits);
+        }
+        any = 0;
+        for (int w = 0; w < Block::BITMAP_WORDS; w++) {
+            selection[w] &= bits[w];
+            any |= selection[w];
+        }
+    }
+    
+    int selected = 0;
+    for (int w = 0; w < Block::BITMAP_WORDS; w++) selected += __builtin_popcount(selection[w]);
+    return selected;
+}
+
+namespace {
+
+/**
+ * Emit Selected Records
+ *
+ * Filters a run of blocks and copies out the selected records.
+ *
+ * @param predicate Conjunction to evaluate
+ * @param blocks First block of the run
+ * @param first_block_id ID of the first block
+ * @param count Blocks in the run
+ * @param emit Called as emit(record, block_id, record_index) per match
+ */
+template <typename Emit>
+void emitMatches(const ScanPredicate& predicate, const Block* blocks, int first_block_id, int count, const Emit& emit) {
+    uint32_t selection[Block::BITMAP_WORDS];
+    for (int b = 0; b < count; b++) {
+        const Block& block = blocks[b];
+        if (predicate.filterBlock(block, selection) == 0) continue;
+        
+        // Materialize only the selected slots
+        for (int w = 0; w < Block::BITMAP_WORDS; w++) {
+            uint32_t bits = selection[w];
+            while (bits != 0) {
+                int i = w * 32 + __builtin_ctz(bits);
+                bits &= bits - 1;
+                emit(block.getRecord(i), first_block_id + b, i);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void aggregateSelected(const Block& block, const uint32_t* selection, RecordField field, ColumnAggregate& aggregate) {
+    size_t offset;
+    bool is_float;
+    locateField(field, offset, is_float);
+    bool is_date = field == RecordField::GAME_DATE;
+    ColumnSpan column = block.getColumn(offset, is_date ? sizeof(Record::game_date) : sizeof(int32_t));
+    
+    for (int w = 0; w < Block::BITMAP_WORDS; w++) {
+        uint32_t bits = selection[w];
+        while (bits != 0) {
+            int i = w * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+            double value;
+            if (is_date) {
+                value = Record::parseDateKey(column.at(i));
+            } else if (is_float) {
+                float f;
+                memcpy(&f, column.at(i), sizeof(f));
+                value = f;
+            } else {
+                int32_t n;
+                memcpy(&n, column.at(i), sizeof(n));
+                value = n;
+            }
+            if (aggregate.count == 0 || value < aggregate.min) aggregate.min = value;
+            if (aggregate.count == 0 || value > aggregate.max) aggregate.max = value;
+            aggregate.sum += value;
+            aggregate.count++;
+        }
+    }
+}
+
+int aggregateScan(Database& db, const ScanPredicate& predicate, RecordField field, ColumnAggregate& result,
+                  int batch_blocks) {
+    result = ColumnAggregate();
+    return db.scanBlocks([&predicate, field, &result](const Block* blocks, int, int count) {
+        uint32_t selection[Block::BITMAP_WORDS];
+        for (int b = 0; b < count; b++) {
+            if (predicate.filterBlock(blocks[b], selection) > 0) aggregateSelected(blocks[b], selection, field, result);
+        }
+    }, batch_blocks, zoneFilter(db, predicate));
+}
+
+int vectorScan(Database& db, const ScanPredicate& predicate, const Database::ScanCallback& emit, int batch_blocks) {
+    return db.scanBlocks([&predicate, &emit](const Block* blocks, int first_block_id, int count) {
+        emitMatches(predicate, blocks, first_block_id, count, emit);
+    }, batch_blocks, zoneFilter(db, predicate));
+}
+
+int parallelVectorScan(Database& db, const ScanPredicate& predicate, const Database::PartitionScanCallback& emit,
+                       int num_threads, int batch_blocks) {
+    return db.parallelScanBlocks(num_threads, [&predicate, &emit](const Block* blocks, int first_block_id, int count, int worker) {
+        emitMatches(predicate, blocks, first_block_id, count, [&emit, worker](const Record& record, int block_id, int index) {
+            emit(record, block_id, index, worker);
+        });
+    }, batch_blocks, zoneFilter(db, predicate));
+}
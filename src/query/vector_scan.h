@@ -0,0 +1,253 @@
+/**
+ * SC3020 Database Management System
+ * Vectorized Scan Header
+ *
+ * This file defines the scan operator used for brute-force predicates.
+ * It works on the raw bytes of each block instead of copying every
+ * Record out:
+ * 1. The column of each comparison is gathered from the fixed-stride
+ *    record slots into a dense array (PAX blocks already keep each column
+ *    as one, which is compared in place)
+ * 2. The comparison runs four slots per SIMD instruction and produces a
+ *    selection bitmap with the same layout as Block::slot_bitmap
+ * 3. The bitmaps of all comparisons are ANDed with the slot bitmap
+ * 4. Only the selected slots are copied out as Records
+ *
+ * parallelVectorScan() runs the same steps on several threads, and
+ * aggregateScan() folds one column of the selected slots instead of
+ * copying them out.
+ *
+ * If the database has a built ZoneMap registered, all three scans skip
+ * the blocks whose zone cannot satisfy the predicate before reading them.
+ *
+ * A ScanPredicate is a conjunction of comparisons between a Record field
+ * and a constant. SIMD uses the GCC/Clang vector extension, so it
+ * compiles to SSE on x86 and NEON on ARM without intrinsics.
+ */
+
+#ifndef VECTOR_SCAN_H
+#define VECTOR_SCAN_H
+
+// Include block and database definitions
+#include "../storage/block.h"
+#include "../storage/database.h"
+#include "../indexing/zone_map.h"
+
+// Standard C++ libraries
+#include <vector>    // For the comparison list
+#include <cstddef>   // For size_t
+#include <cstdint>   // For bitmap words
+
+/**
+ * Record Field Enumeration
+ *
+ * The columns of Record. game_date is compared as Record::dateKey()
+ * (YYYYMMDD).
+ */
+enum class RecordField {
+    GAME_DATE,
+    TEAM_ID_HOME,
+    PTS_HOME,
+    FG_PCT_HOME,
+    FT_PCT_HOME,
+    FG3_PCT_HOME,
+    AST_HOME,
+    REB_HOME,
+    HOME_TEAM_WINS
+};
+
+/**
+ * Comparison Operator Enumeration
+ */
+enum class CompareOp {
+    LT,   // field <  value
+    LE,   // field <= value
+    GT,   // field >  value
+    GE,   // field >= value
+    EQ,   // field == value
+    NE    // field != value
+};
+
+/**
+ * Field Comparison Structure
+ *
+ * One term of a ScanPredicate. The constant is held in the field's own
+ * type, so float columns compare exactly like `record.ft_pct_home > 0.9f`.
+ * For integer columns a fractional constant is rounded per operator
+ * (`pts_home >= 100.5` becomes `pts_home >= 101`), and int_op is the
+ * operator that applies to int_value.
+ */
+struct FieldComparison {
+    RecordField field;  // Column compared
+    CompareOp op;       // Operator
+    bool is_float;      // true for the *_pct_home columns
+    bool is_date;       // true for game_date (compared as YYYYMMDD)
+    size_t offset;      // Byte offset of the column within a Record
+    float float_value;  // Constant for float columns
+    int32_t int_value;  // Constant for integer columns
+    CompareOp int_op;   // Operator for int_value (differs from op only when the constant is not an int32)
+
+    /**
+     * Constructor
+     *
+     * @param field Column compared
+     * @param op Operator
+     * @param value Constant (converted to the column's type)
+     */
+    FieldComparison(RecordField field, CompareOp op, double value);
+
+    /**
+     * Evaluate on One Record
+     *
+     * Scalar reference used for checking the vectorized path.
+     *
+     * @param record Record to test
+     * @return true if the record satisfies the comparison
+     */
+    bool matches(const Record& record) const;
+
+    /**
+     * Evaluate on a Zone
+     *
+     * @param zone Bounds of one block
+     * @return false if no record within the bounds can satisfy the comparison
+     */
+    bool mayMatch(const ZoneMap::Zone& zone) const;
+};
+
+/**
+ * Scan Predicate Class
+ *
+ * Conjunction of field comparisons; an empty predicate selects every live
+ * record.
+ */
+class ScanPredicate {
+public:
+    /**
+     * Add Comparison
+     *
+     * @param field Column compared
+     * @param op Operator
+     * @param value Constant
+     * @return This predicate, for chaining
+     */
+    ScanPredicate& where(RecordField field, CompareOp op, double value) {
+        terms.push_back(FieldComparison(field, op, value));
+        return *this;
+    }
+
+    const std::vector<FieldComparison>& getTerms() const { return terms; }
+
+    /**
+     * Evaluate on One Record
+     *
+     * @param record Record to test
+     * @return true if every comparison holds
+     */
+    bool matches(const Record& record) const;
+
+    /**
+     * Evaluate on a Zone
+     *
+     * @param zone Bounds of one block
+     * @return false if the block cannot hold a matching record
+     */
+    bool mayMatch(const ZoneMap::Zone& zone) const;
+
+    /**
+     * Filter Block
+     *
+     * Computes the selection bitmap of a block: bit i is set if slot i
+     * holds a live record satisfying every comparison.
+     *
+     * @param block Block to filter (only its bytes are read)
+     * @param selection Output bitmap, Block::BITMAP_WORDS words
+     * @return Number of selected slots
+     */
+    int filterBlock(const Block& block, uint32_t* selection) const;
+
+private:
+    std::vector<FieldComparison> terms;  // Comparisons, all of which must hold
+};
+
+/**
+ * Column Aggregate Structure
+ *
+ * COUNT, SUM, MIN and MAX of one column over the selected records.
+ */
+struct ColumnAggregate {
+    long long count;  // Selected records
+    double sum;       // Sum of the column
+    double min;       // Smallest value (0 if count is 0)
+    double max;       // Largest value (0 if count is 0)
+
+    ColumnAggregate() : count(0), sum(0.0), min(0.0), max(0.0) {}
+
+    double average() const { return count == 0 ? 0.0 : sum / count; }
+};
+
+/**
+ * Aggregate Selected Slots
+ *
+ * Folds one column of the slots set in a filterBlock() bitmap into an
+ * aggregate. Only the column is read (one minipage for PAX blocks).
+ *
+ * @param block Block the bitmap was computed for
+ * @param selection Bitmap of Block::BITMAP_WORDS words
+ * @param field Column to aggregate
+ * @param aggregate Running aggregate to update
+ */
+void aggregateSelected(const Block& block, const uint32_t* selection, RecordField field, ColumnAggregate& aggregate);
+
+/**
+ * Aggregate Scan
+ *
+ * Scans the database with Database::scanBlocks, filters each block with
+ * the predicate and aggregates one column of the matches, in block and
+ * slot order, without materializing records.
+ *
+ * @param db Database to scan
+ * @param predicate Conjunction to evaluate
+ * @param field Column to aggregate
+ * @param result Receives the aggregate
+ * @param batch_blocks Blocks per read (1 = block by block through the buffer pool)
+ * @return Number of blocks scanned (blocks skipped by the zone map are not counted)
+ */
+int aggregateScan(Database& db, const ScanPredicate& predicate, RecordField field, ColumnAggregate& result,
+                  int batch_blocks = APPEND_BATCH_BLOCKS);
+
+/**
+ * Vectorized Scan
+ *
+ * Scans the database with Database::scanBlocks, filters each block with
+ * the predicate and materializes only the selected records.
+ *
+ * @param db Database to scan
+ * @param predicate Conjunction to evaluate
+ * @param emit Called as emit(record, block_id, record_index) per match, in block
+ *        order; like a scanBlocks callback it must not call Database methods
+ * @param batch_blocks Blocks per read (1 = block by block through the buffer pool)
+ * @return Number of blocks scanned (blocks skipped by the zone map are not counted)
+ */
+int vectorScan(Database& db, const ScanPredicate& predicate, const Database::ScanCallback& emit,
+               int batch_blocks = APPEND_BATCH_BLOCKS);
+
+/**
+ * Parallel Vectorized Scan
+ *
+ * vectorScan() over Database::parallelScanBlocks: pieces of the table are
+ * filtered on several threads with work stealing.
+ *
+ * @param db Database to scan
+ * @param predicate Conjunction to evaluate
+ * @param emit Called as emit(record, block_id, record_index, worker) per match;
+ *        called concurrently for different workers, in block order within a
+ *        piece but not across pieces
+ * @param num_threads Number of workers (0 = one per hardware thread)
+ * @param batch_blocks Blocks per work piece
+ * @return Number of blocks scanned (blocks skipped by the zone map are not counted)
+ */
+int parallelVectorScan(Database& db, const ScanPredicate& predicate, const Database::PartitionScanCallback& emit,
+                       int num_threads = 0, int batch_blocks = SCAN_STEAL_BLOCKS);
+
+#endif // VECTOR_SCAN_H
@@ -0,0 +1,263 @@
+/**
+ * SC3020 Database Management System
+ * Compressed Archive Implementation
+ *
+ * This file contains the implementation of ArchiveFile: building the
+ * archive from a database and reading it back through the block directory.
+ *
+ */
+
+#include "archive.h"
+#include "block_codec.h"
+#include <fstream>     // For writing the archive
+#include <algorithm>   // For std::sort, std::unique, std::min
+#include <cstring>     // For memcpy, memcmp
+#include <cerrno>      // For EINTR
+#include <fcntl.h>     // For open
+#include <unistd.h>    // For pread, close
+#include <sys/stat.h>  // For fstat
+
+namespace {
+
+const char ARCHIVE_MAGIC[4] = {'A', 'R', 'C', '1'};
+
+/**
+ * Read Fully at Offset
+ *
+ * @return true if length bytes were read
+ */
+bool preadFully(int fd, char* buffer, size_t length, int64_t offset) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = pread(fd, buffer + done, length - done, static_cast<off_t>(offset + static_cast<int64_t>(done)));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * Archive Constructor
+ *
+ * The cache writes nothing back: the archive is read-only.
+ */
+ArchiveFile::ArchiveFile(const std::string& path, int cache_blocks)
+    : path(path), fd(-1), num_blocks(0), num_records(0), file_size(0),
+      cache(static_cast<size_t>(std::max(1, cache_blocks)), ReplacementPolicy::LRU,
+            [this](int block_id, Block& block) { return loadBlock(block_id, block); },
+            [](int, const Block&) { return false; }),
+      bytes_read(0), blocks_decoded(0) {}
+
+ArchiveFile::~ArchiveFile() {
+    close();
+}
+
+/**
+ * Build Archive
+ *
+ * Algorithm:
+ * 1. Write a placeholder header
+ * 2. Compress each batch of blocks from scanBlocks() and append the frames
+ * 3. Append the block directory
+ * 4. Rewrite the header with the block count and the directory offset
+ *
+ * @param db Open database
+ * @param path Path of the archive to write
+ * @return true if the archive was written completely
+ */
+bool ArchiveFile::build(Database& db, const std::string& path) {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    // Step 1: Placeholder header
+    Header header;
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.num_blocks = 0;
+    header.num_records = 0;
+    header.directory_offset = 0;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Step 2: Frames, one write per batch
+    std::vector<DirectoryEntry> directory;
+    directory.reserve(db.getNumBlocks());
+    int64_t offset = sizeof(header);
+    std::vector<char> frames;
+    db.scanBlocks([&](const Block* blocks, int, int count) {
+        frames.clear();
+        for (int b = 0; b < count; b++) {
+            DirectoryEntry entry;
+            entry.offset = offset + static_cast<int64_t>(frames.size());
+            entry.length = static_cast<uint32_t>(BlockCodec::encode(blocks[b], frames));
+            entry.num_records = blocks[b].header.num_records;
+            directory.push_back(entry);
+            header.num_records += entry.num_records;
+        }
+        out.write(&frames[0], static_cast<std::streamsize>(frames.size()));
+        offset += static_cast<int64_t>(frames.size());
+    }, APPEND_BATCH_BLOCKS);
+    if (static_cast<int>(directory.size()) != db.getNumBlocks()) return false;
+
+    // Step 3: Block directory
+    if (!directory.empty()) {
+        out.write(reinterpret_cast<const char*>(&directory[0]),
+                  static_cast<std::streamsize>(directory.size() * sizeof(DirectoryEntry)));
+    }
+
+    // Step 4: Final header
+    header.num_blocks = static_cast<int32_t>(directory.size());
+    header.directory_offset = offset;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+    return out.good();
+}
+
+/**
+ * Open Archive
+ *
+ * @return true if the header and directory are consistent with the file size
+ */
+bool ArchiveFile::open() {
+    if (isOpen()) return true;
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    Header header;
+    if (fstat(fd, &info) != 0 || !preadFully(fd, reinterpret_cast<char*>(&header), sizeof(header), 0) ||
+        memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0 || header.num_blocks < 0 ||
+        header.directory_offset < static_cast<int64_t>(sizeof(header)) ||
+        header.directory_offset + static_cast<int64_t>(header.num_blocks) * static_cast<int64_t>(sizeof(DirectoryEntry)) !=
+            static_cast<int64_t>(info.st_size)) {
+        close();
+        return false;
+    }
+
+    directory.resize(header.num_blocks);
+    if (header.num_blocks > 0 &&
+        !preadFully(fd, reinterpret_cast<char*>(&directory[0]), directory.size() * sizeof(DirectoryEntry),
+                    header.directory_offset)) {
+        close();
+        return false;
+    }
+    for (size_t i = 0; i < directory.size(); i++) {
+        if (directory[i].offset < static_cast<int64_t>(sizeof(header)) ||
+            directory[i].offset + directory[i].length > header.directory_offset) {
+            close();
+            return false;
+        }
+    }
+
+    num_blocks = header.num_blocks;
+    num_records = header.num_records;
+    file_size = static_cast<long long>(info.st_size);
+    return true;
+}
+
+void ArchiveFile::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    cache.reset();
+    directory.clear();
+    num_blocks = 0;
+    num_records = 0;
+    file_size = 0;
+}
+
+bool ArchiveFile::readFrames(int first, int count, std::vector<char>& buffer) {
+    const DirectoryEntry& last = directory[first + count - 1];
+    size_t length = static_cast<size_t>(last.offset + last.length - directory[first].offset);
+    buffer.resize(length);
+    if (length > 0 && !preadFully(fd, &buffer[0], length, directory[first].offset)) return false;
+    bytes_read += static_cast<long long>(length);
+    return true;
+}
+
+bool ArchiveFile::loadBlock(int block_id, Block& block) {
+    if (!isOpen() || block_id < 0 || block_id >= num_blocks) return false;
+    std::vector<char> frame;
+    if (!readFrames(block_id, 1, frame)) return false;
+    blocks_decoded++;
+    return BlockCodec::decode(frame.empty() ? nullptr : &frame[0], frame.size(), block);
+}
+
+bool ArchiveFile::getRecord(const RecordPointer& pointer, Record& record) {
+    if (pointer.block_id < 0 || pointer.block_id >= num_blocks) return false;
+    Block* block = cache.fetchBlock(pointer.block_id);
+    if (block == nullptr) return false;
+    bool live = block->isOccupied(pointer.record_index);
+    if (live) record = block->getRecord(pointer.record_index);
+    cache.unpinBlock(pointer.block_id, false);
+    return live;
+}
+
+/**
+ * Scan Blocks
+ *
+ * Frames of consecutive blocks are adjacent in the file, so a batch is one
+ * read from the first frame's offset to the end of the last frame.
+ */
+int ArchiveFile::scanBlocks(const Database::BlockScanCallback& callback, int batch_blocks) {
+    if (!isOpen()) return 0;
+    batch_blocks = std::max(1, batch_blocks);
+    std::vector<char> frames;
+    std::vector<Block> batch(std::min(batch_blocks, std::max(num_blocks, 1)));
+    int blocks_scanned = 0;
+
+    for (int first = 0; first < num_blocks; first += batch_blocks) {
+        int count = std::min(batch_blocks, num_blocks - first);
+        if (!readFrames(first, count, frames)) return -1;
+        for (int b = 0; b < count; b++) {
+            const DirectoryEntry& entry = directory[first + b];
+            size_t start = static_cast<size_t>(entry.offset - directory[first].offset);
+            if (!BlockCodec::decode(&frames[0] + start, entry.length, batch[b])) return -1;
+        }
+        blocks_decoded += count;
+        blocks_scanned += count;
+        callback(&batch[0], first, count);
+    }
+    return blocks_scanned;
+}
+
+/**
+ * Fetch Records in Batch
+ *
+ * Pointers outside the archive or to free slots are skipped.
+ */
+int ArchiveFile::fetchBatch(const std::vector<RecordPointer>& pointers, const Database::FetchCallback& visitor) {
+    std::vector<RecordPointer> sorted(pointers);
+    std::sort(sorted.begin(), sorted.end(), [](const RecordPointer& a, const RecordPointer& b) {
+        return a.block_id != b.block_id ? a.block_id < b.block_id : a.record_index < b.record_index;
+    });
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), [](const RecordPointer& a, const RecordPointer& b) {
+        return a.block_id == b.block_id && a.record_index == b.record_index;
+    }), sorted.end());
+
+    int blocks_read = 0;
+    size_t i = 0;
+    while (i < sorted.size()) {
+        int block_id = sorted[i].block_id;
+        size_t end = i;
+        while (end < sorted.size() && sorted[end].block_id == block_id) end++;
+        if (block_id >= 0 && block_id < num_blocks) {
+            Block* block = cache.fetchBlock(block_id);
+            if (block == nullptr) return -1;
+            blocks_read++;
+            for (; i < end; i++) {
+                if (block->isOccupied(sorted[i].record_index)) visitor(block->getRecord(sorted[i].record_index), sorted[i]);
+            }
+            cache.unpinBlock(block_id, false);
+        }
+        i = end;
+    }
+    return blocks_read;
+}
+
+void ArchiveFile::resetIOCounters() {
+    bytes_read = 0;
+    blocks_decoded = 0;
+    cache.resetCounters();
+}
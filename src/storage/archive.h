@@ -0,0 +1,187 @@
+/**
+ * SC3020 Database Management System
+ * Compressed Archive Header
+ *
+ * This file defines ArchiveFile, a read-only compressed copy of the heap
+ * file for cold data. Every heap block is compressed with BlockCodec and
+ * the frames are stored back to back, followed by a block directory:
+ *
+ *   [header][frame 0][frame 1]...[frame n-1][directory]
+ *
+ * The directory holds the offset and length of every frame, so block i is
+ * one positioned read away. Decompressed blocks are cached in a BufferPool
+ * (the pool's read callback reads and decodes the frame), while batched
+ * scans read runs of consecutive frames with one sequential read each and
+ * bypass the pool, like Database::scanBlocks.
+ *
+ * Blocks keep their IDs and records keep their slots, so RecordPointers
+ * into the heap the archive was built from (e.g. B+ tree results) can be
+ * fetched from the archive. The heap file stays uncompressed: in-place
+ * updates, deletes and the WAL's page images all need fixed-size blocks.
+ *
+ * An ArchiveFile is used by one thread at a time.
+ */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+// Include storage components
+#include "database.h"
+#include "buffer_pool.h"
+
+// Standard C++ libraries
+#include <string>    // For file paths
+#include <vector>    // For the block directory
+#include <cstdint>   // For file offsets
+
+static const int DEFAULT_ARCHIVE_CACHE_BLOCKS = 64;   // Decompressed blocks cached per archive
+
+/**
+ * Archive File Class
+ */
+class ArchiveFile {
+public:
+    /**
+     * Constructor
+     *
+     * @param path Path to the archive file
+     * @param cache_blocks Frames of the decompressed-block cache
+     */
+    explicit ArchiveFile(const std::string& path, int cache_blocks = DEFAULT_ARCHIVE_CACHE_BLOCKS);
+
+    ~ArchiveFile();
+
+    /**
+     * Build Archive
+     *
+     * Compresses every block of an open database into a new archive file,
+     * replacing any existing one. The heap is read with a batched
+     * scanBlocks(), so memory use does not grow with the table.
+     *
+     * @param db Open database
+     * @param path Path of the archive to write
+     * @return true if the archive was written completely
+     */
+    static bool build(Database& db, const std::string& path);
+
+    /**
+     * Open Archive
+     *
+     * Reads and checks the header and the block directory.
+     *
+     * @return true if the archive is open
+     */
+    bool open();
+
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * Get Record
+     *
+     * Reads one record through the decompressed-block cache.
+     *
+     * @param pointer Record location
+     * @param record Receives the record
+     * @return false if the slot is free or out of range, or the read failed
+     */
+    bool getRecord(const RecordPointer& pointer, Record& record);
+
+    /**
+     * Scan Blocks
+     *
+     * Visits every block in order, decompressed, batch_blocks at a time.
+     * Each batch of frames is read with one sequential read and decoded
+     * into a scan buffer, bypassing the cache. Same callback contract as
+     * Database::scanBlocks.
+     *
+     * @param callback Function called as callback(blocks, first_block_id, count)
+     * @param batch_blocks Blocks per callback
+     * @return Number of blocks scanned, or -1 if a read or decode failed
+     */
+    int scanBlocks(const Database::BlockScanCallback& callback, int batch_blocks = APPEND_BATCH_BLOCKS);
+
+    /**
+     * Fetch Records in Batch
+     *
+     * Like Database::fetchBatch (visitor form): the pointers are sorted and
+     * each block is fetched once, through the decompressed-block cache.
+     *
+     * @param pointers Record locations, in any order, duplicates allowed
+     * @param visitor Called once per distinct live pointer, in (block, slot) order
+     * @return Number of blocks read, or -1 if a read or decode failed
+     */
+    int fetchBatch(const std::vector<RecordPointer>& pointers, const Database::FetchCallback& visitor);
+
+    // Statistics
+    int getNumBlocks() const { return num_blocks; }
+    long long getNumRecords() const { return num_records; }
+    long long getFileSize() const { return file_size; }
+    long long getUncompressedSize() const { return static_cast<long long>(num_blocks) * Block::BLOCK_SIZE; }
+    long long getBytesRead() const { return bytes_read; }
+    long long getBlocksDecoded() const { return blocks_decoded; }
+    const BufferPool& getCache() const { return cache; }
+
+    /**
+     * Reset I/O Counters
+     *
+     * Resets the read and decode counters and the cache counters.
+     */
+    void resetIOCounters();
+
+private:
+    /**
+     * Archive Header Structure
+     *
+     * First bytes of the file; rewritten once the directory is in place.
+     */
+    struct Header {
+        char magic[4];              // "ARC1"
+        int32_t num_blocks;         // Blocks in the archive
+        int64_t num_records;        // Live records in the archive
+        int64_t directory_offset;   // Byte offset of the block directory
+    };
+
+    /**
+     * Directory Entry Structure
+     */
+    struct DirectoryEntry {
+        int64_t offset;        // Byte offset of the frame
+        uint32_t length;       // Frame size in bytes
+        uint32_t num_records;  // Live records in the block
+    };
+
+    ArchiveFile(const ArchiveFile&);
+    ArchiveFile& operator=(const ArchiveFile&);
+
+    /**
+     * Read Frames
+     *
+     * Reads the frames of blocks [first, first + count) with one read.
+     *
+     * @param first First block ID
+     * @param count Number of blocks
+     * @param buffer Receives the frames back to back
+     * @return true if every byte was read
+     */
+    bool readFrames(int first, int count, std::vector<char>& buffer);
+
+    /**
+     * Load Block
+     *
+     * Cache read callback: reads and decodes one frame.
+     */
+    bool loadBlock(int block_id, Block& block);
+
+    std::string path;                       // Path to the archive file
+    int fd;                                 // File descriptor (-1 when closed)
+    int num_blocks;                         // Blocks in the archive
+    long long num_records;                  // Live records in the archive
+    long long file_size;                    // Archive size in bytes
+    std::vector<DirectoryEntry> directory;  // Frame of every block
+    BufferPool cache;                       // Decompressed blocks
+    long long bytes_read;                   // Compressed bytes read
+    long long blocks_decoded;               // Frames decoded
+};
+
+#endif // ARCHIVE_H
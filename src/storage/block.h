@@ -16,48 +16,95 @@
 // Standard C++ libraries
 #include <vector>   // For dynamic arrays
 #include <cstring>  // For memory operations
+#include <cstdint>  // For fixed-width bitmap words
+#include <cstddef>  // For offsetof
+
+/**
+ * Block Layout Enumeration
+ * 
+ * How the records of a block are arranged in its data area. Stored in the
+ * block header, so one file may hold blocks of both layouts.
+ */
+enum class BlockLayout : uint8_t {
+    NSM = 0,   // Row-oriented: whole Records back to back, one slot after another
+    PAX = 1    // Column-oriented: one minipage per field, values in slot order
+};
 
 /**
  * Block Header Structure
  * 
  * Contains metadata about the block including block ID, record count,
  * and pointer to next block. The header is padded to ensure proper alignment.
+ * 
+ * Slots are filled in order up to num_slots; a deleted record leaves a hole
+ * below num_slots. Blocks with holes are chained through next_block into
+ * the database's free-block list.
  */
 struct BlockHeader {
     int block_id;              // Unique identifier for this block
-    int num_records;           // Number of records currently stored in this block
-    int next_block;            // Pointer to next block (-1 if this is the last block)
-    char padding[4];           // Padding to make header exactly 16 bytes
+    int num_records;           // Number of live records in this block
+    int next_block;            // Next block in the free-block list (-1 if none)
+    uint16_t num_slots;        // Slots in use, live or deleted (high-water mark)
+    uint8_t layout;            // BlockLayout of the data area (zero = NSM)
+    char padding[1];           // Padding to make header exactly 16 bytes
     
     /**
      * Default Constructor
      * 
      * Initializes header fields with default values.
      */
-    BlockHeader() : block_id(0), num_records(0), next_block(-1) {
+    BlockHeader() : block_id(0), num_records(0), next_block(-1), num_slots(0), layout(0) {
         memset(padding, 0, sizeof(padding));
     }
 };
 
+/**
+ * Column Span Structure
+ * 
+ * The values of one field in slots [0, count) of a block: slot i's value
+ * starts at data + i * stride. For PAX blocks the stride is the field size
+ * (a dense array); for NSM blocks it is sizeof(Record).
+ */
+struct ColumnSpan {
+    const char* data;   // Value of slot 0
+    size_t stride;      // Bytes from one slot's value to the next
+    int count;          // Slots covered (num_slots)
+    
+    const char* at(int slot) const { return data + slot * stride; }
+};
+
 /**
  * Block Structure
  * 
- * Represents a 4096-byte storage unit that can hold multiple records.
- * The block consists of a header followed by a data area for records.
+ * Represents a 4096-byte slotted page that can hold multiple records.
+ * The block consists of a header, an occupancy bitmap with one bit per
+ * slot, and a data area of fixed-size record slots.
  * 
  * Block Layout:
  * - Header: 16 bytes (BlockHeader)
- * - Data Area: 4080 bytes (for storing records)
+ * - Slot bitmap: 16 bytes (bit i set = slot i holds a live record)
+ * - Data Area: 4064 bytes (for storing records)
  * - Total Size: 4096 bytes (standard disk block size)
+ * 
+ * In an NSM block slot i is the Record at data + i * sizeof(Record). In a
+ * PAX block the field at Record offset o is kept in a minipage starting at
+ * data + o * MAX_RECORDS, with slot i's value i field sizes into it. The
+ * minipages follow Record order and take the same space as the NSM
+ * slots, so both layouts hold MAX_RECORDS records and a slot (and every
+ * RecordPointer) means the same record in either.
  */
 struct Block {
     static const int BLOCK_SIZE = 4096;                    // Total block size in bytes
     static const int HEADER_SIZE = sizeof(BlockHeader);    // Size of block header
-    static const int DATA_SIZE = BLOCK_SIZE - HEADER_SIZE; // Size of data area
+    static const int BITMAP_WORDS = 4;                     // 32-bit words in the slot bitmap
+    static const int BITMAP_SIZE = BITMAP_WORDS * sizeof(uint32_t); // Size of slot bitmap
+    static const int DATA_SIZE = BLOCK_SIZE - HEADER_SIZE - BITMAP_SIZE; // Size of data area
     static const int MAX_RECORDS = DATA_SIZE / sizeof(Record); // Maximum records per block
+    static const int NUM_COLUMNS = 9;                      // Fields of Record (PAX minipages)
     
-    BlockHeader header;        // Block metadata
-    char data[DATA_SIZE];      // Data area for storing records
+    BlockHeader header;                  // Block metadata
+    uint32_t slot_bitmap[BITMAP_WORDS];  // Occupancy bitmap
+    char data[DATA_SIZE];                // Data area for storing records
     
     /**
      * Default Constructor
@@ -65,32 +112,70 @@ struct Block {
      * Initializes the block with zero values.
      */
     Block() {
-        memset(this, 0, sizeof(Block));
+        clear();
     }
     
     /**
      * Add Record to Block
      * 
-     * Attempts to add a record to the block's data area.
-     * Records are stored sequentially in the data area.
+     * Appends a record in the next unused slot (after num_slots).
+     * Holes left by deletions are not reused; see insertRecord().
      * 
      * @param record The record to add
      * @return true if record was added successfully, false if block is full
      */
     bool addRecord(const Record& record) {
-        // Check if block has space for another record
-        if (header.num_records >= MAX_RECORDS) {
+        // Check if block has an unused slot left
+        if (header.num_slots >= MAX_RECORDS) {
             return false; // Block is full
         }
         
-        // Calculate offset for the new record
-        size_t offset = header.num_records * sizeof(Record);
+        int slot = header.num_slots++;
+        putRecord(slot, record);
         
-        // Copy record to the data area
-        memcpy(data + offset, &record, sizeof(Record));
+        return true;
+    }
+    
+    /**
+     * Insert Record into Block
+     * 
+     * Stores a record in the lowest free slot, reusing holes before
+     * appending.
+     * 
+     * @param record The record to insert
+     * @return Slot index used, or -1 if the block has no free slot
+     */
+    int insertRecord(const Record& record) {
+        int slot = firstFreeSlot();
+        if (slot == -1) {
+            if (header.num_slots >= MAX_RECORDS) return -1;
+            slot = header.num_slots++;
+        }
+        putRecord(slot, record);
+        return slot;
+    }
+    
+    /**
+     * Remove Record from Block
+     * 
+     * Clears the slot's occupancy bit and zeroes its bytes. num_slots is
+     * unchanged, so the slot becomes a hole.
+     * 
+     * @param index Slot to free
+     * @return true if the slot held a live record
+     */
+    bool removeRecord(int index) {
+        if (!isOccupied(index)) return false;
         
-        // Increment record count
-        header.num_records++;
+        slot_bitmap[index / 32] &= ~(1u << (index % 32));
+        if (getLayout() == BlockLayout::PAX) {
+            for (int c = 0; c < NUM_COLUMNS; c++) {
+                memset(data + paxOffset(c, index), 0, columnSize(c));
+            }
+        } else {
+            memset(data + index * sizeof(Record), 0, sizeof(Record));
+        }
+        header.num_records--;
         
         return true;
     }
@@ -101,30 +186,186 @@ struct Block {
      * Retrieves a record from the specified index in the block.
      * 
      * @param index Index of the record to retrieve
-     * @return Record at the specified index, or empty record if index is invalid
+     * @return Record at the specified index, or empty record if the index
+     *         is invalid or the slot is free
      */
     Record getRecord(int index) const {
         // Check if index is valid
-        if (index >= header.num_records) {
-            return Record(); // Return empty record if index out of bounds
+        if (!isOccupied(index)) {
+            return Record(); // Return empty record if slot is out of bounds or free
         }
         
-        // Calculate offset for the requested record
-        size_t offset = index * sizeof(Record);
-        
         // Create record and copy data from block
         Record record;
-        memcpy(&record, data + offset, sizeof(Record));
+        if (getLayout() == BlockLayout::PAX) {
+            for (int c = 0; c < NUM_COLUMNS; c++) {
+                memcpy(reinterpret_cast<char*>(&record) + columnOffset(c), data + paxOffset(c, index), columnSize(c));
+            }
+        } else {
+            memcpy(&record, data + index * sizeof(Record), sizeof(Record));
+        }
         
         return record;
     }
     
+    /**
+     * Copy Slots Out
+     * 
+     * Copies slots [0, count) out as Records, live or not (free slots are
+     * zeroed in both layouts).
+     * 
+     * @param records Output array of count Records
+     * @param count Slots to copy (at most MAX_RECORDS)
+     */
+    void copySlots(Record* records, int count) const {
+        if (getLayout() != BlockLayout::PAX) {
+            memcpy(records, data, count * sizeof(Record));
+            return;
+        }
+        for (int i = 0; i < count; i++) records[i] = Record();
+        for (int c = 0; c < NUM_COLUMNS; c++) {
+            const char* value = data + paxOffset(c, 0);
+            for (int i = 0; i < count; i++, value += columnSize(c)) {
+                memcpy(reinterpret_cast<char*>(&records[i]) + columnOffset(c), value, columnSize(c));
+            }
+        }
+    }
+    
+    /**
+     * Place Record in Slot
+     * 
+     * Stores a record in a given free slot, raising num_slots past it if
+     * needed. Used to rebuild a block slot by slot.
+     * 
+     * @param index Slot to fill
+     * @param record The record to store
+     * @return false if the slot is out of range or already occupied
+     */
+    bool placeRecord(int index, const Record& record) {
+        if (index < 0 || index >= MAX_RECORDS || isOccupied(index)) return false;
+        if (index >= header.num_slots) header.num_slots = static_cast<uint16_t>(index + 1);
+        putRecord(index, record);
+        return true;
+    }
+    
+    /**
+     * Get Layout
+     * 
+     * @return Arrangement of the data area
+     */
+    BlockLayout getLayout() const {
+        return static_cast<BlockLayout>(header.layout);
+    }
+    
+    /**
+     * Get Column
+     * 
+     * The values of one field in the used slots, without copying. Only
+     * the bytes of the field are touched when a PAX span is read.
+     * 
+     * @param field_offset offsetof(Record, field)
+     * @param field_size sizeof the field
+     * @return Span of num_slots values (free slots read as zeros)
+     */
+    ColumnSpan getColumn(size_t field_offset, size_t field_size) const {
+        ColumnSpan span;
+        span.count = header.num_slots;
+        if (getLayout() == BlockLayout::PAX) {
+            span.data = data + field_offset * MAX_RECORDS;
+            span.stride = field_size;
+        } else {
+            span.data = data + field_offset;
+            span.stride = sizeof(Record);
+        }
+        return span;
+    }
+    
+    /**
+     * Convert Layout
+     * 
+     * Rearranges the data area into another layout in place. Slots, the
+     * bitmap and the rest of the header are unchanged.
+     * 
+     * @param layout Target layout
+     */
+    void convertLayout(BlockLayout layout) {
+        if (layout == getLayout()) return;
+        int count = header.num_slots < MAX_RECORDS ? header.num_slots : MAX_RECORDS;
+        Record records[MAX_RECORDS];
+        copySlots(records, count);
+        memset(data, 0, sizeof(data));
+        header.layout = static_cast<uint8_t>(layout);
+        for (int i = 0; i < count; i++) {
+            if (isOccupied(i)) storeRecord(i, records[i]);
+        }
+    }
+    
+    /**
+     * Check Slot Occupancy
+     * 
+     * @param index Slot index
+     * @return true if the slot holds a live record
+     */
+    bool isOccupied(int index) const {
+        if (index < 0 || index >= header.num_slots) return false;
+        return (slot_bitmap[index / 32] >> (index % 32)) & 1u;
+    }
+    
+    /**
+     * Find First Free Slot
+     * 
+     * Searches the bitmap for the lowest hole below num_slots.
+     * 
+     * @return Slot index, or -1 if every used slot is occupied
+     */
+    int firstFreeSlot() const {
+        if (!hasHoles()) return -1;
+        for (int w = 0; w < BITMAP_WORDS; w++) {
+            uint32_t free_bits = ~slot_bitmap[w];
+            if (free_bits == 0) continue;
+            int slot = w * 32 + __builtin_ctz(free_bits);
+            return slot < header.num_slots ? slot : -1;
+        }
+        return -1;
+    }
+    
+    /**
+     * Find Last Occupied Slot
+     * 
+     * @return Highest slot holding a live record, or -1 if the block is empty
+     */
+    int lastOccupiedSlot() const {
+        for (int w = BITMAP_WORDS - 1; w >= 0; w--) {
+            if (slot_bitmap[w] != 0) return w * 32 + 31 - __builtin_clz(slot_bitmap[w]);
+        }
+        return -1;
+    }
+    
+    /**
+     * Trim Unused Slots
+     * 
+     * Lowers num_slots to just past the last live record, so free slots at
+     * the end of the block become append space instead of holes.
+     */
+    void trimSlots() {
+        header.num_slots = static_cast<uint16_t>(lastOccupiedSlot() + 1);
+    }
+    
+    /**
+     * Check for Holes
+     * 
+     * @return true if a deleted slot below num_slots can be reused
+     */
+    bool hasHoles() const {
+        return header.num_records < header.num_slots;
+    }
+    
     /**
      * Check if Block is Full
      * 
      * Determines whether the block can hold more records.
      * 
-     * @return true if block is full, false otherwise
+     * @return true if every slot holds a live record, false otherwise
      */
     bool isFull() const {
         return header.num_records >= MAX_RECORDS;
@@ -133,7 +374,7 @@ struct Block {
     /**
      * Get Number of Records in Block
      * 
-     * Returns the current number of records stored in this block.
+     * Returns the current number of live records stored in this block.
      * 
      * @return Number of records in the block
      */
@@ -141,13 +382,28 @@ struct Block {
         return header.num_records;
     }
     
+    /**
+     * Get Number of Slots in Use
+     * 
+     * Returns the slot high-water mark (live records plus holes).
+     * 
+     * @return Number of used slots
+     */
+    int getNumSlots() const {
+        return header.num_slots;
+    }
+    
     /**
      * Clear Block
      * 
      * Resets the block to its initial state by zeroing all data.
+     * 
+     * @param layout Layout of the empty block
      */
-    void clear() {
+    void clear(BlockLayout layout = BlockLayout::NSM) {
         memset(this, 0, sizeof(Block));
+        header.next_block = -1;
+        header.layout = static_cast<uint8_t>(layout);
     }
     
     /**
@@ -158,11 +414,70 @@ struct Block {
     void printInfo() const {
         std::cout << "Block " << header.block_id 
                   << ": " << header.num_records 
-                  << " records, Next: " << header.next_block << std::endl;
+                  << " records in " << header.num_slots
+                  << " slots, Next: " << header.next_block << std::endl;
+    }
+    
+private:
+    /**
+     * Put Record
+     * 
+     * Copies a record into a slot and marks the slot occupied. The caller
+     * has already made sure the slot lies below num_slots.
+     */
+    void putRecord(int index, const Record& record) {
+        storeRecord(index, record);
+        slot_bitmap[index / 32] |= 1u << (index % 32);
+        header.num_records++;
+    }
+    
+    /**
+     * Store Record
+     * 
+     * Writes a record's bytes into a slot in the block's layout.
+     */
+    void storeRecord(int index, const Record& record) {
+        if (getLayout() == BlockLayout::PAX) {
+            for (int c = 0; c < NUM_COLUMNS; c++) {
+                memcpy(data + paxOffset(c, index), reinterpret_cast<const char*>(&record) + columnOffset(c), columnSize(c));
+            }
+        } else {
+            memcpy(data + index * sizeof(Record), &record, sizeof(Record));
+        }
+    }
+    
+    /**
+     * Column Offset and Size
+     * 
+     * Position of field c (in Record order) within a Record.
+     */
+    static size_t columnOffset(int c) {
+        static const size_t offsets[NUM_COLUMNS] = {
+            offsetof(Record, game_date), offsetof(Record, team_id_home), offsetof(Record, pts_home),
+            offsetof(Record, fg_pct_home), offsetof(Record, ft_pct_home), offsetof(Record, fg3_pct_home),
+            offsetof(Record, ast_home), offsetof(Record, reb_home), offsetof(Record, home_team_wins)
+        };
+        return offsets[c];
+    }
+    
+    static size_t columnSize(int c) {
+        return c == 0 ? sizeof(Record::game_date) : sizeof(int32_t);
+    }
+    
+    /**
+     * PAX Value Offset
+     * 
+     * @return Offset in data of field c of slot index in a PAX block
+     */
+    static size_t paxOffset(int c, int index) {
+        return columnOffset(c) * MAX_RECORDS + index * columnSize(c);
     }
 };
 
 // Enforce expected structure sizes to avoid platform-dependent padding surprises
 static_assert(sizeof(BlockHeader) == 16, "BlockHeader must be 16 bytes");
+static_assert(sizeof(Block) == Block::BLOCK_SIZE, "Block must be exactly one 4096-byte page");
+static_assert(Block::MAX_RECORDS <= Block::BITMAP_WORDS * 32, "Slot bitmap too small for MAX_RECORDS");
+static_assert(offsetof(Record, home_team_wins) + sizeof(int32_t) == sizeof(Record), "PAX minipages must end with the Record");
 
 #endif // BLOCK_H
@@ -0,0 +1,321 @@
+/**
+ * SC3020 Database Management System
+ * Block Codec Implementation
+ *
+ * This file contains the column encoders and decoders of BlockCodec and
+ * the bit-packing helpers they share.
+ *
+ */
+
+#include "block_codec.h"
+#include <algorithm>  // For std::min_element, std::max_element, std::find
+#include <cstring>    // For memcpy, memcmp
+#include <cmath>      // For llround
+#include <cstdint>    // For fixed-width fields
+#include <cstddef>    // For offsetof
+#include <string>     // For dictionary entries
+
+namespace {
+
+/**
+ * Frame Header Structure
+ *
+ * Block fields stored before the columns.
+ */
+struct FrameHeader {
+    int32_t block_id;                        // BlockHeader::block_id
+    int32_t next_block;                      // BlockHeader::next_block
+    uint16_t num_slots;                      // BlockHeader::num_slots
+    uint16_t num_records;                    // BlockHeader::num_records
+    uint8_t layout;                          // BlockHeader::layout
+    uint8_t reserved[3];                     // Zero
+    uint32_t slot_bitmap[Block::BITMAP_WORDS]; // Occupancy bitmap
+};
+
+/**
+ * Bits Needed
+ *
+ * @param range Largest value to represent
+ * @return Width in bits (0 when range is 0)
+ */
+int bitsFor(uint64_t range) {
+    int bits = 0;
+    while (range > 0) {
+        bits++;
+        range >>= 1;
+    }
+    return bits;
+}
+
+/**
+ * Append Bit-Packed Values
+ *
+ * Values of width bits each, least significant bit first.
+ */
+void packBits(const std::vector<uint64_t>& values, int width, std::vector<char>& out) {
+    if (width == 0) return;
+    size_t start = out.size();
+    out.resize(start + (values.size() * width + 7) / 8, 0);
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(&out[start]);
+    size_t bit = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        for (int b = 0; b < width; b++, bit++) {
+            if ((values[i] >> b) & 1u) bytes[bit / 8] |= static_cast<unsigned char>(1u << (bit % 8));
+        }
+    }
+}
+
+/**
+ * Frame Reader Class
+ *
+ * Bounds-checked cursor over a frame.
+ */
+class FrameReader {
+public:
+    FrameReader(const char* data, size_t length) : data(data), length(length), pos(0) {}
+
+    bool read(void* dst, size_t count) {
+        if (count > length - pos) return false;
+        memcpy(dst, data + pos, count);
+        pos += count;
+        return true;
+    }
+
+    bool unpackBits(size_t count, int width, std::vector<uint64_t>& values) {
+        values.assign(count, 0);
+        if (width == 0) return true;
+        if (width > 64) return false;
+        size_t bytes = (count * width + 7) / 8;
+        if (bytes > length - pos) return false;
+        const unsigned char* packed = reinterpret_cast<const unsigned char*>(data + pos);
+        size_t bit = 0;
+        for (size_t i = 0; i < count; i++) {
+            for (int b = 0; b < width; b++, bit++) {
+                if ((packed[bit / 8] >> (bit % 8)) & 1u) values[i] |= static_cast<uint64_t>(1) << b;
+            }
+        }
+        pos += bytes;
+        return true;
+    }
+
+    bool atEnd() const { return pos == length; }
+
+private:
+    const char* data;
+    size_t length;
+    size_t pos;
+};
+
+/**
+ * Append Frame-of-Reference Column
+ *
+ * Writes the minimum, the width and the bit-packed offsets from it.
+ */
+void appendFrameOfReference(const std::vector<int64_t>& values, std::vector<char>& out) {
+    int64_t base = *std::min_element(values.begin(), values.end());
+    int64_t top = *std::max_element(values.begin(), values.end());
+    uint8_t width = static_cast<uint8_t>(bitsFor(static_cast<uint64_t>(top - base)));
+    out.insert(out.end(), reinterpret_cast<const char*>(&base), reinterpret_cast<const char*>(&base) + sizeof(base));
+    out.push_back(static_cast<char>(width));
+
+    std::vector<uint64_t> offsets(values.size());
+    for (size_t i = 0; i < values.size(); i++) offsets[i] = static_cast<uint64_t>(values[i] - base);
+    packBits(offsets, width, out);
+}
+
+bool readFrameOfReference(FrameReader& reader, size_t count, std::vector<int64_t>& values) {
+    int64_t base = 0;
+    uint8_t width = 0;
+    std::vector<uint64_t> offsets;
+    if (!reader.read(&base, sizeof(base)) || !reader.read(&width, 1) || !reader.unpackBits(count, width, offsets)) {
+        return false;
+    }
+    values.resize(count);
+    for (size_t i = 0; i < count; i++) values[i] = base + static_cast<int64_t>(offsets[i]);
+    return true;
+}
+
+// Record fields in column order (game_date is encoded separately)
+const size_t INT_FIELDS[] = {offsetof(Record, team_id_home), offsetof(Record, pts_home), offsetof(Record, ast_home),
+                             offsetof(Record, reb_home), offsetof(Record, home_team_wins)};
+const size_t FLOAT_FIELDS[] = {offsetof(Record, fg_pct_home), offsetof(Record, ft_pct_home), offsetof(Record, fg3_pct_home)};
+
+} // namespace
+
+/**
+ * Encode Block
+ *
+ * Algorithm:
+ * 1. Write the frame header (IDs, slot count, bitmap)
+ * 2. Gather each column of the live records in slot order
+ * 3. game_date: dictionary of distinct strings + bit-packed indexes
+ * 4. Integer columns: frame of reference
+ * 5. Float columns: thousandths if every value survives the round trip,
+ *    otherwise the raw bits, then frame of reference
+ *
+ * @param block Block to compress
+ * @param out Buffer the frame is appended to
+ * @return Frame size in bytes
+ */
+size_t BlockCodec::encode(const Block& block, std::vector<char>& out) {
+    size_t start = out.size();
+
+    // Step 1: Frame header (num_slots clamped like the slots encoded, so decode() accepts it)
+    int slots = block.header.num_slots < Block::MAX_RECORDS ? block.header.num_slots : Block::MAX_RECORDS;
+    FrameHeader header;
+    header.block_id = block.header.block_id;
+    header.next_block = block.header.next_block;
+    header.num_slots = static_cast<uint16_t>(slots);
+    header.num_records = 0;
+    header.layout = block.header.layout;
+    memset(header.reserved, 0, sizeof(header.reserved));
+    memcpy(header.slot_bitmap, block.slot_bitmap, sizeof(header.slot_bitmap));
+
+    // Step 2: Live records in slot order
+    std::vector<Record> records;
+    for (int i = 0; i < slots; i++) {
+        if (block.isOccupied(i)) records.push_back(block.getRecord(i));
+    }
+    header.num_records = static_cast<uint16_t>(records.size());
+    out.insert(out.end(), reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header) + sizeof(header));
+    if (records.empty()) return out.size() - start;
+
+    // Step 3: game_date dictionary
+    std::vector<std::string> dictionary;
+    std::vector<uint64_t> indexes(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        std::string date(records[i].game_date, sizeof(records[i].game_date));
+        std::vector<std::string>::iterator it = std::find(dictionary.begin(), dictionary.end(), date);
+        indexes[i] = static_cast<uint64_t>(it - dictionary.begin());
+        if (it == dictionary.end()) dictionary.push_back(date);
+    }
+    uint8_t dictionary_size = static_cast<uint8_t>(dictionary.size());
+    uint8_t index_width = static_cast<uint8_t>(bitsFor(dictionary.size() - 1));
+    out.push_back(static_cast<char>(DICTIONARY));
+    out.push_back(static_cast<char>(dictionary_size));
+    for (size_t d = 0; d < dictionary.size(); d++) out.insert(out.end(), dictionary[d].begin(), dictionary[d].end());
+    out.push_back(static_cast<char>(index_width));
+    packBits(indexes, index_width, out);
+
+    // Step 4: Integer columns
+    std::vector<int64_t> values(records.size());
+    for (size_t f = 0; f < sizeof(INT_FIELDS) / sizeof(INT_FIELDS[0]); f++) {
+        for (size_t i = 0; i < records.size(); i++) {
+            int32_t value;
+            memcpy(&value, reinterpret_cast<const char*>(&records[i]) + INT_FIELDS[f], sizeof(value));
+            values[i] = value;
+        }
+        out.push_back(static_cast<char>(FRAME_OF_REFERENCE));
+        appendFrameOfReference(values, out);
+    }
+
+    // Step 5: Float columns
+    for (size_t f = 0; f < sizeof(FLOAT_FIELDS) / sizeof(FLOAT_FIELDS[0]); f++) {
+        bool scaled = true;
+        for (size_t i = 0; i < records.size(); i++) {
+            float value;
+            memcpy(&value, reinterpret_cast<const char*>(&records[i]) + FLOAT_FIELDS[f], sizeof(value));
+            long long thousandths = std::abs(value) < 1e6f ? llround(static_cast<double>(value) * DECIMAL_SCALE) : 0;
+            float restored = static_cast<float>(thousandths) / static_cast<float>(DECIMAL_SCALE);
+            if (scaled && memcmp(&restored, &value, sizeof(value)) != 0) scaled = false;
+            values[i] = thousandths;
+        }
+        if (!scaled) {
+            for (size_t i = 0; i < records.size(); i++) {
+                uint32_t bits;
+                memcpy(&bits, reinterpret_cast<const char*>(&records[i]) + FLOAT_FIELDS[f], sizeof(bits));
+                values[i] = bits;
+            }
+        }
+        out.push_back(static_cast<char>(scaled ? SCALED_DECIMAL : FRAME_OF_REFERENCE));
+        appendFrameOfReference(values, out);
+    }
+
+    return out.size() - start;
+}
+
+/**
+ * Decode Block
+ *
+ * Reverses encode(): the columns are decoded into records, which go back
+ * into the slots set in the bitmap, in ascending order.
+ *
+ * @param frame Compressed block
+ * @param length Frame size in bytes
+ * @param block Receives the decompressed block
+ * @return false if the frame is malformed
+ */
+bool BlockCodec::decode(const char* frame, size_t length, Block& block) {
+    FrameReader reader(frame, length);
+    FrameHeader header;
+    if (!reader.read(&header, sizeof(header)) || header.num_slots > Block::MAX_RECORDS ||
+        header.num_records > header.num_slots || header.layout > static_cast<uint8_t>(BlockLayout::PAX)) {
+        return false;
+    }
+
+    block.clear(static_cast<BlockLayout>(header.layout));
+    block.header.block_id = header.block_id;
+    block.header.next_block = header.next_block;
+    block.header.num_slots = header.num_slots;
+
+    // Slots of the live records, which must match the record count
+    std::vector<int> slots;
+    for (int i = 0; i < header.num_slots; i++) {
+        if ((header.slot_bitmap[i / 32] >> (i % 32)) & 1u) slots.push_back(i);
+    }
+    if (slots.size() != header.num_records) return false;
+    size_t count = slots.size();
+    if (count == 0) return reader.atEnd();
+
+    std::vector<Record> records(count);
+
+    // game_date dictionary
+    uint8_t mode = 0, dictionary_size = 0, index_width = 0;
+    if (!reader.read(&mode, 1) || mode != DICTIONARY || !reader.read(&dictionary_size, 1) || dictionary_size == 0) {
+        return false;
+    }
+    std::vector<char> dictionary(static_cast<size_t>(dictionary_size) * sizeof(records[0].game_date));
+    std::vector<uint64_t> indexes;
+    if (!reader.read(&dictionary[0], dictionary.size()) || !reader.read(&index_width, 1) ||
+        !reader.unpackBits(count, index_width, indexes)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (indexes[i] >= dictionary_size) return false;
+        memcpy(records[i].game_date, &dictionary[indexes[i] * sizeof(records[i].game_date)], sizeof(records[i].game_date));
+    }
+
+    // Integer columns
+    std::vector<int64_t> values;
+    for (size_t f = 0; f < sizeof(INT_FIELDS) / sizeof(INT_FIELDS[0]); f++) {
+        if (!reader.read(&mode, 1) || mode != FRAME_OF_REFERENCE || !readFrameOfReference(reader, count, values)) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            int32_t value = static_cast<int32_t>(values[i]);
+            memcpy(reinterpret_cast<char*>(&records[i]) + INT_FIELDS[f], &value, sizeof(value));
+        }
+    }
+
+    // Float columns
+    for (size_t f = 0; f < sizeof(FLOAT_FIELDS) / sizeof(FLOAT_FIELDS[0]); f++) {
+        if (!reader.read(&mode, 1) || (mode != FRAME_OF_REFERENCE && mode != SCALED_DECIMAL) ||
+            !readFrameOfReference(reader, count, values)) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            char* field = reinterpret_cast<char*>(&records[i]) + FLOAT_FIELDS[f];
+            if (mode == SCALED_DECIMAL) {
+                float value = static_cast<float>(values[i]) / static_cast<float>(DECIMAL_SCALE);
+                memcpy(field, &value, sizeof(value));
+            } else {
+                uint32_t bits = static_cast<uint32_t>(values[i]);
+                memcpy(field, &bits, sizeof(bits));
+            }
+        }
+    }
+    if (!reader.atEnd()) return false;
+
+    for (size_t i = 0; i < count; i++) block.placeRecord(slots[i], records[i]);
+    return true;
+}
@@ -0,0 +1,76 @@
+/**
+ * SC3020 Database Management System
+ * Block Codec Header
+ *
+ * This file defines BlockCodec, the lossless column-wise compression of
+ * one heap block used by the compressed archive (archive.h).
+ *
+ * A compressed block (frame) holds the block ID, the slot high-water mark,
+ * the layout and the slot bitmap, followed by the live records column by
+ * column, in slot order (whatever the block's layout):
+ * - game_date: per-block dictionary of the distinct 11-byte strings plus a
+ *   bit-packed index per record (a block covers a few days of games)
+ * - Integer columns: frame of reference (the block minimum) and bit-packed
+ *   offsets, e.g. 5 bits for team_id_home and 1 bit for home_team_wins
+ * - Percentage columns: stored as thousandths when every value of the
+ *   block converts back to the identical float, then frame of reference
+ *   and bit-packing like the integers; otherwise frame of reference over
+ *   the raw float bits
+ *
+ * Decoding restores every live record bit for bit in its original slot, so
+ * record pointers (block_id, record_index) stay valid. Free slots decode
+ * as zeros.
+ */
+
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+
+// Include block structure
+#include "block.h"
+
+// Standard C++ libraries
+#include <vector>    // For the output buffer
+#include <cstddef>   // For size_t
+
+/**
+ * Block Codec Class
+ */
+class BlockCodec {
+public:
+    /**
+     * Encode Block
+     *
+     * Appends the compressed form of a block to out.
+     *
+     * @param block Block to compress (header, bitmap and live slots are read)
+     * @param out Buffer the frame is appended to
+     * @return Frame size in bytes
+     */
+    static size_t encode(const Block& block, std::vector<char>& out);
+
+    /**
+     * Decode Block
+     *
+     * @param frame Compressed block
+     * @param length Frame size in bytes
+     * @param block Receives the decompressed block
+     * @return false if the frame is malformed
+     */
+    static bool decode(const char* frame, size_t length, Block& block);
+
+private:
+    /**
+     * Column Mode
+     *
+     * First byte of every encoded column.
+     */
+    enum ColumnMode {
+        FRAME_OF_REFERENCE = 0,   // Integers (or raw float bits) minus the block minimum, bit-packed
+        SCALED_DECIMAL = 1,       // Floats as thousandths, then as FRAME_OF_REFERENCE
+        DICTIONARY = 2            // Distinct strings, then bit-packed indexes
+    };
+
+    static const int DECIMAL_SCALE = 1000;   // Percentages have at most three decimals
+};
+
+#endif // BLOCK_CODEC_H
@@ -0,0 +1,275 @@
+/**
+ * SC3020 Database Management System
+ * Buffer Pool Implementation
+ *
+ * This file contains the implementation of the BufferPool class and the
+ * LRU and CLOCK replacement policies.
+ *
+ */
+
+#include "buffer_pool.h"
+#include <algorithm>  // For ordering write-back
+
+/**
+ * LRU Replacer Constructor
+ *
+ * @param num_frames Number of frames managed by the replacer
+ */
+LRUReplacer::LRUReplacer(size_t num_frames) : positions(num_frames), in_list(num_frames, false) {}
+
+void LRUReplacer::recordAccess(int frame_id) {
+    // Move an evictable frame to the most-recently-used end
+    if (in_list[frame_id]) {
+        lru_list.splice(lru_list.begin(), lru_list, positions[frame_id]);
+    }
+}
+
+void LRUReplacer::setEvictable(int frame_id, bool evictable) {
+    if (evictable && !in_list[frame_id]) {
+        lru_list.push_front(frame_id);
+        positions[frame_id] = lru_list.begin();
+        in_list[frame_id] = true;
+    } else if (!evictable && in_list[frame_id]) {
+        lru_list.erase(positions[frame_id]);
+        in_list[frame_id] = false;
+    }
+}
+
+bool LRUReplacer::victim(int& frame_id) {
+    if (lru_list.empty()) return false;
+
+    // Least recently used frame is at the back
+    frame_id = lru_list.back();
+    lru_list.pop_back();
+    in_list[frame_id] = false;
+    return true;
+}
+
+/**
+ * CLOCK Replacer Constructor
+ *
+ * @param num_frames Number of frames managed by the replacer
+ */
+ClockReplacer::ClockReplacer(size_t num_frames)
+    : reference_bits(num_frames, false), evictable(num_frames, false), hand(0), num_evictable(0) {}
+
+void ClockReplacer::recordAccess(int frame_id) {
+    reference_bits[frame_id] = true;
+}
+
+void ClockReplacer::setEvictable(int frame_id, bool is_evictable) {
+    if (evictable[frame_id] == is_evictable) return;
+    evictable[frame_id] = is_evictable;
+    if (is_evictable) {
+        num_evictable++;
+    } else {
+        num_evictable--;
+    }
+}
+
+bool ClockReplacer::victim(int& frame_id) {
+    if (num_evictable == 0) return false;
+
+    // Sweep until an evictable frame without a second chance is found.
+    // Two full rotations are enough because the first clears every bit.
+    size_t n = evictable.size();
+    for (size_t step = 0; step < 2 * n; step++) {
+        size_t current = hand;
+        hand = (hand + 1) % n;
+        if (!evictable[current]) continue;
+        if (reference_bits[current]) {
+            reference_bits[current] = false; // Give a second chance
+            continue;
+        }
+        evictable[current] = false;
+        num_evictable--;
+        frame_id = static_cast<int>(current);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Buffer Pool Constructor
+ *
+ * Allocates the frames and the selected replacer. All frames start free.
+ *
+ * @param num_frames Number of frames in the pool (at least 1)
+ * @param policy Replacement policy used to choose victims
+ * @param read_fn Callback performing a physical block read
+ * @param write_fn Callback performing a physical block write
+ */
+BufferPool::BufferPool(size_t num_frames, ReplacementPolicy policy,
+                       const ReadFunction& read_fn, const WriteFunction& write_fn)
+    : frames(num_frames > 0 ? num_frames : 1), policy(policy), read_block(read_fn), write_block(write_fn),
+      hits(0), misses(0), physical_reads(0), physical_writes(0), evictions(0) {
+    if (policy == ReplacementPolicy::CLOCK) {
+        replacer.reset(new ClockReplacer(frames.size()));
+    } else {
+        replacer.reset(new LRUReplacer(frames.size()));
+    }
+
+    // Hand out low-numbered frames first
+    for (int i = static_cast<int>(frames.size()) - 1; i >= 0; i--) {
+        free_frames.push_back(i);
+    }
+}
+
+void BufferPool::pinFrame(int frame_id) {
+    Frame& frame = frames[frame_id];
+    frame.pin_count++;
+    replacer->recordAccess(frame_id);
+    replacer->setEvictable(frame_id, false);
+}
+
+int BufferPool::acquireFrame() {
+    // Prefer a frame that holds nothing
+    if (!free_frames.empty()) {
+        int frame_id = free_frames.back();
+        free_frames.pop_back();
+        return frame_id;
+    }
+
+    // Otherwise evict an unpinned frame chosen by the policy
+    int frame_id = -1;
+    if (!replacer->victim(frame_id)) return -1;
+
+    Frame& frame = frames[frame_id];
+    if (frame.dirty) {
+        // Write back before reusing the frame
+        if (!write_block(frame.block_id, frame.block)) {
+            replacer->setEvictable(frame_id, true);
+            return -1;
+        }
+        physical_writes++;
+    }
+
+    page_table.erase(frame.block_id);
+    frame.block_id = -1;
+    frame.dirty = false;
+    evictions++;
+    return frame_id;
+}
+
+Block* BufferPool::fetchBlock(int block_id) {
+    // Hit: block already resident
+    std::unordered_map<int, int>::iterator it = page_table.find(block_id);
+    if (it != page_table.end()) {
+        hits++;
+        pinFrame(it->second);
+        return &frames[it->second].block;
+    }
+
+    // Miss: allocate a frame and read the block from disk
+    misses++;
+    int frame_id = acquireFrame();
+    if (frame_id == -1) return nullptr;
+
+    Frame& frame = frames[frame_id];
+    if (!read_block(block_id, frame.block)) {
+        free_frames.push_back(frame_id);
+        return nullptr;
+    }
+    physical_reads++;
+
+    frame.block_id = block_id;
+    frame.pin_count = 0;
+    frame.dirty = false;
+    page_table[block_id] = frame_id;
+    pinFrame(frame_id);
+    return &frame.block;
+}
+
+Block* BufferPool::newBlock(int block_id) {
+    // A resident frame is reused as-is; the caller overwrites it anyway
+    std::unordered_map<int, int>::iterator it = page_table.find(block_id);
+    if (it != page_table.end()) {
+        hits++;
+        pinFrame(it->second);
+        return &frames[it->second].block;
+    }
+
+    // Miss: no need to read a block that is about to be overwritten
+    misses++;
+    int frame_id = acquireFrame();
+    if (frame_id == -1) return nullptr;
+
+    Frame& frame = frames[frame_id];
+    frame.block.clear();
+    frame.block_id = block_id;
+    frame.pin_count = 0;
+    frame.dirty = false;
+    page_table[block_id] = frame_id;
+    pinFrame(frame_id);
+    return &frame.block;
+}
+
+bool BufferPool::unpinBlock(int block_id, bool is_dirty) {
+    std::unordered_map<int, int>::iterator it = page_table.find(block_id);
+    if (it == page_table.end()) return false;
+
+    Frame& frame = frames[it->second];
+    if (frame.pin_count <= 0) return false;
+
+    if (is_dirty) frame.dirty = true;
+    frame.pin_count--;
+    if (frame.pin_count == 0) {
+        replacer->setEvictable(it->second, true);
+    }
+    return true;
+}
+
+const Block* BufferPool::peekBlock(int block_id) const {
+    std::unordered_map<int, int>::const_iterator it = page_table.find(block_id);
+    return it == page_table.end() ? nullptr : &frames[it->second].block;
+}
+
+bool BufferPool::flushBlock(int block_id) {
+    std::unordered_map<int, int>::iterator it = page_table.find(block_id);
+    if (it == page_table.end()) return true;
+
+    Frame& frame = frames[it->second];
+    if (!frame.dirty) return true;
+
+    if (!write_block(frame.block_id, frame.block)) return false;
+    physical_writes++;
+    frame.dirty = false;
+    return true;
+}
+
+bool BufferPool::flushAll() {
+    // Write dirty frames in block order so the write-back is sequential on disk
+    std::vector<std::pair<int, int>> dirty_frames; // (block_id, frame index)
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (frames[i].block_id != -1 && frames[i].dirty) {
+            dirty_frames.push_back(std::make_pair(frames[i].block_id, static_cast<int>(i)));
+        }
+    }
+    std::sort(dirty_frames.begin(), dirty_frames.end());
+
+    bool ok = true;
+    for (size_t i = 0; i < dirty_frames.size(); i++) {
+        Frame& frame = frames[dirty_frames[i].second];
+        if (write_block(frame.block_id, frame.block)) {
+            physical_writes++;
+            frame.dirty = false;
+        } else {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void BufferPool::reset() {
+    page_table.clear();
+    free_frames.clear();
+    for (int i = static_cast<int>(frames.size()) - 1; i >= 0; i--) {
+        if (frames[i].block_id != -1) {
+            replacer->setEvictable(i, false);
+        }
+        frames[i].block_id = -1;
+        frames[i].pin_count = 0;
+        frames[i].dirty = false;
+        free_frames.push_back(i);
+    }
+}
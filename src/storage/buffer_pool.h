@@ -0,0 +1,283 @@
+/**
+ * SC3020 Database Management System
+ * Buffer Pool Manager Header
+ *
+ * This file defines the BufferPool class that caches database blocks in a
+ * fixed number of in-memory frames, together with the replacement policies
+ * used to choose which frame to evict when the pool is full.
+ *
+ * The Buffer Pool provides:
+ * - A fixed set of 4096-byte frames holding cached blocks
+ * - Pin/unpin reference counting so in-use frames are never evicted
+ * - Dirty tracking with write-back on eviction or explicit flush
+ * - Pluggable replacement policy (LRU or CLOCK)
+ * - Hit/miss and physical I/O counters for performance analysis
+ *
+ * The pool does not know about the file layout. Physical reads and writes
+ * are delegated to callbacks supplied by the owner (the Database class).
+ */
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+// Include block structure
+#include "block.h"
+
+// Standard C++ libraries
+#include <vector>         // For frame storage
+#include <list>           // For LRU ordering
+#include <unordered_map>  // For the page table
+#include <functional>     // For physical I/O callbacks
+#include <memory>         // For owning the replacer
+
+/**
+ * Replacement Policy
+ *
+ * Selects the algorithm used to pick a victim frame on a miss.
+ */
+enum class ReplacementPolicy {
+    LRU,    // Evict the least recently used unpinned frame
+    CLOCK   // Second-chance approximation of LRU with one reference bit per frame
+};
+
+/**
+ * Replacer Interface
+ *
+ * Tracks which frames may be evicted and chooses a victim among them.
+ * A frame is evictable only while its pin count is zero.
+ */
+class Replacer {
+public:
+    virtual ~Replacer() {}
+
+    /**
+     * Record Access
+     *
+     * Notes that a frame was referenced so the policy can update its state.
+     *
+     * @param frame_id Frame that was accessed
+     */
+    virtual void recordAccess(int frame_id) = 0;
+
+    /**
+     * Set Evictable
+     *
+     * Marks a frame as a candidate for eviction (unpinned) or not (pinned).
+     *
+     * @param frame_id Frame to update
+     * @param evictable true if the frame may be evicted
+     */
+    virtual void setEvictable(int frame_id, bool evictable) = 0;
+
+    /**
+     * Choose Victim
+     *
+     * Selects an evictable frame and removes it from the candidate set.
+     *
+     * @param frame_id Output parameter receiving the victim frame
+     * @return true if a victim was found, false if every frame is pinned
+     */
+    virtual bool victim(int& frame_id) = 0;
+};
+
+/**
+ * LRU Replacer
+ *
+ * Keeps evictable frames in a list ordered by recency. The most recently
+ * used frame is at the front and the victim is taken from the back.
+ */
+class LRUReplacer : public Replacer {
+private:
+    std::list<int> lru_list;                           // Evictable frames, most recent first
+    std::vector<std::list<int>::iterator> positions;   // Position of each frame in lru_list
+    std::vector<bool> in_list;                         // Whether the frame is currently evictable
+
+public:
+    explicit LRUReplacer(size_t num_frames);
+    void recordAccess(int frame_id);
+    void setEvictable(int frame_id, bool evictable);
+    bool victim(int& frame_id);
+};
+
+/**
+ * CLOCK Replacer
+ *
+ * Approximates LRU with a circular sweep. Each access sets a reference bit;
+ * the clock hand clears set bits and evicts the first evictable frame whose
+ * bit is already clear.
+ */
+class ClockReplacer : public Replacer {
+private:
+    std::vector<bool> reference_bits;  // Second-chance bit per frame
+    std::vector<bool> evictable;       // Whether the frame is currently unpinned
+    size_t hand;                       // Current clock hand position
+    size_t num_evictable;              // Number of evictable frames
+
+public:
+    explicit ClockReplacer(size_t num_frames);
+    void recordAccess(int frame_id);
+    void setEvictable(int frame_id, bool is_evictable);
+    bool victim(int& frame_id);
+};
+
+/**
+ * Buffer Pool Class
+ *
+ * Caches database blocks in a fixed number of frames. Callers pin a block
+ * with fetchBlock() or newBlock(), use the returned frame, and release it
+ * with unpinBlock(). Dirty frames are written back when they are evicted or
+ * when flushBlock()/flushAll() is called.
+ */
+class BufferPool {
+public:
+    typedef std::function<bool(int, Block&)> ReadFunction;         // Physical block read
+    typedef std::function<bool(int, const Block&)> WriteFunction;  // Physical block write
+
+    /**
+     * Constructor
+     *
+     * @param num_frames Number of frames in the pool (at least 1)
+     * @param policy Replacement policy used to choose victims
+     * @param read_fn Callback performing a physical block read
+     * @param write_fn Callback performing a physical block write
+     */
+    BufferPool(size_t num_frames, ReplacementPolicy policy,
+               const ReadFunction& read_fn, const WriteFunction& write_fn);
+
+    /**
+     * Fetch Block
+     *
+     * Pins the block in a frame, reading it from disk on a miss.
+     *
+     * @param block_id ID of the block to fetch
+     * @return Pointer to the pinned frame, or nullptr if no frame is available
+     *         or the physical read failed
+     */
+    Block* fetchBlock(int block_id);
+
+    /**
+     * New Block
+     *
+     * Pins a frame for a block whose entire contents the caller is about to
+     * overwrite. On a miss the frame is zeroed instead of read from disk.
+     *
+     * @param block_id ID of the block
+     * @return Pointer to the pinned frame, or nullptr if every frame is pinned
+     */
+    Block* newBlock(int block_id);
+
+    /**
+     * Unpin Block
+     *
+     * Releases one pin on a block and optionally marks it dirty.
+     *
+     * @param block_id ID of the block to unpin
+     * @param is_dirty true if the caller modified the frame
+     * @return true if the block was resident and pinned
+     */
+    bool unpinBlock(int block_id, bool is_dirty);
+
+    /**
+     * Peek Block
+     *
+     * Returns the frame of a resident block without pinning it or counting
+     * an access (used to log a frame's contents when it is unpinned).
+     *
+     * @param block_id ID of the block
+     * @return Frame contents, or nullptr if the block is not resident
+     */
+    const Block* peekBlock(int block_id) const;
+
+    /**
+     * Flush Block
+     *
+     * Writes a resident block back to disk if it is dirty.
+     *
+     * @param block_id ID of the block to flush
+     * @return true if the block is clean afterwards (or not resident)
+     */
+    bool flushBlock(int block_id);
+
+    /**
+     * Flush All Blocks
+     *
+     * Writes every dirty frame back to disk.
+     *
+     * @return true if all writes succeeded
+     */
+    bool flushAll();
+
+    /**
+     * Reset Pool
+     *
+     * Drops every frame without writing it back. Used after the owner has
+     * flushed and closed the underlying file.
+     */
+    void reset();
+
+    // Statistics
+    int getNumFrames() const { return static_cast<int>(frames.size()); }
+    ReplacementPolicy getPolicy() const { return policy; }
+    int getHits() const { return hits; }
+    int getMisses() const { return misses; }
+    int getPhysicalReads() const { return physical_reads; }
+    int getPhysicalWrites() const { return physical_writes; }
+    int getEvictions() const { return evictions; }
+
+    /**
+     * Reset Counters
+     *
+     * Resets hit/miss and physical I/O counters for performance measurement.
+     */
+    void resetCounters() { hits = 0; misses = 0; physical_reads = 0; physical_writes = 0; evictions = 0; }
+
+private:
+    /**
+     * Frame Structure
+     *
+     * One slot of the pool holding a cached block and its bookkeeping.
+     */
+    struct Frame {
+        Block block;       // Cached block contents
+        int block_id;      // Block held by this frame (-1 if free)
+        int pin_count;     // Number of outstanding pins
+        bool dirty;        // True if the frame differs from disk
+
+        Frame() : block_id(-1), pin_count(0), dirty(false) {}
+    };
+
+    std::vector<Frame> frames;                  // Frame storage
+    std::unordered_map<int, int> page_table;    // Block ID -> frame index
+    std::vector<int> free_frames;               // Frames not holding any block
+    std::unique_ptr<Replacer> replacer;         // Victim selection policy
+    ReplacementPolicy policy;                   // Policy in use
+    ReadFunction read_block;                    // Physical read callback
+    WriteFunction write_block;                  // Physical write callback
+
+    // Counters
+    int hits;             // Requests served from a resident frame
+    int misses;           // Requests that required a frame allocation
+    int physical_reads;   // Blocks read from disk
+    int physical_writes;  // Blocks written to disk
+    int evictions;        // Frames reclaimed from another block
+
+    /**
+     * Pin Resident Frame
+     *
+     * Pins a frame that already holds a block and notifies the replacer.
+     *
+     * @param frame_id Frame to pin
+     */
+    void pinFrame(int frame_id);
+
+    /**
+     * Acquire Frame
+     *
+     * Returns a free frame, evicting (and writing back) a victim if needed.
+     *
+     * @return Frame index, or -1 if every frame is pinned or write-back failed
+     */
+    int acquireFrame();
+};
+
+#endif // BUFFER_POOL_H
@@ -10,25 +10,39 @@
  * - Fixed-length record storage for predictable access patterns
  * - Metadata persistence for database state management
  * - I/O operation tracking for performance analysis
+ * - Buffer pool caching of hot blocks (LRU or CLOCK replacement)
+ * - Slotted pages with a free-block list so inserts reuse deleted slots
+ * - Online compaction that packs live records and shrinks the file
+ * - Optional memory-mapped backend with zero-copy block access
+ * - A catalog of secondary indexes kept in sync on insert, delete and compaction
+ * - Optional write-ahead log with group commit and crash recovery
+ * - Asynchronous read-ahead for scans and many reads in flight for batched fetches
  * - Comprehensive statistics generation for analysis
  * 
  * File Format:
- * - Header: 8 bytes (num_blocks, num_records)
+ * - Header: 16 bytes (num_blocks, num_records, free_list_head, reserved)
  * - Data: Sequential blocks of 4096 bytes each
- * - Each block contains a header and variable number of records
+ * - Each block contains a header, a slot bitmap and up to MAX_RECORDS records
  */
 
 #ifndef DATABASE_H
 #define DATABASE_H
 
-// Include block structure
+// Include block structure and buffer pool
 #include "block.h"
+#include "buffer_pool.h"
+#include "wal.h"
+#include "../indexing/record_pointer.h"
+#include "../indexing/index_catalog.h"
+#include "../utils/mapped_file.h"
+#include "../utils/async_io.h"
+#include "../utils/metrics.h"
 
 // Standard C++ libraries
 #include <string>    // For file path strings
 #include <fstream>   // For file I/O operations
 #include <vector>    // For dynamic arrays
-#include <set>       // For tracking unique blocks accessed
+#include <functional> // For scan callbacks
 
 /**
  * Database Class
@@ -44,28 +58,61 @@
  * - Statistics generation for analysis
  */
 static const size_t MAX_DATABASE_SIZE = 100 * 1024 * 1024; // Set capacity of database to 100 MB
+static const size_t DEFAULT_POOL_FRAMES = 64;               // Default buffer pool size (64 x 4 KB = 256 KB)
+static const int APPEND_BATCH_BLOCKS = 64;                  // Blocks per sequential write in appendRecords (256 KB)
+static const int SCAN_STEAL_BLOCKS = 16;                    // Blocks per work-stealing piece in parallelScanBlocks (64 KB)
+static const int DEFAULT_READ_AHEAD_BLOCKS = 256;           // Blocks read ahead of direct scans and fetches (1 MB)
 
 class Database {
+public:
+    typedef std::function<void(const Record&, int, int)> ScanCallback; // (record, block_id, record_index)
+    typedef std::function<void(const Record&, int, int, int)> PartitionScanCallback; // (record, block_id, record_index, partition)
+    typedef std::function<void(const Record&, const RecordPointer&)> FetchCallback;  // (record, location)
+    typedef std::function<void(const Block*, int, int)> BlockScanCallback;          // (blocks, first_block_id, count)
+    typedef std::function<void(const Block*, int, int, int)> ParallelBlockScanCallback; // (blocks, first_block_id, count, worker)
+    typedef std::function<bool(int)> BlockFilter;                                   // (block_id) -> false to skip the block
+    
 private:
     std::string filename;      // Path to the binary database file
     std::fstream file;         // File stream for I/O operations
     int num_blocks;            // Total number of blocks in the database
-    int num_records;           // Total number of records in the database
+    int num_records;           // Total number of live records in the database
+    int free_list_head;        // First block with a reusable hole (-1 if none)
+    BufferPool pool;           // Cache of recently used blocks in front of the file (STREAM backend)
+    StorageBackend backend;    // Backend selected at open()
+    MappedFile mapped;         // Mapping of the database file (MMAP backend)
+    IndexCatalog catalog;      // Secondary indexes maintained with the heap file
+    WriteAheadLog* log;        // Attached write-ahead log (nullptr = none)
+    int log_file_id;           // ID of the file in the log (-1 = not logged)
+    bool metadata_dirty;       // Logged metadata not yet written to the file
+    BlockLayout layout;        // Layout of blocks created from now on (stored in the metadata)
+    size_t capacity;           // Largest file size the database may grow to, in bytes
     
     // I/O counters for performance measurement
     mutable int data_blocks_accessed;           // Backward-compat (kept as total ops before change)
-    mutable int total_data_block_ios;           // Total block I/O operations (reads + writes)
-    mutable std::set<int> unique_data_blocks;   // Unique data block IDs accessed since last reset
+    mutable int total_data_block_ios;           // Total logical block accesses (reads + writes)
+    mutable PageSet unique_data_blocks;         // Unique data block IDs accessed since last reset
+    int direct_block_writes;                    // Blocks written by appendRecords, bypassing the pool
+    int direct_block_reads;                     // Blocks read by fetchBatch, bypassing the pool
+    int sequential_write_batches;               // Number of multi-block writes issued by appendRecords
+    int read_ahead_blocks;                      // Read-ahead window of direct reads (0 = synchronous)
+    int peak_reads_in_flight;                   // Most asynchronous reads outstanding at once since last reset
+    LatencyHistogram* block_read_latency;       // Physical single-block reads (nullptr = not measured)
+    LatencyHistogram* block_write_latency;      // Physical single-block writes (nullptr = not measured)
     
 public:
     /**
      * Constructor
      * 
-     * Creates a Database object with the specified filename.
+     * Creates a Database object with the specified filename and a buffer
+     * pool of the given size and replacement policy.
      * 
      * @param fname Path to the database file
+     * @param pool_frames Number of 4 KB frames in the buffer pool
+     * @param policy Buffer pool replacement policy
      */
-    Database(const std::string& fname);
+    Database(const std::string& fname, size_t pool_frames = DEFAULT_POOL_FRAMES,
+             ReplacementPolicy policy = ReplacementPolicy::LRU);
     
     /**
      * Destructor
@@ -82,17 +129,37 @@ public:
      * Opens the database file for reading and writing.
      * Creates the file if it doesn't exist.
      * 
+     * With StorageBackend::MMAP the file is memory-mapped: blocks are
+     * accessed in place, the buffer pool is bypassed and the OS page cache
+     * does the caching.
+     * 
+     * Registered secondary indexes are opened with the same backend.
+     * 
+     * @param backend Storage backend to use until close()
      * @return true if file was opened successfully, false otherwise
      */
-    bool open();
+    bool open(StorageBackend backend = StorageBackend::STREAM);
     
     /**
      * Close Database File
      * 
-     * Closes the database file and flushes any pending writes.
+     * Closes the database file after writing back dirty buffer pool frames,
+     * and closes the secondary indexes.
      */
     void close();
     
+    /**
+     * Flush Database
+     * 
+     * Writes back all dirty buffer pool frames and the metadata header
+     * without closing the file. With the MMAP backend this is the
+     * checkpoint: the mapping is written back with msync. Secondary
+     * indexes are flushed too.
+     * 
+     * @return true if all writes succeeded
+     */
+    bool flush();
+    
     /**
      * Check if Database is Open
      * 
@@ -102,12 +169,41 @@ public:
      */
     bool isOpen() const;
     
+    /**
+     * Attach Write-Ahead Log
+     * 
+     * Logs every change of the database file and of the secondary indexes
+     * in the catalog. Must be called before open(); the log is opened (and
+     * recovered) by open() if necessary. Each public operation that
+     * changes the file (addRecord(), appendRecords(), appendBlocks(),
+     * deleteRecord(), compact(), buildIndexes()) is one transaction; it is
+     * durable once its commit group is written, at the latest on flush().
+     * close() runs a checkpoint. The log is not used with the MMAP backend.
+     * 
+     * @param wal Log to use, shared with other files (nullptr to detach)
+     */
+    void attachLog(WriteAheadLog* wal);
+    
+    /**
+     * Attach Metrics
+     * 
+     * Records the latency of every physical block read and write (buffer
+     * pool misses and write-backs, or copies out of the mapping) into the
+     * registry's database_block_read_seconds and
+     * database_block_write_seconds histograms, and attaches the registry to
+     * the secondary indexes in the catalog. May be called at any time.
+     * 
+     * @param registry Registry to record into (nullptr to detach)
+     */
+    void attachMetrics(MetricsRegistry* registry);
+    
     // Block Operations
     
     /**
      * Write Block to File
      * 
-     * Writes a block to the database file at the specified position.
+     * Writes a block through the buffer pool. The block reaches the file
+     * when its frame is evicted or flushed.
      * 
      * @param block_id ID of the block to write
      * @param block Block data to write
@@ -118,7 +214,7 @@ public:
     /**
      * Read Block from File
      * 
-     * Reads a block from the database file at the specified position.
+     * Reads a block through the buffer pool, going to the file only on a miss.
      * 
      * @param block_id ID of the block to read
      * @param block Block object to store the read data
@@ -126,6 +222,19 @@ public:
      */
     bool readBlock(int block_id, Block& block);
     
+    /**
+     * View Block in Place
+     * 
+     * Returns a pointer straight into the mapped file (MMAP backend only),
+     * so reading records needs no copy. The pointer stays valid until the
+     * database grows or is closed. Counts one logical block access.
+     * 
+     * @param block_id ID of the block to view
+     * @return Pointer to the block, or nullptr with the STREAM backend or
+     *         if the block does not exist
+     */
+    const Block* viewBlock(int block_id);
+    
     /**
      * Add New Block
      * 
@@ -141,14 +250,56 @@ public:
     /**
      * Add Record to Database
      * 
-     * Adds a record to the database by finding an available block
-     * or creating a new block if necessary.
+     * Adds a record to the database, reusing a hole from the free-block
+     * list if there is one, else appending to the last block or creating
+     * a new block if necessary.
      * 
      * @param record Record to add
      * @return true if record was added successfully, false otherwise
      */
     bool addRecord(const Record& record);
     
+    /**
+     * Append Records in Bulk
+     * 
+     * Appends records in file order. Holes are not reused. The partially
+     * filled last block is topped up through the buffer pool; the remaining records are packed
+     * into blocks in memory and written in batches of APPEND_BATCH_BLOCKS
+     * contiguous blocks with one sequential write each. Metadata is written
+     * once at the end.
+     * 
+     * @param records Records to append
+     * @return Number of records appended (less than requested only if the
+     *         capacity limit is reached or a write fails)
+     */
+    int appendRecords(const std::vector<Record>& records);
+    
+    /**
+     * Append Records in Bulk
+     * 
+     * Same as appendRecords(const std::vector<Record>&) for a plain array,
+     * so callers can stream records in chunks without building one vector.
+     * 
+     * @param records Pointer to the first record
+     * @param count Number of records
+     * @return Number of records appended
+     */
+    int appendRecords(const Record* records, size_t count);
+    
+    /**
+     * Append Pre-Packed Blocks
+     * 
+     * Appends blocks that the caller has already filled with records as
+     * new blocks after the current last block, using one sequential write.
+     * Block IDs in the headers are assigned here. Only the in-memory
+     * metadata is updated; call flush() to persist it.
+     * 
+     * @param blocks Contiguous array of blocks (block IDs are overwritten)
+     * @param count Number of blocks
+     * @return true if every block was written
+     */
+    bool appendBlocks(Block* blocks, int count);
+    
     /**
      * Get Record from Database
      * 
@@ -163,15 +314,124 @@ public:
     /**
      * Delete Record from Database
      * 
-     * Marks a record as deleted by setting it to empty values.
-     * This implements a simple deletion strategy.
+     * Frees the record's slot: the slot bitmap bit is cleared, the bytes
+     * are zeroed and the record counts are decremented. A block that gains
+     * its first hole is pushed onto the free-block list.
      * 
      * @param block_id ID of the block containing the record
      * @param record_index Index of the record within the block
-     * @return true if record was deleted successfully
+     * @return true if the slot held a live record
      */
     bool deleteRecord(int block_id, int record_index);
     
+    /**
+     * Fetch Records in Batch
+     * 
+     * Fetches the records behind a list of pointers (e.g. rangeSearch()
+     * output) reading each block once. The pointers are sorted by block,
+     * runs of adjacent block IDs (up to APPEND_BATCH_BLOCKS) are read with
+     * one sequential read each, bypassing the buffer pool (which is
+     * flushed first), or in place with the MMAP backend. With prefetch up
+     * to DEFAULT_IO_QUEUE_DEPTH runs (the read-ahead window) are read
+     * asynchronously at once and decoded in the order they complete.
+     * Each block counts as one logical data block access.
+     * 
+     * @param pointers Record locations, in any order, duplicates allowed
+     * @param records Output: records[i] is the record at pointers[i]
+     *        (an empty Record if the slot is free or out of range)
+     * @param prefetch true to keep many run reads in flight
+     * @return Number of blocks read, or -1 on an I/O failure
+     */
+    int fetchBatch(const std::vector<RecordPointer>& pointers, std::vector<Record>& records, bool prefetch = false);
+    
+    /**
+     * Fetch Records in Batch (Visitor)
+     * 
+     * Same I/O as the vector form, but streams the records: the visitor
+     * is called once per distinct live pointer, in ascending (block, slot)
+     * order, so memory use does not grow with the batch. With prefetch the
+     * reads are in flight together but decoded in block order. The visitor
+     * must not call back into the database.
+     * 
+     * @param pointers Record locations, in any order, duplicates allowed
+     * @param visitor Function called as visitor(record, location)
+     * @param prefetch true to keep many run reads in flight
+     * @return Number of blocks read, or -1 on an I/O failure
+     */
+    int fetchBatch(const std::vector<RecordPointer>& pointers, const FetchCallback& visitor, bool prefetch = false);
+    
+    /**
+     * Compact Database
+     * 
+     * Packs live records into as few blocks as possible while the database
+     * stays open. Records from the last blocks are moved into the holes of
+     * sparse blocks (and into the last block's free slots); blocks left
+     * empty are dropped and the file is truncated. Only blocks on the
+     * free-block list, the last block and the blocks drained from the end
+     * are touched.
+     * 
+     * Every relocation is reported so indexes can be fixed up in one batch
+     * (see BPTree::relocatePointers). Secondary indexes in the catalog are
+     * fixed up here.
+     * 
+     * @param moves Output: old and new location of every moved record
+     * @return Number of blocks freed
+     */
+    int compact(std::vector<RecordMove>& moves);
+    
+    // Block Layout
+    
+    /**
+     * Set Block Layout
+     * 
+     * Layout of the blocks created from now on by addRecord(),
+     * appendRecords() and appendBlocks(), which converts pre-packed blocks
+     * on the way in. Saved in the file metadata, so it survives reopening.
+     * Existing blocks keep their layout; see convertLayout().
+     * 
+     * @param layout NSM (rows) or PAX (one minipage per field)
+     */
+    void setLayout(BlockLayout layout);
+    BlockLayout getLayout() const { return layout; }
+    
+    /**
+     * Convert Block Layout
+     * 
+     * Rewrites every block that is not in the given layout through the
+     * buffer pool (one logged operation per block, so an interrupted
+     * conversion leaves a valid mixed file) and makes it the layout of new
+     * blocks. Record pointers and indexes are unaffected.
+     * 
+     * @param layout Target layout
+     * @return Number of blocks converted
+     */
+    int convertLayout(BlockLayout layout);
+    
+    // Secondary Indexes
+    
+    /**
+     * Get Index Catalog
+     * 
+     * Indexes registered here are updated by addRecord(), appendRecords(),
+     * appendBlocks(), deleteRecord() and compact(). A newly registered
+     * index starts empty; fill it with buildIndexes().
+     * 
+     * @return Catalog of secondary indexes
+     */
+    IndexCatalog& getIndexes() { return catalog; }
+    
+    /**
+     * Build Secondary Indexes
+     * 
+     * Rebuilds every registered index from one parallelScan(): each index
+     * collects its entries per partition and then bulk loads them. If
+     * the scan fails, no index is changed.
+     * 
+     * @param num_threads Scan, sort and build threads (0 = one per hardware thread)
+     * @return true if every index was built
+     */
+    bool buildIndexes(int num_threads = 1);
+    
     // Statistics and Information
     
     /**
@@ -192,6 +452,15 @@ public:
      */
     int getNumRecords() const { return num_records; }
     
+    /**
+     * Get Free-Block List Length
+     * 
+     * Walks the free-block list (one block access per entry).
+     * 
+     * @return Number of blocks with reusable holes
+     */
+    int getNumFreeListBlocks();
+    
     /**
      * Get Records Per Block
      * 
@@ -201,6 +470,18 @@ public:
      */
     int getRecordsPerBlock() const { return Block::MAX_RECORDS; }
     
+    /**
+     * Set Capacity
+     * 
+     * Changes the largest size the file may grow to (MAX_DATABASE_SIZE by
+     * default); inserts and appends that would exceed it fail. Not stored
+     * in the file.
+     * 
+     * @param bytes Capacity in bytes
+     */
+    void setCapacity(size_t bytes) { capacity = bytes; }
+    size_t getCapacity() const { return capacity; }
+    
     /**
      * Get Record Size
      * 
@@ -230,6 +511,96 @@ public:
      */
     std::vector<Record> getAllRecords();
     
+    /**
+     * Scan All Records
+     * 
+     * Visits every live record in block order and passes it to the callback
+     * together with its location. Free slots are skipped using the slot
+     * bitmap. Each block is pinned in the buffer pool
+     * only while its records are visited, so memory use is bounded by the
+     * pool size however large the database is. Each block counts as one
+     * logical data block access.
+     * 
+     * @param callback Function called as callback(record, block_id, record_index)
+     * @return Number of blocks scanned
+     */
+    int scan(const ScanCallback& callback);
+    
+    /**
+     * Parallel Scan
+     * 
+     * Splits the blocks into contiguous ranges, one per thread, and scans
+     * the ranges concurrently. Each thread reads its range with large
+     * sequential reads through its own file handle, with the read-ahead
+     * window in flight (or straight from the mapping), bypassing the buffer
+     * pool, which is flushed first. Within a
+     * partition records are visited in block order, and partition i covers
+     * lower block IDs than partition i + 1, so results collected per
+     * partition and concatenated are in the same order as scan().
+     * 
+     * The callback is called concurrently from different threads, but
+     * never concurrently for the same partition.
+     * 
+     * @param num_threads Number of partitions (0 = one per hardware thread)
+     * @param callback Function called as callback(record, block_id, record_index, partition)
+     * @return Number of blocks scanned, or -1 if the file could not be
+     *         read (the callback may already have seen part of it)
+     */
+    int parallelScan(int num_threads, const PartitionScanCallback& callback);
+    
+    /**
+     * Scan Blocks
+     * 
+     * Visits every block in order without copying records out, for
+     * operators that work on the raw block bytes. With batch_blocks = 1
+     * each block is pinned in the buffer pool (or the mapping) just for the
+     * callback. With larger batches the blocks are passed batch_blocks at a
+     * time: read from the file with one sequential read per batch after
+     * flushing the pool, keeping the read-ahead window in flight, or
+     * straight from the mapping. Either way each
+     * block counts as one logical data block access.
+     * 
+     * A filter (e.g. from a ZoneMap) skips blocks before they are read:
+     * batches then cover runs of consecutive kept blocks, and skipped
+     * blocks are neither read nor counted.
+     * 
+     * The blocks are only valid during the callback, which must not call
+     * other Database methods.
+     * 
+     * @param callback Function called as callback(blocks, first_block_id, count)
+     * @param batch_blocks Blocks per callback (1 = block by block through the pool)
+     * @param filter Blocks to visit (empty = every block)
+     * @return Number of blocks scanned
+     */
+    int scanBlocks(const BlockScanCallback& callback, int batch_blocks = 1,
+                   const BlockFilter& filter = BlockFilter());
+    
+    /**
+     * Parallel Scan Blocks
+     * 
+     * scanBlocks() on several threads. The blocks are handed out in pieces
+     * of batch_blocks with work stealing (parallelForStealing), each piece
+     * read with one sequential read through the worker's own file handle
+     * (or straight from the mapping) after the pool is flushed. Workers
+     * keep their own block counters, which are added to the database's
+     * counters when the scan ends, so the statistics are the same as for
+     * scanBlocks() with the same batch size.
+     * 
+     * The callback is called concurrently from different workers, never
+     * concurrently for the same worker, and must not call other Database
+     * methods. Pieces are not visited in block order. A filter is applied
+     * as in scanBlocks(), so a piece may reach the callback as several
+     * runs; it is called concurrently and must be thread-safe.
+     * 
+     * @param num_threads Number of workers (0 = one per hardware thread)
+     * @param callback Function called as callback(blocks, first_block_id, count, worker)
+     * @param batch_blocks Blocks per piece
+     * @param filter Blocks to visit (empty = every block)
+     * @return Number of blocks scanned
+     */
+    int parallelScanBlocks(int num_threads, const ParallelBlockScanCallback& callback,
+                           int batch_blocks = SCAN_STEAL_BLOCKS, const BlockFilter& filter = BlockFilter());
+    
     /**
      * Get Data Blocks Accessed Count
      * 
@@ -241,25 +612,203 @@ public:
     int getDataBlockIOsTotal() const { return total_data_block_ios; }
     int getDataBlocksAccessedUnique() const { return static_cast<int>(unique_data_blocks.size()); }
     
+    /**
+     * Get Buffer Pool Counters
+     * 
+     * Hits and misses split the logical accesses counted by
+     * getDataBlockIOsTotal(); physical reads/writes are actual file I/O.
+     * 
+     * @return Counter value since last reset
+     */
+    int getBufferHits() const { return pool.getHits(); }
+    int getBufferMisses() const { return pool.getMisses(); }
+    int getPhysicalBlockReads() const { return pool.getPhysicalReads() + direct_block_reads; }
+    int getPhysicalBlockWrites() const { return pool.getPhysicalWrites() + direct_block_writes; }
+    int getSequentialWriteBatches() const { return sequential_write_batches; }
+    int getPeakReadsInFlight() const { return peak_reads_in_flight; }
+    
+    /**
+     * Set Read-Ahead Window
+     * 
+     * Blocks kept in flight ahead of the consumer by batched scanBlocks(),
+     * parallelScan() (per partition) and fetchBatch() with prefetch
+     * (STREAM backend). 0 reads one batch at a time.
+     * 
+     * @param blocks Window size in blocks
+     */
+    void setReadAhead(int blocks) { read_ahead_blocks = blocks > 0 ? blocks : 0; }
+    int getReadAhead() const { return read_ahead_blocks; }
+    
     /**
      * Reset I/O Counters
      * 
      * Resets the I/O counters for performance measurement.
      */
-    void resetIOCounters() { data_blocks_accessed = 0; total_data_block_ios = 0; unique_data_blocks.clear(); }
+    void resetIOCounters() { data_blocks_accessed = 0; total_data_block_ios = 0; unique_data_blocks.clear(); pool.resetCounters(); direct_block_writes = 0; direct_block_reads = 0; sequential_write_batches = 0; peak_reads_in_flight = 0; }
     
 private:
+    /**
+     * Pin Block
+     * 
+     * Pins a block in the buffer pool for in-place access and counts one
+     * logical access. Must be paired with unpinBlock().
+     * 
+     * @param block_id ID of the block to pin
+     * @param overwrite true if the caller replaces the whole block (no read on miss)
+     * @return Pointer to the pinned frame, or nullptr on failure
+     */
+    Block* pinBlock(int block_id, bool overwrite = false);
+    
+    /**
+     * Unpin Block
+     * 
+     * Releases a block pinned with pinBlock().
+     * 
+     * @param block_id ID of the block to unpin
+     * @param dirty true if the frame was modified
+     */
+    void unpinBlock(int block_id, bool dirty) {
+        if (backend != StorageBackend::STREAM) return;
+        if (dirty && activeLog() != nullptr) {
+            // The frame's new contents join the operation's transaction
+            const Block* frame = pool.peekBlock(block_id);
+            if (frame != nullptr) log->logPage(log_file_id, blockOffset(block_id), frame, Block::BLOCK_SIZE);
+        }
+        pool.unpinBlock(block_id, dirty);
+    }
+    
+    /**
+     * Active Log
+     * 
+     * @return The attached log if this file is registered with it, else nullptr
+     */
+    WriteAheadLog* activeLog() const { return log_file_id >= 0 ? log : nullptr; }
+    
+    /**
+     * Logged Operation Class
+     * 
+     * Log transaction around one public operation. The metadata header is
+     * logged just before the commit (on destruction or commit()), and a
+     * due checkpoint runs after it.
+     */
+    class LoggedOperation {
+    public:
+        explicit LoggedOperation(Database& db) : db(db), transaction(db.activeLog(), true), active(true) {}
+        ~LoggedOperation() { commit(); }
+        
+        void commit() {
+            if (!active) return;
+            active = false;
+            if (db.activeLog() != nullptr) db.writeMetadata();
+            transaction.commit();
+        }
+        
+    private:
+        LoggedOperation(const LoggedOperation&);
+        LoggedOperation& operator=(const LoggedOperation&);
+        
+        Database& db;                 // Database being changed
+        LogTransaction transaction;   // Committed after the metadata is logged
+        bool active;                  // false once committed
+    };
+    
+    static const int METADATA_SIZE = 16;        // Bytes of file metadata before block 0
+    
+    /**
+     * Block File Offset
+     * 
+     * @param block_id ID of the block
+     * @return Byte offset of the block (after the metadata header)
+     */
+    static size_t blockOffset(int block_id) {
+        return METADATA_SIZE + static_cast<size_t>(block_id) * Block::BLOCK_SIZE;
+    }
+    
+    /**
+     * Truncate File
+     * 
+     * Shrinks the file to the metadata header plus num_blocks blocks.
+     * Buffer pool frames of dropped blocks must already be discarded.
+     * 
+     * @return true if the file was truncated
+     */
+    bool truncateFile();
+    
+    /**
+     * Physical Block I/O
+     * 
+     * Transfer a block between the file and memory. Only the buffer pool
+     * calls these, on a miss or on write-back (STREAM backend).
+     */
+    bool readBlockFromDisk(int block_id, Block& block);
+    bool writeBlockToDisk(int block_id, const Block& block);
+    
+    /**
+     * Write Block Run
+     * 
+     * Writes a run of consecutive blocks with a single sequential file write.
+     * The blocks must not be resident in the buffer pool.
+     * 
+     * @param first_block_id ID of the first block in the run
+     * @param blocks Contiguous array of blocks
+     * @param count Number of blocks in the run
+     * @return true if write was successful
+     */
+    bool writeBlockRun(int first_block_id, const Block* blocks, int count);
+    
+    /**
+     * Fetch Sorted Pointers
+     * 
+     * Shared implementation of fetchBatch(): reads the blocks of pointers
+     * sorted by packed value in runs and calls emit for every live entry.
+     * 
+     * @param order Packed pointers with their input positions, sorted
+     * @param distinct true to emit only the first of equal pointers
+     * @param prefetch true to keep many run reads in flight
+     * @param emit Function called as emit(record, location, input_position)
+     * @return Number of blocks read, or -1 if flushing, opening or reading the file failed
+     */
+    int fetchSorted(const std::vector<std::pair<int64_t, size_t> >& order, bool distinct, bool prefetch,
+                    const std::function<void(const Record&, const RecordPointer&, size_t)>& emit);
+    
+    /**
+     * Index Blocks
+     * 
+     * Passes every record of newly appended blocks to the catalog.
+     * 
+     * @param blocks Contiguous array of blocks (block IDs already stamped)
+     * @param count Number of blocks
+     */
+    void indexBlocks(const Block* blocks, int count);
+    
+    /**
+     * Report Capacity Exceeded
+     * 
+     * Prints the capacity error with the configured limit.
+     */
+    void reportCapacityExceeded() const;
+    
     /**
      * Write Metadata
      * 
-     * Writes database metadata (num_blocks, num_records) to disk.
+     * Records database metadata (num_blocks, num_records, free_list_head):
+     * written to disk, or only logged if a log is active (flush() writes
+     * it back like a dirty block).
      */
     void writeMetadata();
     
+    /**
+     * Store Metadata
+     * 
+     * Writes the metadata header to the file (STREAM backend), after the
+     * log allows it.
+     */
+    void storeMetadata();
+    
     /**
      * Read Metadata
      * 
-     * Reads database metadata (num_blocks, num_records) from disk.
+     * Reads database metadata (num_blocks, num_records, free_list_head) from disk.
      */
     void readMetadata();
 };
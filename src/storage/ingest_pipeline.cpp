@@ -0,0 +1,321 @@
+/**
+ * SC3020 Database Management System
+ * Ingest Pipeline Implementation
+ *
+ * This file contains the implementation of the IngestPipeline class:
+ * input splitting, the parser/packer/writer threads and the statistics
+ * report.
+ *
+ */
+
+#include "ingest_pipeline.h"
+#include "../utils/bounded_queue.h"
+#include <iostream>   // For error output
+#include <iomanip>    // For formatted statistics
+#include <fstream>    // For locating line boundaries
+#include <thread>     // For pipeline stages
+#include <atomic>     // For the failure flag
+#include <memory>     // For owning the parser queues
+#include <chrono>     // For stage timings
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Seconds elapsed since a time point
+inline double secondsSince(const Clock::time_point& start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+/**
+ * Ingest Pipeline Constructor
+ *
+ * @param db Open database to load into
+ * @param options Thread count, queue depth and batch sizes
+ */
+IngestPipeline::IngestPipeline(Database& db, const IngestOptions& options) : db(db), options(options) {
+    if (this->options.parser_threads <= 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        this->options.parser_threads = hardware > 0 ? static_cast<int>(hardware) : 1;
+    }
+    if (this->options.batch_records == 0) this->options.batch_records = 1;
+    if (this->options.write_batch_blocks <= 0) this->options.write_batch_blocks = 1;
+}
+
+bool IngestPipeline::splitInput(const std::string& filename, int num_ranges, std::vector<long long>& bounds) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+    long long size = static_cast<long long>(file.tellg());
+
+    bounds.assign(num_ranges + 1, size);
+    bounds[0] = 0;
+
+    // Move each nominal split point forward to the start of the next line
+    char buffer[4096];
+    for (int i = 1; i < num_ranges; i++) {
+        long long nominal = size * i / num_ranges;
+        long long start = nominal > bounds[i - 1] ? nominal : bounds[i - 1];
+        if (start >= size) break;
+        if (start == 0) {
+            bounds[i] = 0; // Empty range before the first line
+            continue;
+        }
+
+        // A line starts at 'start' if the previous byte is a newline
+        long long pos = start - 1;
+        file.seekg(pos);
+        bool found = false;
+        while (!found && pos < size) {
+            file.read(buffer, sizeof(buffer));
+            std::streamsize got = file.gcount();
+            if (got <= 0) break;
+            for (std::streamsize j = 0; j < got; j++) {
+                if (buffer[j] == '\n') {
+                    bounds[i] = pos + j + 1;
+                    found = true;
+                    break;
+                }
+            }
+            pos += got;
+        }
+        file.clear();
+        if (!found) break; // No further line starts: remaining ranges are empty
+    }
+    return true;
+}
+
+/**
+ * Run Pipeline
+ *
+ * Starts the parser, packer and writer threads and waits for them.
+ *
+ * Threading:
+ * - Parser i parses range i and pushes RecordBatch objects to queue i
+ * - The packer drains queue 0, then queue 1, ... so file order is kept
+ * - The writer is the only thread that touches the database
+ *
+ * @param filename Path to the TSV file
+ * @return true if the whole file was loaded
+ */
+bool IngestPipeline::run(const std::string& filename) {
+    stats = IngestStats();
+    Clock::time_point run_start = Clock::now();
+
+    if (!db.isOpen()) return false;
+
+    int num_parsers = options.parser_threads;
+    std::vector<long long> bounds;
+    if (!splitInput(filename, num_parsers, bounds)) return false;
+
+    stats.parser_threads = num_parsers;
+    stats.parse_busy.assign(num_parsers, 0.0);
+    stats.parse_wait.assign(num_parsers, 0.0);
+
+    // Free slots in the existing last block are filled first
+    int tail_free = 0;
+    if (db.getNumBlocks() > 0) {
+        Block tail;
+        if (db.readBlock(db.getNumBlocks() - 1, tail)) {
+            tail_free = Block::MAX_RECORDS - tail.getNumSlots();
+        }
+    }
+
+    std::vector<std::unique_ptr<BoundedQueue<RecordBatch> > > parse_queues;
+    for (int i = 0; i < num_parsers; i++) {
+        parse_queues.push_back(std::unique_ptr<BoundedQueue<RecordBatch> >(
+            new BoundedQueue<RecordBatch>(options.queue_depth)));
+    }
+    BoundedQueue<BlockBatch> write_queue(options.queue_depth);
+    std::atomic<bool> failed(false);
+    std::vector<long long> parser_bytes(num_parsers, 0);
+
+    // Stage 1: parsers
+    std::vector<std::thread> parsers;
+    for (int i = 0; i < num_parsers; i++) {
+        parsers.push_back(std::thread([this, i, &filename, &bounds, &parse_queues, &failed, &parser_bytes]() {
+            Clock::time_point start = Clock::now();
+            double wait = 0.0;
+            BoundedQueue<RecordBatch>& queue = *parse_queues[i];
+
+            RecordBatch batch;
+            batch.reserve(options.batch_records);
+            // Only the range that starts at offset 0 contains the header row
+            long long bytes = Parser::parseRange(filename, bounds[i], bounds[i + 1], bounds[i] == 0,
+                [this, &batch, &queue, &wait](const Record& record) {
+                    batch.push_back(record);
+                    if (batch.size() == options.batch_records) {
+                        Clock::time_point push_start = Clock::now();
+                        queue.push(std::move(batch));
+                        wait += secondsSince(push_start);
+                        batch = RecordBatch();
+                        batch.reserve(options.batch_records);
+                    }
+                });
+            if (bytes < 0) {
+                failed = true;
+            } else {
+                parser_bytes[i] = bytes;
+            }
+            if (!batch.empty()) {
+                Clock::time_point push_start = Clock::now();
+                queue.push(std::move(batch));
+                wait += secondsSince(push_start);
+            }
+            queue.close();
+
+            stats.parse_wait[i] = wait;
+            stats.parse_busy[i] = secondsSince(start) - wait;
+        }));
+    }
+
+    // Stage 2: packer
+    std::thread packer([this, num_parsers, tail_free, &parse_queues, &write_queue]() {
+        Clock::time_point start = Clock::now();
+        double wait = 0.0;
+        int tail_pending = tail_free;
+
+        BlockBatch out;
+        out.blocks.reserve(options.write_batch_blocks);
+
+        for (int i = 0; i < num_parsers; i++) {
+            RecordBatch batch;
+            while (true) {
+                Clock::time_point pop_start = Clock::now();
+                bool got = parse_queues[i]->pop(batch);
+                wait += secondsSince(pop_start);
+                if (!got) break;
+
+                for (size_t r = 0; r < batch.size(); r++) {
+                    // Top up the existing last block first
+                    if (tail_pending > 0) {
+                        out.tail_records.push_back(batch[r]);
+                        tail_pending--;
+                        continue;
+                    }
+
+                    if (out.blocks.empty() || !out.blocks.back().addRecord(batch[r])) {
+                        // Current block is full: hand off a complete run first
+                        if (static_cast<int>(out.blocks.size()) == options.write_batch_blocks) {
+                            Clock::time_point push_start = Clock::now();
+                            write_queue.push(std::move(out));
+                            wait += secondsSince(push_start);
+                            out = BlockBatch();
+                            out.blocks.reserve(options.write_batch_blocks);
+                        }
+                        out.blocks.push_back(Block());
+                        out.blocks.back().addRecord(batch[r]);
+                    }
+                }
+            }
+        }
+
+        // Last run (its final block may be partially filled)
+        if (!out.tail_records.empty() || !out.blocks.empty()) {
+            Clock::time_point push_start = Clock::now();
+            write_queue.push(std::move(out));
+            wait += secondsSince(push_start);
+        }
+        write_queue.close();
+
+        stats.pack_wait = wait;
+        stats.pack_busy = secondsSince(start) - wait;
+    });
+
+    // Stage 3: writer
+    std::thread writer([this, &write_queue, &failed]() {
+        Clock::time_point start = Clock::now();
+        double wait = 0.0;
+
+        BlockBatch batch;
+        while (true) {
+            Clock::time_point pop_start = Clock::now();
+            bool got = write_queue.pop(batch);
+            wait += secondsSince(pop_start);
+            if (!got) break;
+
+            // After a failure keep draining so upstream stages can finish
+            if (failed) continue;
+
+            if (!batch.tail_records.empty()) {
+                int appended = db.appendRecords(batch.tail_records);
+                stats.records_loaded += appended;
+                if (appended != static_cast<int>(batch.tail_records.size())) failed = true;
+            }
+            if (!batch.blocks.empty() && !failed) {
+                if (db.appendBlocks(&batch.blocks[0], static_cast<int>(batch.blocks.size()))) {
+                    stats.blocks_written += static_cast<long long>(batch.blocks.size());
+                    stats.write_batches++;
+                    for (size_t b = 0; b < batch.blocks.size(); b++) {
+                        stats.records_loaded += batch.blocks[b].getNumRecords();
+                    }
+                } else {
+                    failed = true;
+                }
+            }
+        }
+
+        stats.write_wait = wait;
+        stats.write_busy = secondsSince(start) - wait;
+    });
+
+    for (size_t i = 0; i < parsers.size(); i++) {
+        parsers[i].join();
+    }
+    packer.join();
+    writer.join();
+
+    // Persist metadata and any blocks written through the buffer pool
+    bool ok = db.flush() && !failed;
+
+    for (int i = 0; i < num_parsers; i++) {
+        stats.bytes_read += parser_bytes[i];
+    }
+    stats.total_seconds = secondsSince(run_start);
+    return ok;
+}
+
+/**
+ * Print Statistics
+ *
+ * Reports, per stage, the items processed, busy and wait time and the
+ * throughput based on busy time.
+ *
+ * @param out Output stream
+ */
+void IngestPipeline::printStats(std::ostream& out) const {
+    double parse_busy_max = 0.0;
+    double parse_busy_sum = 0.0;
+    double parse_wait_sum = 0.0;
+    for (size_t i = 0; i < stats.parse_busy.size(); i++) {
+        if (stats.parse_busy[i] > parse_busy_max) parse_busy_max = stats.parse_busy[i];
+        parse_busy_sum += stats.parse_busy[i];
+        parse_wait_sum += stats.parse_wait[i];
+    }
+    double mb = stats.bytes_read / (1024.0 * 1024.0);
+
+    out << "\n=== INGEST PIPELINE STATISTICS ===" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    out << "Parser threads: " << stats.parser_threads
+        << ", queue depth: " << options.queue_depth << " batches" << std::endl;
+    out << "Parse: " << stats.bytes_read << " bytes in " << stats.parser_threads << " ranges, busy "
+        << parse_busy_sum << " s total / " << parse_busy_max << " s slowest, wait " << parse_wait_sum << " s";
+    if (parse_busy_max > 0) out << " (" << mb / parse_busy_max << " MB/s)";
+    out << std::endl;
+    out << "Pack: " << stats.records_loaded << " records, busy " << stats.pack_busy
+        << " s, wait " << stats.pack_wait << " s";
+    if (stats.pack_busy > 0) out << " (" << static_cast<long long>(stats.records_loaded / stats.pack_busy) << " records/s)";
+    out << std::endl;
+    out << "Write: " << stats.blocks_written << " blocks in " << stats.write_batches
+        << " sequential batches, busy " << stats.write_busy << " s, wait " << stats.write_wait << " s";
+    if (stats.write_busy > 0) out << " (" << static_cast<long long>(stats.blocks_written / stats.write_busy) << " blocks/s)";
+    out << std::endl;
+    out << "Total: " << stats.total_seconds << " s";
+    if (stats.total_seconds > 0) out << " (" << static_cast<long long>(stats.records_loaded / stats.total_seconds) << " records/s)";
+    out << std::endl;
+    out << "==================================\n" << std::endl;
+}
@@ -0,0 +1,156 @@
+/**
+ * SC3020 Database Management System
+ * Ingest Pipeline Header
+ *
+ * This file defines the IngestPipeline class that loads a games.txt file
+ * into a Database using several threads connected by bounded queues.
+ *
+ * Pipeline Stages:
+ * 1. Parse: N parser threads each parse a disjoint, line-aligned byte range
+ *    of the input and emit batches of valid records
+ * 2. Pack: one thread consumes the parser queues in file order and packs
+ *    the records into full 4096-byte blocks
+ * 3. Write: one writer thread appends runs of packed blocks to the
+ *    database with large sequential writes
+ *
+ * Each parser has its own queue and the packer drains them in range order,
+ * so records land in the database in exactly the same order (and the file
+ * is byte-identical) as a single-threaded load. The bounded queues provide
+ * back-pressure, so memory use is capped by the queue depth rather than
+ * the input size.
+ */
+
+#ifndef INGEST_PIPELINE_H
+#define INGEST_PIPELINE_H
+
+// Include database and parsing components
+#include "database.h"
+#include "../utils/parser.h"
+
+// Standard C++ libraries
+#include <string>    // For file paths
+#include <vector>    // For batches and per-thread statistics
+#include <ostream>   // For statistics output
+#include <cstddef>   // For size_t
+
+/**
+ * Ingest Options Structure
+ *
+ * Tuning knobs for the pipeline. The defaults are suitable for files of
+ * any size; only parser_threads usually needs changing.
+ */
+struct IngestOptions {
+    int parser_threads;      // Number of parser threads (0 = one per hardware thread)
+    size_t queue_depth;      // Batches buffered between two stages
+    size_t batch_records;    // Records per batch handed from a parser to the packer
+    int write_batch_blocks;  // Blocks per sequential write issued by the writer
+
+    IngestOptions()
+        : parser_threads(0), queue_depth(8), batch_records(4096), write_batch_blocks(APPEND_BATCH_BLOCKS) {}
+};
+
+/**
+ * Ingest Statistics Structure
+ *
+ * Per-stage counters and timings from the last run. Busy time excludes
+ * time spent blocked on a queue, so items / busy time is the throughput a
+ * stage could sustain on its own; a stage with large wait time is being
+ * held back by its neighbours.
+ */
+struct IngestStats {
+    int parser_threads;                  // Parser threads actually used
+    long long bytes_read;                // Input bytes parsed
+    long long records_loaded;            // Valid records written to the database
+    long long blocks_written;            // Blocks appended by the writer
+    long long write_batches;             // Sequential writes issued by the writer
+    std::vector<double> parse_busy;      // Busy seconds per parser thread
+    std::vector<double> parse_wait;      // Seconds each parser waited for queue space
+    double pack_busy;                    // Seconds the packer spent packing
+    double pack_wait;                    // Seconds the packer waited on either queue
+    double write_busy;                   // Seconds the writer spent writing
+    double write_wait;                   // Seconds the writer waited for blocks
+    double total_seconds;                // Wall-clock time of the whole run
+
+    IngestStats()
+        : parser_threads(0), bytes_read(0), records_loaded(0), blocks_written(0), write_batches(0),
+          pack_busy(0), pack_wait(0), write_busy(0), write_wait(0), total_seconds(0) {}
+};
+
+/**
+ * Ingest Pipeline Class
+ *
+ * Loads a TSV file into an open Database with parsing, packing and writing
+ * overlapped across threads. The database must not be used by other
+ * threads while run() is executing.
+ */
+class IngestPipeline {
+public:
+    /**
+     * Constructor
+     *
+     * @param db Open database to load into
+     * @param options Thread count, queue depth and batch sizes
+     */
+    IngestPipeline(Database& db, const IngestOptions& options = IngestOptions());
+
+    /**
+     * Run Pipeline
+     *
+     * Appends every valid record of the file to the database and flushes it.
+     * If the database's last block is partially filled, it is topped up
+     * first, exactly as Database::appendRecords() would.
+     *
+     * @param filename Path to the TSV file (header row is skipped)
+     * @return true if the whole file was loaded
+     */
+    bool run(const std::string& filename);
+
+    /**
+     * Get Statistics
+     *
+     * @return Counters and timings of the last run()
+     */
+    const IngestStats& getStats() const { return stats; }
+
+    /**
+     * Print Statistics
+     *
+     * Prints per-stage throughput and wait times of the last run().
+     *
+     * @param out Output stream
+     */
+    void printStats(std::ostream& out) const;
+
+private:
+    typedef std::vector<Record> RecordBatch;   // Records from one parser, in file order
+
+    /**
+     * Block Batch Structure
+     *
+     * Unit of work for the writer: records that top up the existing last
+     * block (first batch only) followed by a run of newly packed blocks.
+     */
+    struct BlockBatch {
+        std::vector<Record> tail_records;   // Records for the existing partial block
+        std::vector<Block> blocks;          // New blocks, all full except possibly the last
+    };
+
+    Database& db;             // Destination database
+    IngestOptions options;    // Pipeline configuration
+    IngestStats stats;        // Statistics of the last run
+
+    /**
+     * Split Input
+     *
+     * Computes byte offsets that divide the file into ranges of roughly
+     * equal size, each starting at the beginning of a line.
+     *
+     * @param filename Path to the input file
+     * @param num_ranges Number of ranges wanted
+     * @param bounds Output: num_ranges + 1 offsets (first 0, last file size)
+     * @return true if the file could be read
+     */
+    static bool splitInput(const std::string& filename, int num_ranges, std::vector<long long>& bounds);
+};
+
+#endif // INGEST_PIPELINE_H
@@ -14,6 +14,7 @@
 #include <string>    // For string operations
 #include <cstring>   // For memory operations (memset, strncpy)
 #include <iostream>  // For console output
+#include <cstdint>   // For the sortable date key
 
 /**
  * NBA Game Record Structure
@@ -92,6 +93,45 @@ struct Record {
         return sizeof(Record);
     }
     
+    /**
+     * Parse Date Key
+     * 
+     * Converts a D/M/YYYY or DD/MM/YYYY date string into the integer
+     * YYYYMMDD, whose numeric order is chronological order (so dates can be
+     * range-scanned by an index).
+     * 
+     * @param date Null-terminated date string
+     * @return YYYYMMDD, or 0 if the string is not a valid date
+     */
+    static int32_t parseDateKey(const char* date) {
+        int32_t parts[3] = {0, 0, 0};
+        int part = 0;
+        int digits = 0;
+        for (const char* c = date; *c != '\0'; c++) {
+            if (*c == '/') {
+                if (digits == 0 || ++part > 2) return 0;
+                digits = 0;
+            } else if (*c >= '0' && *c <= '9') {
+                parts[part] = parts[part] * 10 + (*c - '0');
+                if (++digits > 4) return 0;
+            } else {
+                return 0;
+            }
+        }
+        if (part != 2 || digits != 4) return 0;
+        if (parts[0] < 1 || parts[0] > 31 || parts[1] < 1 || parts[1] > 12) return 0;
+        return parts[2] * 10000 + parts[1] * 100 + parts[0];
+    }
+    
+    /**
+     * Get Date Key
+     * 
+     * @return game_date as a sortable YYYYMMDD integer (0 if malformed)
+     */
+    int32_t dateKey() const {
+        return parseDateKey(game_date);
+    }
+    
     /**
      * Print Record for Debugging
      * 
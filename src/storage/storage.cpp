@@ -8,22 +8,43 @@
  */
 
 #include "database.h"
+#include "../utils/parallel.h"
 #include <iostream>  // For console output
 #include <cstring>   // For memory operations
+#include <algorithm> // For ordering compaction targets
+#include <unistd.h>  // For truncate, pread, close
+#include <fcntl.h>   // For open (read-only descriptors for direct reads)
+#include <memory>    // For per-worker scan state
 
 /**
  * Database Constructor
  * 
  * Initializes a Database object with the specified filename.
- * Sets initial values for block and record counts.
+ * Sets initial values for block and record counts and creates the
+ * buffer pool, wiring its physical I/O to this database file.
  * 
  * @param fname Path to the database file
+ * @param pool_frames Number of 4 KB frames in the buffer pool
+ * @param policy Buffer pool replacement policy
  */
-Database::Database(const std::string& fname) : filename(fname), num_blocks(0), num_records(0), data_blocks_accessed(0), total_data_block_ios(0) {
+Database::Database(const std::string& fname, size_t pool_frames, ReplacementPolicy policy)
+    : filename(fname), num_blocks(0), num_records(0), free_list_head(-1),
+      pool(pool_frames, policy,
+           [this](int block_id, Block& block) { return readBlockFromDisk(block_id, block); },
+           [this](int block_id, const Block& block) { return writeBlockToDisk(block_id, block); }),
+      backend(StorageBackend::STREAM), log(nullptr), log_file_id(-1), metadata_dirty(false), layout(BlockLayout::NSM),
+      capacity(MAX_DATABASE_SIZE),
+      data_blocks_accessed(0), total_data_block_ios(0),
+      direct_block_writes(0), direct_block_reads(0), sequential_write_batches(0),
+      read_ahead_blocks(DEFAULT_READ_AHEAD_BLOCKS), peak_reads_in_flight(0),
+      block_read_latency(nullptr), block_write_latency(nullptr) {
     // Constructor initializes member variables
     // filename: stores the path to the database file
     // num_blocks: tracks total number of blocks (starts at 0)
     // num_records: tracks total number of records (starts at 0)
+    // free_list_head: first block with a reusable hole (none yet)
+    // pool: caches blocks and performs physical I/O through this object
+    // log: no write-ahead log until attachLog()
     // data_blocks_accessed: tracks I/O operations for performance measurement
 }
 
@@ -43,9 +64,29 @@ Database::~Database() {
  * Opens the database file for reading and writing.
  * If the file doesn't exist, it creates a new file.
  * 
+ * @param backend Storage backend to use until close()
  * @return true if file was opened successfully, false otherwise
  */
-bool Database::open() {
+bool Database::open(StorageBackend backend) {
+    this->backend = backend;
+    
+    if (backend == StorageBackend::MMAP) {
+        // Map the file; a new (empty) file gets a fresh metadata header
+        if (!mapped.open(filename)) return false;
+        if (mapped.size() < static_cast<size_t>(METADATA_SIZE)) {
+            num_blocks = 0;
+            num_records = 0;
+            free_list_head = -1;
+            writeMetadata();
+        } else {
+            readMetadata();
+        }
+        return catalog.open(backend);
+    }
+    
+    // Recover the log before reading any metadata it may replace
+    if (log != nullptr && !log->open()) return false;
+    
     // Try to open file for both reading and writing
     file.open(filename, std::ios::binary | std::ios::in | std::ios::out);
     
@@ -62,8 +103,14 @@ bool Database::open() {
         // Load existing metadata
         readMetadata();
     }
+    if (!file.is_open()) return false;
+    
+    if (log != nullptr) {
+        log_file_id = log->registerFile(filename, [this]() { return flush(); });
+        if (log_file_id < 0) return false;
+    }
     
-    return file.is_open();
+    return catalog.open(backend);
 }
 
 /**
@@ -73,13 +120,57 @@ bool Database::open() {
  * This ensures all data is safely written to disk.
  */
 void Database::close() {
+    if (backend == StorageBackend::MMAP) {
+        if (mapped.isOpen()) {
+            // Checkpoint, then unmap and trim the file to its logical size
+            flush();
+            mapped.close();
+            catalog.close();
+        }
+        return;
+    }
+    
     if (file.is_open()) {
-        // Write metadata before closing
-        writeMetadata();
+        // Write back dirty frames and metadata before closing
+        flush();
+        if (activeLog() != nullptr) {
+            // Checkpoint so the next open() has nothing to replay
+            log->checkpoint();
+            log->unregisterFile(log_file_id);
+            log_file_id = -1;
+        }
         file.close();
+        pool.reset();
+        catalog.close();
     }
 }
 
+/**
+ * Flush Database
+ * 
+ * Writes back all dirty buffer pool frames, then the metadata header.
+ * 
+ * @return true if all writes succeeded
+ */
+bool Database::flush() {
+    if (!isOpen()) return false;
+    
+    bool indexes_ok = catalog.flush();
+    
+    if (backend == StorageBackend::MMAP) {
+        writeMetadata();
+        return mapped.sync() && indexes_ok;
+    }
+    
+    bool ok = pool.flushAll();
+    storeMetadata();
+    file.flush();
+    
+    // Committed operations are durable once their group is in the log
+    if (activeLog() != nullptr && !log->sync()) ok = false;
+    return ok && indexes_ok && file.good();
+}
+
 /**
  * Check if Database is Open
  * 
@@ -87,61 +178,222 @@ void Database::close() {
  * 
  * @return true if file is open, false otherwise
  */
+/**
+ * Attach Write-Ahead Log
+ * 
+ * The catalog forwards the log to every index it holds or is given.
+ * 
+ * @param wal Log to use (nullptr to detach)
+ */
+void Database::attachLog(WriteAheadLog* wal) {
+    log = wal;
+    catalog.attachLog(wal);
+}
+
+void Database::attachMetrics(MetricsRegistry* registry) {
+    block_read_latency = registry != nullptr ? &registry->histogram("database_block_read_seconds") : nullptr;
+    block_write_latency = registry != nullptr ? &registry->histogram("database_block_write_seconds") : nullptr;
+    catalog.attachMetrics(registry);
+}
+
 bool Database::isOpen() const {
-    return file.is_open();
+    return backend == StorageBackend::MMAP ? mapped.isOpen() : file.is_open();
 }
 
 /**
  * Write Block to File
  * 
- * Writes a block to the database file at the specified position.
- * Each block is written at a fixed offset based on its block ID.
+ * Writes a block through the buffer pool. The frame is marked dirty and
+ * reaches the file when it is evicted or flushed.
  * 
  * @param block_id ID of the block to write
  * @param block Block data to write
  * @return true if write was successful, false otherwise
  */
 bool Database::writeBlock(int block_id, const Block& block) {
-    if (!file.is_open()) return false;
+    Block* frame = pinBlock(block_id, true);
+    if (frame == nullptr) return false;
     
-    // Calculate file position: metadata (8 bytes) + block_id * block_size
-    file.seekp(8 + block_id * Block::BLOCK_SIZE);
+    // Replace the cached copy with the caller's block
+    *frame = block;
+    unpinBlock(block_id, true);
     
-    // Write the entire block to the file
-    file.write(reinterpret_cast<const char*>(&block), Block::BLOCK_SIZE);
-    
-    // Increment I/O counters
-    data_blocks_accessed++;            // kept for backward compat
-    total_data_block_ios++;
-    unique_data_blocks.insert(block_id);
-    
-    return file.good(); // Return true if write operation was successful
+    return true;
 }
 
 /**
  * Read Block from File
  * 
- * Reads a block from the database file at the specified position.
+ * Reads a block through the buffer pool. The file is only accessed
+ * when the block is not already resident.
  * 
  * @param block_id ID of the block to read
  * @param block Block object to store the read data
  * @return true if read was successful, false otherwise
  */
 bool Database::readBlock(int block_id, Block& block) {
-    if (!file.is_open()) return false;
+    Block* frame = pinBlock(block_id);
+    if (frame == nullptr) return false;
     
-    // Calculate file position: metadata (8 bytes) + block_id * block_size
-    file.seekg(8 + block_id * Block::BLOCK_SIZE);
+    // Copy the cached block out to the caller
+    block = *frame;
+    unpinBlock(block_id, false);
     
-    // Read the entire block from the file
-    file.read(reinterpret_cast<char*>(&block), Block::BLOCK_SIZE);
+    return true;
+}
+
+/**
+ * View Block in Place
+ * 
+ * Zero-copy access for the MMAP backend.
+ * 
+ * @param block_id ID of the block to view
+ * @return Pointer into the mapping, or nullptr
+ */
+const Block* Database::viewBlock(int block_id) {
+    if (backend != StorageBackend::MMAP) return nullptr;
+    return pinBlock(block_id);
+}
+
+/**
+ * Pin Block in Buffer Pool
+ * 
+ * Pins a block for in-place access and counts one logical block access.
+ * 
+ * @param block_id ID of the block to pin
+ * @param overwrite true if the caller replaces the whole block
+ * @return Pointer to the pinned frame, or nullptr on failure
+ */
+Block* Database::pinBlock(int block_id, bool overwrite) {
+    if (!isOpen() || block_id < 0) return nullptr;
+    
+    Block* frame = nullptr;
+    if (backend == StorageBackend::MMAP) {
+        // The "frame" is the block's bytes in the mapping
+        size_t end = blockOffset(block_id) + Block::BLOCK_SIZE;
+        if (end > mapped.size()) {
+            if (!overwrite || !mapped.resize(end)) return nullptr;
+        }
+        frame = reinterpret_cast<Block*>(mapped.data() + blockOffset(block_id));
+    } else {
+        frame = overwrite ? pool.newBlock(block_id) : pool.fetchBlock(block_id);
+    }
+    if (frame == nullptr) return nullptr;
     
-    // Increment I/O counters
+    // Increment I/O counters (logical accesses; physical I/O is counted by the pool)
     data_blocks_accessed++;            // kept for backward compat
     total_data_block_ios++;
     unique_data_blocks.insert(block_id);
     
-    return file.good(); // Return true if read operation was successful
+    return frame;
+}
+
+/**
+ * Read Block from Disk
+ * 
+ * Performs the physical read of one block. Called by the buffer pool on a miss.
+ * 
+ * @param block_id ID of the block to read
+ * @param block Frame to fill
+ * @return true if read was successful
+ */
+bool Database::readBlockFromDisk(int block_id, Block& block) {
+    LatencyTimer timer(block_read_latency);
+    if (backend == StorageBackend::MMAP) {
+        return mapped.read(blockOffset(block_id), &block, Block::BLOCK_SIZE);
+    }
+    
+    // Calculate file position: metadata header + block_id * block_size
+    file.seekg(static_cast<std::streamoff>(blockOffset(block_id)));
+    
+    // Read the entire block from the file
+    file.read(reinterpret_cast<char*>(&block), Block::BLOCK_SIZE);
+    
+    if (!file.good()) {
+        file.clear(); // Keep the stream usable after a short read
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Write Block to Disk
+ * 
+ * Performs the physical write of one block. Called by the buffer pool on
+ * eviction or flush of a dirty frame.
+ * 
+ * @param block_id ID of the block to write
+ * @param block Frame contents to write
+ * @return true if write was successful
+ */
+bool Database::writeBlockToDisk(int block_id, const Block& block) {
+    LatencyTimer timer(block_write_latency);
+    if (backend == StorageBackend::MMAP) {
+        return mapped.write(blockOffset(block_id), &block, Block::BLOCK_SIZE);
+    }
+    
+    // WAL rule: the block's committed image reaches the log first
+    if (activeLog() != nullptr && !log->beforeWrite(log_file_id, blockOffset(block_id), Block::BLOCK_SIZE)) {
+        return false;
+    }
+    
+    // Calculate file position: metadata header + block_id * block_size
+    file.seekp(static_cast<std::streamoff>(blockOffset(block_id)));
+    
+    // Write the entire block to the file
+    file.write(reinterpret_cast<const char*>(&block), Block::BLOCK_SIZE);
+    
+    return file.good(); // Return true if write operation was successful
+}
+
+/**
+ * Write Block Run to Disk
+ * 
+ * Writes consecutive blocks in one call so the file sees a single large
+ * sequential write instead of one seek and write per block.
+ * 
+ * @param first_block_id ID of the first block in the run
+ * @param blocks Contiguous array of blocks
+ * @param count Number of blocks in the run
+ * @return true if write was successful
+ */
+bool Database::writeBlockRun(int first_block_id, const Block* blocks, int count) {
+    if (count <= 0) return true;
+    
+    if (backend == StorageBackend::MMAP) {
+        // One copy into the (grown) mapping
+        if (!mapped.write(blockOffset(first_block_id), blocks,
+                          static_cast<size_t>(count) * Block::BLOCK_SIZE)) return false;
+    } else {
+        // Calculate file position: metadata header + block_id * block_size
+        file.seekp(static_cast<std::streamoff>(blockOffset(first_block_id)));
+        file.write(reinterpret_cast<const char*>(blocks),
+                   static_cast<std::streamsize>(count) * Block::BLOCK_SIZE);
+        if (!file.good()) return false;
+        
+        if (activeLog() != nullptr) {
+            // Blocks past the committed end need no images, only a sync
+            // before the commit; a block with an older image in the log
+            // (dropped by compaction) is logged so replay cannot resurrect it
+            for (int i = 0; i < count; i++) {
+                if (log->hasImage(log_file_id, blockOffset(first_block_id + i))) {
+                    log->logPage(log_file_id, blockOffset(first_block_id + i), &blocks[i], Block::BLOCK_SIZE);
+                }
+            }
+            file.flush();
+            log->requireSync(log_file_id);
+        }
+    }
+    
+    // Count logical accesses the same way as writeBlock() does
+    for (int i = 0; i < count; i++) {
+        data_blocks_accessed++;
+        total_data_block_ios++;
+        unique_data_blocks.insert(first_block_id + i);
+    }
+    direct_block_writes += count;
+    sequential_write_batches++;
+    return true;
 }
 
 /**
@@ -154,7 +406,7 @@ bool Database::readBlock(int block_id, Block& block) {
  * @return ID of the newly added block, or -1 if failed
  */
 int Database::addBlock(const Block& block) {
-    if (!file.is_open()) return -1;
+    if (!isOpen()) return -1;
     
     // Assign the next available block ID
     int block_id = num_blocks;
@@ -177,42 +429,72 @@ int Database::addBlock(const Block& block) {
  * scanning all blocks for each record.
  * 
  * Algorithm:
- * 1. Try to add to the current (last) block if it has space
- * 2. If current block is full, create a new block
- * 3. This ensures O(1) average case complexity
+ * 1. Reuse a hole in the block at the head of the free-block list
+ * 2. Otherwise try to add to the current (last) block if it has space
+ * 3. If current block is full, create a new block
+ * 4. This ensures O(1) average case complexity
  * 
  * @param record Record to add
  * @return true if record was added successfully, false otherwise
  */
 bool Database::addRecord(const Record& record) {
-    // Step 1: Try to add to the current block if it exists and has space
+    LoggedOperation operation(*this);
+    
+    // Step 1: Fill a hole left by a deletion, if any
+    if (free_list_head != -1) {
+        int block_id = free_list_head;
+        Block* block = pinBlock(block_id);
+        if (block != nullptr) {
+            int slot = block->insertRecord(record);
+            bool added = slot != -1;
+            if (added && !block->hasHoles()) {
+                // Last hole filled: unlink the block from the free-block list
+                free_list_head = block->header.next_block;
+                block->header.next_block = -1;
+            }
+            unpinBlock(block_id, added);
+            if (added) {
+                num_records++;
+                catalog.onInsert(record, RecordPointer(block_id, slot));
+                return true;
+            }
+        }
+    }
+    
+    // Step 2: Try to add to the current block if it exists and has space.
+    // The block is modified in place in its buffer pool frame.
     if (num_blocks > 0) {
-        Block currentBlock;
-        if (readBlock(num_blocks - 1, currentBlock)) {
-            if (!currentBlock.isFull()) {
-                currentBlock.addRecord(record);
-                writeBlock(num_blocks - 1, currentBlock);
+        int last_block = num_blocks - 1;
+        Block* currentBlock = pinBlock(last_block);
+        if (currentBlock != nullptr) {
+            bool added = currentBlock->addRecord(record);
+            int slot = currentBlock->getNumSlots() - 1;
+            unpinBlock(last_block, added);
+            if (added) {
                 num_records++;
+                catalog.onInsert(record, RecordPointer(last_block, slot));
                 return true;
             }
         }
     }
 
-    // Step 2: Capacity check before creating a new block
-    static const size_t MAX_DATABASE_SIZE = 100 * 1024 * 1024; // 100 MB
-    size_t current_size = (num_blocks * Block::BLOCK_SIZE) + sizeof(int) * 2; // 8-byte metadata
-    if (current_size + Block::BLOCK_SIZE > MAX_DATABASE_SIZE) {
-        std::cerr << "Error: Database capacity exceeded (100 MB limit)." << std::endl;
+    // Step 3: Capacity check before creating a new block
+    size_t current_size = (static_cast<size_t>(num_blocks) * Block::BLOCK_SIZE) + METADATA_SIZE;
+    if (current_size + Block::BLOCK_SIZE > capacity) {
+        reportCapacityExceeded();
         return false;
     }
 
-    // Step 3: Create new block if current block is full or doesn't exist
+    // Step 4: Create new block if current block is full or doesn't exist
     Block newBlock;
+    newBlock.clear(layout);
     newBlock.header.block_id = num_blocks;
     newBlock.addRecord(record);
 
-    if (addBlock(newBlock) != -1) {
+    int block_id = addBlock(newBlock);
+    if (block_id != -1) {
         num_records++;
+        catalog.onInsert(record, RecordPointer(block_id, 0));
         return true;
     }
 
@@ -220,6 +502,153 @@ bool Database::addRecord(const Record& record) {
 }
 
 
+/**
+ * Append Records in Bulk
+ * 
+ * Bulk load path for ingesting many records at once.
+ * 
+ * Algorithm:
+ * 1. Fill the free slots of the current last block in its buffer pool frame
+ * 2. Pack the remaining records into new blocks in a memory batch
+ * 3. Write each full batch with one sequential write
+ * 4. Write the metadata header once
+ * 
+ * @param records Records to append
+ * @return Number of records appended
+ */
+int Database::appendRecords(const std::vector<Record>& records) {
+    if (records.empty()) return 0;
+    return appendRecords(&records[0], records.size());
+}
+
+int Database::appendRecords(const Record* records, size_t count) {
+    if (!isOpen() || count == 0) return 0;
+    LoggedOperation operation(*this);
+    
+    size_t next = 0;
+    
+    // Step 1: Top up the partially filled last block
+    if (num_blocks > 0) {
+        int last_block = num_blocks - 1;
+        Block* tail = pinBlock(last_block);
+        if (tail != nullptr) {
+            bool modified = false;
+            while (next < count && tail->addRecord(records[next])) {
+                catalog.onInsert(records[next], RecordPointer(last_block, tail->getNumSlots() - 1));
+                next++;
+                modified = true;
+            }
+            unpinBlock(last_block, modified);
+            num_records += static_cast<int>(next);
+        }
+    }
+    
+    // Capacity check: never grow the file beyond its capacity
+    size_t remaining = count - next;
+    size_t blocks_needed = (remaining + Block::MAX_RECORDS - 1) / Block::MAX_RECORDS;
+    size_t header_size = METADATA_SIZE;
+    size_t max_blocks = capacity > header_size ? (capacity - header_size) / Block::BLOCK_SIZE : 0;
+    size_t free_blocks = max_blocks > static_cast<size_t>(num_blocks) ? max_blocks - num_blocks : 0;
+    if (blocks_needed > free_blocks) {
+        reportCapacityExceeded();
+        blocks_needed = free_blocks;
+    }
+    
+    // Steps 2-3: Pack new blocks in memory and write them batch by batch
+    std::vector<Block> batch(blocks_needed < static_cast<size_t>(APPEND_BATCH_BLOCKS)
+                             ? blocks_needed : APPEND_BATCH_BLOCKS);
+    size_t blocks_written = 0;
+    while (blocks_written < blocks_needed) {
+        int batch_size = 0;
+        int first_block_id = num_blocks;
+        size_t batch_records = 0;
+        
+        while (batch_size < static_cast<int>(batch.size()) && blocks_written + batch_size < blocks_needed) {
+            Block& block = batch[batch_size];
+            block.clear(layout);
+            block.header.block_id = first_block_id + batch_size;
+            while (next + batch_records < count && block.addRecord(records[next + batch_records])) {
+                batch_records++;
+            }
+            batch_size++;
+        }
+        
+        if (!writeBlockRun(first_block_id, &batch[0], batch_size)) break;
+        if (!catalog.empty()) indexBlocks(&batch[0], batch_size);
+        
+        num_blocks += batch_size;
+        num_records += static_cast<int>(batch_records);
+        next += batch_records;
+        blocks_written += batch_size;
+    }
+    
+    // Step 4: Persist the new counts once
+    writeMetadata();
+    
+    return static_cast<int>(next);
+}
+
+/**
+ * Append Pre-Packed Blocks
+ * 
+ * Used by loaders that pack blocks themselves (e.g. the ingest pipeline).
+ * The blocks are written after the current last block in one run; the
+ * header of each block is stamped with its final block ID and the block
+ * is converted to the database's layout if it was packed in another.
+ * 
+ * @param blocks Contiguous array of blocks (block IDs and layouts are overwritten)
+ * @param count Number of blocks
+ * @return true if every block was written
+ */
+bool Database::appendBlocks(Block* blocks, int count) {
+    if (!isOpen() || count < 0) return false;
+    if (count == 0) return true;
+    LoggedOperation operation(*this);
+    
+    // Capacity check: never grow the file beyond its capacity
+    size_t header_size = METADATA_SIZE;
+    size_t new_size = header_size + static_cast<size_t>(num_blocks + count) * Block::BLOCK_SIZE;
+    if (new_size > capacity) {
+        reportCapacityExceeded();
+        return false;
+    }
+    
+    // Stamp each block with its final ID and layout
+    int first_block_id = num_blocks;
+    for (int i = 0; i < count; i++) {
+        blocks[i].header.block_id = first_block_id + i;
+        blocks[i].convertLayout(layout);
+    }
+    
+    if (!writeBlockRun(first_block_id, blocks, count)) return false;
+    if (!catalog.empty()) indexBlocks(blocks, count);
+    
+    num_blocks += count;
+    for (int i = 0; i < count; i++) {
+        num_records += blocks[i].getNumRecords();
+    }
+    return true;
+}
+
+/**
+ * Index Blocks
+ * 
+ * Adds every record of newly written blocks to the secondary indexes.
+ * 
+ * @param blocks Contiguous array of blocks (block IDs already stamped)
+ * @param count Number of blocks
+ */
+void Database::indexBlocks(const Block* blocks, int count) {
+    for (int b = 0; b < count; b++) {
+        const Block& block = blocks[b];
+        for (int slot = 0; slot < block.getNumSlots(); slot++) {
+            if (block.isOccupied(slot)) {
+                catalog.onInsert(block.getRecord(slot), RecordPointer(block.header.block_id, slot));
+            }
+        }
+    }
+}
+
 /**
  * Get Record from Database
  * 
@@ -230,25 +659,447 @@ bool Database::addRecord(const Record& record) {
  * @return Record at the specified location
  */
 Record Database::getRecord(int block_id, int record_index) {
-    Block block;
-    if (readBlock(block_id, block)) {
-        return block.getRecord(record_index);
+    Block* block = pinBlock(block_id);
+    if (block != nullptr) {
+        Record record = block->getRecord(record_index);
+        unpinBlock(block_id, false);
+        return record;
     }
     return Record(); // Return empty record if read failed
 }
 
+/**
+ * Delete Record from Database
+ * 
+ * Frees the slot in place in its buffer pool frame. The first hole in a
+ * block links the block into the free-block list, so the slot is reused
+ * by a later addRecord().
+ * 
+ * @param block_id ID of the block containing the record
+ * @param record_index Index of the record within the block
+ * @return true if the slot held a live record
+ */
 bool Database::deleteRecord(int block_id, int record_index) {
-    Block block;
-    if (readBlock(block_id, block)) {
-        // Create an empty record to mark as deleted
-        Record empty_record;
-        // Replace the record at the specified index
-        size_t offset = record_index * sizeof(Record);
-        memcpy(block.data + offset, &empty_record, sizeof(Record));
-        // Write the updated block back to disk
-        return writeBlock(block_id, block);
+    if (block_id >= num_blocks) return false;
+    LoggedOperation operation(*this);
+    
+    Block* block = pinBlock(block_id);
+    if (block == nullptr) return false; // Return false if read failed
+    
+    bool had_holes = block->hasHoles();
+    // Keep the old contents for the secondary indexes
+    Record removed;
+    if (!catalog.empty()) removed = block->getRecord(record_index);
+    if (!block->removeRecord(record_index)) {
+        unpinBlock(block_id, false);
+        return false; // Slot was already free
+    }
+    if (!had_holes) {
+        block->header.next_block = free_list_head;
+        free_list_head = block_id;
+    }
+    num_records--;
+    
+    // The dirty frame is written back on eviction or flush
+    unpinBlock(block_id, true);
+    if (!catalog.empty()) catalog.onDelete(removed, RecordPointer(block_id, record_index));
+    return true;
+}
+
+/**
+ * Fetch Records in Batch
+ * 
+ * Sorts (packed pointer, position) pairs and fills records[position].
+ * 
+ * @param pointers Record locations
+ * @param records Output records, aligned with pointers
+ * @param prefetch true to overlap reading the next run with decoding
+ * @return Number of blocks read, or -1 on an I/O failure
+ */
+int Database::fetchBatch(const std::vector<RecordPointer>& pointers, std::vector<Record>& records, bool prefetch) {
+    records.assign(pointers.size(), Record());
+    
+    std::vector<std::pair<int64_t, size_t> > order(pointers.size());
+    for (size_t i = 0; i < pointers.size(); i++) {
+        order[i] = std::make_pair(pointers[i].pack(), i);
+    }
+    std::sort(order.begin(), order.end());
+    
+    return fetchSorted(order, false, prefetch,
+        [&records](const Record& record, const RecordPointer&, size_t position) {
+            records[position] = record;
+        });
+}
+
+/**
+ * Fetch Records in Batch (Visitor)
+ * 
+ * @param pointers Record locations
+ * @param visitor Function called once per distinct live pointer, in block order
+ * @param prefetch true to overlap reading the next run with decoding
+ * @return Number of blocks read, or -1 on an I/O failure
+ */
+int Database::fetchBatch(const std::vector<RecordPointer>& pointers, const FetchCallback& visitor, bool prefetch) {
+    std::vector<std::pair<int64_t, size_t> > order(pointers.size());
+    for (size_t i = 0; i < pointers.size(); i++) {
+        order[i] = std::make_pair(pointers[i].pack(), i);
+    }
+    std::sort(order.begin(), order.end());
+    
+    return fetchSorted(order, true, prefetch,
+        [&visitor](const Record& record, const RecordPointer& ptr, size_t) {
+            visitor(record, ptr);
+        });
+}
+
+/**
+ * Fetch Sorted Pointers
+ * 
+ * Algorithm:
+ * 1. Collect the distinct block IDs (the pointers are sorted by block)
+ * 2. Group adjacent IDs into runs of at most APPEND_BATCH_BLOCKS blocks
+ * 3. Read each run with one sequential read (or view it in the mapping).
+ *    With prefetch up to DEFAULT_IO_QUEUE_DEPTH runs (read_ahead_blocks
+ *    blocks) are submitted to an IOQueue at once and refilled as they
+ *    complete
+ * 4. Emit the pointed-to records of each block in pointer order. Runs are
+ *    decoded in block order when distinct is set (the visitor form of
+ *    fetchBatch), otherwise in completion order
+ * 
+ * @param order Packed pointers with their input positions, sorted
+ * @param distinct true to emit only the first of equal pointers
+ * @param prefetch true to keep many run reads in flight
+ * @param emit Function called as emit(record, location, input_position)
+ * @return Number of blocks read, or -1 if flushing, opening or reading the
+ *         file failed (emit may already have seen some records)
+ */
+int Database::fetchSorted(const std::vector<std::pair<int64_t, size_t> >& order, bool distinct, bool prefetch,
+                          const std::function<void(const Record&, const RecordPointer&, size_t)>& emit) {
+    if (!isOpen() || order.empty()) return 0;
+    
+    // The runs are read from the file directly, so cached writes must reach it first
+    if (backend == StorageBackend::STREAM && !flush()) return -1;
+    
+    // Steps 1-2: Distinct valid blocks (with their first entry in order), cut into runs of adjacent IDs
+    std::vector<int> blocks;
+    std::vector<size_t> block_starts;  // Index into order of the first pointer to each block
+    for (size_t i = 0; i < order.size(); i++) {
+        int block_id = RecordPointer::unpack(order[i].first).block_id;
+        if (block_id < 0 || block_id >= num_blocks) continue;
+        if (blocks.empty() || blocks.back() != block_id) {
+            blocks.push_back(block_id);
+            block_starts.push_back(i);
+        }
+    }
+    std::vector<size_t> run_starts;  // Index into blocks of the first block of each run
+    for (size_t b = 0; b < blocks.size(); b++) {
+        if (b == 0 || blocks[b] != blocks[b - 1] + 1 ||
+            b - run_starts.back() == static_cast<size_t>(APPEND_BATCH_BLOCKS)) {
+            run_starts.push_back(b);
+        }
+    }
+    run_starts.push_back(blocks.size());
+    size_t num_runs = run_starts.size() - 1;
+    
+    // Step 4 for one run
+    int blocks_read = 0;
+    auto decodeRun = [&](size_t run, const Block* run_blocks) {
+        for (size_t b = run_starts[run]; b < run_starts[run + 1]; b++) {
+            const Block& block = run_blocks[b - run_starts[run]];
+            int block_id = blocks[b];
+            
+            // Count one logical access per block, as readBlock() does
+            data_blocks_accessed++;
+            total_data_block_ios++;
+            unique_data_blocks.insert(block_id);
+            if (backend == StorageBackend::STREAM) direct_block_reads++;
+            blocks_read++;
+            
+            for (size_t next = block_starts[b]; next < order.size(); next++) {
+                RecordPointer ptr = RecordPointer::unpack(order[next].first);
+                if (ptr.block_id != block_id) break;
+                bool duplicate = distinct && next > 0 && order[next - 1].first == order[next].first;
+                if (!duplicate && block.isOccupied(ptr.record_index)) {
+                    emit(block.getRecord(ptr.record_index), ptr, order[next].second);
+                }
+            }
+        }
+    };
+    auto runBlocks = [&run_starts](size_t run) { return static_cast<int>(run_starts[run + 1] - run_starts[run]); };
+    
+    // Step 3: The mapping is read in place; the kernel reads ahead on a hint
+    if (backend == StorageBackend::MMAP) {
+        for (size_t run = 0; run < num_runs; run++) {
+            if (prefetch && run + 1 < num_runs) {
+                mapped.willNeed(blockOffset(blocks[run_starts[run + 1]]), runBlocks(run + 1) * Block::BLOCK_SIZE);
+            }
+            decodeRun(run, reinterpret_cast<const Block*>(mapped.data() + blockOffset(blocks[run_starts[run]])));
+        }
+        return blocks_read;
+    }
+    
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return -1;
+    
+    if (!prefetch) {
+        // One read at a time into one buffer
+        std::vector<Block> buffer;
+        for (size_t run = 0; run < num_runs; run++) {
+            size_t bytes = static_cast<size_t>(runBlocks(run)) * Block::BLOCK_SIZE;
+            buffer.resize(runBlocks(run));
+            if (pread(fd, &buffer[0], bytes, static_cast<off_t>(blockOffset(blocks[run_starts[run]]))) !=
+                static_cast<ssize_t>(bytes)) {
+                ::close(fd);
+                return -1;
+            }
+            decodeRun(run, &buffer[0]);
+        }
+        ::close(fd);
+        return blocks_read;
+    }
+    
+    // Asynchronous: one buffer per queue slot, runs submitted while the window has room
+    IOQueue queue(DEFAULT_IO_QUEUE_DEPTH);
+    std::vector<std::vector<Block> > buffers(queue.getDepth());
+    std::vector<int> free_buffers;
+    for (int i = queue.getDepth() - 1; i >= 0; i--) free_buffers.push_back(i);
+    std::vector<int> run_buffer(num_runs, -1);
+    int window_blocks = std::max(read_ahead_blocks, APPEND_BATCH_BLOCKS);
+    int blocks_in_flight = 0;
+    size_t next_submit = 0;
+    bool failed = false;
+    auto submitRuns = [&]() {
+        while (next_submit < num_runs && !queue.full() &&
+               (blocks_in_flight == 0 || blocks_in_flight + runBlocks(next_submit) <= window_blocks)) {
+            int slot = free_buffers.back();
+            std::vector<Block>& buffer = buffers[slot];
+            buffer.resize(runBlocks(next_submit));
+            if (!queue.submitRead(fd, static_cast<int64_t>(blockOffset(blocks[run_starts[next_submit]])), &buffer[0],
+                                  buffer.size() * Block::BLOCK_SIZE, next_submit)) {
+                failed = true;
+                break;
+            }
+            free_buffers.pop_back();
+            run_buffer[next_submit] = slot;
+            blocks_in_flight += runBlocks(next_submit);
+            next_submit++;
+        }
+    };
+    
+    submitRuns();
+    for (size_t decoded = 0; decoded < num_runs && !failed; decoded++) {
+        IOCompletion completion;
+        if (distinct ? !queue.waitFor(decoded, completion) : !queue.waitAny(completion)) {
+            failed = true;
+            break;
+        }
+        size_t run = static_cast<size_t>(completion.tag);
+        int slot = run_buffer[run];
+        if (completion.result != static_cast<ssize_t>(buffers[slot].size() * Block::BLOCK_SIZE)) {
+            failed = true;
+            break;
+        }
+        decodeRun(run, &buffers[slot][0]);
+        
+        free_buffers.push_back(slot);
+        blocks_in_flight -= runBlocks(run);
+        submitRuns();
+    }
+    
+    // Outstanding reads (after a failure) finish before their buffers go away
+    IOCompletion completion;
+    while (queue.waitAny(completion)) {}
+    peak_reads_in_flight = std::max(peak_reads_in_flight, queue.getPeakOutstanding());
+    ::close(fd);
+    return failed ? -1 : blocks_read;
+}
+
+/**
+ * Compact Database
+ * 
+ * Two-cursor compaction: records move from the highest occupied slot of
+ * the last non-empty block (source) into the lowest free slot of the
+ * lowest block with space (target) until the cursors meet.
+ * 
+ * Algorithm:
+ * 1. Collect targets: every block on the free-block list plus the last block
+ * 2. Drain source blocks from the end into the targets, in ascending order
+ * 3. When target and source meet, close the holes inside that block
+ * 4. Drop the empty blocks at the end and truncate the file
+ * 
+ * Afterwards every block but the last is full and the free-block list is
+ * empty.
+ * 
+ * @param moves Output: old and new location of every moved record
+ * @return Number of blocks freed
+ */
+int Database::compact(std::vector<RecordMove>& moves) {
+    moves.clear();
+    if (!isOpen() || num_blocks == 0) return 0;
+    
+    // One logged operation; with a log the file is truncated once it is durable
+    LoggedOperation operation(*this);
+    
+    // Step 1: Blocks with free slots, unlinked from the free-block list
+    std::vector<int> targets;
+    int next = free_list_head;
+    while (next != -1 && next < num_blocks) {
+        Block* block = pinBlock(next);
+        if (block == nullptr) break;
+        int block_id = next;
+        next = block->header.next_block;
+        block->header.next_block = -1;
+        unpinBlock(block_id, true);
+        targets.push_back(block_id);
+    }
+    free_list_head = -1;
+    targets.push_back(num_blocks - 1); // Free slots after num_slots
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    
+    // Step 2: Move records from the end into the lowest free slots
+    int source = num_blocks - 1;
+    size_t t = 0;
+    while (t < targets.size() && source >= 0 && targets[t] <= source) {
+        int target = targets[t];
+        Block* src = pinBlock(source);
+        if (src == nullptr) break;
+        
+        if (target == source) {
+            // Step 3: Cursors met: pack the block's own records to the front
+            int hole = src->firstFreeSlot();
+            int last = src->lastOccupiedSlot();
+            while (hole != -1 && hole < last) {
+                Record record = src->getRecord(last);
+                src->removeRecord(last);
+                src->insertRecord(record);
+                moves.push_back(RecordMove(RecordPointer(source, last), RecordPointer(source, hole)));
+                hole = src->firstFreeSlot();
+                last = src->lastOccupiedSlot();
+            }
+            src->trimSlots();
+            bool empty = src->getNumRecords() == 0;
+            unpinBlock(source, true);
+            if (empty) source--;
+            break;
+        }
+        
+        Block* dst = pinBlock(target);
+        if (dst == nullptr) {
+            unpinBlock(source, false);
+            break;
+        }
+        while (!dst->isFull() && src->getNumRecords() > 0) {
+            int slot = src->lastOccupiedSlot();
+            Record record = src->getRecord(slot);
+            src->removeRecord(slot);
+            int new_slot = dst->insertRecord(record);
+            moves.push_back(RecordMove(RecordPointer(source, slot), RecordPointer(target, new_slot)));
+        }
+        src->trimSlots();
+        bool target_full = dst->isFull();
+        bool source_empty = src->getNumRecords() == 0;
+        unpinBlock(target, true);
+        unpinBlock(source, true);
+        
+        if (target_full) t++;
+        if (source_empty) source--;
     }
-    return false; // Return false if read failed
+    
+    // Step 4: Drop the drained blocks and shrink the file
+    int freed = num_blocks - (source + 1);
+    if (freed > 0) {
+        if (backend == StorageBackend::STREAM) {
+            // Write back surviving frames and forget the dropped ones
+            pool.flushAll();
+            pool.reset();
+        }
+        num_blocks = source + 1;
+        // Until the compaction is durable the committed metadata still
+        // references the dropped blocks
+        if (activeLog() == nullptr) truncateFile();
+    }
+    writeMetadata();
+    catalog.onMove(moves);
+    operation.commit();
+    
+    if (freed > 0 && activeLog() != nullptr && log->sync()) truncateFile();
+    return freed;
+}
+
+/**
+ * Set Block Layout
+ *
+ * @param new_layout Layout of blocks created from now on
+ */
+void Database::setLayout(BlockLayout new_layout) {
+    if (new_layout == layout) return;
+    LoggedOperation operation(*this);
+    layout = new_layout;
+    writeMetadata();
+}
+
+/**
+ * Convert Block Layout
+ *
+ * Blocks already in the target layout are read but not written.
+ *
+ * @param new_layout Target layout
+ * @return Number of blocks converted
+ */
+int Database::convertLayout(BlockLayout new_layout) {
+    if (!isOpen()) return 0;
+    setLayout(new_layout);
+
+    int converted = 0;
+    for (int block_id = 0; block_id < num_blocks; block_id++) {
+        LoggedOperation operation(*this);
+        Block* block = pinBlock(block_id);
+        if (block == nullptr) continue;
+        bool convert = block->getLayout() != new_layout;
+        if (convert) {
+            block->convertLayout(new_layout);
+            converted++;
+        }
+        unpinBlock(block_id, convert);
+    }
+    return converted;
+}
+
+/**
+ * Truncate File
+ *
+ * Cuts the file after the last block: through the mapping for MMAP,
+ * by path for STREAM (the open stream keeps using the same file).
+ * 
+ * @return true if the file was truncated
+ */
+bool Database::truncateFile() {
+    size_t size = blockOffset(num_blocks);
+    if (backend == StorageBackend::MMAP) {
+        return mapped.resize(size);
+    }
+    file.flush();
+    return truncate(filename.c_str(), static_cast<off_t>(size)) == 0;
+}
+
+/**
+ * Get Free-Block List Length
+ * 
+ * @return Number of blocks on the free-block list
+ */
+int Database::getNumFreeListBlocks() {
+    int count = 0;
+    int next = free_list_head;
+    while (next != -1 && next < num_blocks && count < num_blocks) {
+        Block* block = pinBlock(next);
+        if (block == nullptr) break;
+        int block_id = next;
+        next = block->header.next_block;
+        unpinBlock(block_id, false);
+        count++;
+    }
+    return count;
 }
 
 /**
@@ -265,6 +1116,13 @@ void Database::printStatistics() const {
     std::cout << "Total records: " << num_records << std::endl;
     std::cout << "Total blocks: " << num_blocks << std::endl;
     std::cout << "Block size: " << Block::BLOCK_SIZE << " bytes" << std::endl;
+    std::cout << "Block layout: " << (layout == BlockLayout::PAX ? "PAX (column minipages)" : "NSM (row slots)") << std::endl;
+    if (backend == StorageBackend::MMAP) {
+        std::cout << "Storage backend: mmap (OS page cache)" << std::endl;
+    } else {
+        std::cout << "Buffer pool: " << pool.getNumFrames() << " frames ("
+                  << (pool.getPolicy() == ReplacementPolicy::CLOCK ? "CLOCK" : "LRU") << ")" << std::endl;
+    }
     std::cout << "Database file: " << filename << std::endl;
     std::cout << "==========================\n" << std::endl;
 }
@@ -273,65 +1131,475 @@ void Database::printStatistics() const {
  * Get All Records
  * 
  * Retrieves all records from the database and returns them as a vector.
- * This function reads all blocks and extracts all records.
+ * Prefer scan() for large databases: this materializes every record.
  * 
  * @return Vector containing all records in the database
  */
 std::vector<Record> Database::getAllRecords() {
     std::vector<Record> records;
+    records.reserve(num_records);
+    
+    scan([&records](const Record& record, int, int) { records.push_back(record); });
     
-    // Iterate through all blocks
-    for (int i = 0; i < num_blocks; i++) {
-        Block block;
-        if (readBlock(i, block)) {
-            // Extract all records from this block
-            for (int j = 0; j < block.getNumRecords(); j++) {
-                records.push_back(block.getRecord(j));
+    return records;
+}
+
+/**
+ * Scan All Records
+ * 
+ * Streams the database block by block through the buffer pool. The
+ * callback sees records copied out of the pinned frame, so it may call
+ * other Database methods.
+ * 
+ * @param callback Function called as callback(record, block_id, record_index)
+ * @return Number of blocks scanned
+ */
+int Database::scan(const ScanCallback& callback) {
+    int blocks_scanned = 0;
+    
+    for (int block_id = 0; block_id < num_blocks; block_id++) {
+        Block* block = pinBlock(block_id);
+        if (block == nullptr) continue;
+        blocks_scanned++;
+        
+        // Copy the used slots and their bitmap out before releasing the frame
+        int count = block->getNumSlots();
+        if (count > Block::MAX_RECORDS) count = Block::MAX_RECORDS;
+        uint32_t bitmap[Block::BITMAP_WORDS];
+        Record records[Block::MAX_RECORDS];
+        memcpy(bitmap, block->slot_bitmap, sizeof(bitmap));
+        block->copySlots(records, count);
+        unpinBlock(block_id, false);
+        
+        // Visit only occupied slots, one bitmap word at a time
+        for (int w = 0; w < Block::BITMAP_WORDS; w++) {
+            uint32_t bits = bitmap[w];
+            while (bits != 0) {
+                int i = w * 32 + __builtin_ctz(bits);
+                bits &= bits - 1;
+                if (i >= count) break;
+                callback(records[i], block_id, i);
             }
         }
     }
     
-    return records;
+    return blocks_scanned;
+}
+
+/**
+ * Scan Blocks
+ * 
+ * Block-at-a-time through pinned frames, or batch-at-a-time with direct
+ * sequential reads (or in place in the mapping). Batched scans go run by
+ * run over the blocks the filter keeps; without a filter the whole file
+ * is one run.
+ * 
+ * @param callback Function called as callback(blocks, first_block_id, count)
+ * @param batch_blocks Blocks per callback (1 = block by block through the pool)
+ * @param filter Blocks to visit (empty = every block)
+ * @return Number of blocks scanned
+ */
+int Database::scanBlocks(const BlockScanCallback& callback, int batch_blocks, const BlockFilter& filter) {
+    if (!isOpen()) return 0;
+    int blocks_scanned = 0;
+    
+    if (batch_blocks <= 1) {
+        for (int block_id = 0; block_id < num_blocks; block_id++) {
+            if (filter && !filter(block_id)) continue;
+            Block* block = pinBlock(block_id);
+            if (block == nullptr) continue;
+            blocks_scanned++;
+            callback(block, block_id, 1);
+            unpinBlock(block_id, false);
+        }
+        return blocks_scanned;
+    }
+    
+    // Batches are read from the file directly, so cached writes must reach it first
+    if (backend == StorageBackend::STREAM && !flush()) return 0;
+    
+    // With read-ahead the batches come from a ReadAhead window (one per run) on a read-only descriptor
+    std::vector<Block> batch;
+    std::unique_ptr<ReadAhead> ahead;
+    int fd = -1;
+    if (backend == StorageBackend::STREAM && read_ahead_blocks > 0) {
+        fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return 0;
+    } else if (backend == StorageBackend::STREAM) {
+        batch.resize(batch_blocks);
+    }
+    bool failed = false;
+    int run_end = 0;
+    for (int run_first = 0; run_first < num_blocks && !failed; run_first = run_end) {
+        // Next run of consecutive blocks the filter keeps
+        run_end = run_first + 1;
+        if (filter && !filter(run_first)) continue;
+        while (run_end < num_blocks && (!filter || filter(run_end))) run_end++;
+        if (fd >= 0) {
+            ahead.reset(new ReadAhead(fd, static_cast<int64_t>(blockOffset(0)), Block::BLOCK_SIZE, run_first, run_end,
+                                      batch_blocks, std::max(read_ahead_blocks, batch_blocks)));
+        }
+        
+        for (int first = run_first; first < run_end; first += batch_blocks) {
+            int count = std::min(batch_blocks, run_end - first);
+            const Block* blocks = nullptr;
+            if (backend == StorageBackend::MMAP) {
+                blocks = reinterpret_cast<const Block*>(mapped.data() + blockOffset(first));
+            } else if (ahead) {
+                blocks = reinterpret_cast<const Block*>(ahead->next(first, count));
+                if (blocks == nullptr) {
+                    failed = true;
+                    break;
+                }
+                direct_block_reads += count;
+            } else {
+                file.seekg(static_cast<std::streamoff>(blockOffset(first)));
+                file.read(reinterpret_cast<char*>(&batch[0]), static_cast<std::streamsize>(count) * Block::BLOCK_SIZE);
+                if (!file.good()) {
+                    file.clear();
+                    failed = true;
+                    break;
+                }
+                direct_block_reads += count;
+                blocks = &batch[0];
+            }
+            
+            // One logical access per block, as for scan()
+            data_blocks_accessed += count;
+            total_data_block_ios += count;
+            for (int b = 0; b < count; b++) unique_data_blocks.insert(first + b);
+            blocks_scanned += count;
+            callback(blocks, first, count);
+        }
+        if (ahead) {
+            peak_reads_in_flight = std::max(peak_reads_in_flight, ahead->getQueue().getPeakOutstanding());
+            ahead.reset();
+        }
+    }
+    if (fd >= 0) ::close(fd);
+    return blocks_scanned;
+}
+
+/**
+ * Parallel Scan Blocks
+ * 
+ * Work-stealing scan: each worker opens its own stream on first use and
+ * counts the blocks it reads; the counters are merged after the workers
+ * finish, so no counter is shared between threads. A filtered piece is
+ * read and handed over one run of kept blocks at a time.
+ * 
+ * @param num_threads Number of workers (0 = one per hardware thread)
+ * @param callback Function called as callback(blocks, first_block_id, count, worker)
+ * @param batch_blocks Blocks per piece
+ * @param filter Blocks to visit (empty = every block)
+ * @return Number of blocks scanned
+ */
+int Database::parallelScanBlocks(int num_threads, const ParallelBlockScanCallback& callback, int batch_blocks,
+                                 const BlockFilter& filter) {
+    if (!isOpen() || num_blocks == 0) return 0;
+    if (batch_blocks < 1) batch_blocks = 1;
+    
+    // Workers read the file directly, so cached writes must reach it first
+    if (backend == StorageBackend::STREAM && !flush()) return 0;
+    
+    // Per-worker state: stream, read buffer and counters
+    struct WorkerState {
+        std::ifstream in;
+        std::vector<Block> run;
+        std::vector<std::pair<int, int> > pieces;  // (first_block_id, count) of every piece scanned
+        int direct_reads;
+        WorkerState() : direct_reads(0) {}
+    };
+    std::vector<std::unique_ptr<WorkerState> > workers(resolveThreads(num_threads));
+    for (size_t w = 0; w < workers.size(); w++) workers[w].reset(new WorkerState());
+    
+    parallelForStealing(static_cast<size_t>(num_blocks), static_cast<size_t>(batch_blocks), num_threads,
+                        [&](size_t begin, size_t end, int worker) {
+        WorkerState& state = *workers[worker];
+        int run_end = static_cast<int>(begin);
+        for (int first = static_cast<int>(begin); first < static_cast<int>(end); first = run_end) {
+            // Next run of consecutive blocks the filter keeps
+            run_end = first + 1;
+            if (filter && !filter(first)) continue;
+            while (run_end < static_cast<int>(end) && (!filter || filter(run_end))) run_end++;
+            int count = run_end - first;
+            const Block* blocks = nullptr;
+            if (backend == StorageBackend::MMAP) {
+                blocks = reinterpret_cast<const Block*>(mapped.data() + blockOffset(first));
+            } else {
+                if (!state.in.is_open()) {
+                    state.in.open(filename, std::ios::binary);
+                    state.run.resize(batch_blocks);
+                }
+                state.in.seekg(static_cast<std::streamoff>(blockOffset(first)));
+                state.in.read(reinterpret_cast<char*>(&state.run[0]), static_cast<std::streamsize>(count) * Block::BLOCK_SIZE);
+                if (!state.in.good()) {
+                    state.in.clear();
+                    return;
+                }
+                state.direct_reads += count;
+                blocks = &state.run[0];
+            }
+            state.pieces.push_back(std::make_pair(first, count));
+            callback(blocks, first, count, worker);
+        }
+    });
+    
+    // Merge the per-worker counters: one logical access per block, as for scanBlocks()
+    int blocks_scanned = 0;
+    for (size_t w = 0; w < workers.size(); w++) {
+        const WorkerState& state = *workers[w];
+        direct_block_reads += state.direct_reads;
+        for (size_t p = 0; p < state.pieces.size(); p++) {
+            int first = state.pieces[p].first;
+            int count = state.pieces[p].second;
+            data_blocks_accessed += count;
+            total_data_block_ios += count;
+            for (int b = 0; b < count; b++) unique_data_blocks.insert(first + b);
+            blocks_scanned += count;
+        }
+    }
+    return blocks_scanned;
+}
+
+/**
+ * Parallel Scan
+ * 
+ * Scans contiguous block ranges on several threads. Each thread reads its
+ * range APPEND_BATCH_BLOCKS blocks at a time with its own stream, so the
+ * shared file stream and the buffer pool are never touched concurrently.
+ * A partition that cannot open or read the file stops at that point and
+ * the whole scan fails; the blocks read before are still counted.
+ * 
+ * @param num_threads Number of partitions (0 = one per hardware thread)
+ * @param callback Function called as callback(record, block_id, record_index, partition)
+ * @return Number of blocks scanned, or -1 if a read failed
+ */
+int Database::parallelScan(int num_threads, const PartitionScanCallback& callback) {
+    if (!isOpen() || num_blocks == 0) return 0;
+    
+    // Workers read the file directly, so cached writes must reach it first
+    if (backend == StorageBackend::STREAM && !flush()) return -1;
+    
+    int partitions = resolveThreads(num_threads);
+    std::vector<int> partition_peaks(partitions, 0);
+    std::vector<std::pair<int, int> > partition_read(partitions, std::make_pair(0, 0));  // (first_block_id, count) read
+    std::vector<char> partition_failed(partitions, 0);
+    parallelFor(static_cast<size_t>(num_blocks), num_threads, [&](size_t begin, size_t end, int partition) {
+        std::ifstream in;
+        std::vector<Block> run;
+        std::unique_ptr<ReadAhead> ahead;
+        int fd = -1;
+        partition_read[partition] = std::make_pair(static_cast<int>(begin), 0);
+        if (backend == StorageBackend::STREAM && read_ahead_blocks > 0) {
+            fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0) {
+                partition_failed[partition] = 1;
+                return;
+            }
+            ahead.reset(new ReadAhead(fd, static_cast<int64_t>(blockOffset(0)), Block::BLOCK_SIZE,
+                                      static_cast<int>(begin), static_cast<int>(end), APPEND_BATCH_BLOCKS,
+                                      std::max(read_ahead_blocks, APPEND_BATCH_BLOCKS)));
+        } else if (backend == StorageBackend::STREAM) {
+            in.open(filename, std::ios::binary);
+            if (!in.is_open()) {
+                partition_failed[partition] = 1;
+                return;
+            }
+            run.resize(APPEND_BATCH_BLOCKS);
+        }
+        
+        for (size_t first = begin; first < end; first += APPEND_BATCH_BLOCKS) {
+            size_t count = std::min(static_cast<size_t>(APPEND_BATCH_BLOCKS), end - first);
+            const Block* blocks = nullptr;
+            if (backend == StorageBackend::MMAP) {
+                blocks = reinterpret_cast<const Block*>(mapped.data() + blockOffset(static_cast<int>(first)));
+            } else if (ahead) {
+                // Chunks must arrive in order and cover exactly this batch
+                int chunk_first = 0;
+                int chunk_count = 0;
+                blocks = reinterpret_cast<const Block*>(ahead->next(chunk_first, chunk_count));
+                if (blocks == nullptr || chunk_first != static_cast<int>(first) ||
+                    chunk_count != static_cast<int>(count)) {
+                    partition_failed[partition] = 1;
+                    break;
+                }
+            } else {
+                in.seekg(static_cast<std::streamoff>(blockOffset(static_cast<int>(first))));
+                in.read(reinterpret_cast<char*>(&run[0]), static_cast<std::streamsize>(count * Block::BLOCK_SIZE));
+                if (!in.good()) {
+                    partition_failed[partition] = 1;
+                    break;
+                }
+                blocks = &run[0];
+            }
+            
+            for (size_t b = 0; b < count; b++) {
+                const Block& block = blocks[b];
+                int block_id = static_cast<int>(first + b);
+                int slots = block.getNumSlots();
+                if (slots > Block::MAX_RECORDS) slots = Block::MAX_RECORDS;
+                
+                // Visit only occupied slots, one bitmap word at a time
+                for (int w = 0; w < Block::BITMAP_WORDS; w++) {
+                    uint32_t bits = block.slot_bitmap[w];
+                    while (bits != 0) {
+                        int i = w * 32 + __builtin_ctz(bits);
+                        bits &= bits - 1;
+                        if (i >= slots) break;
+                        callback(block.getRecord(i), block_id, i, partition);
+                    }
+                }
+            }
+            partition_read[partition].second += static_cast<int>(count);
+        }
+        if (ahead) {
+            partition_peaks[partition] = ahead->getQueue().getPeakOutstanding();
+            ahead.reset();
+            ::close(fd);
+        }
+    });
+    for (size_t p = 0; p < partition_peaks.size(); p++) {
+        peak_reads_in_flight = std::max(peak_reads_in_flight, partition_peaks[p]);
+    }
+    
+    // One logical access per block actually read, as for scan()
+    int scanned = 0;
+    bool failed = false;
+    for (int p = 0; p < partitions; p++) {
+        int first = partition_read[p].first;
+        int count = partition_read[p].second;
+        for (int b = 0; b < count; b++) unique_data_blocks.insert(first + b);
+        scanned += count;
+        if (partition_failed[p]) failed = true;
+    }
+    data_blocks_accessed += scanned;
+    total_data_block_ios += scanned;
+    return failed ? -1 : scanned;
+}
+
+/**
+ * Build Secondary Indexes
+ * 
+ * One parallel scan feeds every registered index, each collecting into
+ * its own per-partition buffers; the indexes are then sorted and bulk
+ * loaded one after another. If the scan fails no index is loaded.
+ * 
+ * @param num_threads Scan, sort and build threads (0 = one per hardware thread)
+ * @return true if every index was built
+ */
+bool Database::buildIndexes(int num_threads) {
+    if (!isOpen()) return false;
+    if (catalog.empty()) return true;
+    LoggedOperation operation(*this);
+    
+    int partitions = resolveThreads(num_threads);
+    for (size_t i = 0; i < catalog.size(); i++) {
+        catalog.at(i)->beginBuild(partitions);
+    }
+    
+    int scanned = parallelScan(num_threads, [this](const Record& record, int block_id, int record_index, int partition) {
+        RecordPointer ptr(block_id, record_index);
+        for (size_t i = 0; i < catalog.size(); i++) {
+            catalog.at(i)->collect(record, ptr, partition);
+        }
+    });
+    
+    // A failed scan leaves the indexes as they were rather than loading partial entries
+    if (scanned < 0) {
+        for (size_t i = 0; i < catalog.size(); i++) catalog.at(i)->beginBuild(0);
+        return false;
+    }
+    
+    bool ok = true;
+    for (size_t i = 0; i < catalog.size(); i++) {
+        if (!catalog.at(i)->finishBuild(num_threads)) ok = false;
+    }
+    return ok;
+}
+
+void Database::reportCapacityExceeded() const {
+    std::cerr << "Error: Database capacity exceeded (" << capacity / (1024 * 1024) << " MB limit)." << std::endl;
 }
 
 /**
  * Write Metadata to Database File
  * 
- * Writes database metadata (num_blocks, num_records) to the beginning
- * of the database file. This ensures that when the database is reopened,
- * we can restore the correct state without scanning all blocks.
+ * Writes database metadata (num_blocks, num_records, free_list_head, layout) to
+ * the beginning of the database file. This ensures that when the database
+ * is reopened, we can restore the correct state without scanning all blocks.
  * 
  * File Layout:
  * - Bytes 0-3: num_blocks (4 bytes)
  * - Bytes 4-7: num_records (4 bytes)
- * - Bytes 8+: Block data
+ * - Bytes 8-11: free_list_head (4 bytes)
+ * - Bytes 12-15: layout of new blocks (BlockLayout, zero = NSM)
+ * - Bytes 16+: Block data
  */
 void Database::writeMetadata() {
-    if (!file.is_open()) return;
+    if (!isOpen()) return;
+    
+    int header[METADATA_SIZE / sizeof(int)] = { num_blocks, num_records, free_list_head, static_cast<int>(layout) };
+    
+    if (backend == StorageBackend::MMAP) {
+        mapped.write(0, header, sizeof(header));
+        return;
+    }
+    
+    // Logged: the header is written back by flush()
+    if (activeLog() != nullptr) {
+        log->logPage(log_file_id, 0, header, sizeof(header));
+        metadata_dirty = true;
+        return;
+    }
+    storeMetadata();
+}
+
+/**
+ * Store Metadata
+ * 
+ * Writes the metadata header at the beginning of the file.
+ */
+void Database::storeMetadata() {
+    if (backend != StorageBackend::STREAM || !file.is_open()) return;
+    
+    // With a log every change is logged, so a clean header needs no write
+    if (activeLog() != nullptr && !metadata_dirty) return;
+    
+    int header[METADATA_SIZE / sizeof(int)] = { num_blocks, num_records, free_list_head, static_cast<int>(layout) };
+    if (activeLog() != nullptr && !log->beforeWrite(log_file_id, 0, sizeof(header))) return;
+    metadata_dirty = false;
     
     // Write metadata at the beginning of the file
     file.seekp(0);
-    file.write(reinterpret_cast<const char*>(&num_blocks), sizeof(int));
-    file.write(reinterpret_cast<const char*>(&num_records), sizeof(int));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
 }
 
 /**
  * Read Metadata from Database File
  * 
- * Reads database metadata (num_blocks, num_records) from the beginning
- * of the database file. This is called when opening an existing database
- * to restore the correct state.
+ * Reads database metadata (num_blocks, num_records, free_list_head, layout) from
+ * the beginning of the database file. This is called when opening an
+ * existing database to restore the correct state.
  * 
- * File Layout:
- * - Bytes 0-3: num_blocks (4 bytes)
- * - Bytes 4-7: num_records (4 bytes)
- * - Bytes 8+: Block data
+ * File Layout: see writeMetadata()
  */
 void Database::readMetadata() {
-    if (!file.is_open()) return;
+    if (!isOpen()) return;
+    
+    int header[METADATA_SIZE / sizeof(int)] = { 0, 0, -1, 0 };
+    
+    if (backend == StorageBackend::MMAP) {
+        mapped.read(0, header, sizeof(header));
+    } else {
+        // Read metadata from the beginning of the file
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!file.good()) file.clear();
+    }
     
-    // Read metadata from the beginning of the file
-    file.seekg(0);
-    file.read(reinterpret_cast<char*>(&num_blocks), sizeof(int));
-    file.read(reinterpret_cast<char*>(&num_records), sizeof(int));
+    num_blocks = header[0];
+    num_records = header[1];
+    free_list_head = header[2];
+    layout = header[3] == static_cast<int>(BlockLayout::PAX) ? BlockLayout::PAX : BlockLayout::NSM;
 }
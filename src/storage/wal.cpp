@@ -0,0 +1,392 @@
+/**
+ * SC3020 Database Management System
+ * Write-Ahead Log Implementation
+ *
+ * This file contains the implementation of the WriteAheadLog class: the
+ * record format, group commit, checkpoints and recovery.
+ *
+ * Record format (little-endian, as written by the host):
+ * - 24-byte header: magic, type, file ID, offset, payload length, checksum
+ * - Payload: the file path (FILE) or the page image (PAGE); COMMIT has none
+ *
+ * The checksum (FNV-1a over the header and payload) detects a torn write
+ * at the end of the log; recovery stops at the first bad record.
+ */
+
+#include "wal.h"
+#include <cstring>     // For memcpy
+#include <fcntl.h>     // For open
+#include <unistd.h>    // For pread, pwrite, fdatasync, ftruncate
+#include <sys/stat.h>  // For fstat
+
+namespace {
+
+const uint32_t LOG_MAGIC = 0x314c4157;   // "WAL1"
+
+enum LogRecordType {
+    LOG_FILE = 1,     // File ID -> path mapping
+    LOG_PAGE = 2,     // Page image
+    LOG_COMMIT = 3    // End of a commit group
+};
+
+struct LogRecordHeader {
+    uint32_t magic;      // LOG_MAGIC
+    uint16_t type;       // LogRecordType
+    uint16_t file_id;    // File of a FILE or PAGE record
+    int64_t offset;      // Page offset (PAGE) or group sequence (COMMIT)
+    uint32_t length;     // Payload bytes
+    uint32_t checksum;   // FNV-1a of the header (checksum = 0) and payload
+};
+
+uint32_t fnv1a(uint32_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t recordChecksum(LogRecordHeader header, const void* payload) {
+    header.checksum = 0;
+    uint32_t hash = fnv1a(2166136261u, &header, sizeof(header));
+    return fnv1a(hash, payload, header.length);
+}
+
+bool writeAll(int fd, const char* data, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, data, length, offset);
+        if (written <= 0) return false;
+        data += written;
+        length -= static_cast<size_t>(written);
+        offset += written;
+    }
+    return true;
+}
+
+} // namespace
+
+WriteAheadLog::WriteAheadLog(const std::string& path, const LogOptions& options)
+    : path(path), options(options), fd(-1), log_size(0), next_file_id(0), depth(0), commit_sequence(0),
+      group_bytes(0), group_size(0), staged_pages(0), checkpoint_due(false) {}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open() {
+    std::lock_guard<std::mutex> guard(latch);
+    if (fd >= 0) return true;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+    if (!recover()) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+void WriteAheadLog::close() {
+    std::lock_guard<std::mutex> guard(latch);
+    if (fd < 0) return;
+
+    flushLocked();
+    for (std::map<int, LoggedFile>::iterator it = files.begin(); it != files.end(); ++it) {
+        if (it->second.fd >= 0) ::close(it->second.fd);
+    }
+    files.clear();
+    ::close(fd);
+    fd = -1;
+}
+
+int WriteAheadLog::registerFile(const std::string& file_path, const WriteBackCallback& write_back) {
+    std::lock_guard<std::mutex> guard(latch);
+    if (fd < 0 || next_file_id > 0xffff) return -1;
+
+    LoggedFile file;
+    file.path = file_path;
+    file.fd = ::open(file_path.c_str(), O_RDWR);
+    if (file.fd < 0) return -1;
+    file.write_back = write_back;
+
+    int file_id = next_file_id++;
+    files[file_id] = file;
+    stageRecord(LOG_FILE, file_id, 0, file_path.data(), file_path.size());
+    return file_id;
+}
+
+void WriteAheadLog::unregisterFile(int file_id) {
+    std::lock_guard<std::mutex> guard(latch);
+    std::map<int, LoggedFile>::iterator it = files.find(file_id);
+    if (it == files.end()) return;
+
+    flushLocked();
+    if (it->second.fd >= 0) {
+        fsync(it->second.fd);
+        ::close(it->second.fd);
+    }
+    files.erase(it);
+}
+
+void WriteAheadLog::begin() {
+    std::lock_guard<std::mutex> guard(latch);
+    depth++;
+}
+
+void WriteAheadLog::commit() {
+    std::lock_guard<std::mutex> guard(latch);
+    if (depth <= 0 || --depth > 0) return;
+
+    // Outermost commit: the transaction's images join the group, replacing
+    // older images of the same pages
+    for (ImageMap::iterator it = pending.begin(); it != pending.end(); ++it) {
+        std::vector<char>& slot = group[it->first];
+        if (slot.empty()) group_bytes += it->second.size();
+        slot.swap(it->second);
+    }
+    pending.clear();
+    commit_sequence++;
+    stats.transactions++;
+
+    if (++group_size >= options.group_commit_size || group_bytes >= options.group_commit_bytes) {
+        flushLocked();
+    }
+}
+
+void WriteAheadLog::logPage(int file_id, int64_t offset, const void* data, size_t length) {
+    std::lock_guard<std::mutex> guard(latch);
+    if (fd < 0) return;
+
+    const char* bytes = static_cast<const char*>(data);
+    uint64_t key = pageKey(file_id, offset);
+    if (depth > 0) {
+        pending[key].assign(bytes, bytes + length);
+        return;
+    }
+
+    // Outside a transaction the change commits on its own
+    std::vector<char>& slot = group[key];
+    if (slot.empty()) group_bytes += length;
+    slot.assign(bytes, bytes + length);
+    commit_sequence++;
+    stats.transactions++;
+    if (++group_size >= options.group_commit_size || group_bytes >= options.group_commit_bytes) {
+        flushLocked();
+    }
+}
+
+bool WriteAheadLog::beforeWrite(int file_id, int64_t offset, size_t length) {
+    std::lock_guard<std::mutex> guard(latch);
+    if (fd < 0) return true;
+
+    uint64_t key = pageKey(file_id, offset);
+
+    // A committed image not yet in the log must reach it first
+    if (group.count(key) != 0) return flushLocked();
+    if (logged.count(key) != 0) return true;
+
+    // No image since the checkpoint: the file holds the committed version.
+    // Log it before the (possibly uncommitted) write replaces it. A page
+    // past the end of the file is not referenced by any committed state.
+    std::map<int, LoggedFile>::iterator it = files.find(file_id);
+    if (it == files.end()) return true;
+    std::vector<char> image(length);
+    if (pread(it->second.fd, &image[0], length, offset) != static_cast<ssize_t>(length)) {
+        logged.insert(key);
+        return true;
+    }
+    stageRecord(LOG_PAGE, file_id, offset, &image[0], length);
+    staged_pages++;
+    logged.insert(key);
+    stats.before_images++;
+    stats.pages_logged++;
+    return flushLocked();
+}
+
+void WriteAheadLog::requireSync(int file_id) {
+    std::lock_guard<std::mutex> guard(latch);
+    std::map<int, LoggedFile>::iterator it = files.find(file_id);
+    if (it != files.end()) it->second.needs_sync = true;
+}
+
+bool WriteAheadLog::hasImage(int file_id, int64_t offset) const {
+    std::lock_guard<std::mutex> guard(latch);
+    uint64_t key = pageKey(file_id, offset);
+    return logged.count(key) != 0 || group.count(key) != 0 || pending.count(key) != 0;
+}
+
+bool WriteAheadLog::sync() {
+    std::lock_guard<std::mutex> guard(latch);
+    return flushLocked();
+}
+
+bool WriteAheadLog::checkpointDue() const {
+    std::lock_guard<std::mutex> guard(latch);
+    return checkpoint_due;
+}
+
+bool WriteAheadLog::checkpoint() {
+    // Step 1: Snapshot the callbacks while no transaction is active
+    std::vector<WriteBackCallback> callbacks;
+    long long sequence;
+    {
+        std::lock_guard<std::mutex> guard(latch);
+        if (fd < 0 || depth > 0) return false;
+        for (std::map<int, LoggedFile>::iterator it = files.begin(); it != files.end(); ++it) {
+            callbacks.push_back(it->second.write_back);
+        }
+        sequence = commit_sequence;
+    }
+
+    // Step 2: Write back every file; the write-backs call beforeWrite()
+    bool ok = true;
+    for (size_t i = 0; i < callbacks.size(); i++) {
+        if (callbacks[i] && !callbacks[i]()) ok = false;
+    }
+
+    // Step 3: Sync the files and truncate the log, unless something
+    // committed meanwhile (its pages may still be dirty in a cache)
+    std::lock_guard<std::mutex> guard(latch);
+    if (!ok || fd < 0 || depth > 0 || commit_sequence != sequence) return false;
+    if (!flushLocked()) return false;
+    for (std::map<int, LoggedFile>::iterator it = files.begin(); it != files.end(); ++it) {
+        if (fsync(it->second.fd) != 0) return false;
+        it->second.needs_sync = false;
+    }
+    if (ftruncate(fd, 0) != 0 || fdatasync(fd) != 0) return false;
+    log_size = 0;
+    logged.clear();
+    checkpoint_due = false;
+    stats.checkpoints++;
+
+    // The next generation of the log starts with the file mappings again
+    for (std::map<int, LoggedFile>::iterator it = files.begin(); it != files.end(); ++it) {
+        stageRecord(LOG_FILE, it->first, 0, it->second.path.data(), it->second.path.size());
+    }
+    return true;
+}
+
+LogStats WriteAheadLog::getStats() const {
+    std::lock_guard<std::mutex> guard(latch);
+    return stats;
+}
+
+size_t WriteAheadLog::getLogSize() const {
+    std::lock_guard<std::mutex> guard(latch);
+    return log_size;
+}
+
+void WriteAheadLog::stageRecord(uint16_t type, int file_id, int64_t offset, const void* payload, size_t length) {
+    LogRecordHeader header;
+    header.magic = LOG_MAGIC;
+    header.type = type;
+    header.file_id = static_cast<uint16_t>(file_id);
+    header.offset = offset;
+    header.length = static_cast<uint32_t>(length);
+    header.checksum = recordChecksum(header, payload);
+
+    size_t start = staged.size();
+    staged.resize(start + sizeof(header) + length);
+    memcpy(&staged[start], &header, sizeof(header));
+    if (length > 0) memcpy(&staged[start + sizeof(header)], payload, length);
+}
+
+bool WriteAheadLog::flushLocked() {
+    if (fd < 0) return false;
+    if (group.empty() && staged_pages == 0) return true;
+
+    // Blocks appended without images must be on disk before the metadata
+    // that references them
+    for (std::map<int, LoggedFile>::iterator it = files.begin(); it != files.end(); ++it) {
+        if (!it->second.needs_sync) continue;
+        if (fdatasync(it->second.fd) != 0) return false;
+        it->second.needs_sync = false;
+    }
+
+    for (ImageMap::iterator it = group.begin(); it != group.end(); ++it) {
+        int file_id = static_cast<int>(it->first >> 48);
+        int64_t offset = static_cast<int64_t>(it->first & ((static_cast<uint64_t>(1) << 48) - 1));
+        stageRecord(LOG_PAGE, file_id, offset, &it->second[0], it->second.size());
+        logged.insert(it->first);
+        stats.pages_logged++;
+    }
+    stageRecord(LOG_COMMIT, 0, stats.group_commits, nullptr, 0);
+
+    bool ok = writeAll(fd, &staged[0], staged.size(), static_cast<off_t>(log_size)) && fdatasync(fd) == 0;
+    if (ok) {
+        log_size += staged.size();
+        stats.bytes_written += static_cast<long long>(staged.size());
+        stats.group_commits++;
+        if (log_size >= options.checkpoint_bytes) checkpoint_due = true;
+    }
+    staged.clear();
+    staged_pages = 0;
+    group.clear();
+    group_bytes = 0;
+    group_size = 0;
+    return ok;
+}
+
+bool WriteAheadLog::recover() {
+    struct stat info;
+    if (fstat(fd, &info) != 0) return false;
+    size_t size = static_cast<size_t>(info.st_size);
+
+    std::map<int, std::string> paths;   // File ID -> path of this log generation
+    std::map<std::string, int> targets; // Path -> descriptor of files replayed into
+    std::vector<std::pair<LogRecordHeader, std::vector<char> > > batch;   // Images of the current group
+
+    bool ok = true;
+    size_t position = 0;
+    while (position + sizeof(LogRecordHeader) <= size) {
+        LogRecordHeader header;
+        if (pread(fd, &header, sizeof(header), static_cast<off_t>(position)) != static_cast<ssize_t>(sizeof(header))) break;
+        if (header.magic != LOG_MAGIC || position + sizeof(header) + header.length > size) break;
+        std::vector<char> payload(header.length);
+        if (header.length > 0 &&
+            pread(fd, &payload[0], header.length, static_cast<off_t>(position + sizeof(header))) !=
+                static_cast<ssize_t>(header.length)) break;
+        if (recordChecksum(header, payload.empty() ? nullptr : &payload[0]) != header.checksum) break;
+        position += sizeof(header) + header.length;
+
+        if (header.type == LOG_FILE) {
+            paths[header.file_id] = std::string(payload.begin(), payload.end());
+        } else if (header.type == LOG_PAGE) {
+            batch.push_back(std::make_pair(header, std::vector<char>()));
+            batch.back().second.swap(payload);
+        } else if (header.type == LOG_COMMIT) {
+            // Complete group: apply its images in log order
+            for (size_t i = 0; i < batch.size(); i++) {
+                std::map<int, std::string>::iterator name = paths.find(batch[i].first.file_id);
+                if (name == paths.end()) continue;
+                std::map<std::string, int>::iterator target = targets.find(name->second);
+                if (target == targets.end()) {
+                    int file_fd = ::open(name->second.c_str(), O_RDWR | O_CREAT, 0644);
+                    if (file_fd < 0) {
+                        ok = false;
+                        continue;
+                    }
+                    target = targets.insert(std::make_pair(name->second, file_fd)).first;
+                }
+                if (!writeAll(target->second, &batch[i].second[0], batch[i].second.size(),
+                              static_cast<off_t>(batch[i].first.offset))) ok = false;
+                stats.recovered_pages++;
+            }
+            batch.clear();
+            stats.recovered_groups++;
+        }
+    }
+
+    // Make the replayed pages durable before the log that holds them goes
+    for (std::map<std::string, int>::iterator it = targets.begin(); it != targets.end(); ++it) {
+        if (fsync(it->second) != 0) ok = false;
+        ::close(it->second);
+    }
+    if (!ok) return false;
+
+    if (size > 0 && (ftruncate(fd, 0) != 0 || fdatasync(fd) != 0)) return false;
+    log_size = 0;
+    return true;
+}
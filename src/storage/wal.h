@@ -0,0 +1,362 @@
+/**
+ * SC3020 Database Management System
+ * Write-Ahead Log Header
+ *
+ * This file defines WriteAheadLog, an append-only redo log shared by a
+ * Database and its B+ tree files, and LogTransaction, the RAII scope that
+ * groups the page changes of one operation.
+ *
+ * Logging is physical: a record holds the after-image of one page (a data
+ * block, a tree node or a metadata page) of one registered file. The
+ * owners call:
+ * - logPage() whenever they change a page in memory (Database when a dirty
+ *   block is unpinned, BPTree when a node is written to the cache)
+ * - beforeWrite() just before a page is written to its file (buffer pool
+ *   or node cache write-back, metadata writes)
+ *
+ * Commit protocol:
+ * 1. Images logged inside a transaction are kept in memory. When the
+ *    outermost transaction ends they join the current commit group
+ * 2. A group is written with one append and one fdatasync once it holds
+ *    group_commit_size transactions or group_commit_bytes of images, when
+ *    sync() is called, or when a page of the group is about to be written
+ *    to its file (the WAL rule: the log reaches disk before the data)
+ * 3. Each group ends with a COMMIT record; recovery replays only complete
+ *    groups
+ *
+ * A page of an unfinished transaction may still be written to its file
+ * when the cache needs the frame. If the log holds no image of the page
+ * since the last checkpoint, its current file contents are logged and
+ * synced first, so recovery can restore the committed version.
+ *
+ * Checkpoint: every registered file writes back its dirty pages, the files
+ * are fsynced and the log is truncated. Recovery therefore reads only the
+ * log written since the last checkpoint, however large the files are.
+ *
+ * Recovery (open()): complete groups are applied to their files in log
+ * order, the files are fsynced and the log is truncated. Replaying a page
+ * image twice has no further effect, so a crash during recovery is safe.
+ *
+ * The log is used with the STREAM backend only: with MMAP the OS writes
+ * mapped pages back at any time, so the WAL rule cannot be kept.
+ */
+
+#ifndef WAL_H
+#define WAL_H
+
+// Standard C++ libraries
+#include <string>         // For file paths
+#include <vector>         // For page images and record buffers
+#include <map>            // For registered files
+#include <unordered_map>  // For page images by page
+#include <unordered_set>  // For pages logged since the checkpoint
+#include <functional>     // For write-back callbacks
+#include <mutex>          // For the log latch
+#include <cstddef>        // For size_t
+#include <cstdint>        // For record fields
+
+/**
+ * Log Options Structure
+ *
+ * Group commit and checkpoint thresholds.
+ */
+struct LogOptions {
+    int group_commit_size;       // Transactions per commit group (one fdatasync each)
+    size_t group_commit_bytes;   // Page image bytes that close a group early
+    size_t checkpoint_bytes;     // Log size that makes a checkpoint due
+
+    LogOptions() : group_commit_size(32), group_commit_bytes(1024 * 1024), checkpoint_bytes(16 * 1024 * 1024) {}
+};
+
+/**
+ * Log Statistics Structure
+ *
+ * Counters since the log was opened.
+ */
+struct LogStats {
+    long long transactions;       // Outermost transactions committed
+    long long group_commits;      // Groups written (one fdatasync each)
+    long long pages_logged;       // Page images written
+    long long before_images;      // Images of pages written back before their transaction ended
+    long long bytes_written;      // Log bytes appended
+    long long checkpoints;        // Log truncations
+    long long recovered_groups;   // Complete groups replayed by open()
+    long long recovered_pages;    // Page images replayed by open()
+
+    LogStats()
+        : transactions(0), group_commits(0), pages_logged(0), before_images(0), bytes_written(0),
+          checkpoints(0), recovered_groups(0), recovered_pages(0) {}
+};
+
+/**
+ * Write-Ahead Log Class
+ *
+ * All methods are thread-safe. Concurrent operations on the same log
+ * share one transaction: their changes commit when the last of them ends.
+ */
+class WriteAheadLog {
+public:
+    typedef std::function<bool()> WriteBackCallback;   // Writes back a file's dirty pages
+
+    /**
+     * Constructor
+     *
+     * @param path Path to the log file
+     * @param options Group commit and checkpoint thresholds
+     */
+    explicit WriteAheadLog(const std::string& path, const LogOptions& options = LogOptions());
+
+    /**
+     * Destructor
+     *
+     * Writes the pending group (see close()).
+     */
+    ~WriteAheadLog();
+
+    /**
+     * Open Log
+     *
+     * Opens or creates the log file and recovers: complete groups are
+     * applied to their files, which are then synced, and the log is
+     * truncated. Must be called before the logged files are opened.
+     *
+     * @return true if the log is open
+     */
+    bool open();
+
+    /**
+     * Close Log
+     *
+     * Writes the pending group and closes the log file. Files should be
+     * closed (and unregistered) first.
+     */
+    void close();
+
+    bool isOpen() const { return fd >= 0; }
+    const std::string& getPath() const { return path; }
+
+    // Files
+
+    /**
+     * Register File
+     *
+     * Adds a file whose pages are logged. Its path is written to the log
+     * so recovery needs no other information.
+     *
+     * @param file_path Path to the file (must exist)
+     * @param write_back Writes back the file's dirty pages; called by
+     *        checkpoint() without any latch of the log held
+     * @return File ID for the other calls, or -1 on failure
+     */
+    int registerFile(const std::string& file_path, const WriteBackCallback& write_back);
+
+    /**
+     * Unregister File
+     *
+     * Writes the pending group and syncs the file. The caller must have
+     * written back its dirty pages.
+     *
+     * @param file_id ID returned by registerFile()
+     */
+    void unregisterFile(int file_id);
+
+    // Transactions
+
+    /**
+     * Begin / Commit Transaction
+     *
+     * Transactions nest; only the outermost commit() moves the logged
+     * images into the commit group, which may write the group.
+     */
+    void begin();
+    void commit();
+
+    /**
+     * Log Page
+     *
+     * Records the new contents of a page. Outside a transaction the image
+     * commits at once.
+     *
+     * @param file_id Registered file
+     * @param offset Byte offset of the page in the file
+     * @param data Page contents
+     * @param length Page size in bytes
+     */
+    void logPage(int file_id, int64_t offset, const void* data, size_t length);
+
+    /**
+     * Before Page Write
+     *
+     * Enforces the WAL rule for a page about to be written to its file,
+     * writing the commit group or a before-image if necessary.
+     *
+     * @param file_id Registered file
+     * @param offset Byte offset of the page
+     * @param length Page size in bytes
+     * @return false if the log could not be written (the page must not be written)
+     */
+    bool beforeWrite(int file_id, int64_t offset, size_t length);
+
+    /**
+     * Require Data Sync
+     *
+     * For pages written without images (appends past the committed end of
+     * a file): the file is fsynced before the next group is written, so
+     * the committed metadata never points at blocks that are not on disk.
+     *
+     * @param file_id Registered file
+     */
+    void requireSync(int file_id);
+
+    /**
+     * Check for Page Image
+     *
+     * @param file_id Registered file
+     * @param offset Byte offset of the page
+     * @return true if an image of the page was logged since the last
+     *         checkpoint (committed or not), so recovery may replay it
+     */
+    bool hasImage(int file_id, int64_t offset) const;
+
+    /**
+     * Sync
+     *
+     * Writes the pending group, making every committed transaction durable.
+     *
+     * @return true on success
+     */
+    bool sync();
+
+    // Checkpoints
+
+    /**
+     * Check if Checkpoint is Due
+     *
+     * @return true once the log has grown past checkpoint_bytes
+     */
+    bool checkpointDue() const;
+
+    /**
+     * Checkpoint
+     *
+     * Writes back and syncs every registered file, then truncates the log.
+     * Skipped (returning false) while a transaction is active or if one
+     * committed while the files were written back.
+     *
+     * @return true if the log was truncated
+     */
+    bool checkpoint();
+
+    // Statistics
+
+    LogStats getStats() const;
+    size_t getLogSize() const;
+
+private:
+    /**
+     * Logged File Structure
+     */
+    struct LoggedFile {
+        std::string path;               // Path written to FILE records
+        int fd;                         // Own descriptor for before-images and fsync
+        WriteBackCallback write_back;   // Checkpoint write-back
+        bool needs_sync;                // Written without images since the last group
+
+        LoggedFile() : fd(-1), needs_sync(false) {}
+    };
+
+    typedef std::unordered_map<uint64_t, std::vector<char> > ImageMap;   // Page key -> image
+
+    static uint64_t pageKey(int file_id, int64_t offset) {
+        return (static_cast<uint64_t>(file_id) << 48) | static_cast<uint64_t>(offset);
+    }
+
+    /**
+     * Append Record
+     *
+     * Serializes one record into the staging buffer.
+     */
+    void stageRecord(uint16_t type, int file_id, int64_t offset, const void* payload, size_t length);
+
+    /**
+     * Flush Locked
+     *
+     * Writes the staged records, the commit group and a COMMIT record with
+     * one append, then fdatasyncs the log. The log latch must be held.
+     *
+     * @return true on success
+     */
+    bool flushLocked();
+
+    /**
+     * Recover
+     *
+     * Replays the complete groups of the log file (see open()).
+     *
+     * @return true on success
+     */
+    bool recover();
+
+    std::string path;                   // Log file path
+    LogOptions options;                 // Thresholds
+    int fd;                             // Log file descriptor (-1 when closed)
+    size_t log_size;                    // Bytes in the log file
+    mutable std::mutex latch;           // Protects everything below
+
+    std::map<int, LoggedFile> files;    // Registered files by ID
+    int next_file_id;                   // IDs are never reused within a run
+
+    int depth;                          // Transaction nesting depth
+    long long commit_sequence;          // Outermost commits so far (detects commits during a checkpoint)
+    ImageMap pending;                   // Images of the active transaction
+    ImageMap group;                     // Committed images not yet in the log
+    size_t group_bytes;                 // Bytes of images in group
+    int group_size;                     // Transactions in group
+    std::unordered_set<uint64_t> logged;  // Pages with an image in the log since the checkpoint
+    std::vector<char> staged;           // Serialized records waiting for the next write
+    int staged_pages;                   // Before-images in staged (FILE records alone wait for data)
+    bool checkpoint_due;                // Log size passed checkpoint_bytes
+    LogStats stats;                     // Counters
+};
+
+/**
+ * Log Transaction Class
+ *
+ * Begins a transaction on construction and commits it on destruction
+ * (or on commit()).
+ * A null log makes the guard a no-op, so callers need no branches.
+ * With may_checkpoint the commit also runs a due checkpoint; only
+ * callers that hold no latches and may re-enter their files' write-back
+ * should pass it.
+ */
+class LogTransaction {
+public:
+    explicit LogTransaction(WriteAheadLog* log, bool may_checkpoint = false)
+        : log(log), may_checkpoint(may_checkpoint) {
+        if (log != nullptr) log->begin();
+    }
+
+    ~LogTransaction() { commit(); }
+
+    /**
+     * Commit Early
+     *
+     * Ends the transaction before the guard goes out of scope.
+     */
+    void commit() {
+        if (log == nullptr) return;
+        WriteAheadLog* committed = log;
+        log = nullptr;
+        committed->commit();
+        if (may_checkpoint && committed->checkpointDue()) committed->checkpoint();
+    }
+
+private:
+    LogTransaction(const LogTransaction&);
+    LogTransaction& operator=(const LogTransaction&);
+
+    WriteAheadLog* log;      // Log (nullptr = no logging)
+    bool may_checkpoint;     // Run a due checkpoint after committing
+};
+
+#endif // WAL_H
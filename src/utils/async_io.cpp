@@ -0,0 +1,244 @@
+/**
+ * SC3020 Database Management System
+ * Asynchronous I/O Implementation
+ *
+ * This file contains the implementation of IOQueue and ReadAhead on top of
+ * a shared pool of I/O threads issuing pread().
+ *
+ */
+
+#include "async_io.h"
+#include <deque>       // For the request queue
+#include <thread>      // For the I/O threads
+#include <algorithm>   // For std::find, std::min, std::max
+#include <cerrno>      // For EINTR
+#include <unistd.h>    // For pread
+
+/**
+ * I/O Thread Pool Class
+ *
+ * Process-wide FIFO of submitted reads. Threads are started on demand, up
+ * to the deepest queue created so far (at most MAX_IO_THREADS), so every
+ * read of a full queue can be in the kernel at the same time.
+ */
+class IOThreadPool {
+public:
+    struct Request {
+        IOQueue* queue;     // Queue to complete
+        int fd;             // File read
+        int64_t offset;     // Byte offset
+        void* buffer;       // Destination
+        size_t length;      // Bytes to read
+        uint64_t tag;       // Caller's tag
+    };
+
+    static IOThreadPool& instance() {
+        static IOThreadPool pool;
+        return pool;
+    }
+
+    /**
+     * Reserve Threads
+     *
+     * @param count Reads that should be able to run at once
+     */
+    void reserve(int count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        count = std::min(count, MAX_IO_THREADS);
+        while (static_cast<int>(threads.size()) < count) {
+            threads.push_back(std::thread(&IOThreadPool::run, this));
+        }
+    }
+
+    void push(const Request& request) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(request);
+        }
+        ready.notify_one();
+    }
+
+    ~IOThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+    }
+
+private:
+    IOThreadPool() : stopping(false) {}
+
+    /**
+     * Read Fully
+     *
+     * pread() until length bytes, end of file or an error.
+     *
+     * @return Bytes read, or -1 on error
+     */
+    static ssize_t readFully(const Request& request) {
+        size_t done = 0;
+        char* buffer = static_cast<char*>(request.buffer);
+        while (done < request.length) {
+            ssize_t n = pread(request.fd, buffer + done, request.length - done,
+                              static_cast<off_t>(request.offset + static_cast<int64_t>(done)));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return -1;
+            if (n == 0) break;
+            done += static_cast<size_t>(n);
+        }
+        return static_cast<ssize_t>(done);
+    }
+
+    void run() {
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !requests.empty(); });
+                if (requests.empty()) return;
+                request = requests.front();
+                requests.pop_front();
+            }
+            request.queue->complete(request.tag, readFully(request));
+        }
+    }
+
+    std::mutex mutex;                   // Guards requests, threads and stopping
+    std::condition_variable ready;      // Signalled on every request
+    std::deque<Request> requests;       // Submitted reads in FIFO order
+    std::vector<std::thread> threads;   // I/O threads
+    bool stopping;                      // Set at process exit
+};
+
+/**
+ * I/O Queue Constructor
+ *
+ * @param depth Maximum number of submitted reads not yet reaped
+ */
+IOQueue::IOQueue(int depth)
+    : depth(std::max(1, depth)), outstanding(0), running(0), reads(0), bytes_read(0), peak_outstanding(0) {
+    IOThreadPool::instance().reserve(this->depth);
+}
+
+IOQueue::~IOQueue() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return running == 0; });
+}
+
+bool IOQueue::submitRead(int fd, int64_t offset, void* buffer, size_t length, uint64_t tag) {
+    if (full()) return false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running++;
+    }
+    outstanding++;
+    peak_outstanding = std::max(peak_outstanding, outstanding);
+    reads++;
+    submitted.push_back(tag);
+
+    IOThreadPool::Request request = { this, fd, offset, buffer, length, tag };
+    IOThreadPool::instance().push(request);
+    return true;
+}
+
+bool IOQueue::waitAny(IOCompletion& completion) {
+    if (outstanding == 0) return false;
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return !completed.empty(); });
+    completion = completed.front();
+    completed.erase(completed.begin());
+    lock.unlock();
+
+    outstanding--;
+    submitted.erase(std::find(submitted.begin(), submitted.end(), completion.tag));
+    if (completion.result > 0) bytes_read += completion.result;
+    return true;
+}
+
+bool IOQueue::waitFor(uint64_t tag, IOCompletion& completion) {
+    std::vector<uint64_t>::iterator pending = std::find(submitted.begin(), submitted.end(), tag);
+    if (pending == submitted.end()) return false;
+    submitted.erase(pending);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    std::vector<IOCompletion>::iterator it;
+    done.wait(lock, [this, tag, &it] {
+        for (it = completed.begin(); it != completed.end(); ++it) {
+            if (it->tag == tag) return true;
+        }
+        return false;
+    });
+    completion = *it;
+    completed.erase(it);
+    lock.unlock();
+
+    outstanding--;
+    if (completion.result > 0) bytes_read += completion.result;
+    return true;
+}
+
+void IOQueue::complete(uint64_t tag, ssize_t result) {
+    IOCompletion completion;
+    completion.tag = tag;
+    completion.result = result;
+    // Notify under the mutex: once running drops to zero the destructor may free the queue
+    std::lock_guard<std::mutex> lock(mutex);
+    completed.push_back(completion);
+    running--;
+    done.notify_all();
+}
+
+/**
+ * Read-Ahead Constructor
+ *
+ * The window holds window_units / chunk_units chunks (at least one) besides
+ * the chunk being consumed, each with its own buffer.
+ */
+ReadAhead::ReadAhead(int fd, int64_t base_offset, size_t unit_size, int first_unit, int end_unit,
+                     int chunk_units, int window_units)
+    : fd(fd), base_offset(base_offset), unit_size(unit_size), first_unit(first_unit), end_unit(end_unit),
+      chunk_units(std::max(1, chunk_units)), num_chunks(0), next_chunk(0), next_submit(0),
+      queue(std::max(1, window_units / std::max(1, chunk_units))), error(false) {
+    if (end_unit > first_unit) num_chunks = (end_unit - first_unit + this->chunk_units - 1) / this->chunk_units;
+    int num_slots = std::min(queue.getDepth() + 1, std::max(num_chunks, 1));
+    slots.resize(num_slots);
+    fill();
+}
+
+void ReadAhead::fill() {
+    // Chunk next_chunk - 1 is still in use by the caller, so its slot is not free
+    int limit = std::min(num_chunks, next_chunk + static_cast<int>(slots.size()) - (next_chunk > 0 ? 1 : 0));
+    while (!error && next_submit < limit && !queue.full()) {
+        int first = first_unit + next_submit * chunk_units;
+        int count = std::min(chunk_units, end_unit - first);
+        std::vector<char>& buffer = slots[next_submit % slots.size()];
+        buffer.resize(static_cast<size_t>(count) * unit_size);
+        if (!queue.submitRead(fd, base_offset + static_cast<int64_t>(first) * static_cast<int64_t>(unit_size),
+                              &buffer[0], buffer.size(), static_cast<uint64_t>(next_submit))) {
+            break;
+        }
+        next_submit++;
+    }
+}
+
+const char* ReadAhead::next(int& first, int& count) {
+    if (error || next_chunk >= num_chunks) return nullptr;
+
+    IOCompletion completion;
+    if (!queue.waitFor(static_cast<uint64_t>(next_chunk), completion)) {
+        error = true;
+        return nullptr;
+    }
+    first = first_unit + next_chunk * chunk_units;
+    count = std::min(chunk_units, end_unit - first);
+    std::vector<char>& buffer = slots[next_chunk % slots.size()];
+    if (completion.result != static_cast<ssize_t>(buffer.size())) {
+        error = true;
+        return nullptr;
+    }
+    next_chunk++;
+    fill();
+    return &buffer[0];
+}
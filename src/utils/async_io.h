@@ -0,0 +1,208 @@
+/**
+ * SC3020 Database Management System
+ * Asynchronous I/O Header
+ *
+ * This file defines IOQueue, a submission/completion queue for positioned
+ * file reads, and ReadAhead, a sequential reader that keeps a window of
+ * chunks in flight ahead of its consumer.
+ *
+ * The I/O model follows io_uring: a caller submits many reads without
+ * waiting, then reaps completions either in any order (waitAny) or for one
+ * request (waitFor). Reads are serviced by a process-wide pool of I/O
+ * threads issuing pread(), so up to the queue depth of requests are
+ * outstanding at the device at once. The interface is plain POSIX and
+ * builds wherever the rest of the system does; an io_uring backend can
+ * replace the thread pool behind the same calls. The I/O threads start on
+ * first use and, like all threads, do not survive fork().
+ *
+ * Used by:
+ * - Database scans (batched scanBlocks, parallelScan): ReadAhead over the
+ *   heap file
+ * - Database::fetchBatch with prefetch: runs of blocks submitted together
+ *   and decoded as they complete
+ * - BPTree range walks: read-ahead along the leaf chain
+ */
+
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+// Standard C++ libraries
+#include <vector>               // For completions and read-ahead buffers
+#include <mutex>                // For the completion queue
+#include <condition_variable>   // For waiting on completions
+#include <cstddef>              // For size_t
+#include <cstdint>              // For offsets and tags
+#include <sys/types.h>          // For ssize_t
+
+static const int DEFAULT_IO_QUEUE_DEPTH = 32;   // Reads in flight per queue
+static const int MAX_IO_THREADS = 64;           // Size limit of the shared I/O thread pool
+
+/**
+ * I/O Completion Structure
+ */
+struct IOCompletion {
+    uint64_t tag;      // Tag given at submission
+    ssize_t result;    // Bytes read (short at end of file), or -1 on error
+
+    IOCompletion() : tag(0), result(0) {}
+};
+
+/**
+ * I/O Queue Class
+ *
+ * One caller's reads. A queue is used by one thread at a time; different
+ * threads use different queues, which share the I/O threads.
+ */
+class IOQueue {
+public:
+    /**
+     * Constructor
+     *
+     * @param depth Maximum number of submitted reads not yet reaped
+     */
+    explicit IOQueue(int depth = DEFAULT_IO_QUEUE_DEPTH);
+
+    /**
+     * Destructor
+     *
+     * Waits for the outstanding reads (their buffers may be freed next).
+     */
+    ~IOQueue();
+
+    /**
+     * Submit Read
+     *
+     * Queues a read of length bytes at offset into buffer and returns at
+     * once. The buffer must stay valid until the read is reaped.
+     *
+     * @param fd File descriptor (shared between reads; pread has no file position)
+     * @param offset Byte offset in the file
+     * @param buffer Destination
+     * @param length Bytes to read
+     * @param tag Identifies the read in its completion
+     * @return false if the queue is full (reap a completion first)
+     */
+    bool submitRead(int fd, int64_t offset, void* buffer, size_t length, uint64_t tag);
+
+    /**
+     * Wait for Any Completion
+     *
+     * Reaps the next read to complete, in completion order.
+     *
+     * @param completion Receives the tag and result
+     * @return false if no read is outstanding
+     */
+    bool waitAny(IOCompletion& completion);
+
+    /**
+     * Wait for One Read
+     *
+     * Reaps the read submitted with tag; earlier completions of other
+     * reads stay queued for later calls.
+     *
+     * @param tag Tag of an outstanding read
+     * @param completion Receives the tag and result
+     * @return false if no read with that tag is outstanding
+     */
+    bool waitFor(uint64_t tag, IOCompletion& completion);
+
+    bool full() const { return outstanding >= depth; }
+    int getDepth() const { return depth; }
+    int getOutstanding() const { return outstanding; }
+
+    // Statistics
+    long long getReads() const { return reads; }
+    long long getBytesRead() const { return bytes_read; }
+    int getPeakOutstanding() const { return peak_outstanding; }
+
+private:
+    friend class IOThreadPool;
+
+    IOQueue(const IOQueue&);
+    IOQueue& operator=(const IOQueue&);
+
+    /**
+     * Complete Read
+     *
+     * Called by an I/O thread when a read finishes.
+     */
+    void complete(uint64_t tag, ssize_t result);
+
+    int depth;                               // Submission limit
+    int outstanding;                         // Submitted and not yet reaped (caller thread only)
+    std::vector<uint64_t> submitted;         // Tags submitted and not yet reaped
+    std::vector<IOCompletion> completed;     // Finished, not yet reaped
+    int running;                             // Submitted reads the I/O threads have not finished
+    std::mutex mutex;                        // Guards completed and running
+    std::condition_variable done;            // Signalled on every completion
+    long long reads;                         // Reads submitted
+    long long bytes_read;                    // Bytes read
+    int peak_outstanding;                    // Largest outstanding count seen
+};
+
+/**
+ * Read-Ahead Class
+ *
+ * Reads the units [first_unit, end_unit) of a file (blocks, nodes) in
+ * chunks of chunk_units, in order, with up to window_units units read
+ * ahead of the chunk the caller is working on.
+ */
+class ReadAhead {
+public:
+    /**
+     * Constructor
+     *
+     * Submits the first window of reads.
+     *
+     * @param fd File descriptor
+     * @param base_offset Byte offset of unit 0
+     * @param unit_size Bytes per unit
+     * @param first_unit First unit to read
+     * @param end_unit One past the last unit to read
+     * @param chunk_units Units per read (and per next() call)
+     * @param window_units Units in flight ahead of the current chunk (at least one chunk)
+     */
+    ReadAhead(int fd, int64_t base_offset, size_t unit_size, int first_unit, int end_unit,
+              int chunk_units, int window_units);
+
+    /**
+     * Next Chunk
+     *
+     * Waits for the next chunk in file order and submits the read that
+     * refills the window. The returned buffer is valid until the next call.
+     *
+     * @param first_unit Receives the first unit of the chunk
+     * @param count Receives the number of units in the chunk
+     * @return Chunk contents, or nullptr at the end or after a failed read
+     */
+    const char* next(int& first_unit, int& count);
+
+    bool failed() const { return error; }
+    const IOQueue& getQueue() const { return queue; }
+
+private:
+    ReadAhead(const ReadAhead&);
+    ReadAhead& operator=(const ReadAhead&);
+
+    /**
+     * Fill Window
+     *
+     * Submits chunks until the window is full or every chunk is submitted.
+     */
+    void fill();
+
+    int fd;                                 // File read
+    int64_t base_offset;                    // Offset of unit 0
+    size_t unit_size;                       // Bytes per unit
+    int first_unit;                         // First unit of chunk 0
+    int end_unit;                           // One past the last unit
+    int chunk_units;                        // Units per chunk
+    int num_chunks;                         // Chunks in the range
+    int next_chunk;                         // Chunk returned by the next call
+    int next_submit;                        // Next chunk to submit
+    std::vector<std::vector<char> > slots;  // Chunk buffers (chunk c uses slot c % size)
+    IOQueue queue;                          // Reads in flight
+    bool error;                             // A read failed or came back short
+};
+
+#endif // ASYNC_IO_H
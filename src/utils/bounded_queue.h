@@ -0,0 +1,94 @@
+/**
+ * SC3020 Database Management System
+ * Bounded Queue Header
+ *
+ * This file defines the BoundedQueue class template, a blocking
+ * multi-producer/multi-consumer FIFO with a fixed capacity. It connects
+ * the stages of the ingest pipeline and provides back-pressure: a fast
+ * producer blocks once the queue is full instead of buffering the whole
+ * input in memory.
+ */
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+// Standard C++ libraries
+#include <deque>               // For queued items
+#include <mutex>               // For mutual exclusion
+#include <condition_variable>  // For blocking push/pop
+#include <cstddef>             // For size_t
+
+/**
+ * Bounded Queue Class
+ *
+ * push() blocks while the queue is full, pop() blocks while it is empty.
+ * After close() no more items are accepted and pop() drains the remaining
+ * items before reporting the end of the stream.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * Constructor
+     *
+     * @param capacity Maximum number of queued items (at least 1)
+     */
+    explicit BoundedQueue(size_t capacity) : capacity(capacity > 0 ? capacity : 1), closed(false) {}
+
+    /**
+     * Push Item
+     *
+     * Moves an item into the queue, waiting for space if necessary.
+     *
+     * @param item Item to enqueue
+     * @return true if queued, false if the queue was closed
+     */
+    bool push(T&& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return items.size() < capacity || closed; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * Pop Item
+     *
+     * Removes the oldest item, waiting for one if necessary.
+     *
+     * @param item Output parameter receiving the item
+     * @return true if an item was returned, false if the queue is closed and empty
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return !items.empty() || closed; });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    /**
+     * Close Queue
+     *
+     * Marks the end of the stream and wakes every waiting thread.
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+private:
+    std::deque<T> items;                  // Queued items, oldest first
+    size_t capacity;                      // Maximum number of queued items
+    bool closed;                          // True once the producer has finished
+    std::mutex mutex;                     // Protects all members
+    std::condition_variable not_empty;    // Signalled when an item is pushed
+    std::condition_variable not_full;     // Signalled when an item is popped
+};
+
+#endif // BOUNDED_QUEUE_H
@@ -0,0 +1,126 @@
+/**
+ * SC3020 Database Management System
+ * Latch Header
+ *
+ * This file defines RWLatch, a small reader/writer latch for protecting
+ * in-memory structures (B+ tree nodes and trees) between threads, and
+ * RAII guards for it.
+ *
+ * The latch is one atomic word: -1 while a writer holds it, otherwise the
+ * number of readers. Writers announce themselves before they wait, and new
+ * readers back off while a writer is waiting, so a steady stream of
+ * readers cannot starve a writer. Waiting threads yield instead of
+ * sleeping: latches are held for a few node accesses at most.
+ *
+ * The latch is not recursive: a thread must not acquire a latch it
+ * already holds, in either mode.
+ */
+
+#ifndef LATCH_H
+#define LATCH_H
+
+// Standard C++ libraries
+#include <atomic>    // For the latch word
+#include <thread>    // For std::this_thread::yield
+
+/**
+ * Reader/Writer Latch Class
+ */
+class RWLatch {
+public:
+    RWLatch() : state(0), waiting_writers(0) {}
+
+    /**
+     * Acquire Shared
+     *
+     * Waits until no writer holds or waits for the latch.
+     */
+    void lockShared() {
+        while (true) {
+            int readers = state.load(std::memory_order_relaxed);
+            if (readers >= 0 && waiting_writers.load(std::memory_order_relaxed) == 0 &&
+                state.compare_exchange_weak(readers, readers + 1, std::memory_order_acquire)) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * Release Shared
+     */
+    void unlockShared() { state.fetch_sub(1, std::memory_order_release); }
+
+    /**
+     * Acquire Exclusive
+     *
+     * Blocks new readers, then waits until the current holders are gone.
+     */
+    void lock() {
+        waiting_writers.fetch_add(1, std::memory_order_relaxed);
+        int expected = 0;
+        while (!state.compare_exchange_weak(expected, -1, std::memory_order_acquire)) {
+            expected = 0;
+            std::this_thread::yield();
+        }
+        waiting_writers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Release Exclusive
+     */
+    void unlock() { state.store(0, std::memory_order_release); }
+
+private:
+    RWLatch(const RWLatch&);             // Not copyable
+    RWLatch& operator=(const RWLatch&);
+
+    std::atomic<int> state;              // -1 = writer, otherwise number of readers
+    std::atomic<int> waiting_writers;    // Writers waiting to acquire
+};
+
+/**
+ * Shared Latch Guard
+ *
+ * Holds a latch in shared mode for its lifetime (or until release()).
+ */
+class SharedLatchGuard {
+public:
+    explicit SharedLatchGuard(RWLatch& latch) : latch(&latch) { latch.lockShared(); }
+    ~SharedLatchGuard() { release(); }
+
+    void release() {
+        if (latch != nullptr) latch->unlockShared();
+        latch = nullptr;
+    }
+
+private:
+    SharedLatchGuard(const SharedLatchGuard&);
+    SharedLatchGuard& operator=(const SharedLatchGuard&);
+
+    RWLatch* latch;   // Held latch (nullptr once released)
+};
+
+/**
+ * Exclusive Latch Guard
+ *
+ * Holds a latch in exclusive mode for its lifetime (or until release()).
+ */
+class ExclusiveLatchGuard {
+public:
+    explicit ExclusiveLatchGuard(RWLatch& latch) : latch(&latch) { latch.lock(); }
+    ~ExclusiveLatchGuard() { release(); }
+
+    void release() {
+        if (latch != nullptr) latch->unlock();
+        latch = nullptr;
+    }
+
+private:
+    ExclusiveLatchGuard(const ExclusiveLatchGuard&);
+    ExclusiveLatchGuard& operator=(const ExclusiveLatchGuard&);
+
+    RWLatch* latch;   // Held latch (nullptr once released)
+};
+
+#endif // LATCH_H
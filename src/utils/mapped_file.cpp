@@ -0,0 +1,122 @@
+/**
+ * SC3020 Database Management System
+ * Memory-Mapped File Implementation
+ *
+ * This file contains the implementation of the MappedFile class using the
+ * POSIX mmap/msync/ftruncate interfaces.
+ *
+ */
+
+#include "mapped_file.h"
+#include <cstring>      // For memcpy
+#include <fcntl.h>      // For open
+#include <unistd.h>     // For close, ftruncate, sysconf
+#include <sys/mman.h>   // For mmap, msync, munmap, posix_madvise
+#include <sys/stat.h>   // For fstat
+
+MappedFile::MappedFile() : fd(-1), base(nullptr), length(0), capacity(0) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    if (isOpen()) close();
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    length = static_cast<size_t>(st.st_size);
+
+    // Map at least one chunk so small files can grow without remapping
+    size_t chunks = length / GROW_CHUNK + 1;
+    if (!remap(chunks * GROW_CHUNK)) {
+        ::close(fd);
+        fd = -1;
+        length = 0;
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (!isOpen()) return;
+
+    if (base != nullptr) {
+        msync(base, capacity, MS_SYNC);
+        munmap(base, capacity);
+    }
+    // Drop the unused tail of the last chunk (if this fails the tail is only zeros)
+    int truncated = ftruncate(fd, static_cast<off_t>(length));
+    (void)truncated;
+    ::close(fd);
+
+    fd = -1;
+    base = nullptr;
+    length = 0;
+    capacity = 0;
+}
+
+bool MappedFile::sync() {
+    if (!isOpen() || base == nullptr) return false;
+    return msync(base, capacity, MS_SYNC) == 0;
+}
+
+bool MappedFile::remap(size_t new_capacity) {
+    if (base != nullptr) {
+        munmap(base, capacity);
+        base = nullptr;
+    }
+
+    // The file must cover the whole mapping
+    if (ftruncate(fd, static_cast<off_t>(new_capacity)) != 0) return false;
+
+    void* mapping = mmap(nullptr, new_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        capacity = 0;
+        return false;
+    }
+    base = static_cast<char*>(mapping);
+    capacity = new_capacity;
+    return true;
+}
+
+bool MappedFile::resize(size_t new_size) {
+    if (!isOpen()) return false;
+
+    if (new_size > capacity) {
+        size_t chunks = (new_size + GROW_CHUNK - 1) / GROW_CHUNK;
+        if (!remap(chunks * GROW_CHUNK)) return false;
+    }
+    length = new_size;
+    return true;
+}
+
+bool MappedFile::read(size_t offset, void* dst, size_t count) const {
+    if (!isOpen() || offset + count > length) return false;
+    memcpy(dst, base + offset, count);
+    return true;
+}
+
+bool MappedFile::write(size_t offset, const void* src, size_t count) {
+    if (!isOpen()) return false;
+    if (offset + count > length && !resize(offset + count)) return false;
+    memcpy(base + offset, src, count);
+    return true;
+}
+
+void MappedFile::willNeed(size_t offset, size_t count) const {
+    if (!isOpen() || base == nullptr || offset >= length) return;
+    if (offset + count > length) count = length - offset;
+    
+    // madvise needs a page-aligned start
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t start = offset - offset % page;
+    posix_madvise(base + start, count + (offset - start), POSIX_MADV_WILLNEED);
+}
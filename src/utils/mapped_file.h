@@ -0,0 +1,157 @@
+/**
+ * SC3020 Database Management System
+ * Memory-Mapped File Header
+ *
+ * This file defines the MappedFile class, a read/write shared mapping of a
+ * whole file used as an alternative storage backend by Database and BPTree.
+ *
+ * The Mapped File provides:
+ * - Direct pointers into the file contents (zero-copy access)
+ * - Growth in GROW_CHUNK steps so appends do not remap on every page
+ * - msync-based flushing at checkpoints
+ * - Truncation back to the logical size on close
+ *
+ * Caching is left to the operating system page cache.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+// Standard C++ libraries
+#include <string>    // For file paths
+#include <cstddef>   // For size_t
+
+/**
+ * Storage Backend
+ *
+ * Selects how Database and BPTree access their files.
+ */
+enum class StorageBackend {
+    STREAM,   // std::fstream reads/writes behind an in-process cache
+    MMAP      // Shared memory mapping; pointers go straight into the file
+};
+
+/**
+ * Mapped File Class
+ *
+ * Keeps a file mapped read/write. The logical size is what readers see and
+ * what the file is truncated to on close; the mapping itself is larger and
+ * grows in chunks.
+ *
+ * Pointers returned by data() are invalidated whenever the mapping grows
+ * (resize() or write() past the current capacity) and by close().
+ */
+class MappedFile {
+public:
+    static const size_t GROW_CHUNK = 1 << 20; // Mapping growth step (1 MB)
+
+    MappedFile();
+    ~MappedFile();
+
+    /**
+     * Open File
+     *
+     * Opens (creating if necessary) and maps the file.
+     *
+     * @param path Path to the file
+     * @return true if the file is open and mapped
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Close File
+     *
+     * Flushes the mapping, unmaps it and truncates the file to its
+     * logical size.
+     */
+    void close();
+
+    /**
+     * Check if File is Open
+     *
+     * @return true if the file is mapped
+     */
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * Sync Mapping
+     *
+     * Writes modified pages of the mapping back to the file (msync).
+     *
+     * @return true if the sync succeeded
+     */
+    bool sync();
+
+    /**
+     * Resize File
+     *
+     * Changes the logical size, growing the mapping if needed.
+     *
+     * @param new_size New logical size in bytes
+     * @return true if the file could be grown
+     */
+    bool resize(size_t new_size);
+
+    /**
+     * Read Bytes
+     *
+     * Copies bytes out of the mapping.
+     *
+     * @param offset Byte offset in the file
+     * @param dst Destination buffer
+     * @param count Number of bytes
+     * @return false if the range lies beyond the logical size
+     */
+    bool read(size_t offset, void* dst, size_t count) const;
+
+    /**
+     * Write Bytes
+     *
+     * Copies bytes into the mapping, extending the file if the range ends
+     * beyond the logical size.
+     *
+     * @param offset Byte offset in the file
+     * @param src Source buffer
+     * @param count Number of bytes
+     * @return true if the write succeeded
+     */
+    bool write(size_t offset, const void* src, size_t count);
+    
+    /**
+     * Advise Will Need
+     * 
+     * Asks the kernel to start reading a range of the file into the page
+     * cache (madvise WILLNEED) without waiting for it.
+     * 
+     * @param offset Byte offset in the file
+     * @param count Number of bytes
+     */
+    void willNeed(size_t offset, size_t count) const;
+
+    // Accessors
+    size_t size() const { return length; }
+    char* data() { return base; }
+    const char* data() const { return base; }
+
+private:
+    int fd;             // File descriptor (-1 if closed)
+    char* base;         // Start of the mapping
+    size_t length;      // Logical file size
+    size_t capacity;    // Size of the mapping (and of the file while open)
+
+    /**
+     * Remap
+     *
+     * Extends the file to new_capacity bytes and maps it again.
+     *
+     * @param new_capacity New mapping size (multiple of GROW_CHUNK)
+     * @return true if the new mapping was created
+     */
+    bool remap(size_t new_capacity);
+
+    // Not copyable (owns the mapping)
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,348 @@
+/**
+ * SC3020 Database Management System
+ * Metrics Implementation
+ *
+ * This file contains the implementation of the counters, histograms,
+ * spans and the JSON and Prometheus exports.
+ *
+ */
+
+#include "metrics.h"
+#include <algorithm>  // For std::max, std::fill
+#include <cmath>      // For std::isfinite
+#include <iomanip>    // For std::setprecision
+#include <sstream>    // For number formatting
+
+namespace {
+
+// Span open on this thread (innermost)
+thread_local ScopedSpan* current_span = nullptr;
+
+/**
+ * Format Number
+ *
+ * @return The value with up to 9 significant digits, or "null" (JSON) /
+ *         "NaN" (Prometheus) if it is not finite
+ */
+std::string formatNumber(double value, const char* non_finite) {
+    if (!std::isfinite(value)) return non_finite;
+    std::ostringstream out;
+    out << std::setprecision(9) << value;
+    return out.str();
+}
+
+/**
+ * Quote JSON String
+ */
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            static const char hex[] = "0123456789abcdef";
+            quoted += "\\u00";
+            quoted += hex[(c >> 4) & 0xF];
+            quoted += hex[c & 0xF];
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+/**
+ * Prometheus Metric Name
+ *
+ * @return prefix + name with every character outside [a-zA-Z0-9_] replaced by '_'
+ */
+std::string promName(const std::string& prefix, const std::string& name) {
+    std::string result = prefix + name;
+    for (size_t i = 0; i < result.size(); i++) {
+        char c = result[i];
+        bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        if (!valid) result[i] = '_';
+    }
+    return result;
+}
+
+/**
+ * Prometheus Label Value
+ */
+std::string promLabel(const std::string& text) {
+    std::string escaped;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '"' || text[i] == '\\') escaped += '\\';
+        if (text[i] == '\n') {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += text[i];
+    }
+    return escaped;
+}
+
+double nanosToSeconds(uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) / 1e9;
+}
+
+} // namespace
+
+// ShardedCounter
+
+int ShardedCounter::shardIndex() {
+    static std::atomic<int> next_shard(0);
+    thread_local int shard = -1;
+    if (shard < 0) shard = next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+    return shard;
+}
+
+long long ShardedCounter::value() const {
+    long long total = 0;
+    for (int i = 0; i < NUM_SHARDS; i++) total += shards[i].value.load(std::memory_order_relaxed);
+    return total;
+}
+
+void ShardedCounter::reset() {
+    for (int i = 0; i < NUM_SHARDS; i++) shards[i].value.store(0, std::memory_order_relaxed);
+}
+
+// PageSet
+
+void PageSet::grow(size_t word) {
+    words.resize(std::max(word + 1, words.size() * 2), 0);
+}
+
+void PageSet::merge(const PageSet& other) {
+    if (other.words.size() > words.size()) words.resize(other.words.size(), 0);
+    count = 0;
+    for (size_t w = 0; w < words.size(); w++) {
+        if (w < other.words.size()) words[w] |= other.words[w];
+        count += static_cast<size_t>(__builtin_popcountll(words[w]));
+    }
+}
+
+void PageSet::clear() {
+    std::fill(words.begin(), words.end(), 0);
+    count = 0;
+}
+
+// LatencyHistogram
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    int bucket = nanoseconds == 0 ? 0 : 63 - __builtin_clzll(nanoseconds);
+    if (bucket >= NUM_BUCKETS) bucket = NUM_BUCKETS - 1;
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t longest = max_ns.load(std::memory_order_relaxed);
+    while (nanoseconds > longest && !max_ns.compare_exchange_weak(longest, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::quantile(double q) const {
+    uint64_t total = getCount();
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < NUM_BUCKETS; b++) {
+        seen += getBucket(b);
+        if (seen >= rank) return bucketUpperBound(b);
+    }
+    return bucketUpperBound(NUM_BUCKETS - 1);
+}
+
+void LatencyHistogram::reset() {
+    for (int b = 0; b < NUM_BUCKETS; b++) buckets[b].store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    sum_ns.store(0, std::memory_order_relaxed);
+    max_ns.store(0, std::memory_order_relaxed);
+}
+
+// MetricsRegistry
+
+MetricsRegistry::MetricsRegistry() : next_span_id(0), created(std::chrono::steady_clock::now()) {}
+
+ShardedCounter& MetricsRegistry::counter(const std::string& name) {
+    std::lock_guard<std::mutex> guard(mutex);
+    std::unique_ptr<ShardedCounter>& slot = counters[name];
+    if (!slot) slot.reset(new ShardedCounter());
+    return *slot;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name) {
+    std::lock_guard<std::mutex> guard(mutex);
+    std::unique_ptr<LatencyHistogram>& slot = histograms[name];
+    if (!slot) slot.reset(new LatencyHistogram());
+    return *slot;
+}
+
+void MetricsRegistry::setGauge(const std::string& name, double value) {
+    std::lock_guard<std::mutex> guard(mutex);
+    gauges[name] = value;
+}
+
+void MetricsRegistry::addSpan(const SpanRecord& span) {
+    std::lock_guard<std::mutex> guard(mutex);
+    spans.push_back(span);
+}
+
+std::vector<SpanRecord> MetricsRegistry::getSpans() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return spans;
+}
+
+double MetricsRegistry::secondsSinceStart() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - created).count();
+}
+
+void MetricsRegistry::writeJson(std::ostream& out) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    out << "{\n  \"uptime_seconds\": " << formatNumber(secondsSinceStart(), "null") << ",\n";
+
+    out << "  \"counters\": {";
+    for (auto it = counters.begin(); it != counters.end(); ++it) {
+        out << (it == counters.begin() ? "\n" : ",\n") << "    " << jsonString(it->first) << ": " << it->second->value();
+    }
+    out << (counters.empty() ? "},\n" : "\n  },\n");
+
+    out << "  \"gauges\": {";
+    for (auto it = gauges.begin(); it != gauges.end(); ++it) {
+        out << (it == gauges.begin() ? "\n" : ",\n") << "    " << jsonString(it->first) << ": "
+            << formatNumber(it->second, "null");
+    }
+    out << (gauges.empty() ? "},\n" : "\n  },\n");
+
+    out << "  \"histograms\": {";
+    for (auto it = histograms.begin(); it != histograms.end(); ++it) {
+        const LatencyHistogram& h = *it->second;
+        out << (it == histograms.begin() ? "\n" : ",\n") << "    " << jsonString(it->first) << ": {"
+            << "\"count\": " << h.getCount()
+            << ", \"sum_seconds\": " << formatNumber(nanosToSeconds(h.getSumNanos()), "null")
+            << ", \"max_seconds\": " << formatNumber(nanosToSeconds(h.getMaxNanos()), "null")
+            << ", \"p50_seconds\": " << formatNumber(nanosToSeconds(h.quantile(0.50)), "null")
+            << ", \"p95_seconds\": " << formatNumber(nanosToSeconds(h.quantile(0.95)), "null")
+            << ", \"p99_seconds\": " << formatNumber(nanosToSeconds(h.quantile(0.99)), "null")
+            << ", \"buckets\": [";
+        bool first = true;
+        for (int b = 0; b < LatencyHistogram::NUM_BUCKETS; b++) {
+            if (h.getBucket(b) == 0) continue;
+            out << (first ? "" : ", ") << "{\"le_seconds\": "
+                << formatNumber(nanosToSeconds(LatencyHistogram::bucketUpperBound(b)), "null")
+                << ", \"count\": " << h.getBucket(b) << "}";
+            first = false;
+        }
+        out << "]}";
+    }
+    out << (histograms.empty() ? "},\n" : "\n  },\n");
+
+    out << "  \"spans\": [";
+    for (size_t s = 0; s < spans.size(); s++) {
+        const SpanRecord& span = spans[s];
+        out << (s == 0 ? "\n" : ",\n") << "    {\"id\": " << span.id << ", \"parent\": " << span.parent
+            << ", \"name\": " << jsonString(span.name)
+            << ", \"start_seconds\": " << formatNumber(span.start_seconds, "null")
+            << ", \"duration_seconds\": " << formatNumber(span.duration_seconds, "null") << ", \"attributes\": {";
+        for (size_t a = 0; a < span.attributes.size(); a++) {
+            out << (a == 0 ? "" : ", ") << jsonString(span.attributes[a].first) << ": "
+                << formatNumber(span.attributes[a].second, "null");
+        }
+        out << "}}";
+    }
+    out << (spans.empty() ? "]\n" : "\n  ]\n") << "}\n";
+}
+
+void MetricsRegistry::writePrometheus(std::ostream& out, const std::string& prefix) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto it = counters.begin(); it != counters.end(); ++it) {
+        std::string name = promName(prefix, it->first);
+        if (name.size() < 6 || name.compare(name.size() - 6, 6, "_total") != 0) name += "_total";
+        out << "# TYPE " << name << " counter\n" << name << " " << it->second->value() << "\n";
+    }
+    for (auto it = gauges.begin(); it != gauges.end(); ++it) {
+        std::string name = promName(prefix, it->first);
+        out << "# TYPE " << name << " gauge\n" << name << " " << formatNumber(it->second, "NaN") << "\n";
+    }
+    for (auto it = histograms.begin(); it != histograms.end(); ++it) {
+        const LatencyHistogram& h = *it->second;
+        std::string name = promName(prefix, it->first);
+        out << "# TYPE " << name << " histogram\n";
+        uint64_t cumulative = 0;
+        for (int b = 0; b < LatencyHistogram::NUM_BUCKETS - 1; b++) {
+            cumulative += h.getBucket(b);
+            out << name << "_bucket{le=\"" << formatNumber(nanosToSeconds(LatencyHistogram::bucketUpperBound(b)), "NaN")
+                << "\"} " << cumulative << "\n";
+        }
+        out << name << "_bucket{le=\"+Inf\"} " << h.getCount() << "\n";
+        out << name << "_sum " << formatNumber(nanosToSeconds(h.getSumNanos()), "NaN") << "\n";
+        out << name << "_count " << h.getCount() << "\n";
+    }
+
+    // Spans, summarized per name in first-finished order
+    if (!spans.empty()) {
+        std::vector<std::string> names;
+        std::map<std::string, std::pair<double, long long> > totals;
+        for (size_t s = 0; s < spans.size(); s++) {
+            std::pair<double, long long>& total = totals[spans[s].name];
+            if (total.second == 0) names.push_back(spans[s].name);
+            total.first += spans[s].duration_seconds;
+            total.second++;
+        }
+        std::string name = promName(prefix, "span_duration_seconds");
+        out << "# TYPE " << name << " summary\n";
+        for (size_t n = 0; n < names.size(); n++) {
+            const std::pair<double, long long>& total = totals[names[n]];
+            std::string label = "{span=\"" + promLabel(names[n]) + "\"}";
+            out << name << "_sum" << label << " " << formatNumber(total.first, "NaN") << "\n";
+            out << name << "_count" << label << " " << total.second << "\n";
+        }
+    }
+}
+
+void MetricsRegistry::reset() {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto it = counters.begin(); it != counters.end(); ++it) it->second->reset();
+    for (auto it = histograms.begin(); it != histograms.end(); ++it) it->second->reset();
+    gauges.clear();
+    spans.clear();
+}
+
+// ScopedSpan
+
+ScopedSpan::ScopedSpan(MetricsRegistry* registry, const std::string& name)
+    : registry(registry), enclosing(nullptr), start(std::chrono::steady_clock::now()) {
+    if (registry == nullptr) return;
+    span.id = registry->nextSpanId();
+    span.parent = current_span != nullptr ? current_span->span.id : -1;
+    span.name = name;
+    span.start_seconds = registry->secondsSinceStart();
+    span.duration_seconds = 0.0;
+    enclosing = current_span;
+    current_span = this;
+}
+
+void ScopedSpan::finish() {
+    if (registry == nullptr) return;
+    span.duration_seconds = elapsed();
+    if (current_span == this) current_span = enclosing;
+    registry->addSpan(span);
+    registry = nullptr;
+}
+
+void ScopedSpan::set(const std::string& key, double value) {
+    if (registry == nullptr) return;
+    for (size_t a = 0; a < span.attributes.size(); a++) {
+        if (span.attributes[a].first == key) {
+            span.attributes[a].second = value;
+            return;
+        }
+    }
+    span.attributes.push_back(std::make_pair(key, value));
+}
+
+double ScopedSpan::elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
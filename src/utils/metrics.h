@@ -0,0 +1,373 @@
+/**
+ * SC3020 Database Management System
+ * Metrics Header
+ *
+ * This file defines the instrumentation layer used by the storage and
+ * indexing components and by the query drivers:
+ * - ShardedCounter: a counter split over cache-line-sized shards. Each
+ *   thread adds to its own shard with a relaxed atomic, so a counter bumped
+ *   by every worker of a parallel scan is never contended
+ * - PageSet: the distinct page IDs touched since the last reset, as a
+ *   bitmap (no allocation per access, unlike std::set)
+ * - LatencyHistogram: log2 buckets of nanoseconds with lock-free recording;
+ *   LatencyTimer records the lifetime of a scope into one
+ * - MetricsRegistry: named counters, gauges, histograms and finished
+ *   spans, exported as JSON or in the Prometheus text format
+ * - ScopedSpan: times one query or operator; spans opened while another
+ *   span is open on the same thread become its children
+ *
+ * Counters and histograms are looked up by name once (e.g. when a registry
+ * is attached to a Database) and then updated through the returned
+ * reference, so the hot path takes no lock and does no lookup.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+// Standard C++ libraries
+#include <atomic>    // For lock-free counters
+#include <chrono>    // For timing
+#include <cstdint>   // For fixed-width counters
+#include <map>       // For the named metrics
+#include <memory>    // For the metric objects
+#include <mutex>     // For registration and spans
+#include <ostream>   // For exports
+#include <string>    // For metric names
+#include <utility>   // For std::pair
+#include <vector>    // For bitmaps and spans
+
+static const size_t METRICS_CACHE_LINE = 64;   // Bytes per shard, so shards never share a cache line
+
+/**
+ * Sharded Counter Class
+ */
+class ShardedCounter {
+public:
+    static const int NUM_SHARDS = 16;   // Threads beyond this share shards (still lock-free)
+
+    ShardedCounter() { reset(); }
+
+    /**
+     * Add to Counter
+     *
+     * @param n Amount to add
+     */
+    void add(long long n = 1) {
+        shards[shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get Value
+     *
+     * @return Sum of all shards (exact once the adding threads are done)
+     */
+    long long value() const;
+
+    void reset();
+
+private:
+    ShardedCounter(const ShardedCounter&);
+    ShardedCounter& operator=(const ShardedCounter&);
+
+    /**
+     * Shard Index
+     *
+     * @return The calling thread's shard, assigned round-robin on first use
+     */
+    static int shardIndex();
+
+    struct Shard {
+        std::atomic<long long> value;
+        char padding[METRICS_CACHE_LINE - sizeof(std::atomic<long long>)];
+    };
+
+    Shard shards[NUM_SHARDS];
+};
+
+/**
+ * Page Set Class
+ *
+ * Set of non-negative page IDs, one bit each. Not thread-safe.
+ */
+class PageSet {
+public:
+    PageSet() : count(0) {}
+
+    /**
+     * Insert Page
+     *
+     * @param page_id Page to add (negative IDs are ignored)
+     * @return true if the page was not in the set
+     */
+    bool insert(int page_id) {
+        if (page_id < 0) return false;
+        size_t word = static_cast<size_t>(page_id) / 64;
+        if (word >= words.size()) grow(word);
+        uint64_t bit = 1ULL << (page_id % 64);
+        if ((words[word] & bit) != 0) return false;
+        words[word] |= bit;
+        count++;
+        return true;
+    }
+
+    bool contains(int page_id) const {
+        size_t word = static_cast<size_t>(page_id) / 64;
+        return page_id >= 0 && word < words.size() && (words[word] & (1ULL << (page_id % 64))) != 0;
+    }
+
+    /**
+     * Merge Set
+     *
+     * @param other Set whose pages are added
+     */
+    void merge(const PageSet& other);
+
+    size_t size() const { return count; }
+
+    /**
+     * Clear Set
+     *
+     * Keeps the bitmap's capacity, so a reset does not free memory that
+     * the next query would allocate again.
+     */
+    void clear();
+
+private:
+    void grow(size_t word);
+
+    std::vector<uint64_t> words;   // Bit i % 64 of word i / 64 is set if page i is in the set
+    size_t count;                  // Pages in the set
+};
+
+/**
+ * Latency Histogram Class
+ */
+class LatencyHistogram {
+public:
+    static const int NUM_BUCKETS = 40;   // Bucket b counts [2^b, 2^(b+1)) ns; the last also holds longer ones
+
+    LatencyHistogram() { reset(); }
+
+    /**
+     * Record Latency
+     *
+     * @param nanoseconds Duration of one operation
+     */
+    void record(uint64_t nanoseconds);
+
+    uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+    uint64_t getSumNanos() const { return sum_ns.load(std::memory_order_relaxed); }
+    uint64_t getMaxNanos() const { return max_ns.load(std::memory_order_relaxed); }
+    uint64_t getBucket(int bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+
+    /**
+     * Bucket Upper Bound
+     *
+     * @param bucket Bucket index
+     * @return Exclusive upper bound of the bucket in nanoseconds
+     */
+    static uint64_t bucketUpperBound(int bucket) { return 1ULL << (bucket + 1); }
+
+    /**
+     * Quantile
+     *
+     * @param q Quantile in [0, 1]
+     * @return Upper bound (ns) of the bucket holding the q-th value (0 if empty)
+     */
+    uint64_t quantile(double q) const;
+
+    void reset();
+
+private:
+    LatencyHistogram(const LatencyHistogram&);
+    LatencyHistogram& operator=(const LatencyHistogram&);
+
+    std::atomic<uint64_t> buckets[NUM_BUCKETS];   // Operations per bucket
+    std::atomic<uint64_t> count;                  // Operations recorded
+    std::atomic<uint64_t> sum_ns;                 // Total duration
+    std::atomic<uint64_t> max_ns;                 // Longest operation
+};
+
+/**
+ * Latency Timer Class
+ *
+ * Records the time from construction to destruction into a histogram;
+ * does nothing (not even read the clock) for a null histogram.
+ */
+class LatencyTimer {
+public:
+    explicit LatencyTimer(LatencyHistogram* histogram) : histogram(histogram) {
+        if (histogram != nullptr) start = std::chrono::steady_clock::now();
+    }
+
+    ~LatencyTimer() {
+        if (histogram == nullptr) return;
+        histogram->record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    }
+
+private:
+    LatencyTimer(const LatencyTimer&);
+    LatencyTimer& operator=(const LatencyTimer&);
+
+    LatencyHistogram* histogram;                     // Destination (nullptr = disabled)
+    std::chrono::steady_clock::time_point start;     // Start of the scope
+};
+
+/**
+ * Span Record Structure
+ *
+ * One finished ScopedSpan.
+ */
+struct SpanRecord {
+    int id;                                                  // Unique within the registry
+    int parent;                                              // Enclosing span on the same thread (-1 = none)
+    std::string name;                                        // Query or operator
+    double start_seconds;                                    // Start, relative to the registry's creation
+    double duration_seconds;                                 // Wall time
+    std::vector<std::pair<std::string, double> > attributes; // Values set on the span (e.g. blocks read)
+};
+
+/**
+ * Metrics Registry Class
+ *
+ * Metric objects are created on first lookup and live as long as the
+ * registry, so references to them stay valid. Names should use
+ * [a-z0-9_] (other characters are replaced by '_' in the Prometheus export).
+ */
+class MetricsRegistry {
+public:
+    MetricsRegistry();
+
+    /**
+     * Get Counter
+     *
+     * @param name Counter name
+     * @return The counter, created at zero if needed
+     */
+    ShardedCounter& counter(const std::string& name);
+
+    /**
+     * Get Histogram
+     *
+     * @param name Histogram name (exported in seconds)
+     * @return The histogram, created empty if needed
+     */
+    LatencyHistogram& histogram(const std::string& name);
+
+    /**
+     * Set Gauge
+     *
+     * @param name Gauge name
+     * @param value Current value
+     */
+    void setGauge(const std::string& name, double value);
+
+    // Spans (used by ScopedSpan)
+    int nextSpanId() { return next_span_id.fetch_add(1, std::memory_order_relaxed); }
+    void addSpan(const SpanRecord& span);
+    std::vector<SpanRecord> getSpans() const;
+
+    /**
+     * Seconds Since Creation
+     *
+     * @return Time from the registry's creation to now
+     */
+    double secondsSinceStart() const;
+
+    /**
+     * Write JSON
+     *
+     * One object with "counters", "gauges", "histograms" (count, sum, max,
+     * p50/p95/p99 and the non-empty buckets, in seconds) and "spans".
+     *
+     * @param out Destination stream
+     */
+    void writeJson(std::ostream& out) const;
+
+    /**
+     * Write Prometheus Text
+     *
+     * Prometheus exposition format: every metric is prefixed with prefix,
+     * counters get a _total suffix, histograms have cumulative le buckets
+     * in seconds, and spans are summarized per name as
+     * <prefix>span_duration_seconds{span="..."}.
+     *
+     * @param out Destination stream
+     * @param prefix Prefix of every metric name
+     */
+    void writePrometheus(std::ostream& out, const std::string& prefix = "sc3020_") const;
+
+    /**
+     * Reset
+     *
+     * Zeroes the counters and histograms and drops the gauges and spans;
+     * references stay valid.
+     */
+    void reset();
+
+private:
+    MetricsRegistry(const MetricsRegistry&);
+    MetricsRegistry& operator=(const MetricsRegistry&);
+
+    mutable std::mutex mutex;                                             // Guards the maps and spans
+    std::map<std::string, std::unique_ptr<ShardedCounter> > counters;     // By name
+    std::map<std::string, std::unique_ptr<LatencyHistogram> > histograms; // By name
+    std::map<std::string, double> gauges;                                 // By name
+    std::vector<SpanRecord> spans;                                        // Finished spans, in finishing order
+    std::atomic<int> next_span_id;                                        // Next span ID
+    std::chrono::steady_clock::time_point created;                        // Time origin of the spans
+};
+
+/**
+ * Scoped Span Class
+ *
+ * Times a scope and adds it to a registry when it ends, or earlier with
+ * finish() (for spans that end in the middle of a scope). A null registry
+ * disables the span.
+ */
+class ScopedSpan {
+public:
+    /**
+     * Constructor
+     *
+     * @param registry Registry to record into (nullptr = disabled)
+     * @param name Query or operator name
+     */
+    ScopedSpan(MetricsRegistry* registry, const std::string& name);
+
+    ~ScopedSpan() { finish(); }
+
+    /**
+     * Finish Span
+     *
+     * Ends the span and adds it to the registry; later calls do nothing.
+     */
+    void finish();
+
+    /**
+     * Set Attribute
+     *
+     * @param key Attribute name
+     * @param value Attribute value (a later value for the same key replaces it)
+     */
+    void set(const std::string& key, double value);
+
+    /**
+     * Elapsed Time
+     *
+     * @return Seconds since the span started
+     */
+    double elapsed() const;
+
+private:
+    ScopedSpan(const ScopedSpan&);
+    ScopedSpan& operator=(const ScopedSpan&);
+
+    MetricsRegistry* registry;                     // Destination (nullptr = disabled)
+    SpanRecord span;                               // Filled in as the span runs
+    ScopedSpan* enclosing;                         // Span open on this thread before this one
+    std::chrono::steady_clock::time_point start;   // Start of the scope
+};
+
+#endif // METRICS_H
@@ -0,0 +1,262 @@
+/**
+ * SC3020 Database Management System
+ * Parallel Utilities Header
+ *
+ * This file defines small helpers for spreading CPU-bound work over
+ * several threads, used by the index build and the parallel scans:
+ * - resolveThreads(): maps a requested thread count (0 = one per
+ *   hardware thread) to the number actually used
+ * - parallelFor(): splits an index range into contiguous chunks, one per
+ *   thread
+ * - parallelForStealing(): hands out an index range in small pieces; a
+ *   thread that runs out of work steals from the others, so uneven
+ *   pieces (scans that hit the disk, skewed key ranges) stay balanced
+ * - parallelRadixSort(): stable LSD radix sort on 32- or 64-bit keys, with the
+ *   histogram and scatter of every pass split across threads
+ * - floatSortKey(): maps a float to unsigned bits with the same order
+ *
+ * Chunks are contiguous and processed in index order within a chunk, so
+ * results that are concatenated by chunk index keep the input order.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+// Standard C++ libraries
+#include <vector>    // For chunk bounds and sort buffers
+#include <thread>    // For worker threads
+#include <cstddef>   // For size_t
+#include <cstdint>   // For uint32_t, uint64_t
+#include <cstring>   // For memcpy
+#include <algorithm> // For std::fill, std::swap
+#include <mutex>     // For work-stealing ranges
+#include <memory>    // For work-stealing ranges
+
+/**
+ * Resolve Thread Count
+ *
+ * @param requested Requested threads (0 or less = one per hardware thread)
+ * @return Number of threads to use (at least 1)
+ */
+inline int resolveThreads(int requested) {
+    if (requested > 0) return requested;
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+/**
+ * Parallel For
+ *
+ * Calls fn(begin, end, chunk) for num_threads contiguous chunks of
+ * [0, count). Chunk 0 runs on the calling thread; with one thread (or a
+ * single item) no thread is started.
+ *
+ * @param count Number of items
+ * @param num_threads Number of chunks (resolved with resolveThreads)
+ * @param fn Function called as fn(size_t begin, size_t end, int chunk)
+ * @return Number of chunks used
+ */
+template <typename Function>
+int parallelFor(size_t count, int num_threads, const Function& fn) {
+    int chunks = resolveThreads(num_threads);
+    if (static_cast<size_t>(chunks) > count) chunks = count > 0 ? static_cast<int>(count) : 1;
+
+    std::vector<std::thread> workers;
+    for (int c = 1; c < chunks; c++) {
+        size_t begin = count * c / chunks;
+        size_t end = count * (c + 1) / chunks;
+        workers.push_back(std::thread([&fn, begin, end, c]() { fn(begin, end, c); }));
+    }
+    fn(0, count / chunks, 0);
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    return chunks;
+}
+
+/**
+ * Parallel For with Work Stealing
+ *
+ * Calls fn(begin, end, worker) for pieces of at most grain items that
+ * together cover [0, count) exactly once. Every worker starts with a
+ * contiguous share of the range and takes pieces from its front, so a
+ * worker's own pieces are in ascending order. A worker whose share is
+ * used up steals a piece from the back of the share with the most items
+ * left. Worker 0 runs on the calling thread.
+ *
+ * Pieces are not handed out in index order across workers: results that
+ * must keep the input order have to be collected by piece position.
+ *
+ * @param count Number of items
+ * @param grain Most items per piece (at least 1)
+ * @param num_threads Number of workers (resolved with resolveThreads)
+ * @param fn Function called as fn(size_t begin, size_t end, int worker)
+ * @return Number of workers used
+ */
+template <typename Function>
+int parallelForStealing(size_t count, size_t grain, int num_threads, const Function& fn) {
+    if (grain == 0) grain = 1;
+    size_t pieces = (count + grain - 1) / grain;
+    int workers = resolveThreads(num_threads);
+    if (static_cast<size_t>(workers) > pieces) workers = pieces > 0 ? static_cast<int>(pieces) : 1;
+
+    // Remaining share of each worker: [next, end)
+    struct Share {
+        std::mutex mutex;
+        size_t next;
+        size_t end;
+    };
+    std::vector<std::unique_ptr<Share> > shares;
+    for (int w = 0; w < workers; w++) {
+        shares.push_back(std::unique_ptr<Share>(new Share()));
+        shares.back()->next = count * w / workers;
+        shares.back()->end = count * (w + 1) / workers;
+    }
+
+    auto work = [&](int worker) {
+        while (true) {
+            size_t begin = 0, end = 0;
+            {
+                // Own share first, from the front
+                Share& own = *shares[worker];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (own.next < own.end) {
+                    begin = own.next;
+                    end = std::min(own.end, begin + grain);
+                    own.next = end;
+                }
+            }
+            if (begin == end) {
+                // Steal from the back of the largest remaining share
+                int victim = -1;
+                size_t most = 0;
+                for (int w = 0; w < workers; w++) {
+                    std::lock_guard<std::mutex> lock(shares[w]->mutex);
+                    size_t left = shares[w]->end - shares[w]->next;
+                    if (left > most) {
+                        most = left;
+                        victim = w;
+                    }
+                }
+                if (victim == -1) return;
+                Share& share = *shares[victim];
+                std::lock_guard<std::mutex> lock(share.mutex);
+                if (share.next == share.end) continue; // Taken meanwhile: look again
+                end = share.end;
+                begin = end - std::min(grain, end - share.next);
+                share.end = begin;
+            }
+            fn(begin, end, worker);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 1; w < workers; w++) {
+        threads.push_back(std::thread(work, w));
+    }
+    work(0);
+
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    return workers;
+}
+
+/**
+ * Float Sort Key
+ *
+ * Maps a float to an unsigned integer that sorts in the same order
+ * (negative values have all bits flipped, positive values the sign bit).
+ *
+ * @param value Float key (not NaN)
+ * @return Order-preserving 32-bit key
+ */
+inline uint32_t floatSortKey(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+/**
+ * Parallel Radix Sort
+ *
+ * Sorts items by key(item) with 8-bit LSD passes, one per key byte
+ * (four for uint32_t keys, eight for uint64_t). Each pass:
+ * 1. Every thread counts the digits of its chunk
+ * 2. The counts are turned into per-thread output offsets, digit by digit
+ *    and chunk by chunk, so the pass is stable
+ * 3. Every thread scatters its chunk to the other buffer
+ * Passes in which every item has the same digit are skipped.
+ *
+ * The sort is stable: items with equal keys keep their input order.
+ * Time Complexity: O(n) per pass, divided over the threads
+ * Space Complexity: one extra copy of the items
+ *
+ * @param items Items to sort (sorted in place)
+ * @param key Function returning the unsigned (uint32_t or uint64_t) key of an item
+ * @param num_threads Number of threads (0 = one per hardware thread)
+ */
+template <typename T, typename KeyFunction>
+void parallelRadixSort(std::vector<T>& items, const KeyFunction& key, int num_threads) {
+    const int RADIX = 256;
+    size_t count = items.size();
+    if (count < 2) return;
+
+    int chunks = resolveThreads(num_threads);
+    if (static_cast<size_t>(chunks) > count) chunks = static_cast<int>(count);
+
+    const int KEY_BITS = static_cast<int>(sizeof(key(items[0]))) * 8;
+
+    std::vector<T> buffer(count);
+    std::vector<T>* source = &items;
+    std::vector<T>* target = &buffer;
+    std::vector<size_t> offsets(static_cast<size_t>(chunks) * RADIX);
+
+    for (int shift = 0; shift < KEY_BITS; shift += 8) {
+        // Step 1: per-chunk digit histograms
+        std::fill(offsets.begin(), offsets.end(), 0);
+        const std::vector<T>& in = *source;
+        parallelFor(count, chunks, [&](size_t begin, size_t end, int chunk) {
+            size_t* histogram = &offsets[static_cast<size_t>(chunk) * RADIX];
+            for (size_t i = begin; i < end; i++) {
+                histogram[(key(in[i]) >> shift) & (RADIX - 1)]++;
+            }
+        });
+
+        // Skip the pass if every item has the same digit
+        bool trivial = false;
+        for (int d = 0; d < RADIX && !trivial; d++) {
+            size_t total = 0;
+            for (int c = 0; c < chunks; c++) total += offsets[static_cast<size_t>(c) * RADIX + d];
+            if (total == count) trivial = true;
+            else if (total != 0) break;
+        }
+        if (trivial) continue;
+
+        // Step 2: exclusive prefix sum in (digit, chunk) order
+        size_t running = 0;
+        for (int d = 0; d < RADIX; d++) {
+            for (int c = 0; c < chunks; c++) {
+                size_t& slot = offsets[static_cast<size_t>(c) * RADIX + d];
+                size_t n = slot;
+                slot = running;
+                running += n;
+            }
+        }
+
+        // Step 3: stable scatter
+        std::vector<T>& out = *target;
+        parallelFor(count, chunks, [&](size_t begin, size_t end, int chunk) {
+            size_t* next = &offsets[static_cast<size_t>(chunk) * RADIX];
+            for (size_t i = begin; i < end; i++) {
+                out[next[(key(in[i]) >> shift) & (RADIX - 1)]++] = in[i];
+            }
+        });
+        std::swap(source, target);
+    }
+
+    if (source != &items) items.swap(buffer);
+}
+
+#endif // PARALLEL_H
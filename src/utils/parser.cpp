@@ -1,8 +1,27 @@
 #include "parser.h"
 #include <iostream>
-#include <sstream>
 #include <algorithm>
-#include <cctype>
+#include <cerrno>    // For strtof range errors
+#include <climits>   // For int range checks
+#include <cstdlib>   // For strtof fallback
+
+namespace {
+
+// Exact float powers of ten (10^10 = 5^10 * 2^10 and 5^10 < 2^24)
+const float POW10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+const int MAX_FAST_FRACTION_DIGITS = 10;
+const unsigned long long MAX_EXACT_MANTISSA = 1ULL << 24; // Largest run of exact float integers
+
+// Whitespace as accepted by strtol/strtof in the C locale
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+} // namespace
 
 /**
  * Parse Single Line from Games Data
@@ -15,59 +34,172 @@
  * @return Record structure containing the parsed data, or empty record if parsing fails
  */
 Record Parser::parseLine(const std::string& line) {
-    // Split the line by tab delimiter
-    std::vector<std::string> tokens = split(line, '\t');
+    return parseLine(line.data(), line.data() + line.size());
+}
+
+/**
+ * Parse Single Line in Place
+ * 
+ * Locates the first 9 tab-separated fields inside the caller's buffer and
+ * converts them without building strings. A field terminated by a tab
+ * always counts (even when empty); a trailing empty field after the last
+ * tab does not, matching the previous getline-based tokenizer.
+ * 
+ * @param begin First character of the line
+ * @param end One past the last character of the line
+ * @return Record structure containing the parsed data, or empty record if parsing fails
+ */
+Record Parser::parseLine(const char* begin, const char* end) {
+    static const int NUM_FIELDS = 9;
+    const char* field_begin[NUM_FIELDS];
+    const char* field_end[NUM_FIELDS];
+    
+    // Tokenize: record the bounds of each field
+    int num_fields = 0;
+    const char* p = begin;
+    while (num_fields < NUM_FIELDS) {
+        const char* tab = static_cast<const char*>(memchr(p, '\t', end - p));
+        if (tab == nullptr) {
+            if (p < end) {
+                field_begin[num_fields] = p;
+                field_end[num_fields] = end;
+                num_fields++;
+            }
+            break;
+        }
+        field_begin[num_fields] = p;
+        field_end[num_fields] = tab;
+        num_fields++;
+        p = tab + 1;
+    }
     
     // Check if we have enough tokens (need at least 9 fields)
-    if (tokens.size() < 9) {
+    if (num_fields < NUM_FIELDS) {
         return Record(); // Return empty record if insufficient data
     }
     
-    try {
-        // Extract each field from the tokens
-        std::string game_date = tokens[0];    // Game date (DD/MM/YYYY format)
-        int team_id = stringToInt(tokens[1]); // Home team identifier
-        int pts = stringToInt(tokens[2]);     // Points scored by home team
-        float fg_pct = stringToFloat(tokens[3]); // Field goal percentage
-        float ft_pct = stringToFloat(tokens[4]); // Free throw percentage (key for indexing)
-        float fg3_pct = stringToFloat(tokens[5]); // 3-point field goal percentage
-        int ast = stringToInt(tokens[6]);     // Assists
-        int reb = stringToInt(tokens[7]);     // Rebounds
-        int wins = stringToInt(tokens[8]);    // Win indicator (1=win, 0=loss)
-        
-        // Create and return the record
-        return Record(game_date, team_id, pts, fg_pct, ft_pct, fg3_pct, ast, reb, wins);
-    } catch (...) {
-        return Record(); // Return empty record on parsing error
+    Record record;
+    
+    // Game date (DD/MM/YYYY format), copied with strncpy semantics
+    for (int i = 0; i < 10 && field_begin[0] + i < field_end[0] && field_begin[0][i] != '\0'; i++) {
+        record.game_date[i] = field_begin[0][i];
     }
+    
+    record.team_id_home = stringToInt(field_begin[1], field_end[1]);     // Home team identifier
+    record.pts_home = stringToInt(field_begin[2], field_end[2]);         // Points scored by home team
+    record.fg_pct_home = stringToFloat(field_begin[3], field_end[3]);    // Field goal percentage
+    record.ft_pct_home = stringToFloat(field_begin[4], field_end[4]);    // Free throw percentage (key for indexing)
+    record.fg3_pct_home = stringToFloat(field_begin[5], field_end[5]);   // 3-point field goal percentage
+    record.ast_home = stringToInt(field_begin[6], field_end[6]);         // Assists
+    record.reb_home = stringToInt(field_begin[7], field_end[7]);         // Rebounds
+    record.home_team_wins = stringToInt(field_begin[8], field_end[8]);   // Win indicator (1=win, 0=loss)
+    
+    return record;
 }
 
+/**
+ * Parse Entire File
+ * 
+ * Parses the whole file through parseRange() and collects the records.
+ * 
+ * @param filename Path to the text file to parse
+ * @return Vector of valid Record structures
+ */
 std::vector<Record> Parser::parseFile(const std::string& filename) {
     std::vector<Record> records;
-    std::ifstream file(filename);
+    forEachRecord(filename, [&records](const Record& record) { records.push_back(record); });
+    return records;
+}
+
+/**
+ * Stream Records from File
+ * 
+ * Parses the whole file (header skipped) in constant memory.
+ * 
+ * @param filename Path to the text file to parse
+ * @param callback Function called for every valid record
+ * @return Number of bytes read, or -1 if the file cannot be opened
+ */
+long long Parser::forEachRecord(const std::string& filename, const RecordCallback& callback) {
+    return parseRange(filename, 0, -1, true, callback);
+}
+
+/**
+ * Parse Byte Range of File
+ * 
+ * Reads the range in READ_CHUNK_SIZE chunks. Complete lines are parsed
+ * directly in the chunk buffer; a partial line at the end of a chunk is
+ * moved to the front of the buffer and completed by the next read.
+ * 
+ * @param filename Path to the text file to parse
+ * @param begin Byte offset of the first line
+ * @param end Byte offset one past the last line (-1 for end of file)
+ * @param skip_header true if the first line in the range is the header row
+ * @param callback Function called for every valid record
+ * @return Number of bytes read, or -1 if the file cannot be opened
+ */
+long long Parser::parseRange(const std::string& filename, long long begin, long long end,
+                             bool skip_header, const RecordCallback& callback) {
+    std::ifstream file(filename, std::ios::binary);
     
     if (!file.is_open()) {
         std::cerr << "Error: Cannot open file " << filename << std::endl;
-        return records;
+        return -1;
     }
+    file.seekg(begin);
     
-    std::string line;
-    bool first_line = true;
+    std::vector<char> buffer(READ_CHUNK_SIZE);
+    size_t carry = 0;            // Bytes of an incomplete line at the front of the buffer
+    long long bytes_read = 0;
+    bool first_line = skip_header;
     
-    while (std::getline(file, line)) {
-        if (first_line) {
-            first_line = false; // Skip header line
-            continue;
+    while (end < 0 || begin + bytes_read < end) {
+        // A single line longer than the buffer: grow it
+        if (carry == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        
+        // Never read past the end of the range
+        long long want = static_cast<long long>(buffer.size() - carry);
+        if (end >= 0 && want > end - begin - bytes_read) {
+            want = end - begin - bytes_read;
         }
+        file.read(&buffer[carry], static_cast<std::streamsize>(want));
+        size_t got = static_cast<size_t>(file.gcount());
+        if (got == 0) break;
+        bytes_read += static_cast<long long>(got);
         
-        Record record = parseLine(line);
+        // Parse every complete line in the buffer
+        const char* p = &buffer[0];
+        const char* limit = p + carry + got;
+        const char* newline;
+        while ((newline = static_cast<const char*>(memchr(p, '\n', limit - p))) != nullptr) {
+            if (first_line) {
+                first_line = false; // Skip header line
+            } else {
+                Record record = parseLine(p, newline);
+                if (isValidRecord(record)) {
+                    callback(record);
+                }
+            }
+            p = newline + 1;
+        }
+        
+        // Keep the incomplete tail for the next chunk
+        carry = static_cast<size_t>(limit - p);
+        memmove(&buffer[0], p, carry);
+    }
+    
+    // Last line without a trailing newline
+    if (carry > 0 && !first_line) {
+        Record record = parseLine(&buffer[0], &buffer[0] + carry);
         if (isValidRecord(record)) {
-            records.push_back(record);
+            callback(record);
         }
     }
     
     file.close();
-    return records;
+    return bytes_read;
 }
 
 bool Parser::isValidRecord(const Record& record) {
@@ -80,67 +212,119 @@ bool Parser::isValidRecord(const Record& record) {
 }
 
 void Parser::printRecordStats(const std::vector<Record>& records) {
-    if (records.empty()) {
+    RecordStats stats;
+    for (const Record& record : records) {
+        stats.add(record);
+    }
+    printRecordStats(stats);
+}
+
+void Parser::printRecordStats(const RecordStats& stats) {
+    if (stats.count == 0) {
         std::cout << "No valid records found." << std::endl;
         return;
     }
     
     std::cout << "\n=== RECORD STATISTICS ===" << std::endl;
-    std::cout << "Total records: " << records.size() << std::endl;
+    std::cout << "Total records: " << stats.count << std::endl;
     
-    // Calculate statistics for FT_PCT_home
-    float min_ft = records[0].ft_pct_home;
-    float max_ft = records[0].ft_pct_home;
-    float sum_ft = 0.0f;
+    // Statistics for FT_PCT_home
+    float avg_ft = stats.sum_ft / stats.count;
     
-    for (const Record& record : records) {
-        if (record.ft_pct_home < min_ft) min_ft = record.ft_pct_home;
-        if (record.ft_pct_home > max_ft) max_ft = record.ft_pct_home;
-        sum_ft += record.ft_pct_home;
-    }
+    std::cout << "FT_PCT_home - Min: " << stats.min_ft 
+              << ", Max: " << stats.max_ft 
+              << ", Average: " << avg_ft << std::endl;
     
-    float avg_ft = sum_ft / records.size();
+    // Records with FT_PCT_home > 0.9
+    std::cout << "Records with FT_PCT_home > 0.9: " << stats.count_above_09 << std::endl;
+    std::cout << "==========================\n" << std::endl;
+}
+
+float Parser::stringToFloat(const char* begin, const char* end) {
+    const char* p = begin;
+    while (p < end && isSpace(*p)) p++;
     
-    std::cout << "FT_PCT_home - Min: " << min_ft 
-              << ", Max: " << max_ft 
-              << ", Average: " << avg_ft << std::endl;
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        p++;
+    }
     
-    // Count records with FT_PCT_home > 0.9
-    int count_above_09 = 0;
-    for (const Record& record : records) {
-        if (record.ft_pct_home > 0.9f) {
-            count_above_09++;
+    // Fast path: [digits][.digits] with an exact mantissa
+    unsigned long long mantissa = 0;
+    int num_digits = 0;
+    int fraction_digits = 0;
+    while (p < end && isDigit(*p) && num_digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        num_digits++;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && isDigit(*p) && num_digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            num_digits++;
+            fraction_digits++;
+            p++;
         }
     }
     
-    std::cout << "Records with FT_PCT_home > 0.9: " << count_above_09 << std::endl;
-    std::cout << "==========================\n" << std::endl;
-}
-
-std::vector<std::string> Parser::split(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
+    bool fast = num_digits > 0 &&
+                mantissa <= MAX_EXACT_MANTISSA &&
+                fraction_digits <= MAX_FAST_FRACTION_DIGITS &&
+                !(p < end && (isDigit(*p) || *p == 'e' || *p == 'E' || *p == 'x' || *p == 'X'));
+    if (fast) {
+        float value = static_cast<float>(mantissa) / POW10[fraction_digits];
+        return negative ? -value : value;
+    }
     
-    while (std::getline(ss, token, delimiter)) {
-        tokens.push_back(token);
+    // Slow path: exponents, long mantissas, hex, inf/nan
+    char small[64];
+    std::string large;
+    size_t length = static_cast<size_t>(end - begin);
+    const char* text;
+    if (length < sizeof(small)) {
+        memcpy(small, begin, length);
+        small[length] = '\0';
+        text = small;
+    } else {
+        large.assign(begin, end);
+        text = large.c_str();
     }
     
-    return tokens;
-}
-
-float Parser::stringToFloat(const std::string& str) {
-    try {
-        return std::stof(str);
-    } catch (...) {
-        return 0.0f;
+    char* parse_end = nullptr;
+    errno = 0;
+    float value = strtof(text, &parse_end);
+    if (parse_end == text || errno == ERANGE) {
+        return 0.0f; // No conversion or out of range (std::stof would throw)
     }
+    return value;
 }
 
-int Parser::stringToInt(const std::string& str) {
-    try {
-        return std::stoi(str);
-    } catch (...) {
-        return 0;
+int Parser::stringToInt(const char* begin, const char* end) {
+    const char* p = begin;
+    while (p < end && isSpace(*p)) p++;
+    
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        p++;
     }
+    
+    const char* digits = p;
+    long long value = 0;
+    bool overflow = false;
+    while (p < end && isDigit(*p)) {
+        if (value > static_cast<long long>(INT_MAX) + 1) {
+            overflow = true; // Keep consuming digits; the result is rejected anyway
+        } else {
+            value = value * 10 + (*p - '0');
+        }
+        p++;
+    }
+    
+    if (p == digits || overflow) return 0; // No digits or out of range
+    if (negative) value = -value;
+    if (value < INT_MIN || value > INT_MAX) return 0;
+    return static_cast<int>(value);
 }
@@ -11,6 +11,8 @@
  * - Type conversion from string to appropriate data types
  * - Statistics generation for data analysis
  * - Batch processing capabilities for large datasets
+ * - Chunked file reading with in-place tokenization (no per-line or
+ *   per-field allocations)
  * 
  * Data Format:
  * - Tab-separated values with 9 columns
@@ -40,6 +42,40 @@
 #include <string>    // For string operations
 #include <vector>    // For dynamic arrays
 #include <fstream>   // For file I/O
+#include <cstddef>   // For size_t
+#include <functional> // For per-record callbacks
+
+/**
+ * Record Statistics Structure
+ * 
+ * Running summary of FT_PCT_home over a stream of records. Records are
+ * added one at a time, so statistics can be computed while streaming a
+ * file or a database scan without keeping the records in memory.
+ */
+struct RecordStats {
+    long long count;            // Number of records seen
+    float min_ft;               // Minimum FT_PCT_home
+    float max_ft;               // Maximum FT_PCT_home
+    float sum_ft;               // Sum of FT_PCT_home (for the average)
+    long long count_above_09;   // Records with FT_PCT_home > 0.9
+    
+    RecordStats() : count(0), min_ft(0.0f), max_ft(0.0f), sum_ft(0.0f), count_above_09(0) {}
+    
+    /**
+     * Add Record
+     * 
+     * Folds one record into the summary.
+     * 
+     * @param record Record to add
+     */
+    void add(const Record& record) {
+        if (count == 0 || record.ft_pct_home < min_ft) min_ft = record.ft_pct_home;
+        if (count == 0 || record.ft_pct_home > max_ft) max_ft = record.ft_pct_home;
+        sum_ft += record.ft_pct_home;
+        if (record.ft_pct_home > 0.9f) count_above_09++;
+        count++;
+    }
+};
 
 /**
  * Parser Class
@@ -55,6 +91,10 @@
  */
 class Parser {
 public:
+    static const size_t READ_CHUNK_SIZE = 1 << 20; // Bytes read from the file per chunk (1 MB)
+    
+    typedef std::function<void(const Record&)> RecordCallback; // Receives each valid record
+    
     /**
      * Parse Single Line
      * 
@@ -66,17 +106,63 @@ public:
      */
     static Record parseLine(const std::string& line);
     
+    /**
+     * Parse Single Line (in place)
+     * 
+     * Parses the characters in [begin, end) without copying them.
+     * Fields are located by scanning for tabs and converted directly
+     * from the buffer.
+     * 
+     * @param begin First character of the line
+     * @param end One past the last character (excluding the newline)
+     * @return Record structure containing the parsed data
+     */
+    static Record parseLine(const char* begin, const char* end);
+    
     /**
      * Parse Entire File
      * 
      * Parses the entire games.txt file and returns a vector of records.
-     * Skips the header line and validates each record.
+     * Skips the header line and validates each record. The file is read
+     * in READ_CHUNK_SIZE chunks and lines are parsed where they lie in
+     * the chunk buffer.
      * 
      * @param filename Path to the text file to parse
      * @return Vector of valid Record structures
      */
     static std::vector<Record> parseFile(const std::string& filename);
     
+    /**
+     * Stream Records from File
+     * 
+     * Parses the file (skipping the header line) and passes each valid
+     * record to the callback instead of collecting them. Memory use is
+     * bounded by the read buffer regardless of the file size.
+     * 
+     * @param filename Path to the text file to parse
+     * @param callback Function called for every valid record, in file order
+     * @return Number of bytes read, or -1 if the file cannot be opened
+     */
+    static long long forEachRecord(const std::string& filename, const RecordCallback& callback);
+    
+    /**
+     * Parse Byte Range of File
+     * 
+     * Parses the lines starting in [begin, end) of the file and passes each
+     * valid record to the callback, in file order. begin must be the start
+     * of a line; end must be the start of a line or the end of the file.
+     * This lets several threads parse disjoint parts of one file.
+     * 
+     * @param filename Path to the text file to parse
+     * @param begin Byte offset of the first line
+     * @param end Byte offset one past the last line (-1 for end of file)
+     * @param skip_header true if the first line in the range is the header row
+     * @param callback Function called for every valid record
+     * @return Number of bytes read, or -1 if the file cannot be opened
+     */
+    static long long parseRange(const std::string& filename, long long begin, long long end,
+                                bool skip_header, const RecordCallback& callback);
+    
     /**
      * Validate Record
      * 
@@ -97,39 +183,45 @@ public:
      */
     static void printRecordStats(const std::vector<Record>& records);
     
-private:
     /**
-     * Split String by Delimiter
+     * Print Record Statistics
      * 
-     * Splits a string into tokens based on a delimiter character.
+     * Same report as printRecordStats(records) for a summary that was
+     * accumulated while streaming.
      * 
-     * @param str String to split
-     * @param delimiter Character to use as delimiter
-     * @return Vector of string tokens
+     * @param stats Accumulated statistics
      */
-    static std::vector<std::string> split(const std::string& str, char delimiter);
+    static void printRecordStats(const RecordStats& stats);
     
+private:
     /**
-     * Convert String to Float
+     * Convert Characters to Float
      * 
-     * Safely converts a string to a float value.
-     * Returns 0.0f if conversion fails.
+     * Converts [begin, end) to a float with the same result as std::stof.
+     * Plain decimals with up to 7 significant digits take a fast path:
+     * the digits form an integer mantissa that is exact in a float, and a
+     * single correctly rounded division by an exact power of ten gives the
+     * same value strtof would. Anything else falls back to strtof.
+     * Returns 0.0f if conversion fails or is out of range.
      * 
-     * @param str String to convert
+     * @param begin First character of the field
+     * @param end One past the last character of the field
      * @return Float value
      */
-    static float stringToFloat(const std::string& str);
+    static float stringToFloat(const char* begin, const char* end);
     
     /**
-     * Convert String to Integer
+     * Convert Characters to Integer
      * 
-     * Safely converts a string to an integer value.
-     * Returns 0 if conversion fails.
+     * Converts [begin, end) to an integer with the same result as std::stoi
+     * (leading whitespace, optional sign, decimal digits).
+     * Returns 0 if conversion fails or the value does not fit in an int.
      * 
-     * @param str String to convert
+     * @param begin First character of the field
+     * @param end One past the last character of the field
      * @return Integer value
      */
-    static int stringToInt(const std::string& str);
+    static int stringToInt(const char* begin, const char* end);
 };
 
 #endif // PARSER_H
@@ -0,0 +1,96 @@
+/**
+ * SC3020 Database Management System
+ * Thread Pool Implementation
+ *
+ * This file contains the implementation of ThreadPool: the worker loop and
+ * the job hand-off.
+ *
+ */
+
+#include "thread_pool.h"
+#include "parallel.h"
+
+ThreadPool::ThreadPool(int num_threads)
+    : job(nullptr), job_count(0), generation(0), busy_workers(0), stopping(false), next_index(0) {
+    int threads = resolveThreads(num_threads);
+    for (int w = 1; w < threads; w++) {
+        workers.push_back(std::thread([this, w]() { workerLoop(w); }));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+/**
+ * Run Job
+ *
+ * Algorithm:
+ * 1. Publish the job and wake the workers (small jobs run inline)
+ * 2. Take indices on the calling thread like any worker
+ * 3. Wait until every worker has seen the job and run out of indices,
+ *    so no worker still holds a reference to it when run() returns
+ */
+void ThreadPool::run(size_t count, const Job& fn) {
+    if (count == 0) return;
+    std::lock_guard<std::mutex> run_lock(run_mutex);
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; i++) fn(i, 0);
+        return;
+    }
+
+    // Step 1: Publish the job
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        job_count = count;
+        next_index.store(0, std::memory_order_relaxed);
+        busy_workers = static_cast<int>(workers.size());
+        generation++;
+    }
+    work_ready.notify_all();
+
+    // Step 2: Work on the calling thread
+    drain(fn, count, 0);
+
+    // Step 3: Wait for the workers
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this]() { return busy_workers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::workerLoop(int worker) {
+    unsigned long seen = 0;
+    while (true) {
+        const Job* current;
+        size_t count;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [this, seen]() { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            current = job;
+            count = job_count;
+        }
+        drain(*current, count, worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy_workers == 0) work_done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::drain(const Job& fn, size_t count, int worker) {
+    while (true) {
+        size_t i = next_index.fetch_add(1, std::memory_order_relaxed);
+        if (i >= count) return;
+        fn(i, worker);
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * SC3020 Database Management System
+ * Thread Pool Header
+ *
+ * This file defines ThreadPool, a fixed set of worker threads that stay
+ * alive between jobs. parallelFor() (parallel.h) starts and joins its
+ * threads on every call, which is fine for one index build but costs more
+ * than the work itself for a batch of small queries; the pool hands each
+ * batch to threads that are already running.
+ *
+ * A job is a function over the indices [0, count). Workers and the
+ * calling thread take indices from a shared atomic counter, so cheap and
+ * expensive items balance out without any per-item queueing.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+// Standard C++ libraries
+#include <atomic>              // For the next index
+#include <condition_variable>  // For waking workers and the caller
+#include <cstddef>             // For size_t
+#include <functional>          // For the job
+#include <mutex>               // For the job hand-off
+#include <thread>              // For the workers
+#include <vector>              // For the workers
+
+/**
+ * Thread Pool Class
+ */
+class ThreadPool {
+public:
+    typedef std::function<void(size_t, int)> Job;   // (index, worker); worker 0 is the calling thread
+
+    /**
+     * Constructor
+     *
+     * @param num_threads Threads running a job, including the caller
+     *        (0 = one per hardware thread); num_threads - 1 workers are started
+     */
+    explicit ThreadPool(int num_threads);
+
+    /**
+     * Destructor
+     *
+     * Stops and joins the workers.
+     */
+    ~ThreadPool();
+
+    /**
+     * Get Size
+     *
+     * @return Threads running a job, including the caller
+     */
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+
+    /**
+     * Run Job
+     *
+     * Calls fn(i, worker) exactly once for every i in [0, count) and
+     * returns when all calls have finished. Jobs submitted by several
+     * threads run one after another.
+     *
+     * @param count Number of indices
+     * @param fn Function to call; must be thread-safe
+     */
+    void run(size_t count, const Job& fn);
+
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    /**
+     * Worker Loop
+     *
+     * @param worker Worker number (1-based)
+     */
+    void workerLoop(int worker);
+
+    /**
+     * Drain Indices
+     *
+     * @param fn Current job
+     * @param count Indices of the job
+     * @param worker Calling worker
+     */
+    void drain(const Job& fn, size_t count, int worker);
+
+    std::vector<std::thread> workers;    // Started once, joined by the destructor
+    std::mutex run_mutex;                // Serializes run() callers
+    std::mutex mutex;                    // Guards the fields below
+    std::condition_variable work_ready;  // Signalled when a job starts or the pool stops
+    std::condition_variable work_done;   // Signalled when the last worker finishes a job
+    const Job* job;                      // Current job (nullptr = none)
+    size_t job_count;                    // Indices of the current job
+    unsigned long generation;            // Incremented per job, so a worker runs each job once
+    int busy_workers;                    // Workers not yet finished with the current job
+    bool stopping;                       // Set by the destructor
+    std::atomic<size_t> next_index;      // Next index to hand out
+};
+
+#endif // THREAD_POOL_H
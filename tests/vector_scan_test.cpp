@@ -0,0 +1,141 @@
+/**
+ * SC3020 Database Management System
+ * Vectorized Scan Test
+ *
+ * Checks ScanPredicate against a plain double comparison of every record,
+ * on both block layouts: the SIMD path (filterBlock), the scalar path
+ * (matches) and zone pruning (mayMatch). The constants include fractions,
+ * out-of-range values and NaN against integer columns and the date key.
+ *
+ * Run with `make test`; exits non-zero if any check fails.
+ */
+
+#include "../src/query/vector_scan.h"
+#include "../src/indexing/zone_map.h"
+
+#include <cmath>     // For NAN
+#include <iomanip>   // For the constants in failures
+#include <iostream>  // For the report
+#include <string>    // For the dates
+#include <vector>    // For the blocks
+
+namespace {
+
+int failures = 0;
+
+/**
+ * Expected Result
+ *
+ * @param value Column value
+ * @param op Operator
+ * @param constant Constant as given to the predicate
+ * @return The comparison evaluated in double precision
+ */
+bool expected(double value, CompareOp op, double constant) {
+    switch (op) {
+        case CompareOp::LT: return value < constant;
+        case CompareOp::LE: return value <= constant;
+        case CompareOp::GT: return value > constant;
+        case CompareOp::GE: return value >= constant;
+        case CompareOp::EQ: return value == constant;
+        case CompareOp::NE: return value != constant;
+    }
+    return false;
+}
+
+const char* opName(CompareOp op) {
+    static const char* const names[] = { "<", "<=", ">", ">=", "==", "!=" };
+    return names[static_cast<int>(op)];
+}
+
+/**
+ * Build Blocks
+ *
+ * Records with PTS_home from -3 to 104 and game dates 1/1/2022 to
+ * 6/1/2022, MAX_RECORDS per block.
+ *
+ * @param layout Block layout
+ * @param records Receives the records in slot order
+ * @return The blocks
+ */
+std::vector<Block> buildBlocks(BlockLayout layout, std::vector<Record>& records) {
+    std::vector<Block> blocks;
+    for (int pts = -3; pts <= 104; pts++) {
+        std::string date = std::to_string(1 + (pts + 3) % 6) + "/01/2022";
+        records.push_back(Record(date, 1610612737, pts, 0.5f, 0.75f, 0.25f, 20, 40, pts % 2 == 0));
+    }
+    for (size_t i = 0; i < records.size(); i++) {
+        if (blocks.empty() || !blocks.back().addRecord(records[i])) {
+            blocks.push_back(Block());
+            blocks.back().clear(layout);
+            blocks.back().addRecord(records[i]);
+        }
+    }
+    return blocks;
+}
+
+/**
+ * Check Comparison
+ *
+ * @param blocks Blocks holding records in order
+ * @param records Same records, flat
+ * @param field Column compared
+ * @param op Operator
+ * @param constant Constant
+ */
+void check(const std::vector<Block>& blocks, const std::vector<Record>& records,
+           RecordField field, CompareOp op, double constant) {
+    ScanPredicate predicate = ScanPredicate().where(field, op, constant);
+    int want = 0, got = 0, scalar_errors = 0;
+    bool pruned_match = false;
+    size_t next = 0;
+    for (size_t b = 0; b < blocks.size(); b++) {
+        ZoneMap::Zone zone;
+        int block_want = 0;
+        for (int slot = 0; slot < blocks[b].getNumSlots(); slot++, next++) {
+            const Record& record = records[next];
+            zone.add(record);
+            double value = field == RecordField::GAME_DATE ? record.dateKey() : record.pts_home;
+            bool hit = expected(value, op, constant);
+            block_want += hit;
+            if (predicate.matches(record) != hit) scalar_errors++;
+        }
+        uint32_t selection[Block::BITMAP_WORDS];
+        got += predicate.filterBlock(blocks[b], selection);
+        want += block_want;
+        if (block_want > 0 && !predicate.mayMatch(zone)) pruned_match = true;
+    }
+    if (got != want || scalar_errors != 0 || pruned_match) {
+        std::cout << std::setprecision(12) << "FAIL " << (field == RecordField::GAME_DATE ? "game_date " : "pts_home ")
+                  << opName(op) << " " << constant << ": expected " << want << ", filterBlock " << got << ", " << scalar_errors
+                  << " scalar mismatches" << (pruned_match ? ", matching block pruned" : "") << std::endl;
+        failures++;
+    }
+}
+
+} // namespace
+
+int main() {
+    const CompareOp ops[] = { CompareOp::LT, CompareOp::LE, CompareOp::GT, CompareOp::GE, CompareOp::EQ, CompareOp::NE };
+    const double pts_constants[] = { 100.0, 100.5, 99.5, -2.5, -2.0, -0.5, 0.0, 1e10, -1e10, NAN };
+    const double date_constants[] = { 20220103.0, 20220103.5, 20220102.5, 30000000000.0 };
+    const BlockLayout layouts[] = { BlockLayout::NSM, BlockLayout::PAX };
+
+    int checks = 0;
+    for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++) {
+        std::vector<Record> records;
+        std::vector<Block> blocks = buildBlocks(layouts[l], records);
+        for (size_t o = 0; o < sizeof(ops) / sizeof(ops[0]); o++) {
+            for (size_t c = 0; c < sizeof(pts_constants) / sizeof(pts_constants[0]); c++, checks++) {
+                check(blocks, records, RecordField::PTS_HOME, ops[o], pts_constants[c]);
+            }
+            for (size_t c = 0; c < sizeof(date_constants) / sizeof(date_constants[0]); c++, checks++) {
+                check(blocks, records, RecordField::GAME_DATE, ops[o], date_constants[c]);
+            }
+        }
+    }
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << ": vector_scan " << checks - failures << "/" << checks
+              << " comparisons" << std::endl;
+    return failures == 0 ? 0 : 1;
+}